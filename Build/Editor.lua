@@ -61,7 +61,7 @@ project "Editor"
     end
 
     if os.host() == "linux" then
-        links { "shaderc_shared", "X11" }
+        links { "shaderc_shared", "X11", "pthread" }
     end
 
     filter "configurations:Debug"
@@ -0,0 +1,68 @@
+project "Tests"
+    location "../Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    staticruntime "On" -- affects only windows
+    linkgroups "On" -- affects only linux
+
+    targetdir(paths.Binary)
+    objdir(paths.Temp)
+
+    -- cpu-only code, no window or vulkan device is created, run with --benchmark for the timings
+    files
+    {
+        "%{paths.Tests}/**.h",
+        "%{paths.Tests}/**.cpp",
+        -- renderer code that runs without a device
+        "%{paths.Renderer}/Core/BlockCompression.cpp",
+        "%{paths.Renderer}/Core/DrawReservation.cpp",
+        "%{paths.Renderer}/Core/KTXFile.cpp",
+        "%{paths.Renderer}/Core/RenderQueue.cpp",
+        "%{paths.Renderer}/Core/ResidencyPolicy.cpp",
+        "%{paths.Renderer}/Core/StagingRing.cpp",
+        "%{paths.Renderer}/Core/TextureCooker.cpp",
+        "%{paths.Renderer}/Core/ThumbnailGenerator.cpp",
+        "%{paths.Renderer}/GLTF/Accessor.cpp",
+        "%{paths.Renderer}/GLTF/Meshlet.cpp",
+        "%{paths.Renderer}/GLTF/Source.cpp",
+        "%{paths.Renderer}/Wrapper/tinygltf.cpp"
+    }
+    
+    includedirs
+    {
+        "%{paths.Workspace}",
+        "%{paths.Tests}",
+        --
+        "%{paths.glm}",
+        "%{paths.rapidjson}",
+        "%{paths.spdlog}",
+        "%{paths.stb}",
+        "%{paths.tinygltf}",
+        --
+        "%{paths.Common}",
+        "%{paths.Renderer}"
+    }
+
+    links
+    {
+        "Common"
+    }
+
+    if os.host() == "windows" then
+        defines { "_CRT_SECURE_NO_WARNINGS" }
+    end
+
+    if os.host() == "linux" then
+        links { "pthread" }
+    end
+
+    filter "configurations:Debug"
+        defines { "TESTS_DEBUG" }
+        runtime "Debug"
+        symbols "On"
+
+    filter "configurations:Release"
+        defines { "TESTS_RELEASE" }
+        runtime "Release"
+        optimize "On"
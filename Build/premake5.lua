@@ -37,6 +37,7 @@ paths["Engine"] = "../Engine";
 ---- applications
 paths["Editor"]  = "../Editor";
 paths["Game"]  = "../Game";
+paths["Tests"]  = "../Tests";
 
 -- project inclusion
 ---- dependencies
@@ -63,4 +64,8 @@ group ""
 group "Application"
     include "Editor.lua";
     include "Game.lua";
+group ""
+---- tests
+group "Tests"
+    include "Tests.lua";
 group ""
\ No newline at end of file
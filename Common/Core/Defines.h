@@ -18,4 +18,29 @@
 #define CONCURENTLY_RENDERED_FRAMES 2
 
 //// how many joints a mesh may have, this must be changed on shader as well
-#define COSMOS_MESH_MAX_JOINTS 128u
\ No newline at end of file
+#define COSMOS_MESH_MAX_JOINTS 128u
+//// how many unique vertices and triangles a meshlet (cluster of triangles) may hold
+#define COSMOS_MESHLET_MAX_VERTICES 64u
+#define COSMOS_MESHLET_MAX_TRIANGLES 124u
+
+//// textures at or below this size (on it's largest side) are never streamed out, they're the fallback while more detail is loaded
+#define COSMOS_TEXTURE_FALLBACK_SIZE 64u
+//// how many frames a texture may go without being drawn before it's considered idle and the first to lose detail
+#define COSMOS_RESIDENCY_IDLE_FRAMES 120u
+//// how many texture stream operations (in or out) may happen on a single frame
+#define COSMOS_RESIDENCY_UPLOADS_PER_FRAME 1u
+//// percent of the budget textures lose detail down to once over it and may regain detail up to, usage between it and the budget changes nothing
+#define COSMOS_RESIDENCY_LOW_WATERMARK 90u
+
+//// how many instances may be drawn on a single frame (all stages), each one takes 80 bytes of the per-frame instance buffer
+#define COSMOS_RENDER_MAX_INSTANCES 65536u
+//// how many primitive draws and instances of them the gpu culling may handle on a single frame, each draw is a single indirect command of it's visible instances
+#define COSMOS_CULLING_MAX_DRAWS 4096u
+#define COSMOS_CULLING_MAX_INSTANCES 262144u
+//// how many batches a recording thread gets at least, fewer batches than this are recorded on the calling thread alone
+#define COSMOS_RECORD_MIN_BATCHES 32u
+//// size of the persistently mapped staging ring uploads are copied through, bigger uploads than a quarter of it get their own staging
+#define COSMOS_UPLOAD_RING_SIZE (64ull * 1024ull * 1024ull)
+//// how many textures and materials the global descriptor set may reference, textures are clamped to what the device allows
+#define COSMOS_BINDLESS_MAX_TEXTURES 4096u
+#define COSMOS_BINDLESS_MAX_MATERIALS 4096u
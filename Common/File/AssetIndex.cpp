@@ -0,0 +1,555 @@
+#include "AssetIndex.h"
+
+#include "FileWatcher.h"
+#include "Debug/Logger.h"
+#include "Util/Timer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+namespace Cosmos
+{
+	// paths are compared in generic format, without dot components or a trailing slash
+	static std::string Normalize(const std::string& path)
+	{
+		std::string normalized = std::filesystem::path(path).lexically_normal().generic_string();
+
+		while (normalized.size() > 1 && normalized.back() == '/') {
+			normalized.pop_back();
+		}
+
+		return normalized;
+	}
+
+	static std::string ToLower(std::string text)
+	{
+		std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+		return text;
+	}
+
+	AssetIndex::AssetIndex(std::string root)
+		: mRoot(Normalize(root))
+	{
+		Node node = {};
+		node.name = mRoot;
+		node.directory = true;
+		mNodes.push_back(node);
+
+		mThread = std::thread(&AssetIndex::Run, this);
+	}
+
+	AssetIndex::~AssetIndex()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mStopMutex);
+			mStop = true;
+		}
+
+		mStopCondition.notify_all();
+		mThread.join();
+	}
+
+	bool AssetIndex::List(std::string directory, std::vector<Entry>& entries)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		uint32_t node = Find(Normalize(directory));
+
+		if (node == UINT32_MAX || !mNodes[node].directory) {
+			return false;
+		}
+
+		std::string path = GetPath(node);
+
+		for (auto& [name, child] : mNodes[node].children) {
+			entries.push_back({ path + "/" + name, mNodes[child].directory });
+		}
+
+		return true;
+	}
+
+	bool AssetIndex::BeginSearch(std::string text, std::string directory, bool recursive, Search& search)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		uint32_t node = Find(Normalize(directory));
+
+		if (node == UINT32_MAX || !mNodes[node].directory) {
+			return false;
+		}
+
+		search = {};
+		search.text = ToLower(text);
+		search.scope = node;
+		search.recursive = recursive;
+		search.generation = mGeneration;
+
+		std::vector<uint32_t> trigrams = {};
+		GetTrigrams(search.text, trigrams);
+
+		// too short for trigrams, a directory's own children are few enough to be the candidates
+		if (trigrams.empty() && !recursive) {
+			for (auto& [name, child] : mNodes[node].children) {
+				search.candidates.push_back(child);
+			}
+
+			search.end = search.candidates.size();
+			return true;
+		}
+
+		if (trigrams.empty()) {
+			search.all = true;
+			search.end = mNodes.size();
+			return true;
+		}
+
+		// the candidates are the nodes with every trigram of the text, intersected from the rarest one
+		std::vector<const std::vector<uint32_t>*> lists = {};
+
+		for (uint32_t trigram : trigrams)
+		{
+			auto it = mTrigrams.find(trigram);
+
+			if (it == mTrigrams.end()) {
+				return true; // nothing has it
+			}
+
+			lists.push_back(&it->second);
+		}
+
+		std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) { return a->size() < b->size(); });
+		search.candidates = *lists[0];
+
+		for (size_t i = 1; i < lists.size() && !search.candidates.empty(); i++)
+		{
+			std::vector<uint32_t> intersection = {};
+			std::set_intersection(search.candidates.begin(), search.candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(intersection));
+			search.candidates = std::move(intersection);
+		}
+
+		search.end = search.candidates.size();
+		return true;
+	}
+
+	bool AssetIndex::StepSearch(Search& search, std::vector<Entry>& entries, double budget)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		// it's ids are from before the nodes were renumbered
+		if (search.generation != mGeneration) {
+			search.position = search.end;
+			return true;
+		}
+
+		Timer timer;
+		timer.Start();
+
+		auto equal = [](char a, char b) { return (char)std::tolower((unsigned char)a) == b; };
+
+		while (search.position < search.end)
+		{
+			// checking the clock on every candidate would cost more than the candidate
+			if ((search.position & 255) == 255 && timer.Stop() > budget) {
+				return false;
+			}
+
+			uint32_t id = search.all ? (uint32_t)search.position : search.candidates[search.position];
+			search.position++;
+
+			const Node& node = mNodes[id];
+
+			if (!node.alive || id == search.scope) {
+				continue;
+			}
+
+			// trigrams only tell the name has the pieces, not that they're contiguous
+			if (std::search(node.name.begin(), node.name.end(), search.text.begin(), search.text.end(), equal) == node.name.end()) {
+				continue;
+			}
+
+			uint32_t parent = node.parent;
+
+			if (search.recursive) {
+				while (parent != UINT32_MAX && parent != search.scope) {
+					parent = mNodes[parent].parent;
+				}
+			}
+
+			if (parent != search.scope) {
+				continue;
+			}
+
+			entries.push_back({ GetPath(id), node.directory });
+		}
+
+		return true;
+	}
+
+	void AssetIndex::Run()
+	{
+		// the watcher is created first, so changes made while crawling aren't missed, inserting twice is harmless
+		FileWatcher watcher(mRoot, true);
+
+		Timer timer;
+		timer.Start();
+
+		// the lock is taken once per batch, a search on the ui thread never waits for the whole crawl
+		constexpr size_t batchSize = 1024;
+		std::vector<Entry> batch = {};
+		std::error_code error;
+
+		auto flush = [&]()
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+
+				for (const Entry& entry : batch) {
+					Insert(entry.path, entry.directory);
+				}
+
+				batch.clear();
+			};
+
+		auto options = std::filesystem::directory_options::skip_permission_denied;
+		for (auto it = std::filesystem::recursive_directory_iterator(mRoot, options, error); it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+		{
+			if (error) {
+				break;
+			}
+
+			batch.push_back({ it->path().generic_string(), it->is_directory(error) });
+
+			if (batch.size() == batchSize) {
+				flush();
+
+				std::unique_lock<std::mutex> lock(mStopMutex);
+				if (mStop) return;
+			}
+		}
+
+		flush();
+
+		size_t count = 0;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			count = mNodes.size() - 1;
+		}
+
+		COSMOS_LOG(Logger::Trace, "Indexed %zu files and directories of %s in %.2fms", count, mRoot.c_str(), timer.Stop());
+		mVersion++;
+		mReady = true;
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mStopMutex);
+				mStopCondition.wait_for(lock, std::chrono::milliseconds(100), [this]() { return mStop; });
+
+				if (mStop) {
+					return;
+				}
+			}
+
+			std::vector<FileWatcher::Change> changes = watcher.Poll();
+
+			if (changes.empty()) {
+				continue;
+			}
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+
+				for (const FileWatcher::Change& change : changes)
+				{
+					if (change.action == FileWatcher::Action::Removed) {
+						Remove(change.path);
+					}
+
+					else if (change.action != FileWatcher::Action::Rescan) {
+						Insert(change.path, change.directory);
+					}
+				}
+			}
+
+			// the watcher lost changes under these, they're listed from the disk again (it takes the lock itself, not while crawling)
+			for (const FileWatcher::Change& change : changes) {
+				if (change.action == FileWatcher::Action::Rescan) {
+					Rescan(change.path);
+				}
+			}
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+
+				if (mRemoved > mNodes.size() / 2) {
+					Compact();
+				}
+			}
+
+			mVersion++;
+		}
+	}
+
+	uint32_t AssetIndex::Insert(const std::string& path, bool directory)
+	{
+		std::string normalized = Normalize(path);
+
+		if (normalized.compare(0, mRoot.size(), mRoot) != 0 || normalized.size() <= mRoot.size() + 1 || normalized[mRoot.size()] != '/') {
+			return UINT32_MAX;
+		}
+
+		uint32_t node = 0;
+		size_t start = mRoot.size() + 1;
+		std::vector<uint32_t> trigrams = {};
+
+		while (start <= normalized.size())
+		{
+			size_t end = normalized.find('/', start);
+			bool last = end == std::string::npos;
+			std::string name = normalized.substr(start, last ? std::string::npos : end - start);
+			start = last ? normalized.size() + 1 : end + 1;
+
+			auto it = mNodes[node].children.find(name);
+
+			if (it != mNodes[node].children.end()) {
+				node = it->second;
+				continue;
+			}
+
+			// node ids only grow, so appending keeps every trigram list sorted
+			uint32_t id = (uint32_t)mNodes.size();
+
+			Node child = {};
+			child.name = name;
+			child.parent = node;
+			child.directory = last ? directory : true;
+			mNodes.push_back(std::move(child));
+			mNodes[node].children[name] = id;
+
+			GetTrigrams(ToLower(name), trigrams);
+
+			for (uint32_t trigram : trigrams) {
+				mTrigrams[trigram].push_back(id);
+			}
+
+			node = id;
+		}
+
+		return node;
+	}
+
+	void AssetIndex::Remove(const std::string& path)
+	{
+		uint32_t node = Find(Normalize(path));
+
+		if (node == UINT32_MAX || node == 0) {
+			return;
+		}
+
+		mNodes[mNodes[node].parent].children.erase(mNodes[node].name);
+
+		// a directory moved away is reported alone, everything under it goes with it
+		std::vector<uint32_t> stack = { node };
+
+		while (!stack.empty())
+		{
+			uint32_t id = stack.back();
+			stack.pop_back();
+
+			for (auto& [name, child] : mNodes[id].children) {
+				stack.push_back(child);
+			}
+
+			mNodes[id].alive = false;
+			mNodes[id].children.clear();
+			mRemoved++;
+		}
+	}
+
+	void AssetIndex::Rescan(const std::string& directory)
+	{
+		std::string path = Normalize(directory);
+		std::vector<Entry> entries = {};
+		std::error_code error;
+		bool exists = std::filesystem::is_directory(path, error);
+		bool complete = exists;
+
+		auto options = std::filesystem::directory_options::skip_permission_denied;
+		for (auto it = std::filesystem::recursive_directory_iterator(path, options, error); exists && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+		{
+			if (error) {
+				complete = false;
+				break;
+			}
+
+			entries.push_back({ it->path().generic_string(), it->is_directory(error) });
+		}
+
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		if (!exists) {
+			Remove(path);
+			return;
+		}
+
+		uint32_t node = path == mRoot ? 0 : Insert(path, true);
+
+		if (node == UINT32_MAX) {
+			return;
+		}
+
+		std::vector<uint32_t> ids = {};
+
+		for (const Entry& entry : entries)
+		{
+			uint32_t id = Insert(entry.path, entry.directory);
+
+			// it may have been replaced by a directory of the same name, or the other way around
+			if (id != UINT32_MAX) {
+				mNodes[id].directory = entry.directory;
+				ids.push_back(id);
+			}
+		}
+
+		// a crawl cut short can't tell what's gone
+		if (!complete) {
+			return;
+		}
+
+		std::vector<bool> seen(mNodes.size(), false);
+
+		for (uint32_t id : ids) {
+			seen[id] = true;
+		}
+
+		// whatever is on the index under the directory but wasn't listed is gone, it's removed with everything under it
+		std::vector<std::string> removed = {};
+		std::vector<uint32_t> stack = { node };
+
+		while (!stack.empty())
+		{
+			uint32_t id = stack.back();
+			stack.pop_back();
+
+			for (auto& [name, child] : mNodes[id].children)
+			{
+				if (!seen[child]) {
+					removed.push_back(GetPath(child));
+				}
+
+				else {
+					stack.push_back(child);
+				}
+			}
+		}
+
+		for (const std::string& gone : removed) {
+			Remove(gone);
+		}
+	}
+
+	uint32_t AssetIndex::Find(const std::string& path) const
+	{
+		if (path == mRoot) {
+			return 0;
+		}
+
+		if (path.compare(0, mRoot.size(), mRoot) != 0 || path.size() <= mRoot.size() + 1 || path[mRoot.size()] != '/') {
+			return UINT32_MAX;
+		}
+
+		uint32_t node = 0;
+		size_t start = mRoot.size() + 1;
+
+		while (start <= path.size())
+		{
+			size_t end = path.find('/', start);
+			bool last = end == std::string::npos;
+
+			auto it = mNodes[node].children.find(path.substr(start, last ? std::string::npos : end - start));
+
+			if (it == mNodes[node].children.end()) {
+				return UINT32_MAX;
+			}
+
+			node = it->second;
+			start = last ? path.size() + 1 : end + 1;
+		}
+
+		return node;
+	}
+
+	std::string AssetIndex::GetPath(uint32_t node) const
+	{
+		std::vector<uint32_t> components = {};
+
+		for (uint32_t id = node; id != 0 && id != UINT32_MAX; id = mNodes[id].parent) {
+			components.push_back(id);
+		}
+
+		std::string path = mRoot;
+
+		for (size_t i = components.size(); i-- > 0; ) {
+			path.append("/");
+			path.append(mNodes[components[i]].name);
+		}
+
+		return path;
+	}
+
+	void AssetIndex::Compact()
+	{
+		// the alive nodes keep their order, so parents stay before their children and the trigram lists come out sorted
+		std::vector<uint32_t> remap(mNodes.size(), UINT32_MAX);
+		std::vector<Node> nodes = {};
+		nodes.reserve(mNodes.size() - std::min(mRemoved, mNodes.size() - 1));
+
+		for (uint32_t id = 0; id < (uint32_t)mNodes.size(); id++)
+		{
+			if (mNodes[id].alive) {
+				remap[id] = (uint32_t)nodes.size();
+				nodes.push_back(std::move(mNodes[id]));
+			}
+		}
+
+		for (Node& node : nodes)
+		{
+			if (node.parent != UINT32_MAX) {
+				node.parent = remap[node.parent];
+			}
+
+			for (auto& [name, child] : node.children) {
+				child = remap[child];
+			}
+		}
+
+		mNodes = std::move(nodes);
+		mTrigrams.clear();
+
+		// the root is never a search result, it's name isn't indexed
+		std::vector<uint32_t> trigrams = {};
+
+		for (uint32_t id = 1; id < (uint32_t)mNodes.size(); id++)
+		{
+			GetTrigrams(ToLower(mNodes[id].name), trigrams);
+
+			for (uint32_t trigram : trigrams) {
+				mTrigrams[trigram].push_back(id);
+			}
+		}
+
+		// searches in progress hold the old ids, they end once they see the generation changed
+		mRemoved = 0;
+		mGeneration++;
+	}
+
+	void AssetIndex::GetTrigrams(const std::string& name, std::vector<uint32_t>& trigrams)
+	{
+		trigrams.clear();
+
+		for (size_t i = 0; i + 3 <= name.size(); i++) {
+			trigrams.push_back(((uint32_t)(uint8_t)name[i] << 16) | ((uint32_t)(uint8_t)name[i + 1] << 8) | (uint32_t)(uint8_t)name[i + 2]);
+		}
+
+		std::sort(trigrams.begin(), trigrams.end());
+		trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Cosmos
+{
+	// in-memory index of everything under a directory, crawled once and then kept current by a file watcher on it's own thread
+	// paths are kept on a trie of their components and names on a trigram index, so listing a directory or searching never touches the disk
+	class AssetIndex
+	{
+	public:
+
+		struct Entry
+		{
+			std::string path = {};								// generic format (forward slashes)
+			bool directory = false;
+		};
+
+		// a search in progress, it's stepped across frames until done
+		struct Search
+		{
+			std::string text = {};								// lowercase
+			uint32_t scope = UINT32_MAX;						// the directory searched
+			bool recursive = false;
+			bool all = false;									// too short for trigrams, every node is a candidate
+			std::vector<uint32_t> candidates = {};
+			size_t position = 0;
+			size_t end = 0;
+			uint64_t generation = 0;							// node ids are renumbered when compacting, a search from before is over
+		};
+
+	public:
+
+		// constructor, the crawl starts right away on the indexer thread
+		AssetIndex(std::string root);
+
+		// destructor
+		~AssetIndex();
+
+		// delete copy constructor
+		AssetIndex(const AssetIndex&) = delete;
+
+		// delete assignment constructor
+		AssetIndex& operator=(const AssetIndex&) = delete;
+
+		// returns if the first crawl is done, until then the index only holds part of the tree
+		inline bool IsReady() const { return mReady.load(); }
+
+		// returns a number that changes every time the index does
+		inline uint64_t GetVersion() const { return mVersion.load(); }
+
+		// returns how many nodes the index holds, removed ones are counted until compacted
+		inline size_t GetNodeCount() { std::unique_lock<std::mutex> lock(mMutex); return mNodes.size(); }
+
+	public:
+
+		// writes the entries directly inside a directory, returns false if it's not on the index
+		bool List(std::string directory, std::vector<Entry>& entries);
+
+		// starts a case-insensitive search for names containing text inside a directory, returns false if it's not on the index
+		bool BeginSearch(std::string text, std::string directory, bool recursive, Search& search);
+
+		// appends the matches found within budget milliseconds, returns true once the search is done
+		// a search begun before the index was compacted ends without results, the version has changed by then and it should be begun again
+		bool StepSearch(Search& search, std::vector<Entry>& entries, double budget);
+
+	private:
+
+		struct Node
+		{
+			std::string name = {};
+			uint32_t parent = UINT32_MAX;
+			bool directory = false;
+			bool alive = true;
+			std::unordered_map<std::string, uint32_t> children = {};
+		};
+
+		// crawls the root and then applies the watcher changes until stopped, it's the indexer thread
+		void Run();
+
+		// adds a path and the directories leading to it, returns it's node or UINT32_MAX if it's outside the root
+		uint32_t Insert(const std::string& path, bool directory);
+
+		// removes a path and everything under it
+		void Remove(const std::string& path);
+
+		// lists a directory again from the disk, adding what's new and removing what's gone, used when the watcher lost changes under it
+		void Rescan(const std::string& directory);
+
+		// returns the node of a path, UINT32_MAX if it's not on the index
+		uint32_t Find(const std::string& path) const;
+
+		// returns the full path of a node
+		std::string GetPath(uint32_t node) const;
+
+		// renumbers the nodes without the removed ones and rebuilds the trigram lists
+		void Compact();
+
+		// writes the trigrams of a lowercase name, without repeats
+		static void GetTrigrams(const std::string& name, std::vector<uint32_t>& trigrams);
+
+	private:
+
+		std::string mRoot = {};
+		std::thread mThread;
+		std::atomic<bool> mReady{ false };
+		std::atomic<uint64_t> mVersion{ 0 };
+
+		std::mutex mStopMutex;
+		std::condition_variable mStopCondition;
+		bool mStop = false;
+
+		// guards everything below, the indexer holds it for small batches only
+		std::mutex mMutex;
+		std::vector<Node> mNodes = {};							// the root is node 0, removed nodes are kept until compacted
+		std::unordered_map<uint32_t, std::vector<uint32_t>> mTrigrams = {};	// nodes with each trigram on their name, sorted
+		size_t mRemoved = 0;
+		uint64_t mGeneration = 0;								// how many times the nodes were renumbered
+	};
+}
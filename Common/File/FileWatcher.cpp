@@ -0,0 +1,266 @@
+#include "FileWatcher.h"
+
+#include "Debug/Logger.h"
+
+#if !defined _WIN32
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+namespace Cosmos
+{
+	FileWatcher::FileWatcher(std::string directory, bool recursive)
+		: mDirectory(std::filesystem::path(directory).generic_string()), mRecursive(recursive)
+	{
+		#if defined _WIN32
+		mWatching = std::filesystem::is_directory(mDirectory);
+
+		if (mWatching) {
+			Poll(); // takes the first snapshot, nothing is reported for files that already exist
+		}
+		#else
+		mDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+		if (mDescriptor < 0) {
+			COSMOS_LOG(Logger::Error, "Failed to create a file watcher for %s", mDirectory.c_str());
+			return;
+		}
+
+		Watch(mDirectory);
+		mWatching = !mWatches.empty();
+		#endif
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		#if !defined _WIN32
+		if (mDescriptor >= 0) {
+			close(mDescriptor); // also removes every watch
+		}
+		#endif
+	}
+
+	std::vector<FileWatcher::Change> FileWatcher::Poll()
+	{
+		std::vector<Change> changes = {};
+		std::unordered_map<std::string, size_t> indices = {};
+
+		if (!mWatching) {
+			return changes;
+		}
+
+		#if defined _WIN32
+		auto now = std::chrono::steady_clock::now();
+
+		if (mScanned && now - mLastScan < std::chrono::milliseconds(250)) {
+			return changes;
+		}
+
+		bool report = mScanned;
+		mScanned = true;
+		mLastScan = now;
+		std::unordered_map<std::string, std::filesystem::file_time_type> timestamps = {};
+		std::error_code error;
+
+		auto visit = [&](const std::filesystem::directory_entry& entry)
+			{
+				std::string path = entry.path().generic_string();
+				std::filesystem::file_time_type timestamp = entry.last_write_time(error);
+				timestamps[path] = timestamp;
+
+				auto it = mTimestamps.find(path);
+
+				if (it == mTimestamps.end()) {
+					if (report) Push(changes, indices, Action::Created, path, entry.is_directory(error));
+				}
+
+				else if (it->second != timestamp) {
+					Push(changes, indices, Action::Modified, path, entry.is_directory(error));
+				}
+			};
+
+		if (mRecursive) {
+			for (auto& entry : std::filesystem::recursive_directory_iterator(mDirectory, error)) visit(entry);
+		}
+
+		else {
+			for (auto& entry : std::filesystem::directory_iterator(mDirectory, error)) visit(entry);
+		}
+
+		for (auto& [path, timestamp] : mTimestamps) {
+			if (timestamps.find(path) == timestamps.end()) {
+				Push(changes, indices, Action::Removed, path, false);
+			}
+		}
+
+		mTimestamps = std::move(timestamps);
+		#else
+		// events are variable sized, the buffer must be aligned as an inotify_event
+		alignas(inotify_event) char buffer[4096];
+		std::vector<std::string> rescans = {};
+		bool overflowed = false;
+
+		while (true) {
+			ssize_t length = read(mDescriptor, buffer, sizeof(buffer));
+
+			if (length <= 0) {
+				break; // EAGAIN, nothing else to read
+			}
+
+			for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + ((inotify_event*)ptr)->len) {
+				const inotify_event* event = (const inotify_event*)ptr;
+
+				// the kernel queue filled up and events were dropped, there's no telling wich
+				if (event->mask & IN_Q_OVERFLOW) {
+					overflowed = true;
+					continue;
+				}
+
+				if (event->mask & IN_IGNORED) {
+					mWatches.erase(event->wd);
+					continue;
+				}
+
+				auto it = mWatches.find(event->wd);
+
+				if (it == mWatches.end() || event->len == 0) {
+					continue;
+				}
+
+				std::string path = it->second + "/" + event->name;
+				bool directory = (event->mask & IN_ISDIR) != 0;
+
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					// editors often save by renaming a temporary over the file, so this may also be an existing file being replaced
+					Push(changes, indices, Action::Created, path, directory);
+
+					if (directory && mRecursive) {
+						Watch(path);
+
+						// files created before the watch existed are reported here, or they'd be missed
+						std::error_code error;
+						for (auto& entry : std::filesystem::recursive_directory_iterator(path, error)) {
+							Push(changes, indices, Action::Created, entry.path().generic_string(), entry.is_directory(error));
+						}
+					}
+				}
+
+				else if (event->mask & IN_CLOSE_WRITE) {
+					Push(changes, indices, Action::Modified, path, directory);
+				}
+
+				else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+					Push(changes, indices, Action::Removed, path, directory);
+				}
+			}
+		}
+
+		// directories created while events were dropped aren't watched yet, watching the tree again adds them (existing watches are kept)
+		if (overflowed) {
+			COSMOS_LOG(Logger::Warn, "File watcher of %s overflowed, it's directory must be scanned again", mDirectory.c_str());
+			Watch(mDirectory);
+			rescans.push_back(mDirectory);
+		}
+
+		auto now = std::chrono::steady_clock::now();
+
+		if (!mUnwatched.empty() && now - mLastRetry >= std::chrono::seconds(2)) {
+			mLastRetry = now;
+
+			std::vector<std::string> unwatched = {};
+			unwatched.swap(mUnwatched);
+
+			for (const std::string& directory : unwatched)
+			{
+				std::error_code error;
+
+				if (!std::filesystem::is_directory(directory, error)) {
+					continue;
+				}
+
+				Watch(directory);
+
+				if (!overflowed) {
+					rescans.push_back(directory);
+				}
+			}
+		}
+		#endif
+
+		// changes merged away are left with an empty path
+		changes.erase(std::remove_if(changes.begin(), changes.end(), [](const Change& change) { return change.path.empty(); }), changes.end());
+
+		#if !defined _WIN32
+		for (const std::string& directory : rescans) {
+			changes.push_back({ Action::Rescan, directory, true });
+		}
+		#endif
+
+		return changes;
+	}
+
+	void FileWatcher::Watch(const std::string& directory)
+	{
+		#if !defined _WIN32
+		uint32_t mask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+		int watch = inotify_add_watch(mDescriptor, directory.c_str(), mask);
+
+		// it's sub-directories aren't watched either, the whole subtree is rescanned until the watch succeeds
+		if (watch < 0) {
+			if (std::find(mUnwatched.begin(), mUnwatched.end(), directory) == mUnwatched.end()) {
+				COSMOS_LOG(Logger::Warn, "Failed to watch directory %s, it will be rescanned periodically", directory.c_str());
+				mUnwatched.push_back(directory);
+			}
+
+			return;
+		}
+
+		mWatches[watch] = directory;
+
+		if (!mRecursive) {
+			return;
+		}
+
+		std::error_code error;
+		for (auto& entry : std::filesystem::directory_iterator(directory, error)) {
+			if (entry.is_directory(error)) {
+				Watch(entry.path().generic_string());
+			}
+		}
+		#endif
+	}
+
+	void FileWatcher::Push(std::vector<Change>& changes, std::unordered_map<std::string, size_t>& indices, Action action, const std::string& path, bool directory)
+	{
+		// a directory tree copied in reports every file at once, the lookup must not be linear
+		auto found = indices.find(path);
+
+		if (found == indices.end()) {
+			indices[path] = changes.size();
+			changes.push_back({ action, path, directory });
+			return;
+		}
+
+		Change* it = &changes[found->second];
+
+		// created and then written is still created, created and then removed never existed, removed and then created was replaced
+		if (it->action == Action::Created && action == Action::Modified) {
+			return;
+		}
+
+		if (it->action == Action::Created && action == Action::Removed) {
+			it->path.clear();
+			indices.erase(found);
+			return;
+		}
+
+		if (it->action == Action::Removed && action == Action::Created) {
+			it->action = Action::Modified;
+			return;
+		}
+
+		it->action = action;
+	}
+}
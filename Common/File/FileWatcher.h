@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Cosmos
+{
+	// reports changes made to the files of a directory, it's polled instead of calling back so the caller decides on wich thread changes are handled
+	class FileWatcher
+	{
+	public:
+
+		enum class Action
+		{
+			Created = 0,
+			Modified,
+			Removed,
+			Rescan										// changes under the directory were lost, it must be listed again
+		};
+
+		struct Change
+		{
+			Action action = Action::Modified;
+			std::string path;								// generic format (forward slashes)
+			bool directory = false;
+		};
+
+	public:
+
+		// constructor, recursive also watches sub-directories, including the ones created later
+		FileWatcher(std::string directory, bool recursive = false);
+
+		// destructor
+		~FileWatcher();
+
+		// delete copy constructor
+		FileWatcher(const FileWatcher&) = delete;
+
+		// delete assignment constructor
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		// returns the watched directory
+		inline const std::string& GetDirectory() const { return mDirectory; }
+
+		// returns if the directory is being watched
+		inline bool IsWatching() const { return mWatching; }
+
+	public:
+
+		// returns the changes since the last call, never blocks, a file saved several times in between is reported once
+		// rescans come last, for the whole directory when the system dropped events and for the sub-directories that couldn't be watched every few seconds
+		std::vector<Change> Poll();
+
+	private:
+
+		// starts watching a directory (and it's sub-directories when recursive)
+		void Watch(const std::string& directory);
+
+		// appends a change, merging it with a previous one of the same path, indices holds where each path is on changes
+		void Push(std::vector<Change>& changes, std::unordered_map<std::string, size_t>& indices, Action action, const std::string& path, bool directory);
+
+	private:
+
+		std::string mDirectory;
+		bool mRecursive = false;
+		bool mWatching = false;
+
+		#if defined _WIN32
+		// windows has no cheap non-blocking notification that fits a poll, modification times are compared instead
+		std::unordered_map<std::string, std::filesystem::file_time_type> mTimestamps = {};
+		std::chrono::steady_clock::time_point mLastScan = {};
+		bool mScanned = false;
+		#else
+		int mDescriptor = -1;
+		std::unordered_map<int, std::string> mWatches = {};
+		std::vector<std::string> mUnwatched = {};			// usually past the watch limit, retried and rescanned on an interval
+		std::chrono::steady_clock::time_point mLastRetry = {};
+		#endif
+	};
+}
@@ -50,5 +50,30 @@ namespace Cosmos
 
 		return assets;
 	}
+
+	std::string GetCacheDir()
+	{
+		// generated data lives next to the binary, it's safe to delete and never shipped with the assets
+		std::string cacheDir = GetBinDir();
+		cacheDir.append("/Cache");
+
+		std::error_code error;
+		std::filesystem::create_directories(cacheDir, error);
+
+		if (error) {
+			COSMOS_LOG(Logger::Error, "Failed to create cache directory %s: %s", cacheDir.c_str(), error.message().c_str());
+		}
+
+		return cacheDir;
+	}
+
+	std::string GetCacheSubDir(std::string subpath)
+	{
+		std::string cache = GetCacheDir();
+		cache.append("/");
+		cache.append(subpath);
+
+		return cache;
+	}
 }
 
@@ -16,4 +16,10 @@ namespace Cosmos
 
 	// returns the path of a sub-directory item that starts at the asset directory
 	std::string GetAssetSubDir(std::string subpath, bool removeExtension = false);
+
+	// returns the directory where generated data (pipeline cache, compiled shaders, etc) is kept, it's created when missing
+	std::string GetCacheDir();
+
+	// returns the path of a sub-directory item that starts at the cache directory
+	std::string GetCacheSubDir(std::string subpath);
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "MappedFile.h"
+
+#if defined _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Cosmos
+{
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(std::string path)
+	{
+		Close();
+
+		#if defined _WIN32
+		mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (mFile == INVALID_HANDLE_VALUE) {
+			mFile = nullptr;
+			return false;
+		}
+
+		LARGE_INTEGER size = {};
+		GetFileSizeEx(mFile, &size);
+		mSize = (size_t)size.QuadPart;
+
+		if (mSize == 0) {
+			Close();
+			return false;
+		}
+
+		mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mMapping == nullptr) {
+			Close();
+			return false;
+		}
+
+		mData = (const uint8_t*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+		#else
+		int descriptor = open(path.c_str(), O_RDONLY);
+
+		if (descriptor < 0) {
+			return false;
+		}
+
+		struct stat info = {};
+
+		if (fstat(descriptor, &info) != 0 || info.st_size == 0) {
+			close(descriptor);
+			return false;
+		}
+
+		mSize = (size_t)info.st_size;
+		void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+		// the mapping keeps it's own reference to the file
+		close(descriptor);
+
+		if (data == MAP_FAILED) {
+			mSize = 0;
+			return false;
+		}
+
+		madvise(data, mSize, MADV_WILLNEED);
+		mData = (const uint8_t*)data;
+		#endif
+
+		if (mData == nullptr) {
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		#if defined _WIN32
+		if (mData != nullptr) UnmapViewOfFile(mData);
+		if (mMapping != nullptr) CloseHandle(mMapping);
+		if (mFile != nullptr) CloseHandle(mFile);
+		mMapping = nullptr;
+		mFile = nullptr;
+		#else
+		if (mData != nullptr) munmap((void*)mData, mSize);
+		#endif
+
+		mData = nullptr;
+		mSize = 0;
+	}
+}
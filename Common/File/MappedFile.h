@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Cosmos
+{
+	// read-only memory mapping of a whole file, the operating system pages the content in on demand
+	class MappedFile
+	{
+	public:
+
+		// constructor
+		MappedFile() = default;
+
+		// destructor
+		~MappedFile();
+
+		// delete copy constructor
+		MappedFile(const MappedFile&) = delete;
+
+		// delete assignment constructor
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// returns the mapped content
+		inline const uint8_t* GetData() const { return mData; }
+
+		// returns the mapped content size in bytes
+		inline size_t GetSize() const { return mSize; }
+
+		// returns if a file is currently mapped
+		inline bool IsOpen() const { return mData != nullptr; }
+
+	public:
+
+		// maps a file into memory, returns false if it couldn't be opened
+		bool Open(std::string path);
+
+		// unmaps the current file
+		void Close();
+
+	private:
+
+		const uint8_t* mData = nullptr;
+		size_t mSize = 0;
+
+		#if defined _WIN32
+		void* mFile = nullptr;
+		void* mMapping = nullptr;
+		#endif
+	};
+}
@@ -0,0 +1,272 @@
+#include "DynamicBVH.h"
+
+#include <algorithm>
+
+namespace Cosmos
+{
+	// surface area of a box, the cost of a node is proportional to the chance of a query touching it
+	static float SurfaceArea(const glm::vec3& min, const glm::vec3& max)
+	{
+		glm::vec3 d = max - min;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	DynamicBVH::DynamicBVH(float margin)
+		: mMargin(margin)
+	{
+	}
+
+	int32_t DynamicBVH::Insert(const glm::vec3& min, const glm::vec3& max, uint64_t userData)
+	{
+		int32_t proxy = AllocateNode();
+		glm::vec3 margin = (max - min) * mMargin;
+
+		mNodes[proxy].min = min - margin;
+		mNodes[proxy].max = max + margin;
+		mNodes[proxy].userData = userData;
+		mNodes[proxy].height = 0;
+
+		InsertLeaf(proxy);
+		mProxyCount++;
+
+		return proxy;
+	}
+
+	void DynamicBVH::Remove(int32_t proxy)
+	{
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		mProxyCount--;
+	}
+
+	bool DynamicBVH::Move(int32_t proxy, const glm::vec3& min, const glm::vec3& max)
+	{
+		Node& node = mNodes[proxy];
+
+		// still inside the enlarged bounds, nothing changes
+		if (glm::all(glm::greaterThanEqual(min, node.min)) && glm::all(glm::lessThanEqual(max, node.max))) {
+			return false;
+		}
+
+		RemoveLeaf(proxy);
+
+		glm::vec3 margin = (max - min) * mMargin;
+		mNodes[proxy].min = min - margin;
+		mNodes[proxy].max = max + margin;
+
+		InsertLeaf(proxy);
+		return true;
+	}
+
+	void DynamicBVH::Clear()
+	{
+		mNodes.clear();
+		mRoot = Null;
+		mFreeList = Null;
+		mProxyCount = 0;
+	}
+
+	int32_t DynamicBVH::AllocateNode()
+	{
+		if (mFreeList == Null) {
+			mNodes.emplace_back();
+			return (int32_t)mNodes.size() - 1;
+		}
+
+		int32_t node = mFreeList;
+		mFreeList = mNodes[node].parent;
+		mNodes[node] = Node();
+		return node;
+	}
+
+	void DynamicBVH::FreeNode(int32_t node)
+	{
+		mNodes[node].parent = mFreeList;
+		mNodes[node].height = -1;
+		mFreeList = node;
+	}
+
+	void DynamicBVH::InsertLeaf(int32_t leaf)
+	{
+		if (mRoot == Null) {
+			mRoot = leaf;
+			mNodes[leaf].parent = Null;
+			return;
+		}
+
+		// descends to the sibling where the leaf costs the least, a subtree is skipped once going down costs more than stopping
+		glm::vec3 leafMin = mNodes[leaf].min;
+		glm::vec3 leafMax = mNodes[leaf].max;
+		int32_t index = mRoot;
+
+		while (mNodes[index].left != Null) {
+			const Node& node = mNodes[index];
+			float area = SurfaceArea(node.min, node.max);
+			float combinedArea = SurfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+			// a new parent here costs the combined area, every ancestor below it grows as well
+			float cost = 2.0f * combinedArea;
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto descendCost = [&](int32_t child) -> float
+				{
+					const Node& childNode = mNodes[child];
+					float childArea = SurfaceArea(glm::min(childNode.min, leafMin), glm::max(childNode.max, leafMax));
+					return (childNode.left == Null ? childArea : childArea - SurfaceArea(childNode.min, childNode.max)) + inheritanceCost;
+				};
+
+			float costLeft = descendCost(node.left);
+			float costRight = descendCost(node.right);
+
+			if (cost < costLeft && cost < costRight) {
+				break;
+			}
+
+			index = costLeft < costRight ? node.left : node.right;
+		}
+
+		int32_t sibling = index;
+		int32_t oldParent = mNodes[sibling].parent;
+		int32_t newParent = AllocateNode();
+
+		mNodes[newParent].parent = oldParent;
+		mNodes[newParent].min = glm::min(mNodes[sibling].min, leafMin);
+		mNodes[newParent].max = glm::max(mNodes[sibling].max, leafMax);
+		mNodes[newParent].height = mNodes[sibling].height + 1;
+		mNodes[newParent].left = sibling;
+		mNodes[newParent].right = leaf;
+		mNodes[sibling].parent = newParent;
+		mNodes[leaf].parent = newParent;
+
+		if (oldParent == Null) {
+			mRoot = newParent;
+		}
+
+		else if (mNodes[oldParent].left == sibling) {
+			mNodes[oldParent].left = newParent;
+		}
+
+		else {
+			mNodes[oldParent].right = newParent;
+		}
+
+		Refit(mNodes[leaf].parent);
+	}
+
+	void DynamicBVH::RemoveLeaf(int32_t leaf)
+	{
+		if (leaf == mRoot) {
+			mRoot = Null;
+			return;
+		}
+
+		// the leaf parent is removed as well, the sibling takes it's place
+		int32_t parent = mNodes[leaf].parent;
+		int32_t grandParent = mNodes[parent].parent;
+		int32_t sibling = mNodes[parent].left == leaf ? mNodes[parent].right : mNodes[parent].left;
+
+		if (grandParent == Null) {
+			mRoot = sibling;
+			mNodes[sibling].parent = Null;
+			FreeNode(parent);
+			return;
+		}
+
+		if (mNodes[grandParent].left == parent) {
+			mNodes[grandParent].left = sibling;
+		}
+
+		else {
+			mNodes[grandParent].right = sibling;
+		}
+
+		mNodes[sibling].parent = grandParent;
+		FreeNode(parent);
+		Refit(grandParent);
+	}
+
+	int32_t DynamicBVH::Balance(int32_t a)
+	{
+		if (mNodes[a].left == Null || mNodes[a].height < 2) {
+			return a;
+		}
+
+		int32_t b = mNodes[a].left;
+		int32_t c = mNodes[a].right;
+		int32_t balance = mNodes[c].height - mNodes[b].height;
+
+		// the taller child is rotated up, a becomes it's child and keeps the shorter grandchild
+		auto rotate = [&](int32_t up, int32_t kept, bool upIsRight) -> int32_t
+			{
+				int32_t f = mNodes[up].left;
+				int32_t g = mNodes[up].right;
+
+				mNodes[up].left = a;
+				mNodes[up].parent = mNodes[a].parent;
+				mNodes[a].parent = up;
+
+				if (mNodes[up].parent == Null) {
+					mRoot = up;
+				}
+
+				else if (mNodes[mNodes[up].parent].left == a) {
+					mNodes[mNodes[up].parent].left = up;
+				}
+
+				else {
+					mNodes[mNodes[up].parent].right = up;
+				}
+
+				int32_t taller = mNodes[f].height > mNodes[g].height ? f : g;
+				int32_t shorter = taller == f ? g : f;
+
+				mNodes[up].right = taller;
+
+				if (upIsRight) {
+					mNodes[a].right = shorter;
+				}
+
+				else {
+					mNodes[a].left = shorter;
+				}
+
+				mNodes[shorter].parent = a;
+
+				mNodes[a].min = glm::min(mNodes[kept].min, mNodes[shorter].min);
+				mNodes[a].max = glm::max(mNodes[kept].max, mNodes[shorter].max);
+				mNodes[a].height = 1 + std::max(mNodes[kept].height, mNodes[shorter].height);
+
+				mNodes[up].min = glm::min(mNodes[a].min, mNodes[taller].min);
+				mNodes[up].max = glm::max(mNodes[a].max, mNodes[taller].max);
+				mNodes[up].height = 1 + std::max(mNodes[a].height, mNodes[taller].height);
+
+				return up;
+			};
+
+		if (balance > 1) {
+			return rotate(c, b, true);
+		}
+
+		if (balance < -1) {
+			return rotate(b, c, false);
+		}
+
+		return a;
+	}
+
+	void DynamicBVH::Refit(int32_t node)
+	{
+		while (node != Null) {
+			node = Balance(node);
+
+			int32_t left = mNodes[node].left;
+			int32_t right = mNodes[node].right;
+
+			mNodes[node].height = 1 + std::max(mNodes[left].height, mNodes[right].height);
+			mNodes[node].min = glm::min(mNodes[left].min, mNodes[right].min);
+			mNodes[node].max = glm::max(mNodes[left].max, mNodes[right].max);
+
+			node = mNodes[node].parent;
+		}
+	}
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "Math.h"
+#include "Frustum.h"
+#include <vector>
+
+namespace Cosmos
+{
+	class DynamicBVH
+	{
+	public:
+
+		static constexpr int32_t Null = -1;
+
+		// percent of the proxies a frustum query must accept for the next one to scan the leaves instead of walking the tree
+		// on a 100k proxies city both take the same time at about a quarter accepted, at 80% the walk is 2.3x slower than the scan
+		// the scan still steps over the internal nodes, so a wide view stays about 1.5x slower than a plain loop over the entities
+		static constexpr uint32_t ScanLeavesPercent = 25;
+
+		struct Node
+		{
+			glm::vec3 min = glm::vec3(0.0f);
+			glm::vec3 max = glm::vec3(0.0f);
+			uint64_t userData = 0;
+			int32_t parent = Null;			// also the next free node while the node is unused
+			int32_t left = Null;			// leaves have no children
+			int32_t right = Null;
+			int32_t height = -1;			// leaves are at zero, unused nodes at -1
+		};
+
+		struct QueryStatistics
+		{
+			uint32_t nodesTested = 0;
+			uint32_t leavesAccepted = 0;
+			bool scanned = false;			// the leaves were tested in memory order instead of walking the tree
+		};
+
+	public:
+
+		// constructor, leaves are enlarged by margin (relative to their size) so small movements don't change the tree
+		DynamicBVH(float margin = 0.1f);
+
+		// destructor
+		~DynamicBVH() = default;
+
+		// returns how many leaves (proxies) the tree has
+		inline uint32_t GetProxyCount() const { return mProxyCount; }
+
+		// returns the tree height, zero for a single leaf
+		inline int32_t GetHeight() const { return mRoot == Null ? 0 : mNodes[mRoot].height; }
+
+		// returns the user data given to a proxy
+		inline uint64_t GetUserData(int32_t proxy) const { return mNodes[proxy].userData; }
+
+		// returns a reference to the enlarged bounds of a node
+		inline const Node& GetNodeRef(int32_t node) const { return mNodes[node]; }
+
+	public:
+
+		// inserts a proxy with given world bounds, returns the proxy handle
+		int32_t Insert(const glm::vec3& min, const glm::vec3& max, uint64_t userData);
+
+		// removes a proxy
+		void Remove(int32_t proxy);
+
+		// updates a proxy bounds, the tree only changes if it's outside the enlarged ones, returns if it did
+		bool Move(int32_t proxy, const glm::vec3& min, const glm::vec3& max);
+
+		// removes all proxies
+		void Clear();
+
+		// calls visit(userData) for every proxy at least partially inside the frustum, subtrees fully inside are accepted without further tests
+		// accepting a subtree still walks every node under it out of memory order, once a query accepts most of the proxies (a view from above)
+		// that's slower than testing each leaf, so the next queries scan the node array in order until they accept less again
+		template<typename T>
+		QueryStatistics Query(const Frustum& frustum, T&& visit) const
+		{
+			QueryStatistics statistics = {};
+
+			if (mRoot == Null) {
+				return statistics;
+			}
+
+			if (mScanLeaves)
+			{
+				statistics.scanned = true;
+
+				for (const Node& node : mNodes)
+				{
+					if (node.height != 0) {
+						continue;
+					}
+
+					statistics.nodesTested++;
+
+					if (frustum.ContainsAABB(node.min, node.max)) {
+						statistics.leavesAccepted++;
+						visit(node.userData);
+					}
+				}
+
+				mScanLeaves = statistics.leavesAccepted * 100 > mProxyCount * ScanLeavesPercent;
+				return statistics;
+			}
+
+			// the second value tells if the node is known to be fully inside
+			std::vector<std::pair<int32_t, bool>>& stack = mStack;
+			stack.clear();
+			stack.push_back({ mRoot, false });
+
+			while (!stack.empty()) {
+				auto [index, inside] = stack.back();
+				stack.pop_back();
+
+				const Node& node = mNodes[index];
+
+				if (!inside) {
+					statistics.nodesTested++;
+					Frustum::Intersection intersection = frustum.ClassifyAABB(node.min, node.max);
+
+					if (intersection == Frustum::Intersection::Outside) {
+						continue;
+					}
+
+					inside = intersection == Frustum::Intersection::Inside;
+				}
+
+				if (node.left == Null) {
+					statistics.leavesAccepted++;
+					visit(node.userData);
+					continue;
+				}
+
+				stack.push_back({ node.left, inside });
+				stack.push_back({ node.right, inside });
+			}
+
+			mScanLeaves = statistics.leavesAccepted * 100 > mProxyCount * ScanLeavesPercent;
+			return statistics;
+		}
+
+		// calls visit(userData, maxDistance) for every proxy the ray crosses closer than maxDistance, direction doesn't need to be normalized and distances are in it's units
+		// visit returns the distance of it's own hit or maxDistance when there's none, nodes farther than the closest hit so far are skipped and the nearest child is visited first
+		template<typename T>
+		QueryStatistics RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, T&& visit) const
+		{
+			QueryStatistics statistics = {};
+
+			if (mRoot == Null) {
+				return statistics;
+			}
+
+			glm::vec3 inverse = 1.0f / direction;
+			std::vector<std::pair<int32_t, float>> stack = {};
+			stack.push_back({ mRoot, 0.0f });
+
+			while (!stack.empty()) {
+				auto [index, entry] = stack.back();
+				stack.pop_back();
+
+				// a closer hit may have been found since the node was pushed
+				if (entry > maxDistance) {
+					continue;
+				}
+
+				const Node& node = mNodes[index];
+
+				if (node.left == Null) {
+					statistics.leavesAccepted++;
+					maxDistance = visit(node.userData, maxDistance);
+					continue;
+				}
+
+				statistics.nodesTested += 2;
+				float left = RayEntry(origin, inverse, mNodes[node.left].min, mNodes[node.left].max, maxDistance);
+				float right = RayEntry(origin, inverse, mNodes[node.right].min, mNodes[node.right].max, maxDistance);
+
+				// the nearest one is pushed last so it's popped first
+				if (left >= 0.0f && right >= 0.0f) {
+					bool leftFirst = left <= right;
+					stack.push_back({ leftFirst ? node.right : node.left, leftFirst ? right : left });
+					stack.push_back({ leftFirst ? node.left : node.right, leftFirst ? left : right });
+				}
+
+				else if (left >= 0.0f) {
+					stack.push_back({ node.left, left });
+				}
+
+				else if (right >= 0.0f) {
+					stack.push_back({ node.right, right });
+				}
+			}
+
+			return statistics;
+		}
+
+	private:
+
+		// returns the distance the ray enters the bounds at, zero if it starts inside and negative if it misses them or enters past maxDistance
+		static inline float RayEntry(const glm::vec3& origin, const glm::vec3& inverse, const glm::vec3& min, const glm::vec3& max, float maxDistance)
+		{
+			float enter = 0.0f;
+			float exit = maxDistance;
+
+			for (int32_t axis = 0; axis < 3; axis++)
+			{
+				float t0 = (min[axis] - origin[axis]) * inverse[axis];
+				float t1 = (max[axis] - origin[axis]) * inverse[axis];
+
+				// zero times infinity, the ray runs along the axis starting on one of the bounds planes, the slab doesn't limit it
+				if (t0 != t0 || t1 != t1) {
+					continue;
+				}
+
+				enter = glm::max(enter, glm::min(t0, t1));
+				exit = glm::min(exit, glm::max(t0, t1));
+			}
+
+			return enter <= exit ? enter : -1.0f;
+		}
+
+		// returns an unused node, growing the pool when needed
+		int32_t AllocateNode();
+
+		// returns a node into the pool
+		void FreeNode(int32_t node);
+
+		// places a leaf next to the sibling that least increases the total surface area
+		void InsertLeaf(int32_t leaf);
+
+		// detaches a leaf from the tree, it's node is kept
+		void RemoveLeaf(int32_t leaf);
+
+		// rotates the subtree if it's unbalanced, returns the new subtree root
+		int32_t Balance(int32_t node);
+
+		// recomputes bounds and heights from a node up to the root, balancing along the way
+		void Refit(int32_t node);
+
+	private:
+
+		std::vector<Node> mNodes = {};
+		mutable std::vector<std::pair<int32_t, bool>> mStack = {};
+		mutable bool mScanLeaves = false;
+		int32_t mRoot = Null;
+		int32_t mFreeList = Null;
+		uint32_t mProxyCount = 0;
+		float mMargin = 0.1f;
+	};
+}
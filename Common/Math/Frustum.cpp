@@ -0,0 +1,128 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COSMOS_FRUSTUM_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Cosmos
+{
+	Frustum::Frustum(const glm::mat4& matrix)
+	{
+		Update(matrix);
+	}
+
+	void Frustum::Update(const glm::mat4& matrix)
+	{
+		// glm is column-major, rows are gathered manually (Gribb-Hartmann)
+		glm::vec4 row0 = glm::vec4(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+		glm::vec4 row1 = glm::vec4(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+		glm::vec4 row2 = glm::vec4(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+		glm::vec4 row3 = glm::vec4(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+
+		mPlanes[Side::Left] = row3 + row0;
+		mPlanes[Side::Right] = row3 - row0;
+		mPlanes[Side::Bottom] = row3 + row1;
+		mPlanes[Side::Top] = row3 - row1;
+		mPlanes[Side::Near] = row2; // depth is zero to one
+		mPlanes[Side::Far] = row3 - row2;
+
+		for (uint32_t i = 0; i < Side::Count; i++) {
+			float length = glm::length(glm::vec3(mPlanes[i]));
+
+			if (length > 0.0f) {
+				mPlanes[i] /= length;
+			}
+		}
+
+		for (uint32_t i = 0; i < 8; i++) {
+			glm::vec4 plane = i < Side::Count ? mPlanes[i] : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			mPlanesX[i] = plane.x;
+			mPlanesY[i] = plane.y;
+			mPlanesZ[i] = plane.z;
+			mPlanesW[i] = plane.w;
+		}
+	}
+
+	bool Frustum::ContainsSphere(const glm::vec3& center, float radius) const
+	{
+		for (uint32_t i = 0; i < Side::Count; i++) {
+			if (glm::dot(glm::vec3(mPlanes[i]), center) + mPlanes[i].w < -radius) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool Frustum::ContainsAABB(const glm::vec3& min, const glm::vec3& max) const
+	{
+		for (uint32_t i = 0; i < Side::Count; i++) {
+			// the corner furthest along the plane normal
+			glm::vec3 positive = glm::vec3
+			(
+				mPlanes[i].x >= 0.0f ? max.x : min.x,
+				mPlanes[i].y >= 0.0f ? max.y : min.y,
+				mPlanes[i].z >= 0.0f ? max.z : min.z
+			);
+
+			if (glm::dot(glm::vec3(mPlanes[i]), positive) + mPlanes[i].w < 0.0f) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	Frustum::Intersection Frustum::ClassifyAABB(const glm::vec3& min, const glm::vec3& max) const
+	{
+		// the box is outside a plane when it's center distance is below minus it's projected extent, inside when above it
+		glm::vec3 center = (min + max) * 0.5f;
+		glm::vec3 extent = (max - min) * 0.5f;
+
+		#if defined COSMOS_FRUSTUM_SSE2
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		__m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+		__m128 ex = _mm_set1_ps(extent.x), ey = _mm_set1_ps(extent.y), ez = _mm_set1_ps(extent.z);
+		int outside = 0;
+		int inside = 0;
+
+		for (uint32_t i = 0; i < 8; i += 4) {
+			__m128 nx = _mm_load_ps(&mPlanesX[i]);
+			__m128 ny = _mm_load_ps(&mPlanesY[i]);
+			__m128 nz = _mm_load_ps(&mPlanesZ[i]);
+
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), _mm_load_ps(&mPlanesW[i])));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, signMask), ex), _mm_mul_ps(_mm_and_ps(ny, signMask), ey)), _mm_mul_ps(_mm_and_ps(nz, signMask), ez));
+
+			outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+			inside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		if (outside != 0) {
+			return Intersection::Outside;
+		}
+
+		return inside == 0 ? Intersection::Inside : Intersection::Intersecting;
+		#else
+		Intersection result = Intersection::Inside;
+
+		for (uint32_t i = 0; i < Side::Count; i++) {
+			float distance = mPlanesX[i] * center.x + mPlanesY[i] * center.y + mPlanesZ[i] * center.z + mPlanesW[i];
+			float radius = std::abs(mPlanesX[i]) * extent.x + std::abs(mPlanesY[i]) * extent.y + std::abs(mPlanesZ[i]) * extent.z;
+
+			if (distance + radius < 0.0f) {
+				return Intersection::Outside;
+			}
+
+			if (distance - radius < 0.0f) {
+				result = Intersection::Intersecting;
+			}
+		}
+
+		return result;
+		#endif
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Math.h"
+#include "BoundingBox.h"
+
+namespace Cosmos
+{
+	class Frustum
+	{
+	public:
+
+		enum Side : uint32_t
+		{
+			Left = 0,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			Far,
+
+			Count
+		};
+
+		enum Intersection : uint32_t
+		{
+			Outside = 0,
+			Intersecting,
+			Inside
+		};
+
+	public:
+
+		// constructor
+		Frustum() = default;
+
+		// constructor, extracts the planes from a combined projection * view (* model) matrix
+		Frustum(const glm::mat4& matrix);
+
+		// destructor
+		~Frustum() = default;
+
+		// returns a reference to the frustum planes, xyz is the normal pointing inwards and w the distance
+		inline glm::vec4* GetPlanes() { return mPlanes; }
+
+	public:
+
+		// recalculates the frustum planes given a combined projection * view (* model) matrix
+		void Update(const glm::mat4& matrix);
+
+		// returns if a sphere is at least partially inside the frustum
+		bool ContainsSphere(const glm::vec3& center, float radius) const;
+
+		// returns if an axis-aligned bounding box is at least partially inside the frustum
+		bool ContainsAABB(const glm::vec3& min, const glm::vec3& max) const;
+
+		// returns if a bounding box is at least partially inside the frustum
+		inline bool ContainsAABB(const BoundingBox& bb) const { return ContainsAABB(bb.GetMin(), bb.GetMax()); }
+
+		// returns if an axis-aligned bounding box is outside, crossing or fully inside the frustum, all planes are tested at once with sse when available
+		Intersection ClassifyAABB(const glm::vec3& min, const glm::vec3& max) const;
+
+	private:
+
+		glm::vec4 mPlanes[Side::Count] = {};
+
+		// planes as structure of arrays, padded to 8 with planes that contain everything
+		alignas(16) float mPlanesX[8] = {};
+		alignas(16) float mPlanesY[8] = {};
+		alignas(16) float mPlanesZ[8] = {};
+		alignas(16) float mPlanesW[8] = {};
+	};
+}
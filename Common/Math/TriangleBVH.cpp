@@ -0,0 +1,338 @@
+#include "TriangleBVH.h"
+
+#include <algorithm>
+
+namespace Cosmos
+{
+	// surface area of a box, the chance of a ray touching it is proportional to it
+	static float SurfaceArea(const glm::vec3& min, const glm::vec3& max)
+	{
+		glm::vec3 d = max - min;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	// centroid of a triangle, it's what's binned and partitioned
+	static glm::vec3 GetCentroid(const TriangleBVH::Triangle& triangle)
+	{
+		return triangle.v0 + (triangle.edge1 + triangle.edge2) * (1.0f / 3.0f);
+	}
+
+	void TriangleBVH::Build(const glm::vec3* positions, const uint32_t* indices, size_t indexCount, const glm::mat4& matrix)
+	{
+		Clear();
+		mTriangles.reserve(indexCount / 3);
+		mIDs.reserve(indexCount / 3);
+
+		for (size_t i = 0; i + 2 < indexCount; i += 3) {
+			glm::vec3 v0 = glm::vec3(matrix * glm::vec4(positions[indices[i + 0]], 1.0f));
+			glm::vec3 v1 = glm::vec3(matrix * glm::vec4(positions[indices[i + 1]], 1.0f));
+			glm::vec3 v2 = glm::vec3(matrix * glm::vec4(positions[indices[i + 2]], 1.0f));
+			AddTriangle(v0, v1, v2, (uint32_t)(i / 3));
+		}
+
+		Build();
+	}
+
+	void TriangleBVH::Build()
+	{
+		mNodes.clear();
+
+		if (mTriangles.empty()) {
+			return;
+		}
+
+		// a binary tree never has more than 2n - 1 nodes, reserving them keeps node references valid while splitting
+		mNodes.reserve(mTriangles.size() * 2);
+
+		Node root = {};
+		root.first = 0;
+		root.count = (uint32_t)mTriangles.size();
+		mNodes.push_back(root);
+
+		UpdateBounds(mNodes[0]);
+		Subdivide(0);
+
+		mNodes.shrink_to_fit();
+	}
+
+	void TriangleBVH::AddTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, uint32_t id)
+	{
+		Triangle triangle = {};
+		triangle.v0 = v0;
+		triangle.edge1 = v1 - v0;
+		triangle.edge2 = v2 - v0;
+
+		mTriangles.push_back(triangle);
+		mIDs.push_back(id);
+	}
+
+	void TriangleBVH::Clear()
+	{
+		mNodes.clear();
+		mTriangles.clear();
+		mIDs.clear();
+	}
+
+	bool TriangleBVH::RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const
+	{
+		if (mNodes.empty()) {
+			return false;
+		}
+
+		glm::vec3 inverse = 1.0f / direction;
+		float closest = maxDistance;
+		uint32_t closestTriangle = UINT32_MAX;
+		glm::vec2 closestBarycentric = glm::vec2(0.0f);
+
+		// the tree is never deeper than MaxDepth, so the far children pending never exceed it
+		uint32_t stack[MaxDepth];
+		uint32_t stackSize = 0;
+
+		if (RayBox(origin, inverse, mNodes[0].min, mNodes[0].max, closest) == FLT_MAX) {
+			return false;
+		}
+
+		uint32_t current = 0;
+
+		while (true)
+		{
+			const Node& node = mNodes[current];
+
+			if (node.count > 0) {
+				for (uint32_t i = node.first; i < node.first + node.count; i++) {
+					float u = 0.0f, v = 0.0f;
+					float t = RayTriangle(origin, direction, mTriangles[i], u, v);
+
+					if (t < closest) {
+						closest = t;
+						closestTriangle = i;
+						closestBarycentric = glm::vec2(u, v);
+					}
+				}
+			}
+
+			else {
+				// the nearest child is visited first, the other one is skipped if something closer is found meanwhile
+				uint32_t nearest = node.first;
+				uint32_t farthest = node.first + 1;
+				float nearestDistance = RayBox(origin, inverse, mNodes[nearest].min, mNodes[nearest].max, closest);
+				float farthestDistance = RayBox(origin, inverse, mNodes[farthest].min, mNodes[farthest].max, closest);
+
+				if (nearestDistance > farthestDistance) {
+					std::swap(nearest, farthest);
+					std::swap(nearestDistance, farthestDistance);
+				}
+
+				if (nearestDistance != FLT_MAX) {
+					if (farthestDistance != FLT_MAX) {
+						stack[stackSize++] = farthest;
+					}
+
+					current = nearest;
+					continue;
+				}
+			}
+
+			// pops until a node still worth visiting, it's entry distance is tested again against the closest hit so far
+			bool found = false;
+
+			while (stackSize > 0 && !found) {
+				current = stack[--stackSize];
+				found = RayBox(origin, inverse, mNodes[current].min, mNodes[current].max, closest) != FLT_MAX;
+			}
+
+			if (!found) {
+				break;
+			}
+		}
+
+		if (closestTriangle == UINT32_MAX) {
+			return false;
+		}
+
+		const Triangle& triangle = mTriangles[closestTriangle];
+		glm::vec3 normal = glm::cross(triangle.edge1, triangle.edge2);
+
+		hit.distance = closest;
+		hit.triangle = mIDs[closestTriangle];
+		hit.barycentric = closestBarycentric;
+		hit.normal = glm::dot(normal, direction) > 0.0f ? -normal : normal;
+		return true;
+	}
+
+	void TriangleBVH::Subdivide(uint32_t root)
+	{
+		constexpr uint32_t binCount = 12;
+
+		struct Bin
+		{
+			glm::vec3 min = glm::vec3(FLT_MAX);
+			glm::vec3 max = glm::vec3(-FLT_MAX);
+			uint32_t count = 0;
+		};
+
+		// triangle bounds and centroids are read once per axis on every level, they're computed once and partitioned along
+		struct Primitive
+		{
+			glm::vec3 min;
+			glm::vec3 max;
+			glm::vec3 centroid;
+		};
+
+		std::vector<Primitive> primitives(mTriangles.size());
+
+		for (size_t i = 0; i < mTriangles.size(); i++) {
+			const Triangle& triangle = mTriangles[i];
+			glm::vec3 v1 = triangle.v0 + triangle.edge1;
+			glm::vec3 v2 = triangle.v0 + triangle.edge2;
+
+			primitives[i].min = glm::min(triangle.v0, glm::min(v1, v2));
+			primitives[i].max = glm::max(triangle.v0, glm::max(v1, v2));
+			primitives[i].centroid = GetCentroid(triangle);
+		}
+
+		// the second value is the depth of the node
+		std::vector<std::pair<uint32_t, uint32_t>> stack = { { root, 0 } };
+
+		while (!stack.empty())
+		{
+			auto [index, depth] = stack.back();
+			stack.pop_back();
+
+			Node node = mNodes[index];
+
+			if (node.count <= 2 || depth + 1 >= MaxDepth) {
+				continue;
+			}
+
+			glm::vec3 centroidMin = glm::vec3(FLT_MAX);
+			glm::vec3 centroidMax = glm::vec3(-FLT_MAX);
+
+			for (uint32_t i = node.first; i < node.first + node.count; i++) {
+				centroidMin = glm::min(centroidMin, primitives[i].centroid);
+				centroidMax = glm::max(centroidMax, primitives[i].centroid);
+			}
+
+			// every axis is binned, the split is where the cost of both sides is the lowest
+			float bestCost = FLT_MAX;
+			int32_t bestAxis = -1;
+			uint32_t bestBin = 0;
+			Node bestLeft = {};
+			Node bestRight = {};
+
+			for (int32_t axis = 0; axis < 3; axis++)
+			{
+				float extent = centroidMax[axis] - centroidMin[axis];
+
+				if (extent <= 0.0f) {
+					continue;
+				}
+
+				Bin bins[binCount] = {};
+				float scale = binCount / extent;
+
+				for (uint32_t i = node.first; i < node.first + node.count; i++) {
+					const Primitive& primitive = primitives[i];
+					uint32_t bin = std::min(binCount - 1, (uint32_t)((primitive.centroid[axis] - centroidMin[axis]) * scale));
+
+					bins[bin].count++;
+					bins[bin].min = glm::min(bins[bin].min, primitive.min);
+					bins[bin].max = glm::max(bins[bin].max, primitive.max);
+				}
+
+				// areas and counts left of each plane are swept forward, right of it backwards
+				// the bounds of both sides are kept as well, the children of the chosen split are fitted by them
+				Node left[binCount - 1], right[binCount - 1];
+				Node leftSide = {}, rightSide = {};
+				leftSide.min = rightSide.min = glm::vec3(FLT_MAX);
+				leftSide.max = rightSide.max = glm::vec3(-FLT_MAX);
+
+				for (uint32_t i = 0; i < binCount - 1; i++)
+				{
+					leftSide.count += bins[i].count;
+					leftSide.min = glm::min(leftSide.min, bins[i].min);
+					leftSide.max = glm::max(leftSide.max, bins[i].max);
+					left[i] = leftSide;
+
+					rightSide.count += bins[binCount - 1 - i].count;
+					rightSide.min = glm::min(rightSide.min, bins[binCount - 1 - i].min);
+					rightSide.max = glm::max(rightSide.max, bins[binCount - 1 - i].max);
+					right[binCount - 2 - i] = rightSide;
+				}
+
+				for (uint32_t i = 0; i < binCount - 1; i++)
+				{
+					if (left[i].count == 0 || right[i].count == 0) {
+						continue;
+					}
+
+					float cost = left[i].count * SurfaceArea(left[i].min, left[i].max) + right[i].count * SurfaceArea(right[i].min, right[i].max);
+
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestBin = i + 1;
+						bestLeft = left[i];
+						bestRight = right[i];
+					}
+				}
+			}
+
+			// a leaf costs testing all it's triangles, a split costs one more box test plus the triangles of the sides it reaches
+			float leafCost = node.count * SurfaceArea(node.min, node.max);
+
+			if (bestAxis < 0 || SurfaceArea(node.min, node.max) + bestCost >= leafCost) {
+				continue;
+			}
+
+			// the same expression used for binning decides the side, so no triangle lands on the side it wasn't counted on
+			float scale = binCount / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+			uint32_t i = node.first;
+			uint32_t j = node.first + node.count;
+
+			while (i < j)
+			{
+				uint32_t bin = std::min(binCount - 1, (uint32_t)((primitives[i].centroid[bestAxis] - centroidMin[bestAxis]) * scale));
+
+				if (bin < bestBin) {
+					i++;
+					continue;
+				}
+
+				j--;
+				std::swap(primitives[i], primitives[j]);
+				std::swap(mTriangles[i], mTriangles[j]);
+				std::swap(mIDs[i], mIDs[j]);
+			}
+
+			// the binned counts are exact, so the sides match what was partitioned
+			bestLeft.first = node.first;
+			bestRight.first = node.first + bestLeft.count;
+
+			uint32_t leftIndex = (uint32_t)mNodes.size();
+			mNodes.push_back(bestLeft);
+			mNodes.push_back(bestRight);
+
+			mNodes[index].first = leftIndex;
+			mNodes[index].count = 0;
+
+			stack.push_back({ leftIndex, depth + 1 });
+			stack.push_back({ leftIndex + 1, depth + 1 });
+		}
+	}
+
+	void TriangleBVH::UpdateBounds(Node& node)
+	{
+		node.min = glm::vec3(FLT_MAX);
+		node.max = glm::vec3(-FLT_MAX);
+
+		for (uint32_t i = node.first; i < node.first + node.count; i++) {
+			const Triangle& triangle = mTriangles[i];
+			glm::vec3 v1 = triangle.v0 + triangle.edge1;
+			glm::vec3 v2 = triangle.v0 + triangle.edge2;
+
+			node.min = glm::min(node.min, glm::min(triangle.v0, glm::min(v1, v2)));
+			node.max = glm::max(node.max, glm::max(triangle.v0, glm::max(v1, v2)));
+		}
+	}
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Math.h"
+#include <cfloat>
+#include <vector>
+
+namespace Cosmos
+{
+	// static bvh over the triangles of a mesh, built once with the surface area heuristic and only ray casted afterwards
+	// triangles are copied into leaf order, so it doesn't depend on the mesh keeping it's positions around
+	class TriangleBVH
+	{
+	public:
+
+		static constexpr uint32_t MaxDepth = 64;			// nodes this deep are kept as leaves, whatever they cost
+
+		struct Node
+		{
+			glm::vec3 min = glm::vec3(0.0f);
+			uint32_t first = 0;								// first triangle of a leaf, left child of an interior node (the right one follows it)
+			glm::vec3 max = glm::vec3(0.0f);
+			uint32_t count = 0;								// triangles of a leaf, zero on interior nodes
+		};
+
+		struct Triangle
+		{
+			glm::vec3 v0 = glm::vec3(0.0f);
+			glm::vec3 edge1 = glm::vec3(0.0f);				// v1 - v0
+			glm::vec3 edge2 = glm::vec3(0.0f);				// v2 - v0
+		};
+
+		struct Hit
+		{
+			float distance = FLT_MAX;						// in units of the ray direction
+			uint32_t triangle = UINT32_MAX;					// index of the triangle on the indices it was built from
+			glm::vec2 barycentric = glm::vec2(0.0f);		// weights of v1 and v2
+			glm::vec3 normal = glm::vec3(0.0f);				// geometric, unnormalized and facing the ray origin
+		};
+
+	public:
+
+		// constructor
+		TriangleBVH() = default;
+
+		// destructor
+		~TriangleBVH() = default;
+
+		// returns if there's anything to cast against
+		inline bool IsEmpty() const { return mNodes.empty(); }
+
+		// returns how many nodes the tree has
+		inline size_t GetNodeCount() const { return mNodes.size(); }
+
+		// returns how many triangles the tree has
+		inline size_t GetTriangleCount() const { return mTriangles.size(); }
+
+		// returns how many bytes the tree holds
+		inline size_t GetMemoryBytes() const { return mNodes.size() * sizeof(Node) + mTriangles.size() * (sizeof(Triangle) + sizeof(uint32_t)); }
+
+		// returns the bounds of every triangle
+		inline const Node& GetRootRef() const { return mNodes[0]; }
+
+	public:
+
+		// builds the tree over indexed triangles, every three indices are a triangle, positions may be transformed by matrix first
+		void Build(const glm::vec3* positions, const uint32_t* indices, size_t indexCount, const glm::mat4& matrix = glm::mat4(1.0f));
+
+		// builds the tree over triangles added by AddTriangle, used when a mesh is made of many parts with their own transforms
+		void Build();
+
+		// adds a triangle to be built into the tree, id is what hits report for it
+		void AddTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, uint32_t id);
+
+		// removes every triangle
+		void Clear();
+
+		// finds the closest triangle a ray hits within maxDistance, returns false if there's none
+		bool RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const;
+
+	private:
+
+		// splits nodes until they're cheaper as leaves, binning triangle centroids along every axis
+		void Subdivide(uint32_t root);
+
+		// fits a node bounds to it's triangles
+		void UpdateBounds(Node& node);
+
+		// intersects a ray with a triangle, returns the distance or FLT_MAX if it misses
+		static inline float RayTriangle(const glm::vec3& origin, const glm::vec3& direction, const Triangle& triangle, float& u, float& v)
+		{
+			glm::vec3 p = glm::cross(direction, triangle.edge2);
+			float determinant = glm::dot(triangle.edge1, p);
+
+			// both faces are hit, picking shouldn't depend on winding
+			if (glm::abs(determinant) < 1e-12f) {
+				return FLT_MAX;
+			}
+
+			float inverse = 1.0f / determinant;
+			glm::vec3 s = origin - triangle.v0;
+			u = glm::dot(s, p) * inverse;
+
+			if (u < 0.0f || u > 1.0f) {
+				return FLT_MAX;
+			}
+
+			glm::vec3 q = glm::cross(s, triangle.edge1);
+			v = glm::dot(direction, q) * inverse;
+
+			if (v < 0.0f || u + v > 1.0f) {
+				return FLT_MAX;
+			}
+
+			float t = glm::dot(triangle.edge2, q) * inverse;
+			return t >= 0.0f ? t : FLT_MAX;
+		}
+
+		// returns the distance a ray enters a box, FLT_MAX if it misses it or enters after maxDistance
+		static inline float RayBox(const glm::vec3& origin, const glm::vec3& inverse, const glm::vec3& min, const glm::vec3& max, float maxDistance)
+		{
+			float enter = 0.0f;
+			float exit = maxDistance;
+
+			for (int32_t axis = 0; axis < 3; axis++)
+			{
+				float t0 = (min[axis] - origin[axis]) * inverse[axis];
+				float t1 = (max[axis] - origin[axis]) * inverse[axis];
+
+				// zero times infinity, the ray runs along the axis starting on one of the box planes, the slab doesn't limit it
+				if (t0 != t0 || t1 != t1) {
+					continue;
+				}
+
+				enter = glm::max(enter, glm::min(t0, t1));
+				exit = glm::min(exit, glm::max(t0, t1));
+			}
+
+			return enter <= exit ? enter : FLT_MAX;
+		}
+
+	private:
+
+		std::vector<Node> mNodes = {};						// the root is node 0, children are allocated in pairs
+		std::vector<Triangle> mTriangles = {};				// in leaf order
+		std::vector<uint32_t> mIDs = {};					// the id of each triangle, in leaf order
+	};
+}
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <cstdarg>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <string>
+#include <vector>
 
 namespace Cosmos
 {
@@ -14,4 +17,53 @@ namespace Cosmos
             if (*first == old_value)
                 *first = new_value;
     }
+
+    // least significant digit radix sort on a 64-bit key of each item, 8 bits per pass, stable
+    // scratch is resized to the item count and kept by the caller so it's not reallocated every time, passes where all keys share the digit are skipped
+    template<class T, class KeyFunc>
+    void RadixSort(std::vector<T>& items, std::vector<T>& scratch, KeyFunc key)
+    {
+        size_t count = items.size();
+
+        if (count < 2) {
+            return;
+        }
+
+        // all eight histograms are built on a single read of the keys
+        size_t histograms[8][256] = {};
+
+        for (const T& item : items) {
+            uint64_t value = key(item);
+
+            for (uint32_t pass = 0; pass < 8; pass++) {
+                histograms[pass][(value >> (pass * 8)) & 0xFF]++;
+            }
+        }
+
+        scratch.resize(count);
+
+        for (uint32_t pass = 0; pass < 8; pass++)
+        {
+            size_t* histogram = histograms[pass];
+            uint32_t shift = pass * 8;
+
+            // every key has the same digit, this pass wouldn't move anything
+            if (histogram[(key(items[0]) >> shift) & 0xFF] == count) {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (uint32_t digit = 0; digit < 256; digit++) {
+                size_t digitCount = histogram[digit];
+                histogram[digit] = offset;
+                offset += digitCount;
+            }
+
+            for (const T& item : items) {
+                scratch[histogram[(key(item) >> shift) & 0xFF]++] = item;
+            }
+
+            items.swap(scratch);
+        }
+    }
 }
\ No newline at end of file
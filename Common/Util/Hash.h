@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Cosmos
+{
+	// fnv-1a offset basis, the seed of a new hash
+	constexpr uint64_t HashSeed = 14695981039346656037ull;
+
+	// fnv-1a hash of a byte range, chaining calls with the previous result as seed hashes the concatenation
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = HashSeed)
+	{
+		const uint8_t* bytes = (const uint8_t*)data;
+		uint64_t hash = seed;
+
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	// fnv-1a hash of a string contents
+	inline uint64_t HashString(const std::string& str, uint64_t seed = HashSeed)
+	{
+		return HashBytes(str.data(), str.size(), seed);
+	}
+}
\ No newline at end of file
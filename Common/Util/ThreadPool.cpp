@@ -0,0 +1,155 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Cosmos
+{
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		if (threadCount == 0) {
+			uint32_t hardware = std::thread::hardware_concurrency();
+			threadCount = hardware > 1 ? hardware - 1 : 1;
+		}
+
+		// every worker may be needed by the frame, background work gets half of them
+		mBackgroundLimit = std::max(threadCount / 2, 1u);
+
+		for (uint32_t i = 0; i < threadCount; i++) {
+			mWorkers.emplace_back(&ThreadPool::Work, this);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mStop = true;
+		}
+
+		mCondition.notify_all();
+
+		for (auto& worker : mWorkers) {
+			worker.join();
+		}
+	}
+
+	ThreadPool& ThreadPool::GetRef()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func)
+	{
+		if (count == 0) {
+			return;
+		}
+
+		if (count == 1) {
+			func(0);
+			return;
+		}
+
+		// helpers outlive the call when they start late, so what they touch is shared and func is only read while running
+		struct Shared
+		{
+			std::atomic<size_t> next = 0;
+			size_t count = 0;
+			const std::function<void(size_t)>* func = nullptr;
+			std::mutex mutex;
+			std::condition_variable condition;
+			uint32_t running = 0;
+			bool closed = false;
+		};
+
+		auto shared = std::make_shared<Shared>();
+		shared->count = count;
+		shared->func = &func;
+
+		auto consume = [](Shared& state)
+			{
+				for (size_t i = state.next.fetch_add(1); i < state.count; i = state.next.fetch_add(1)) {
+					(*state.func)(i);
+				}
+			};
+
+		size_t helpers = std::min<size_t>(mWorkers.size(), count - 1);
+
+		for (size_t i = 0; i < helpers; i++) {
+			Enqueue([shared, consume]()
+				{
+					{
+						std::unique_lock<std::mutex> lock(shared->mutex);
+
+						if (shared->closed) {
+							return;
+						}
+
+						shared->running++;
+					}
+
+					consume(*shared);
+
+					std::unique_lock<std::mutex> lock(shared->mutex);
+
+					if (--shared->running == 0) {
+						shared->condition.notify_all();
+					}
+				});
+		}
+
+		// the caller consumes every index nobody else took, then only waits for helpers that already started
+		// helpers still queued behind busy workers (or behind this very call, when nested on a worker) find it closed and return
+		consume(*shared);
+
+		std::unique_lock<std::mutex> lock(shared->mutex);
+		shared->closed = true;
+		shared->condition.wait(lock, [&shared]() { return shared->running == 0; });
+	}
+
+	void ThreadPool::Work()
+	{
+		while (true) {
+			std::function<void()> task;
+			bool background = false;
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+
+				// background tasks over the limit wait, unless the pool is stopping and everything left must be drained
+				auto backgroundReady = [this]() { return !mBackgroundTasks.empty() && (mBackgroundRunning < mBackgroundLimit || mStop); };
+				mCondition.wait(lock, [this, &backgroundReady]() { return mStop || !mTasks.empty() || backgroundReady(); });
+
+				if (!mTasks.empty()) {
+					task = std::move(mTasks.front());
+					mTasks.pop();
+				}
+
+				else if (backgroundReady()) {
+					task = std::move(mBackgroundTasks.front());
+					mBackgroundTasks.pop();
+					mBackgroundRunning++;
+					background = true;
+				}
+
+				// stopping with nothing left
+				else {
+					return;
+				}
+			}
+
+			task();
+
+			// a slot was freed, a worker waiting only on background tasks may take the next one
+			if (background) {
+				{
+					std::unique_lock<std::mutex> lock(mMutex);
+					mBackgroundRunning--;
+				}
+
+				mCondition.notify_one();
+			}
+		}
+	}
+}
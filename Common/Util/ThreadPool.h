@@ -0,0 +1,90 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Cosmos
+{
+	class ThreadPool
+	{
+	public:
+
+		// constructor, zero threads means one less than the hardware threads (at least one)
+		ThreadPool(uint32_t threadCount = 0);
+
+		// destructor
+		~ThreadPool();
+
+		// returns the engine-wide shared pool
+		static ThreadPool& GetRef();
+
+		// returns how many worker threads the pool has
+		inline uint32_t GetThreadCount() const { return (uint32_t)mWorkers.size(); }
+
+		// returns how many background tasks may run at once, the rest of the workers stay free for frame work
+		inline uint32_t GetBackgroundLimit() const { return mBackgroundLimit; }
+
+	public:
+
+		// schedules a task to be executed by one of the workers
+		template<typename F>
+		auto Enqueue(F&& func) -> std::future<decltype(func())>
+		{
+			using Result = decltype(func());
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+			std::future<Result> future = task->get_future();
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mTasks.emplace([task]() { (*task)(); });
+			}
+
+			mCondition.notify_one();
+			return future;
+		}
+
+		// schedules a long running task (decoding, streaming), at most GetBackgroundLimit() of them run at once
+		// they're only picked when no regular task is waiting, so frame work enqueued meanwhile isn't stuck behind them
+		template<typename F>
+		auto EnqueueBackground(F&& func) -> std::future<decltype(func())>
+		{
+			using Result = decltype(func());
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+			std::future<Result> future = task->get_future();
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mBackgroundTasks.emplace([task]() { (*task)(); });
+			}
+
+			mCondition.notify_one();
+			return future;
+		}
+
+		// executes func for every index in [0, count) across the workers, blocks until all are done
+		// the caller takes part and never waits on helpers that didn't start, so it may be called from a worker or with every worker busy
+		void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+	private:
+
+		// worker thread loop
+		void Work();
+
+	private:
+
+		std::vector<std::thread> mWorkers;
+		std::queue<std::function<void()>> mTasks;
+		std::queue<std::function<void()>> mBackgroundTasks;
+		uint32_t mBackgroundLimit = 1;
+		uint32_t mBackgroundRunning = 0;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		bool mStop = false;
+	};
+}
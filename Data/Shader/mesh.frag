@@ -1,12 +1,18 @@
 #version 450
 #extension GL_ARB_gpu_shader_int64 : enable
+#extension GL_EXT_nonuniform_qualifier : enable
 
-layout(push_constant) uniform constants
+struct MaterialData
 {
-    uint selected;
-    uint64_t id;
-	mat4 model;
-} pushConstant;
+    uint albedo;
+    float alphaCutoff;
+    uint padding0;
+    uint padding1;
+};
+
+// constant per pipeline variant, disabled features are removed when the pipeline is built
+layout(constant_id = 0) const bool ALPHA_TEST = false;
+layout(constant_id = 1) const bool HIGHLIGHT = false;
 
 layout(set = 0, binding = 0) uniform ubo_camera
 {
@@ -15,19 +21,39 @@ layout(set = 0, binding = 0) uniform ubo_camera
     mat4 proj;
 } camera;
 
-layout(binding = 1) uniform sampler2D colorMapSampler;
+layout(std430, set = 0, binding = 2) readonly buffer ssbo_materials
+{
+    MaterialData materials[];
+} materialBuffer;
+
+// every texture on the scene, partially bound so only the indices referenced by materials are valid
+layout(set = 0, binding = 3) uniform sampler2D textures[];
 
 layout(location = 0) in vec2 inFragTexCoord;
+layout(location = 1) flat in uint inSelected;
+layout(location = 2) flat in uint inMaterial;
+#ifdef VERTEX_COLORS
+layout(location = 3) in vec4 inColor;
+#endif
 
 layout(location = 0) out vec4 outColor;
 
 void main()
 {
-    // create the texture
-    outColor = texture(colorMapSampler, inFragTexCoord);
+    // sample the albedo the instance material points to
+    MaterialData material = materialBuffer.materials[inMaterial];
+    outColor = texture(textures[nonuniformEXT(material.albedo)], inFragTexCoord);
+
+#ifdef VERTEX_COLORS
+    outColor *= inColor;
+#endif
+
+    if(ALPHA_TEST && outColor.a < material.alphaCutoff) {
+        discard;
+    }
 
     // if it's marked as selected, paint it
-    if(pushConstant.selected == 1) {
+    if(HIGHLIGHT && inSelected == 1) {
         outColor *= vec4(0.9059, 0.4275, 0.0353, 0.75);
     }
 }
\ No newline at end of file
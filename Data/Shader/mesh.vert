@@ -1,12 +1,13 @@
 #version 450
 #extension GL_ARB_gpu_shader_int64 : enable
 
-layout(push_constant) uniform constants
+struct InstanceData
 {
-    uint selected;
+    mat4 model;
     uint64_t id;
-	mat4 model;
-} pushConstant;
+    uint selected;
+    uint material;
+};
 
 layout(set = 0, binding = 0) uniform ubo_camera
 {
@@ -15,17 +16,43 @@ layout(set = 0, binding = 0) uniform ubo_camera
     mat4 proj;
 } camera;
 
+layout(std430, set = 0, binding = 1) readonly buffer ssbo_instances
+{
+    InstanceData instances[];
+} instanceBuffer;
+
+// instances are drawn through this list, the gpu culling packs the visible ones of a draw on it
+layout(std430, set = 0, binding = 4) readonly buffer ssbo_instance_indices
+{
+    uint indices[];
+} instanceIndexBuffer;
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
+#ifdef VERTEX_COLORS
+layout(location = 5) in vec4 inColor;
+#endif
 
 layout(location = 0) out vec2 outFragTexCoord;
+layout(location = 1) flat out uint outSelected;
+layout(location = 2) flat out uint outMaterial;
+#ifdef VERTEX_COLORS
+layout(location = 3) out vec4 outColor;
+#endif
 
 void main()
 {
+    InstanceData instance = instanceBuffer.instances[instanceIndexBuffer.indices[gl_InstanceIndex]];
+
     // set vertex position on world
-    gl_Position = camera.proj * camera.view * pushConstant.model * vec4(inPosition, 1.0);
+    gl_Position = camera.proj * camera.view * instance.model * vec4(inPosition, 1.0);
 
     // output variables for the fragment shader
     outFragTexCoord = inTexCoord;
+    outSelected = instance.selected;
+    outMaterial = instance.material;
+#ifdef VERTEX_COLORS
+    outColor = inColor;
+#endif
 }
\ No newline at end of file
@@ -1,12 +1,13 @@
 #version 450
 #extension GL_ARB_gpu_shader_int64 : enable
 
-layout(push_constant) uniform constants
+struct InstanceData
 {
-    uint selected;
+    mat4 model;
     uint64_t id;
-	mat4 model;
-} pushConstant;
+    uint selected;
+    uint material;
+};
 
 layout(set = 0, binding = 0) uniform ubo_camera
 {
@@ -15,10 +16,28 @@ layout(set = 0, binding = 0) uniform ubo_camera
     mat4 proj;
 } camera;
 
+layout(std430, set = 0, binding = 1) readonly buffer ssbo_instances
+{
+    InstanceData instances[];
+} instanceBuffer;
+
+// instances are drawn through this list, the gpu culling packs the visible ones of a draw on it
+layout(std430, set = 0, binding = 4) readonly buffer ssbo_instance_indices
+{
+    uint indices[];
+} instanceIndexBuffer;
+
 layout(location = 0) in vec3 inPosition;
 
+layout(location = 0) flat out uvec2 outId;
+
 void main()
 {
+    InstanceData instance = instanceBuffer.instances[instanceIndexBuffer.indices[gl_InstanceIndex]];
+
     // set vertex position on world
-    gl_Position = camera.proj * camera.view * pushConstant.model * vec4(inPosition, 1.0);
+    gl_Position = camera.proj * camera.view * instance.model * vec4(inPosition, 1.0);
+
+    // we're going to separate our uint64_t into a uvec2, latter on CPU code we're going to read it back
+    outId = uvec2(uint(instance.id & 0xFFFFFFFFUL), uint(instance.id >> 32));
 }
\ No newline at end of file
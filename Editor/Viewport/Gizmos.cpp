@@ -2,7 +2,9 @@
 
 #include <Common/Math/Math.h>
 #include <Engine/Entity/Camera.h>
+#include <Engine/Core/Scene.h>
 #include <Engine/Entity/Entity.h>
+#include <Engine/Entity/Components/IDComponent.h>
 #include <Engine/Entity/Components/TransformComponent.h>
 #include <Renderer/Wrapper/imgui.h>
 
@@ -60,6 +62,29 @@ namespace Cosmos::Editor
 			tc.translation = translation;
 			tc.rotation += deltaRotation;
 			tc.scale = scale;
+
+			// the object is dropped where the mouse ray meets the scene, the object itself is seen through
+			if (mSurfaceSnapping && (mMode & GizmosMode::Translate) != 0 && entity->HasComponent<Engine::IDComponent>()) {
+				ImVec2 mouse = ImGui::GetMousePos();
+				glm::vec2 ndc;
+				ndc.x = 2.0f * (mouse.x - ImGui::GetWindowPos().x) / vpWidth - 1.0f;
+				ndc.y = 1.0f - 2.0f * (mouse.y - ImGui::GetWindowPos().y) / vpHeight;
+
+				glm::mat4 inverse = glm::inverse(proj * view);
+				glm::vec4 start = inverse * glm::vec4(ndc, 0.0f, 1.0f);
+				glm::vec4 end = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+				glm::vec3 origin = glm::vec3(start) / start.w;
+				glm::vec3 direction = glm::normalize(glm::vec3(end) / end.w - origin);
+
+				Engine::Scene::RayHit hit = {};
+				uint64_t ignore = entity->GetComponent<Engine::IDComponent>().id->GetValue();
+
+				if (entity->GetScene()->ObjectPicking(origin, direction, &hit, ignore) != 0) {
+					tc.translation = hit.point;
+				}
+			}
+
+			entity->PatchComponent<Engine::TransformComponent>();
 		}
 	}
 }
\ No newline at end of file
@@ -59,6 +59,12 @@ namespace Cosmos::Editor
 		// sets the grid snapping
 		inline void SetSnapping(bool value) { mSnapping = value; }
 
+		// returns if translated objects snap to the surface under the mouse
+		inline bool GetSurfaceSnapping() const { return mSurfaceSnapping; }
+
+		// sets the surface snapping
+		inline void SetSurfaceSnapping(bool value) { mSurfaceSnapping = value; }
+
 		// returns the snapping value
 		inline float GetSnappingValue() { return mSnappingValue; }
 
@@ -76,6 +82,7 @@ namespace Cosmos::Editor
 		GizmosMode mMode = GizmosMode::Undefined;
 		bool mSelectedButton = false;
 		bool mSnapping = false;
+		bool mSurfaceSnapping = false;
 		float mSnappingValue = 1.0f;
 	};
 }
\ No newline at end of file
@@ -35,20 +35,12 @@ namespace Cosmos::Editor
 		// called when an event happen
 		void OnEvent(Shared<Platform::EventBase> event);
 
-	public:
-
-		// create all renderer resources
-		void CreateRendererResources();
-
 	private:
 
 		bool mVisible = true;
 
 		Shared<Renderer::Vulkan::Shader> mVertexShader;
 		Shared<Renderer::Vulkan::Shader> mFragmentShader;
-
-		VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
-		std::vector<VkDescriptorSet> mDescriptorSets;
 	};
 }
 #endif
\ No newline at end of file
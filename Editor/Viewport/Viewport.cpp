@@ -15,7 +15,9 @@
 #include <Renderer/Core/IContext.h>
 #include <Renderer/Core/IGUI.h>
 #include <Renderer/GUI/Icon.h>
+#include <Renderer/Vulkan/Bindless.h>
 #include <Renderer/Vulkan/Context.h>
+#include <Renderer/Vulkan/DeletionQueue.h>
 #include <Renderer/Vulkan/Device.h>
 #include <Renderer/Vulkan/Pipeline.h>
 #include <Renderer/Vulkan/Renderpass.h>
@@ -40,16 +42,15 @@ namespace Cosmos::Editor
 	Viewport::~Viewport()
 	{
 		Renderer::Vulkan::Context* renderer = (Renderer::Vulkan::Context*)(Renderer::IContext::GetRef());
-		auto device = renderer->GetDevice();
-		auto swapchain = renderer->GetSwapchain();
+		auto& deletionQueue = renderer->GetDeletionQueueRef();
 
-		vkDeviceWaitIdle(device->GetLogicalDevice());
-		vkDestroySampler(device->GetLogicalDevice(), mSampler, nullptr);
-		vkDestroyImageView(device->GetLogicalDevice(), mDepthView, nullptr);
-		vmaDestroyImage(device->GetAllocator(), mDepthImage, mDepthMemory);
-		
-		vkDestroyImageView(device->GetLogicalDevice(), mColorView, nullptr);
-		vmaDestroyImage(device->GetAllocator(), mColorImage, mColorMemory);
+		// the attachments may still be written by frames in flight
+		deletionQueue->ReleaseSampler(mSampler);
+		deletionQueue->ReleaseImageView(mDepthView);
+		deletionQueue->ReleaseImage(mDepthImage, mDepthMemory);
+
+		deletionQueue->ReleaseImageView(mColorView);
+		deletionQueue->ReleaseImage(mColorImage, mColorMemory);
 	}
 
 	void Viewport::OnUpdate()
@@ -111,11 +112,11 @@ namespace Cosmos::Editor
 		}
 
 		if (event->GetType() == Platform::EventType::MousePress) {
+			auto pressEvent = std::dynamic_pointer_cast<Platform::MousePressEvent>(event);
 			auto& boundaries = Renderer::IContext::GetRef()->GetViewportBoundariesRef();
-			glm::vec2 framebufferSize = Platform::MainWindow::GetRef().GetFrameBufferSize();
 			glm::vec2 mousePos = Platform::MainWindow::GetRef().GetCursorPos();
 
-			if (mousePos.x <= 0 || mousePos.y <= 0) {
+			if (pressEvent->GetButtoncode() != Platform::Buttoncode::BUTTON_LEFT || mousePos.x <= 0 || mousePos.y <= 0) {
 				return;
 			}
 			
@@ -123,11 +124,49 @@ namespace Cosmos::Editor
 			clickedInViewport &= mousePos.x >= boundaries.min.x && mousePos.x <= boundaries.max.x;
 			clickedInViewport &= mousePos.y >= boundaries.min.y && mousePos.y <= boundaries.max.y;
 
-			if (clickedInViewport) {
-				Renderer::Vulkan::Context* renderer = (Renderer::Vulkan::Context*)Renderer::IContext::GetRef();
-				renderer->GetPickingRef()->ReadImagePixels(Platform::MainWindow::GetRef().GetViewportCursorPos(boundaries.position, boundaries.size));
+			// the gizmo handles are drawn over the objects, clicking them must not change the selection
+			if (clickedInViewport && !ImGuizmo::IsOver() && !ImGuizmo::IsUsing()) {
+				mPicking = true;
+				mPickStart = Platform::MainWindow::GetRef().GetViewportCursorPos(boundaries.position, boundaries.size);
 			}
 		}
+
+		if (event->GetType() == Platform::EventType::MouseRelease && mPicking) {
+			auto releaseEvent = std::dynamic_pointer_cast<Platform::MouseReleaseEvent>(event);
+
+			if (releaseEvent->GetButtoncode() == Platform::Buttoncode::BUTTON_LEFT) {
+				auto& boundaries = Renderer::IContext::GetRef()->GetViewportBoundariesRef();
+				RequestPick(mPickStart, Platform::MainWindow::GetRef().GetViewportCursorPos(boundaries.position, boundaries.size));
+				mPicking = false;
+			}
+		}
+	}
+
+	void Viewport::RequestPick(glm::vec2 start, glm::vec2 end)
+	{
+		Renderer::Vulkan::Context* renderer = (Renderer::Vulkan::Context*)Renderer::IContext::GetRef();
+
+		// small drags are still clicks, the hand is never perfectly still
+		if (glm::length(end - start) < 4.0f) {
+			end = start;
+		}
+
+		// a ray against the scene bvhs answers right away and the picking pass is never rendered, rectangles still need it
+		if (mCPUPicking && end == start) {
+			VkExtent2D extent = renderer->GetSwapchain()->GetExtent();
+			Engine::Camera& camera = Engine::Camera::GetRef();
+
+			glm::vec3 origin, direction;
+			RayCast(start, (float)extent.width, (float)extent.height, camera.GetProjectionRef(), camera.GetViewRef(), origin, direction);
+			mPrefabHierarchy->SelectEntity(mApplication->GetCurrentScene()->ObjectPicking(origin, direction));
+			return;
+		}
+
+		// the hierarchy holds a single selection for now, a dragged rectangle selects the first object found on it
+		renderer->GetPickingRef()->RequestPick(start, end, [this](const std::vector<uint64_t>& ids)
+			{
+				mPrefabHierarchy->SelectEntity(ids.empty() ? 0 : ids.front());
+			});
 	}
 
 	void Viewport::DrawMenu()
@@ -219,6 +258,27 @@ namespace Cosmos::Editor
 
 			ImGui::SameLine();
 
+			//
+			selectedButton = mGizmos->GetSurfaceSnapping();
+			if (selectedButton) {
+				ImGui::PushStyleColor(ImGuiCol_Button, ImGui::GetStyleColorVec4(ImGuiCol_HeaderActive));
+			}
+
+			ImGui::SetCursorPosX(ImGui::GetCursorPosX() - 5.0f);
+			if (ImGui::Button(ICON_LC_ARROW_DOWN_TO_DOT)) {
+				mGizmos->SetSurfaceSnapping(!mGizmos->GetSurfaceSnapping());
+			}
+
+			if (selectedButton) {
+				ImGui::PopStyleColor();
+			}
+
+			if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+				ImGui::SetTooltip("Enables/Disables snapping translated objects to the surface under the mouse");
+			}
+
+			ImGui::SameLine();
+
 			//
 			static bool selectedGrid = true;
 			selectedButton = selectedGrid;
@@ -239,6 +299,27 @@ namespace Cosmos::Editor
 			if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
 				ImGui::SetTooltip("Enables/Disables grid on 3D View");
 			}
+
+			ImGui::SameLine();
+
+			//
+			selectedButton = mCPUPicking;
+			if (selectedButton) {
+				ImGui::PushStyleColor(ImGuiCol_Button, ImGui::GetStyleColorVec4(ImGuiCol_HeaderActive));
+			}
+
+			ImGui::SetCursorPosX(ImGui::GetCursorPosX() - 5.0f);
+			if (ImGui::Button(ICON_LC_CPU)) {
+				mCPUPicking = !mCPUPicking;
+			}
+
+			if (selectedButton) {
+				ImGui::PopStyleColor();
+			}
+
+			if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+				ImGui::SetTooltip("Picks with a ray against the scene meshes instead of rendering the picking pass");
+			}
 		}
 		
 		ImGui::PopStyleColor();
@@ -381,7 +462,7 @@ namespace Cosmos::Editor
 		CreateFramebufferResources();
 
 		// recreate pipelines to match new renderpass
-		Renderer::Vulkan::DefaultPipelinesCreateInfo ci = { renderer->GetDevice(), renderer->GetMainRenderpassRef(), renderer->GetPipelinesLibraryRef(), renderer->GetRenderpassesLibraryRef() };
+		Renderer::Vulkan::DefaultPipelinesCreateInfo ci = { renderer->GetDevice(), renderer->GetMainRenderpassRef(), renderer->GetPipelinesLibraryRef(), renderer->GetRenderpassesLibraryRef(), renderer->GetBindlessRef()->GetDescriptorSetLayout() };
 		Renderer::Vulkan::CreateDefaultPipelines(ci);
 	}
 
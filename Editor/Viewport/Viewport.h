@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Common/Math/Math.h>
 #include <Common/Util/Memory.h>
 #include <Renderer/GUI/Widget.h>
 #include <Wrapper/imgui.h>
@@ -48,6 +49,9 @@ namespace Cosmos::Editor
 		// creates all framebuffer resources
 		void CreateFramebufferResources();
 
+		// selects what's under the clicked point or dragged rectangle, once it's read back from the picking pass
+		void RequestPick(glm::vec2 start, glm::vec2 end);
+
 	private:
 
 		Application* mApplication;
@@ -57,6 +61,11 @@ namespace Cosmos::Editor
 		Unique<Gizmos> mGizmos;
 		Unique<Grid> mGrid;
 
+		// left mouse pressed inside the viewport, where it's dragged from, clicks may be answered by a cpu ray instead of the picking pass
+		bool mPicking = false;
+		bool mCPUPicking = false;
+		glm::vec2 mPickStart = glm::vec2(0.0f);
+
 		// vulkan resources
 		VkFormat mSurfaceFormat = VK_FORMAT_UNDEFINED;
 		VkFormat mDepthFormat = VK_FORMAT_UNDEFINED;
@@ -83,25 +83,36 @@ namespace Cosmos::Editor
 
 		ShowComponent<Engine::TransformComponent>("Transform", entity, [&](Engine::TransformComponent& component)
 			{
+				bool changed = false;
+
 				ImGui::Text("T: ");
 				ImGui::SameLine();
-				Renderer::CustomWidget::Vector3Control("Translation", component.translation);
+				changed |= Renderer::CustomWidget::Vector3Control("Translation", component.translation);
 
 				ImGui::Text("R: ");
 				ImGui::SameLine();
 				glm::vec3 rotation = glm::degrees(component.rotation);
-				Renderer::CustomWidget::Vector3Control("Rotation", rotation);
-				component.rotation = glm::radians(rotation);
+
+				if (Renderer::CustomWidget::Vector3Control("Rotation", rotation)) {
+					component.rotation = glm::radians(rotation);
+					changed = true;
+				}
 
 				ImGui::Text("S: ");
 				ImGui::SameLine();
-				Renderer::CustomWidget::Vector3Control("Scale", component.scale);
+				changed |= Renderer::CustomWidget::Vector3Control("Scale", component.scale);
+
+				// the scene culling only looks at entities whose components were patched
+				if (changed) {
+					entity->PatchComponent<Engine::TransformComponent>();
+				}
 			});
 
 		ShowComponent<Engine::MeshComponent>("Mesh", entity, [&](Engine::MeshComponent& component)
 			{
 				if (component.mesh == nullptr) {
 					component.mesh = Renderer::IMesh::Create();
+					entity->PatchComponent<Engine::MeshComponent>();
 				}
 
 				// path to mesh object on disk
@@ -121,8 +132,10 @@ namespace Cosmos::Editor
 
 					if (ImGui::BeginDragDropTarget()) {
 						if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("EXPLORER")) {
+							// the mesh may be shared with other entities, this one takes another instead of reloading it
 							std::string path = (const char*)payload->Data;
-							component.mesh->LoadFromFile(path);
+							component.mesh = Renderer::IMesh::Acquire(path);
+							entity->PatchComponent<Engine::MeshComponent>();
 						}
 					
 						ImGui::EndDragDropTarget();
@@ -154,10 +167,10 @@ namespace Cosmos::Editor
 
 						if (ImGui::BeginDragDropTarget()) {
 							if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("EXPLORER")) {
+								// a different albedo is a different mesh, entities sharing the current one keep theirs
 								std::string path = (const char*)payload->Data;
-								component.mesh->GetMaterialRef().GetAlbedoTextureRef().reset();
-								component.mesh->GetMaterialRef().GetAlbedoTextureRef() = Renderer::ITexture2D::Create(path);
-								component.mesh->Refresh();
+								component.mesh = Renderer::IMesh::Acquire(component.mesh->GetPathRef(), component.mesh->GetScale(), path);
+								entity->PatchComponent<Engine::MeshComponent>();
 							}
 						
 							ImGui::EndDragDropTarget();
@@ -168,6 +181,27 @@ namespace Cosmos::Editor
 						ImGui::Image(component.mesh->GetMaterialRef().GetAlbedoTextureRef()->GetUIDescriptor(), ImVec2(32.0f, 32.0f));
 					}
 				}
+
+				// what the mesh keeps on cpu memory, it's shared by every entity drawing the same mesh
+				ImGui::SeparatorText("Residency");
+				{
+					const char* names[] = { "Discard", "Positions", "Full" };
+					int32_t residency = (int32_t)component.mesh->GetResidency();
+
+					ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(5.0f, 1.0f));
+					if (ImGui::Combo("##Residency", &residency, names, IM_ARRAYSIZE(names))) {
+						component.mesh->SetResidency((Renderer::IMesh::Residency)residency);
+						entity->PatchComponent<Engine::MeshComponent>();
+					}
+					ImGui::PopStyleVar();
+
+					if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+						ImGui::SetTooltip("Discard keeps nothing, positions are used by picking, full keeps every vertex attribute. Going up reads the file again.");
+					}
+
+					ImGui::SameLine();
+					ImGui::Text("%.2fMB", component.mesh->GetResidentBytes() / (1024.0 * 1024.0));
+				}
 			});
 	}
 
@@ -1,11 +1,21 @@
 #include "DebugWindow.h"
 
 #include "Core/Application.h"
+#include <Engine/Core/Scene.h>
 #include <Engine/Core/Timestep.h>
 #include <Engine/Entity/Camera.h>
 #include <Platform/Core/MainWindow.h>
+#include <Renderer/Core/IMesh.h>
+#include <Renderer/Vulkan/Bindless.h>
+#include <Renderer/Vulkan/CommandRecorder.h>
 #include <Renderer/Vulkan/Context.h>
+#include <Renderer/Vulkan/Culling.h>
+#include <Renderer/Vulkan/DeletionQueue.h>
+#include <Renderer/Vulkan/Device.h>
+#include <Renderer/Vulkan/ResidencyManager.h>
 #include <Renderer/Vulkan/Swapchain.h>
+#include <Renderer/Vulkan/TextureLoader.h>
+#include <Renderer/Vulkan/Uploader.h>
 #include <Renderer/GUI/Icon.h>
 #include <Wrapper/imgui.h>
 
@@ -42,6 +52,88 @@ namespace Cosmos::Editor
 			ImGui::Text("Size: (Window: %dx%d):(Swapchain: %dx%d)", framebuffer.x, framebuffer.y, extent.width, extent.height);
 			ImGui::Text("Mouse Pos: %lf x %lf", cursorPos.x, cursorPos.y);
 
+			auto& queue = renderer->GetRenderQueueRef().GetStatisticsRef();
+			ImGui::Text("Packets: %u, Batches: %u, Draws: %u, Binds: %u", queue.packets, queue.batches, queue.draws, queue.binds);
+			ImGui::Text("Queue CPU: sort %.3fms, submit %.3fms", queue.sortTime, queue.submitTime);
+			ImGui::Text("Recorded into %u command buffer(s), up to %u at once", queue.ranges, renderer->GetCommandRecorderRef()->GetRangeSlotCount());
+
+			ImGui::SeparatorText("GPU Culling");
+
+			auto& culling = renderer->GetCullingRef();
+
+			if (culling->IsSupported()) {
+				bool enabled = culling->IsEnabled();
+
+				if (ImGui::Checkbox("Enabled", &enabled)) {
+					culling->SetEnabled(enabled);
+				}
+
+				auto& cullingStats = culling->GetStatisticsRef();
+				ImGui::Text("Indirect draws: %u, instances tested: %u, visible: %u", cullingStats.draws, cullingStats.instances, cullingStats.visible);
+			}
+
+			else {
+				ImGui::Text("Not supported by the device, culling on the cpu only");
+			}
+
+			ImGui::SeparatorText("Scene Culling");
+
+			auto& sceneCulling = mApplication->GetCurrentScene()->GetCullingStatisticsRef();
+			ImGui::Text("Objects: %u, visible: %u, culled: %u", sceneCulling.objects, sceneCulling.visible, sceneCulling.culled);
+			ImGui::Text("BVH height: %d, nodes tested: %u (%s)", sceneCulling.height, sceneCulling.nodesTested, sceneCulling.scanned ? "leaves scanned" : "tree walked");
+			ImGui::Text("BVH checked: %u, reinserted: %u", sceneCulling.checked, sceneCulling.reinserted);
+			ImGui::Text("BVH CPU: update %.3fms, query %.3fms", sceneCulling.updateTime, sceneCulling.queryTime);
+
+			ImGui::SeparatorText("Global Descriptors");
+
+			auto& bindless = renderer->GetBindlessRef()->GetStatisticsRef();
+			ImGui::Text("Textures: %u of %u, materials: %u", bindless.textures, bindless.maxTextures, bindless.materials);
+			ImGui::Text("Writes this frame: %u", bindless.writes);
+
+			ImGui::SeparatorText("Pipeline Variants");
+
+			uint32_t variants = 0;
+
+			for (auto& [name, pipeline] : renderer->GetPipelinesLibraryRef().GetAllRefs()) {
+				if (name == "Mesh" || name.rfind("Mesh:", 0) == 0) {
+					variants++;
+				}
+			}
+
+			ImGui::Text("Mesh variants: %u, all built with the default pipelines", variants);
+
+			ImGui::SeparatorText("Mesh Memory (CPU)");
+
+			Renderer::IMesh::MemoryReport report = Renderer::IMesh::GetMemoryReport();
+
+			for (uint32_t i = 0; i < Renderer::IMesh::Residency::Count; i++) {
+				ImGui::Text("%s: %zu mesh(es), %.2f MB", Renderer::IMesh::ResidencyToString((Renderer::IMesh::Residency)i), report.meshes[i], report.bytes[i] / (1024.0 * 1024.0));
+			}
+
+			ImGui::SeparatorText("GPU Memory");
+
+			auto& residency = renderer->GetResidencyManagerRef()->GetStatisticsRef();
+			ImGui::Text("Usage: %.2f MB of %.2f MB", residency.usage / (1024.0 * 1024.0), residency.budget / (1024.0 * 1024.0));
+			ImGui::Text("Textures: %u (%u below full resolution), %.2f MB", residency.textures, residency.reducedTextures, residency.textureBytes / (1024.0 * 1024.0));
+			ImGui::Text("Streamed this frame: %u in, %u out", residency.streamedIn, residency.streamedOut);
+
+			ImGui::SeparatorText("Texture Loading");
+
+			auto& loading = renderer->GetTextureLoaderRef()->GetStatisticsRef();
+			ImGui::Text("%u queued, %u decoding on the workers, %u streamed level(s) uploading", loading.queued, loading.decoding, loading.swapping);
+			ImGui::Text("%u loaded, %u failed, %.2fms spent decoding", loading.loaded, loading.failed, loading.decodeTime);
+
+			ImGui::SeparatorText("Uploads");
+
+			auto& uploader = renderer->GetDevice()->GetUploaderRef();
+			auto& uploads = uploader->GetStatisticsRef();
+			ImGui::Text("Queue: %s", uploader->HasDedicatedQueue() ? "transfer" : "graphics");
+			ImGui::Text("%u upload(s), %.2f MB in %u batch(es), %u in flight", uploads.uploads, uploads.bytes / (1024.0 * 1024.0), uploads.batches, uploads.inFlight);
+			ImGui::Text("Stalls on a full ring: %u", uploads.stalls);
+			ImGui::Text("Mip levels generated on the gpu: %u, precomputed: %u", uploads.generatedLevels, uploads.precomputedLevels);
+			ImGui::Text("GPU time of upload batches: %.3f ms", uploads.gpuTime);
+			ImGui::Text("Objects waiting on frames in flight to be destroyed: %zu", renderer->GetDeletionQueueRef()->GetPendingCount());
+
 			ImGui::End();
 		}
 	}
@@ -5,8 +5,11 @@
 #include <Common/File/Filesystem.h>
 #include <Common/Util/Algorithm.h>
 #include <Engine/Core/Scene.h>
+#include <Renderer/Core/TextureCooker.h>
 #include <Renderer/GUI/Icon.h>
+#include <Renderer/Vulkan/Context.h>
 #include <Renderer/Vulkan/Texture.h>
+#include <Renderer/Vulkan/ThumbnailCache.h>
 
 #include <algorithm>
 #include <filesystem>
@@ -29,24 +32,25 @@ namespace Cosmos::Editor
 		mAssetsPath[Asset::Type::Spv] = GetAssetSubDir("Texture/Editor/spv.png");
 		mAssetsPath[Asset::Type::Mesh] = GetAssetSubDir("Texture/Editor/mesh.png");
 		mAssetsPath[Asset::Type::Sound] = GetAssetSubDir("Texture/Editor/sound.png");
+		mAssetsPath[Asset::Type::Image] = GetAssetSubDir("Texture/Editor/undef.png");
 
-		// create default resources for each supported format
+		// create default resources for each supported format, images and meshes show it until their thumbnail is ready
 		for (uint32_t i = 0; i < Asset::Type::ASSET_TYPE_MAX; i++) 
 		{
-			// skip image, it has it's own asset view type
-			if (i == Asset::Type::Image) {
-				continue;
-			}
-
 			mAssets[i].view.texture = CreateShared<Renderer::Vulkan::Texture2D>(mAssetsPath[i], true);
-			mAssets[i].view.descriptor = (VkDescriptorSet)Renderer::IGUI::GetRef()->AddTexture(mAssets[i].view.texture);
 		}
 
 		// create default resource for parent folder
 		mParentFolder.path = GetAssetsDir();
 		mParentFolder.name = "...";
-		mParentFolder.view.descriptor = mAssets[Asset::Type::Folder].view.descriptor;
 		mParentFolder.view.texture = mAssets[Asset::Type::Folder].view.texture;
+
+		// files are indexed on the background, until it's done folders are read from the disk
+		mIndex = CreateUnique<AssetIndex>(GetAssetsDir());
+
+		// thumbnails of images and meshes
+		auto* renderer = (Renderer::Vulkan::Context*)(Renderer::IContext::GetRef());
+		mThumbnails = CreateUnique<Renderer::Vulkan::ThumbnailCache>(renderer->GetDevice(), GetCacheSubDir("Thumbnails"));
 	}
 
 	Explorer::~Explorer()
@@ -56,6 +60,8 @@ namespace Cosmos::Editor
 
 	void Explorer::OnUpdate()
 	{
+		mThumbnails->OnUpdate();
+
 		if (mOpened)
 		{
 			ImGui::Begin(ICON_FA_FOLDER " Explorer", nullptr);
@@ -85,10 +91,29 @@ namespace Cosmos::Editor
 			separatorText.append(mCurrentDir);
 			ImGui::SeparatorText(separatorText.c_str());
 
-			// check if contents should be refreshed
+			// check if contents should be refreshed, files changed on disk also refresh it
+			if (mIndex->IsReady() && mIndex->GetVersion() != mIndexVersion) {
+				mRefreshExplorer = true;
+			}
+
 			if (mRefreshExplorer) {
 				Refresh(mCurrentDir);
 			}
+
+			// a search only takes a small slice of the frame, it's results show up as they're found
+			if (mSearching) {
+				std::vector<AssetIndex::Entry> entries = {};
+				bool done = mIndex->StepSearch(mSearch, entries, 1.0);
+
+				for (const AssetIndex::Entry& entry : entries) {
+					PushAsset(entry.path, entry.directory);
+				}
+
+				if (done) {
+					std::sort(mCurrentDirAssets.begin(), mCurrentDirAssets.end(), [](const Asset& a, const Asset& b) { return a.path < b.path; });
+					mSearching = false;
+				}
+			}
 			
 			// assets part
 			if (ImGui::BeginChild("##ExplorerAssets", ImVec2(0,0))) {
@@ -125,7 +150,19 @@ namespace Cosmos::Editor
 		// the group consists of the asset's image and name
 		ImGui::BeginGroup();
 		{
-			if (ImGui::ImageButton(asset.path.c_str(), asset.view.descriptor, buttonSize))
+			// the thumbnail is drawn from the atlas once it's there, the icon of the asset type until then
+			Renderer::Vulkan::ThumbnailCache::Region region = {};
+			VkDescriptorSet descriptor = (VkDescriptorSet)asset.view.texture->GetUIDescriptor();
+			ImVec2 uv0 = ImVec2(0.0f, 0.0f);
+			ImVec2 uv1 = ImVec2(1.0f, 1.0f);
+
+			if (mThumbnails->GetRegion(asset.thumbnail, region)) {
+				descriptor = mThumbnails->GetUIDescriptor();
+				uv0 = ImVec2(region.u0, region.v0);
+				uv1 = ImVec2(region.u1, region.v1);
+			}
+
+			if (ImGui::ImageButton(asset.path.c_str(), descriptor, buttonSize, uv0, uv1))
 			{
 				std::filesystem::path path(asset.path);
 				auto dir = std::filesystem::directory_entry(path);
@@ -171,6 +208,28 @@ namespace Cosmos::Editor
 	{
 		mCurrentDirAssets.clear();
 		mRefreshExplorer = false;
+		mSearching = false;
+		mIndexVersion = mIndex->GetVersion();
+
+		// the index answers without touching the disk, searches are stepped on the following frames
+		if (mIndex->IsReady()) {
+			if (!mSearchboxText.empty() && mIndex->BeginSearch(mSearchboxText, path, mRecursiveSearch, mSearch)) {
+				mSearching = true;
+				return;
+			}
+
+			std::vector<AssetIndex::Entry> entries = {};
+
+			if (mSearchboxText.empty() && mIndex->List(path, entries)) {
+				std::sort(entries.begin(), entries.end(), [](const AssetIndex::Entry& a, const AssetIndex::Entry& b) { return a.directory != b.directory ? a.directory : a.path < b.path; });
+
+				for (const AssetIndex::Entry& entry : entries) {
+					PushAsset(entry.path, entry.directory);
+				}
+
+				return;
+			}
+		}
 
 		// holds paths
 		std::vector<std::string> paths = {};
@@ -216,99 +275,104 @@ namespace Cosmos::Editor
 
 		// draw all found assets, according with previous specifications
 		for (auto& entry : paths) {
+			PushAsset(entry, std::filesystem::is_directory(entry));
+		}
+	}
 
-			// string manipulation
-			std::string ext = std::filesystem::path(entry).extension().string();
-			std::filesystem::path pathCorrected = entry;
-
-			// default asset configs
-			Asset asset = {};
-			asset.path = pathCorrected.string();
-			asset.name = pathCorrected.filename().replace_extension().string();
-			Cosmos::replace(asset.path.begin(), asset.path.end(), char('\\'), char('/'));
-
-			// check if it's a folder
-			if (std::filesystem::is_directory(entry)) {
-				asset.type = Asset::Type::Folder;
-				asset.view = mAssets[1].view;
-
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+	void Explorer::PushAsset(const std::string& path, bool directory)
+	{
+		// string manipulation
+		std::string ext = std::filesystem::path(path).extension().string();
+		std::filesystem::path pathCorrected = path;
+
+		// default asset configs
+		Asset asset = {};
+		asset.path = pathCorrected.string();
+		asset.name = pathCorrected.filename().replace_extension().string();
+		Cosmos::replace(asset.path.begin(), asset.path.end(), char('\\'), char('/'));
+
+		// check if it's a folder
+		if (directory) {
+			asset.type = Asset::Type::Folder;
+			asset.view = mAssets[1].view;
+
+			mCurrentDirAssets.push_back(asset);
+			return;
+		}
 
-			// text files
-			if (strcmp(".txt", ext.c_str()) == 0 || strcmp(".cfg", ext.c_str()) == 0 || strcmp(".cfg", ext.c_str()) == 0) {
-				asset.type = Asset::Type::Text;
-				asset.view = mAssets[Asset::Type::Text].view;
+		// text files
+		if (strcmp(".txt", ext.c_str()) == 0 || strcmp(".cfg", ext.c_str()) == 0 || strcmp(".cfg", ext.c_str()) == 0) {
+			asset.type = Asset::Type::Text;
+			asset.view = mAssets[Asset::Type::Text].view;
 
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+			mCurrentDirAssets.push_back(asset);
+			return;
+		}
 
-			// scenes
-			if (strcmp(".scene", ext.c_str()) == 0) {
-				asset.type = Asset::Type::Scene;
-				asset.view = mAssets[Asset::Type::Scene].view;
+		// scenes
+		if (strcmp(".scene", ext.c_str()) == 0) {
+			asset.type = Asset::Type::Scene;
+			asset.view = mAssets[Asset::Type::Scene].view;
 
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+			mCurrentDirAssets.push_back(asset);
+			return;
+		}
 
-			// vertex shaders
-			if (strcmp(".vert", ext.c_str()) == 0) {
-				asset.type = Asset::Type::Vert;
-				asset.view = mAssets[Asset::Type::Vert].view;
+		// vertex shaders
+		if (strcmp(".vert", ext.c_str()) == 0) {
+			asset.type = Asset::Type::Vert;
+			asset.view = mAssets[Asset::Type::Vert].view;
 
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+			mCurrentDirAssets.push_back(asset);
+			return;
+		}
 
-			// fragment shader
-			if (strcmp(".frag", ext.c_str()) == 0) {
-				asset.type = Asset::Type::Frag;
-				asset.view = mAssets[Asset::Type::Frag].view;
+		// fragment shader
+		if (strcmp(".frag", ext.c_str()) == 0) {
+			asset.type = Asset::Type::Frag;
+			asset.view = mAssets[Asset::Type::Frag].view;
 
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+			mCurrentDirAssets.push_back(asset);
+			return;
+		}
 
-			// spir-v shader
-			if (strcmp(".spv", ext.c_str()) == 0) {
-				asset.type = Asset::Type::Spv;
-				asset.view = mAssets[Asset::Type::Spv].view;
+		// spir-v shader
+		if (strcmp(".spv", ext.c_str()) == 0) {
+			asset.type = Asset::Type::Spv;
+			asset.view = mAssets[Asset::Type::Spv].view;
 
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+			mCurrentDirAssets.push_back(asset);
+			return;
+		}
 
-			// meshes
-			if (strcmp(".gltf", ext.c_str()) == 0) {
-				asset.type = Asset::Type::Mesh;
-				asset.view = mAssets[Asset::Type::Mesh].view;
+		// meshes
+		if (strcmp(".gltf", ext.c_str()) == 0) {
+			asset.type = Asset::Type::Mesh;
+			asset.view = mAssets[Asset::Type::Mesh].view;
+			asset.thumbnail = mThumbnails->Request(asset.path);
 
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+			mCurrentDirAssets.push_back(asset);
+			return;
+		}
 
-			// sound
-			if (strcmp(".mp3", ext.c_str()) == 0  || strcmp(".wav", ext.c_str()) == 0  || strcmp(".ogg", ext.c_str()) == 0) {
-				asset.type = Asset::Type::Sound;
-				asset.view = mAssets[Asset::Type::Sound].view;
+		// sound
+		if (strcmp(".mp3", ext.c_str()) == 0  || strcmp(".wav", ext.c_str()) == 0  || strcmp(".ogg", ext.c_str()) == 0) {
+			asset.type = Asset::Type::Sound;
+			asset.view = mAssets[Asset::Type::Sound].view;
 
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+			mCurrentDirAssets.push_back(asset);
+			return;
+		}
 
-			// images
-			if (strcmp(".png", ext.c_str()) == 0 || strcmp(".jpg", ext.c_str()) == 0)
-			{
-				asset.type = Asset::Type::Image;
-				asset.view.texture = CreateShared<Renderer::Vulkan::Texture2D>(asset.path.c_str(), true);
-				asset.view.descriptor = (VkDescriptorSet)Renderer::IGUI::GetRef()->AddTexture(asset.view.texture);
+		// images
+		if (strcmp(".png", ext.c_str()) == 0 || strcmp(".jpg", ext.c_str()) == 0 || strcmp(".ktx2", ext.c_str()) == 0)
+		{
+			asset.type = Asset::Type::Image;
+			asset.view = mAssets[Asset::Type::Image].view;
+			asset.thumbnail = mThumbnails->Request(asset.path);
 
-				mCurrentDirAssets.push_back(asset);
-				continue;
-			}
+			mCurrentDirAssets.push_back(asset);
+			return;
 		}
 	}
 
@@ -455,6 +519,32 @@ namespace Cosmos::Editor
 				break;
 			}
 
+			case Asset::Type::Image:
+			{
+				if (ImGui::BeginPopupContextItem("##RightClickExplorerImage", ImGuiPopupFlags_MouseButtonRight)) {
+					// writes a ktx2 with every mip level next to the image, textures loading the image use it from now on
+					if (std::filesystem::path(asset.path).extension() != ".ktx2" && ImGui::BeginMenu(ICON_LC_COOKING_POT " Cook")) {
+						using Usage = Renderer::TextureCooker::Usage;
+						Usage guess = Renderer::TextureCooker::GuessUsage(asset.path);
+
+						for (Usage usage : { Usage::Albedo, Usage::Normal, Usage::Mask, Usage::Uncompressed }) {
+							char label[64];
+							snprintf(label, sizeof(label), "%s (%s)", Renderer::TextureCooker::GetUsageName(usage), usage == Usage::Mask ? "BC1/BC3" : Renderer::KTXFile::GetFormatName(Renderer::TextureCooker::GetFormat(usage, false)));
+
+							if (ImGui::MenuItem(label, nullptr, usage == guess)) {
+								Renderer::TextureCooker::Cook(asset.path, usage);
+								mRefreshExplorer = true;
+							}
+						}
+
+						ImGui::EndMenu();
+					}
+
+					ImGui::EndPopup();
+				}
+				break;
+			}
+
 			default: { break; }
 		}
 		ImGui::PopID();
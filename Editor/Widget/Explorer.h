@@ -2,6 +2,7 @@
 #include <Renderer/Wrapper/imgui.h>
 #include <Renderer/Wrapper/vulkan.h>
 
+#include <Common/File/AssetIndex.h>
 #include <Renderer/Core/IGUI.h>
 #include <Renderer/GUI/Widget.h>
 
@@ -11,6 +12,7 @@
 
 // forward declarations
 namespace Cosmos::Renderer::Vulkan { class Texture2D; }
+namespace Cosmos::Renderer::Vulkan { class ThumbnailCache; }
 namespace Cosmos::Editor { class Application; }
 
 namespace Cosmos::Editor
@@ -38,13 +40,13 @@ namespace Cosmos::Editor
 		struct ViewResource
 		{
 			Shared<Renderer::Vulkan::Texture2D> texture = {};
-			VkDescriptorSet descriptor = VK_NULL_HANDLE;
 		};
 
 		Type type = Type::Undefined;
 		ViewResource view = {};
 		std::string path = {};
 		std::string name = {};
+		uint32_t thumbnail = UINT32_MAX;						// handle on the thumbnail cache, the view is drawn while it's not ready
 	};
 	
 	class Explorer : public Renderer::Widget
@@ -81,6 +83,9 @@ namespace Cosmos::Editor
 		// reloads the folder's content
 		void Refresh(std::string path);
 
+		// appends the asset of a path to the folder's content by it's extension
+		void PushAsset(const std::string& path, bool directory);
+
 		// draws a menu if right mouse is clicked on the window
 		void DisplayRightClickMenu();
 		
@@ -97,9 +102,16 @@ namespace Cosmos::Editor
 		std::vector<Asset> mCurrentDirAssets = {};
 		std::string mSearchboxText = {};
 
+		// the folder's content comes from the index once it's built, searches are stepped a little every frame
+		Unique<AssetIndex> mIndex;
+		AssetIndex::Search mSearch = {};
+		bool mSearching = false;
+		uint64_t mIndexVersion = 0;
+
 		// default resources
 		std::array<Asset, Asset::ASSET_TYPE_MAX> mAssets;
 		std::array<std::string, Asset::ASSET_TYPE_MAX> mAssetsPath = {};
 		Asset mParentFolder;
+		Unique<Renderer::Vulkan::ThumbnailCache> mThumbnails;
 	};
 }
\ No newline at end of file
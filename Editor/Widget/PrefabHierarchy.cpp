@@ -55,6 +55,12 @@ namespace Cosmos::Editor
 		}
 	}
 
+	void PrefabHierarchy::SelectEntity(uint64_t id)
+	{
+		mRenamingEntity = nullptr;
+		mLastSelectedEntity = id != 0 ? FindEntity(mApplication->GetCurrentScene()->GetRootPrefab(), id) : nullptr;
+	}
+
 	void PrefabHierarchy::UpdatePrefabs(Engine::Prefab* parent, Engine::Prefab* current)
 	{
 		if (current == mApplication->GetCurrentScene()->GetRootPrefab()) {
@@ -417,4 +423,21 @@ namespace Cosmos::Editor
 			IsValidMove(movingTo, entry.second, found);
 		}
 	}
+
+	Engine::Entity* PrefabHierarchy::FindEntity(Engine::Prefab* current, uint64_t id)
+	{
+		for (auto& entity : current->GetEntitiesRef()) {
+			if (entity.second->HasComponent<Engine::IDComponent>() && entity.second->GetComponent<Engine::IDComponent>().id->GetValue() == id) {
+				return entity.second;
+			}
+		}
+
+		for (auto& child : current->GetChildrenRef()) {
+			if (Engine::Entity* entity = FindEntity(child.second, id)) {
+				return entity;
+			}
+		}
+
+		return nullptr;
+	}
 }
\ No newline at end of file
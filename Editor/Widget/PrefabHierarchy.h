@@ -29,6 +29,9 @@ namespace Cosmos::Editor
 		// returns the last selected entity pointer
 		inline Engine::Entity* GetSelectedEntity() { return mLastSelectedEntity; }
 
+		// selects the entity with an id, nothing is selected if there's none
+		void SelectEntity(uint64_t id);
+
 	public:
 
 		// updates the tick logic
@@ -71,6 +74,9 @@ namespace Cosmos::Editor
 		// makes a place to drop entities and prefabs
 		void DragAndDropTarget(Engine::Prefab* movingTo);
 
+		// returns the entity with an id on a prefab or it's sub-prefabs, nullptr if there's none
+		Engine::Entity* FindEntity(Engine::Prefab* current, uint64_t id);
+
 	private:
 
 		Application* mApplication = nullptr;
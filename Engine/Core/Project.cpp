@@ -34,6 +34,8 @@ namespace Cosmos::Engine
 		if (data.Exists("validations")) settings.validations = data["validations"].GetInt() == 1 ? true : false;
 		if (data.Exists("vulkanversion")) settings.vulkanversion = data["vulkanversion"].GetString();
 		if (data.Exists("msaa")) settings.msaa = (uint32_t)data["msaa"].GetInt();
+		if (data.Exists("meshresidency")) settings.meshresidency = data["meshresidency"].GetString();
+		if (data.Exists("gpubudget")) settings.gpubudget = (uint32_t)data["gpubudget"].GetInt();
 		//
 		if (data.Exists("enginename")) settings.enginename = data["enginename"].GetString();
 		if (data.Exists("datapath")) settings.datapath = data["datapath"].GetString();
@@ -64,6 +66,8 @@ namespace Cosmos::Engine
 		data["Project Settings"]["validations"].SetInt((int32_t)settings.validations);
 		data["Project Settings"]["vulkanversion"].SetString(settings.vulkanversion);
 		data["Project Settings"]["msaa"].SetInt(settings.msaa);
+		data["Project Settings"]["meshresidency"].SetString(settings.meshresidency);
+		data["Project Settings"]["gpubudget"].SetInt(settings.gpubudget);
 		//
 		data["Project Settings"]["enginename"].SetString(settings.enginename);
 		data["Project Settings"]["datapath"].SetString(settings.datapath);
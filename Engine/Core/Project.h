@@ -16,6 +16,8 @@ namespace Cosmos::Engine
 		bool validations = true;
 		std::string vulkanversion = "1.2.0";
 		uint32_t msaa = 2U;
+		std::string meshresidency = "positions";
+		uint32_t gpubudget = 0U;
 
 		// engine
 		std::string enginename = "Cosmos";
@@ -1,5 +1,6 @@
 #include "Scene.h"
 
+#include "Entity/Camera.h"
 #include "Entity/Entity.h"
 #include "Entity/Prefab.h"
 #include "Entity/Components/AllComponents.h"
@@ -7,17 +8,30 @@
 #include <Common/Debug/Logger.h>
 #include <Common/Debug/Profiler.h>
 #include <Common/File/Filesystem.h>
+#include <Common/Math/Frustum.h>
 #include <Common/Math/ID.h>
+#include <Common/Math/TriangleBVH.h>
+#include <Common/Util/Timer.h>
 #include <Renderer/Core/IContext.h>
 #include <Renderer/Core/IMesh.h>
 #include <Renderer/Core/ITexture.h>
 
+#include <cfloat>
+
 namespace Cosmos::Engine
 {
 	Scene::Scene(std::string name)
 		: mName(name)
 	{
 		mRootPrefab = new Prefab(this, "Root Prefab");
+
+		// the bvh update only looks at entities whose transform or mesh changed, code writing them in place must patch the component
+		mRegistry.on_construct<TransformComponent>().connect<&Scene::OnCullingChanged>(this);
+		mRegistry.on_update<TransformComponent>().connect<&Scene::OnCullingChanged>(this);
+		mRegistry.on_destroy<TransformComponent>().connect<&Scene::OnCullingChanged>(this);
+		mRegistry.on_construct<MeshComponent>().connect<&Scene::OnCullingChanged>(this);
+		mRegistry.on_update<MeshComponent>().connect<&Scene::OnCullingChanged>(this);
+		mRegistry.on_destroy<MeshComponent>().connect<&Scene::OnCullingChanged>(this);
 	}
 
 	Scene::~Scene()
@@ -40,23 +54,61 @@ namespace Cosmos::Engine
 
 			mesh.mesh->OnUpdate(timestep);
 		}
+
+		UpdateBVH();
 	}
 
 	void Scene::OnRender(uint32_t stage)
 	{
 		PROFILER_FUNCTION();
 
-		// meshes rendering
-		auto meshesView = mRegistry.view<IDComponent, TransformComponent, MeshComponent>();
-		for (auto entity : meshesView) {
-			auto [id, transform, mesh] = meshesView.get<IDComponent, TransformComponent, MeshComponent>(entity);
+		// meshes are submitted into the render queue, wich sorts them to avoid redundant state changes before recording
+		Renderer::RenderQueue& queue = Renderer::IContext::GetRef()->GetRenderQueueRef();
+		Camera& camera = Camera::GetRef();
+		glm::vec3 cameraPosition = glm::vec3(glm::inverse(camera.GetViewRef())[3]);
 
-			if (mesh.mesh == nullptr || !mesh.mesh->IsLoaded() || mesh.mesh->IsTransfering()) {
-				continue;
-			}
+		// only entities the bvh finds inside the view are submitted
+		Frustum frustum(camera.GetProjectionRef() * camera.GetViewRef());
+		uint32_t visible = 0;
+
+		Timer queryTimer;
+		queryTimer.Start();
+
+		auto submit = [&](entt::entity entity)
+			{
+				if (!mRegistry.valid(entity) || !mRegistry.all_of<IDComponent, TransformComponent, MeshComponent>(entity)) {
+					return;
+				}
 
-			mesh.mesh->OnRender(transform.GetTransform(), id.id->GetValue(), (Renderer::IContext::Stage)stage);
+				auto& id = mRegistry.get<IDComponent>(entity);
+				auto& transform = mRegistry.get<TransformComponent>(entity);
+				auto& mesh = mRegistry.get<MeshComponent>(entity);
+
+				if (mesh.mesh == nullptr || !mesh.mesh->IsLoaded() || mesh.mesh->IsTransfering()) {
+					return;
+				}
+
+				glm::mat4 model = transform.GetTransform();
+				float depth = glm::length(glm::vec3(model[3]) - cameraPosition);
+				queue.Submit(mesh.mesh.get(), model, id.id->GetValue(), depth, mesh.mesh->GetFeatures());
+				visible++;
+			};
+
+		DynamicBVH::QueryStatistics statistics = mBVH.Query(frustum, [&](uint64_t userData) { submit((entt::entity)userData); });
+
+		for (entt::entity entity : mUnbounded) {
+			submit(entity);
 		}
+
+		mCullingStatistics.queryTime = queryTimer.Stop();
+		mCullingStatistics.objects = mBVH.GetProxyCount() + (uint32_t)mUnbounded.size();
+		mCullingStatistics.visible = visible;
+		mCullingStatistics.culled = mCullingStatistics.objects - visible;
+		mCullingStatistics.nodesTested = statistics.nodesTested;
+		mCullingStatistics.scanned = statistics.scanned;
+		mCullingStatistics.height = mBVH.GetHeight();
+
+		queue.Flush(stage);
 	}
 
 	void Scene::OnEvent(Shared<Platform::EventBase> event)
@@ -80,65 +132,74 @@ namespace Cosmos::Engine
 		mRootPrefab->GetEntitiesRef().clear();
 	}
 
-	void Scene::FindObjectIntersection(glm::vec3 rayStart, glm::vec3 rayDirection)
+	uint64_t Scene::ObjectPicking(const glm::vec3& origin, const glm::vec3& direction, RayHit* hit, uint64_t ignore)
 	{
-		auto meshesView = mRegistry.view<IDComponent, TransformComponent, MeshComponent>();
-
-		for (auto entity : meshesView) {
-			auto [id, transform, mesh] = meshesView.get<IDComponent, TransformComponent, MeshComponent>(entity);
-
-			if (mesh.mesh == nullptr || !mesh.mesh->IsLoaded() || mesh.mesh->IsTransfering()) {
-				continue;
-			}
+		PROFILER_FUNCTION();
 
-			Debug_CubeRay(rayStart, rayDirection);
+		uint64_t closestID = 0;
+		float closestDistance = FLT_MAX;
+		glm::vec3 closestNormal = glm::vec3(0.0f);
+
+		// the bvh bounds are enlarged and axis aligned, each candidate is tested again against it's mesh bounds in it's own space
+		auto test = [&](uint64_t userData, float maxDistance) -> float
+			{
+				entt::entity entity = (entt::entity)userData;
+
+				if (!mRegistry.valid(entity) || !mRegistry.all_of<IDComponent, TransformComponent, MeshComponent>(entity)) {
+					return maxDistance;
+				}
+
+				auto& id = mRegistry.get<IDComponent>(entity);
+				auto& transform = mRegistry.get<TransformComponent>(entity);
+				auto& mesh = mRegistry.get<MeshComponent>(entity);
+
+				if (mesh.mesh == nullptr || !mesh.mesh->IsLoaded() || mesh.mesh->IsTransfering() || id.id->GetValue() == ignore) {
+					return maxDistance;
+				}
+
+				// the direction isn't normalized again, so distances along the local ray are the same as along the world one
+				glm::mat4 inverse = glm::inverse(transform.GetTransform());
+				glm::vec3 localOrigin = glm::vec3(inverse * glm::vec4(origin, 1.0f));
+				glm::vec3 localDirection = glm::vec3(inverse * glm::vec4(direction, 0.0f));
+
+				const TriangleBVH* triangles = mesh.mesh->GetTriangleBVH();
+				TriangleBVH::Hit triangleHit = {};
+				float t = 0.0f;
+
+				// meshes whose triangles weren't kept, or are still being built on a worker, are hit on their bounds facing the ray
+				if (triangles == nullptr) {
+					if (!RayAABBCollide(localOrigin, localDirection, mesh.mesh->GetBoundingBoxRef().GetMin(), mesh.mesh->GetBoundingBoxRef().GetMax(), t) || t >= maxDistance) {
+						return maxDistance;
+					}
+
+					closestNormal = -glm::normalize(direction);
+				}
+
+				else {
+					if (!triangles->RayCast(localOrigin, localDirection, maxDistance, triangleHit)) {
+						return maxDistance;
+					}
+
+					// normals go back to world space by the inverse transpose, wich keeps them perpendicular under non-uniform scale
+					t = triangleHit.distance;
+					closestNormal = glm::normalize(glm::transpose(glm::mat3(inverse)) * triangleHit.normal);
+				}
+
+				closestID = id.id->GetValue();
+				closestDistance = t;
+				return t;
+			};
+
+		mBVH.RayCast(origin, direction, FLT_MAX, test);
+
+		if (hit != nullptr && closestID != 0) {
+			hit->id = closestID;
+			hit->distance = closestDistance;
+			hit->point = origin + direction * closestDistance;
+			hit->normal = closestNormal;
 		}
-	}
 
-	void Scene::ObjectPicking(const glm::vec3& startPos, const glm::vec3& endPos, const glm::vec3& dir)
-	{
-		//float closestDistance = FLT_MAX; // Closest intersection distance
-		//uint64_t closestID = -1; // ID of the closest AABB
-		//
-		//auto meshesView = mRegistry.view<IDComponent, TransformComponent, MeshComponent>();
-		//for (auto selectable : meshesView) {
-		//	auto [id, transform, mesh] = meshesView.get<IDComponent, TransformComponent, MeshComponent>(selectable);
-		//
-		//	if (mesh.mesh == nullptr || !mesh.mesh->IsLoaded() || mesh.mesh->IsTransfering()) {
-		//		continue;
-		//	}
-		//
-		//	float t;
-		//	glm::vec3 aabbMin, aabbMax;
-		//	glm::vec3 localMin = { -1.0f, -1.0f, -1.0f };
-		//	glm::vec3 localMax = { 1.0f, 1.0f, 1.0f };
-		//	transform.ComputeAABB(localMin, localMax, transform.GetTransform(), aabbMin, aabbMax);
-		//
-		//	if (RayAABBCollide(startPos, dir, aabbMin, aabbMax, t)) {
-		//
-		//		if (t < closestDistance) {
-		//			closestDistance = t;
-		//			closestID = id.id->GetValue();
-		//		}
-		//	}
-		//}
-		//
-		// now we must find ID, maybe I should be replacing the main structure behind the Editor's Hierarchy
-		// or I could add an selectable component
-
-		// we have an selectable component to set/unset the item as selected. However the only supported component is the mesh component
-		//auto meshesView = mRegistry.view<IDComponent, EditorComponent, TransformComponent, MeshComponent>();
-		//for (auto selectable : meshesView) {
-		//	auto [id, editor, transform, mesh] = meshesView.get<IDComponent, EditorComponent, TransformComponent, MeshComponent>(selectable);
-		//
-		//	if (mesh.mesh == nullptr) continue;
-		//	if (!mesh.mesh->IsLoaded()) continue;
-		//	if (mesh.mesh->IsTransfering()) continue;
-		//
-		//	if (RayAABBCollide(startPos, dir, aabbMin, aabbMax, t)) {
-		//
-		//	}
-		//}
+		return closestID;
 	}
 
 	void Scene::Debug_CubeRay(glm::vec3 startPos, glm::vec3 endPos)
@@ -158,8 +219,7 @@ namespace Cosmos::Engine
 			it->second->GetComponent<TransformComponent>().translation = startPos;
 
 			it->second->AddComponent<MeshComponent>();
-			it->second->GetComponent<MeshComponent>().mesh = Renderer::IMesh::Create();
-			it->second->GetComponent<MeshComponent>().mesh->LoadFromFile(GetAssetSubDir("Mesh/cube.gltf"));
+			it->second->GetComponent<MeshComponent>().mesh = Renderer::IMesh::Acquire(GetAssetSubDir("Mesh/cube.gltf"));
 		}
 
 		std::string endName = "LineEnd";
@@ -171,6 +231,7 @@ namespace Cosmos::Engine
 			it->second->AddComponent<TransformComponent>();
 			it->second->GetComponent<TransformComponent>().translation = endPos;
 		
+			// selection tints the whole mesh, so this one isn't shared with the other cubes
 			it->second->AddComponent<MeshComponent>();
 			it->second->GetComponent<MeshComponent>().mesh = Renderer::IMesh::Create();
 			it->second->GetComponent<MeshComponent>().mesh->LoadFromFile(GetAssetSubDir("Mesh/cube.gltf"));
@@ -178,6 +239,102 @@ namespace Cosmos::Engine
 		}
 	}
 
+	void Scene::UpdateBVH()
+	{
+		PROFILER_FUNCTION();
+
+		Timer updateTimer;
+		updateTimer.Start();
+
+		uint32_t reinserted = 0;
+
+		// meshes loading on the workers have nothing to insert yet, they're looked at again until they finish
+		mChanged.insert(mLoading.begin(), mLoading.end());
+		mLoading.clear();
+
+		for (entt::entity entity : mChanged) {
+			// entities destroyed or without a mesh leave the bvh
+			if (!mRegistry.valid(entity) || !mRegistry.all_of<IDComponent, TransformComponent, MeshComponent>(entity)) {
+				RemoveCullingProxy(entity);
+				continue;
+			}
+
+			auto& transform = mRegistry.get<TransformComponent>(entity);
+			auto& mesh = mRegistry.get<MeshComponent>(entity);
+
+			if (mesh.mesh == nullptr) {
+				RemoveCullingProxy(entity);
+				continue;
+			}
+
+			if (!mesh.mesh->IsLoaded() || mesh.mesh->IsTransfering()) {
+				RemoveCullingProxy(entity);
+				mLoading.push_back(entity);
+				continue;
+			}
+
+			// without bounds there's nothing to cull against, the entity is always drawn
+			if (!mesh.mesh->GetBoundingBoxRef().IsValid()) {
+				RemoveCullingProxy(entity);
+				mUnbounded.insert(entity);
+				continue;
+			}
+
+			mUnbounded.erase(entity);
+
+			glm::vec3 localMin = mesh.mesh->GetBoundingBoxRef().GetMin();
+			glm::vec3 localMax = mesh.mesh->GetBoundingBoxRef().GetMax();
+			CullingProxy& proxy = mProxies[entity];
+
+			bool changed = proxy.proxy == DynamicBVH::Null
+				|| proxy.translation != transform.translation || proxy.rotation != transform.rotation || proxy.scale != transform.scale
+				|| proxy.localMin != localMin || proxy.localMax != localMax;
+
+			if (!changed) {
+				continue;
+			}
+
+			proxy.translation = transform.translation;
+			proxy.rotation = transform.rotation;
+			proxy.scale = transform.scale;
+			proxy.localMin = localMin;
+			proxy.localMax = localMax;
+
+			glm::vec3 min, max;
+			transform.ComputeAABB(localMin, localMax, transform.GetTransform(), min, max);
+
+			if (proxy.proxy == DynamicBVH::Null) {
+				proxy.proxy = mBVH.Insert(min, max, (uint64_t)entity);
+			}
+
+			else if (mBVH.Move(proxy.proxy, min, max)) {
+				reinserted++;
+			}
+		}
+
+		mCullingStatistics.checked = (uint32_t)mChanged.size();
+		mCullingStatistics.reinserted = reinserted;
+		mCullingStatistics.updateTime = updateTimer.Stop();
+		mChanged.clear();
+	}
+
+	void Scene::OnCullingChanged(entt::registry& registry, entt::entity entity)
+	{
+		mChanged.insert(entity);
+	}
+
+	void Scene::RemoveCullingProxy(entt::entity entity)
+	{
+		auto it = mProxies.find(entity);
+
+		if (it != mProxies.end()) {
+			mBVH.Remove(it->second.proxy);
+			mProxies.erase(it);
+		}
+
+		mUnbounded.erase(entity);
+	}
+
 	Datafile Scene::Serialize()
 	{
 		Datafile scene;
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "Wrapper/Entt.h"
+#include <Common/Math/DynamicBVH.h>
 #include <Common/Math/Math.h>
 #include <Common/File/Datafile.h>
 #include <Common/Util/Library.h>
 #include <Common/Util/Memory.h>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // forward declarations
@@ -17,6 +20,30 @@ namespace Cosmos::Engine
 {
 	class Scene
 	{
+	public:
+
+		struct CullingStatistics
+		{
+			uint32_t objects = 0;		// entities with a mesh on the bvh
+			uint32_t visible = 0;		// entities submitted for rendering
+			uint32_t culled = 0;		// entities outside the view
+			uint32_t nodesTested = 0;	// bvh nodes tested against the frustum
+			bool scanned = false;		// the query went through the leaves in order instead of walking the tree
+			int32_t height = 0;			// bvh height
+			uint32_t checked = 0;		// entities looked at this update, the ones patched or still loading their mesh
+			uint32_t reinserted = 0;	// proxies that left their enlarged bounds this update
+			double updateTime = 0.0;	// milliseconds spent updating the bvh
+			double queryTime = 0.0;		// milliseconds spent querying the bvh
+		};
+
+		struct RayHit
+		{
+			uint64_t id = 0;							// entity hit, 0 if none
+			float distance = 0.0f;						// in units of the ray direction
+			glm::vec3 point = glm::vec3(0.0f);			// world space
+			glm::vec3 normal = glm::vec3(0.0f);			// world space, normalized and facing the ray origin
+		};
+
 	public:
 
 		// constructor
@@ -31,6 +58,9 @@ namespace Cosmos::Engine
 		// returns the root prefab of the scene
 		inline Prefab* GetRootPrefab() { return mRootPrefab; }
 
+		// returns a reference to the culling statistics of the last update and render
+		inline CullingStatistics& GetCullingStatisticsRef() { return mCullingStatistics; }
+
 	public:
 
 		// returns the scene's name
@@ -55,11 +85,9 @@ namespace Cosmos::Engine
 		// erases all contents the scene has
 		void ClearScene();
 
-		// attempts to find an entity that may intersect with a given ray
-		void FindObjectIntersection(glm::vec3 rayStart, glm::vec3 rayDirection);
-
-		// attempts to select an object checking collision with a ray between two points
-		void ObjectPicking(const glm::vec3& startPos, const glm::vec3& endPos, const glm::vec3& dir);
+		// returns the id of the closest entity a ray hits, 0 if there's none, the ignored entity is seen through
+		// it runs on the cpu, the culling bvh finds the instances and each mesh triangle bvh the surface, meshes without one are hit on their bounds
+		uint64_t ObjectPicking(const glm::vec3& origin, const glm::vec3& direction, RayHit* hit = nullptr, uint64_t ignore = 0);
 
 		// creates 2 entities, representing a line
 		void Debug_CubeRay(glm::vec3 startPos, glm::vec3 endPos);
@@ -74,8 +102,38 @@ namespace Cosmos::Engine
 
 	private:
 
+		// keeps the bvh in sync with the mesh entities, only the ones whose transform or mesh was created, patched or destroyed are looked at
+		// entities with a mesh still loading are looked at on every update until it's done
+		void UpdateBVH();
+
+		// marks an entity to be looked at on the next bvh update, connected to the transform and mesh signals
+		void OnCullingChanged(entt::registry& registry, entt::entity entity);
+
+		// takes an entity out of the bvh and the unbounded ones
+		void RemoveCullingProxy(entt::entity entity);
+
+	private:
+
+		// the transform and mesh bounds last used for an entity's proxy
+		struct CullingProxy
+		{
+			int32_t proxy = DynamicBVH::Null;
+			glm::vec3 translation = glm::vec3(0.0f);
+			glm::vec3 rotation = glm::vec3(0.0f);
+			glm::vec3 scale = glm::vec3(1.0f);
+			glm::vec3 localMin = glm::vec3(0.0f);
+			glm::vec3 localMax = glm::vec3(0.0f);
+		};
+
 		entt::registry mRegistry;
 		std::string mName;
 		Prefab* mRootPrefab;
+
+		DynamicBVH mBVH;
+		std::unordered_map<entt::entity, CullingProxy> mProxies = {};
+		std::unordered_set<entt::entity> mUnbounded = {};
+		std::unordered_set<entt::entity> mChanged = {};
+		std::vector<entt::entity> mLoading = {};
+		CullingStatistics mCullingStatistics = {};
 	};
 }
\ No newline at end of file
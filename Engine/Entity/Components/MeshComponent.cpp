@@ -29,11 +29,8 @@ namespace Cosmos::Engine
 			entity->AddComponent<MeshComponent>();
 			auto& component = entity->GetComponent<MeshComponent>();
 
-			component.mesh = Renderer::IMesh::Create();
-			component.mesh->LoadFromFile(dataFile["Mesh"]["Path"].GetString());
-			component.mesh->GetMaterialRef().GetAlbedoTextureRef().reset();
-			component.mesh->GetMaterialRef().GetAlbedoTextureRef() = Renderer::ITexture2D::Create(dataFile["Mesh"]["Albedo"].GetString());
-			component.mesh->Refresh();
+			// entities with the same file and albedo share the mesh, they're drawn as instances of it
+			component.mesh = Renderer::IMesh::Acquire(dataFile["Mesh"]["Path"].GetString(), 1.0f, dataFile["Mesh"]["Albedo"].GetString());
 		}
 	}
 }
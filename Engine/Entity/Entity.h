@@ -20,6 +20,9 @@ namespace Cosmos::Engine
 		// returns the entity handle
 		inline entt::entity GetHandle() const { return mHandle; }
 
+		// returns the scene the entity is on
+		inline Scene* GetScene() { return mScene; }
+
 		// returns if entity is mouse-picked
 		inline bool IsMousePicked() { return mPicked; }
 
@@ -49,6 +52,13 @@ namespace Cosmos::Engine
 			return mScene->GetEntityRegistryRef().emplace_or_replace<T>(mHandle, std::forward<Args>(args)...);
 		}
 
+		// informs the component was changed in place, the scene keeps it's culling in sync by listening to these
+		template<typename T>
+		void PatchComponent()
+		{
+			mScene->GetEntityRegistryRef().patch<T>(mHandle);
+		}
+
 		// removes the component
 		template<typename T>
 		void RemoveComponent()
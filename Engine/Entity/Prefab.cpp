@@ -136,21 +136,9 @@ namespace Cosmos::Engine
         }
         
         if (entity->HasComponent<MeshComponent>()) {
+            // the duplicate shares the mesh, both are drawn as instances of it
             newEntity->AddComponent<MeshComponent>();
-            newEntity->GetComponent<MeshComponent>().mesh = Renderer::IMesh::Create();
-        
-            auto& oldMesh = entity->GetComponent<MeshComponent>().mesh;
-            auto& newMesh = newEntity->GetComponent<MeshComponent>().mesh;
-        
-            if (oldMesh->IsLoaded()) {
-                newMesh->LoadFromFile(oldMesh->GetPathRef());
-            }
-        
-            if (oldMesh->GetMaterialRef().GetAlbedoTextureRef() != nullptr) {
-                newMesh->GetMaterialRef().SetName(oldMesh->GetMaterialRef().GetName());
-                newMesh->GetMaterialRef().GetAlbedoTextureRef() = Renderer::ITexture2D::Create(oldMesh->GetMaterialRef().GetAlbedoTextureRef()->GetPathRef());
-                newMesh->Refresh();
-            }
+            newEntity->GetComponent<MeshComponent>().mesh = entity->GetComponent<MeshComponent>().mesh;
         }
         
         COSMOS_LOG(Logger::Info, "Scripting duplication is not implemented");
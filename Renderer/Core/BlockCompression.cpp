@@ -0,0 +1,698 @@
+#include "BlockCompression.h"
+
+#include <Common/Util/ThreadPool.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace Cosmos::Renderer
+{
+	// bc7 interpolation weights of 4 bit indices
+	static const int32_t sBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// writes bits into a zeroed block, least significant first
+	struct BitWriter
+	{
+		uint8_t* data = nullptr;
+		uint32_t position = 0;
+
+		void Write(uint32_t value, uint32_t bits)
+		{
+			for (uint32_t i = 0; i < bits; i++, position++) {
+				data[position >> 3] |= (uint8_t)(((value >> i) & 1) << (position & 7));
+			}
+		}
+	};
+
+	// reads bits from a block, least significant first
+	struct BitReader
+	{
+		const uint8_t* data = nullptr;
+		uint32_t position = 0;
+
+		uint32_t Read(uint32_t bits)
+		{
+			uint32_t value = 0;
+
+			for (uint32_t i = 0; i < bits; i++, position++) {
+				value |= (uint32_t)((data[position >> 3] >> (position & 7)) & 1) << i;
+			}
+
+			return value;
+		}
+	};
+
+	// finds the mean and the direction along wich 16 points of n dimensions spread the most
+	static void FindPrincipalAxis(const float* points, uint32_t dims, float* mean, float* axis)
+	{
+		float covariance[4][4] = {};
+
+		for (uint32_t c = 0; c < dims; c++) {
+			mean[c] = 0.0f;
+
+			for (uint32_t i = 0; i < 16; i++) {
+				mean[c] += points[i * dims + c] / 16.0f;
+			}
+		}
+
+		for (uint32_t i = 0; i < 16; i++) {
+			for (uint32_t a = 0; a < dims; a++) {
+				for (uint32_t b = 0; b < dims; b++) {
+					covariance[a][b] += (points[i * dims + a] - mean[a]) * (points[i * dims + b] - mean[b]);
+				}
+			}
+		}
+
+		// power iteration, starting from the dimension that varies the most
+		uint32_t widest = 0;
+
+		for (uint32_t c = 1; c < dims; c++) {
+			if (covariance[c][c] > covariance[widest][widest]) widest = c;
+		}
+
+		for (uint32_t c = 0; c < dims; c++) {
+			axis[c] = covariance[widest][c];
+		}
+
+		for (uint32_t iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float length = 0.0f;
+
+			for (uint32_t a = 0; a < dims; a++) {
+				for (uint32_t b = 0; b < dims; b++) {
+					next[a] += covariance[a][b] * axis[b];
+				}
+
+				length += next[a] * next[a];
+			}
+
+			// every point is the same, any direction works
+			if (length < 1e-12f) {
+				for (uint32_t c = 0; c < dims; c++) axis[c] = 1.0f / std::sqrt((float)dims);
+				return;
+			}
+
+			length = std::sqrt(length);
+
+			for (uint32_t c = 0; c < dims; c++) {
+				axis[c] = next[c] / length;
+			}
+		}
+	}
+
+	// places the endpoints on the extremes of the points projected on their principal axis
+	static void FitEndpoints(const float* points, uint32_t dims, float* e0, float* e1)
+	{
+		float mean[4] = {};
+		float axis[4] = {};
+		FindPrincipalAxis(points, dims, mean, axis);
+
+		float minT = FLT_MAX;
+		float maxT = -FLT_MAX;
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			float t = 0.0f;
+
+			for (uint32_t c = 0; c < dims; c++) {
+				t += (points[i * dims + c] - mean[c]) * axis[c];
+			}
+
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		for (uint32_t c = 0; c < dims; c++) {
+			e0[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+			e1[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+		}
+	}
+
+	// solves the endpoints that best reproduce the points given how much of e0 each one takes, returns false if they can't be solved
+	static bool RefitEndpoints(const float* points, uint32_t dims, const float* weights, float* e0, float* e1)
+	{
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[4] = {}, bx[4] = {};
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			float a = weights[i];
+			float b = 1.0f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+
+			for (uint32_t c = 0; c < dims; c++) {
+				ax[c] += a * points[i * dims + c];
+				bx[c] += b * points[i * dims + c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+
+		if (std::abs(determinant) < 1e-6f) {
+			return false;
+		}
+
+		for (uint32_t c = 0; c < dims; c++) {
+			e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+			e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+		}
+
+		return true;
+	}
+
+	static uint16_t PackRGB565(const float* color)
+	{
+		uint32_t r = (uint32_t)std::clamp((int32_t)std::lround(color[0] * 31.0f / 255.0f), 0, 31);
+		uint32_t g = (uint32_t)std::clamp((int32_t)std::lround(color[1] * 63.0f / 255.0f), 0, 63);
+		uint32_t b = (uint32_t)std::clamp((int32_t)std::lround(color[2] * 31.0f / 255.0f), 0, 31);
+
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static void UnpackRGB565(uint16_t value, int32_t* color)
+	{
+		int32_t r = (value >> 11) & 31;
+		int32_t g = (value >> 5) & 63;
+		int32_t b = value & 31;
+
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	// quantizes two endpoints and writes the bc1 color block that best fits the texels with them, returns it's squared error
+	static uint32_t EncodeBC1Endpoints(const uint8_t* texels, const float* e0, const float* e1, uint8_t* block, uint32_t& indices)
+	{
+		uint16_t c0 = PackRGB565(e0);
+		uint16_t c1 = PackRGB565(e1);
+
+		// the 4 color mode needs the first endpoint to be the greater one
+		if (c0 < c1) {
+			std::swap(c0, c1);
+		}
+
+		int32_t palette[4][3] = {};
+		UnpackRGB565(c0, palette[0]);
+		UnpackRGB565(c1, palette[1]);
+
+		for (uint32_t c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+		}
+
+		// equal endpoints decode on the 3 color mode, where index 3 is black, only index 0 is safe
+		uint32_t candidates = c0 == c1 ? 1 : 4;
+		uint32_t error = 0;
+		indices = 0;
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			uint32_t best = 0;
+			int32_t bestError = INT32_MAX;
+
+			for (uint32_t j = 0; j < candidates; j++)
+			{
+				int32_t distance = 0;
+
+				for (uint32_t c = 0; c < 3; c++) {
+					int32_t d = (int32_t)texels[i * 4 + c] - palette[j][c];
+					distance += d * d;
+				}
+
+				if (distance < bestError) {
+					bestError = distance;
+					best = j;
+				}
+			}
+
+			indices |= best << (i * 2);
+			error += (uint32_t)bestError;
+		}
+
+		block[0] = (uint8_t)(c0 & 0xFF);
+		block[1] = (uint8_t)(c0 >> 8);
+		block[2] = (uint8_t)(c1 & 0xFF);
+		block[3] = (uint8_t)(c1 >> 8);
+
+		for (uint32_t b = 0; b < 4; b++) {
+			block[4 + b] = (uint8_t)(indices >> (b * 8));
+		}
+
+		return error;
+	}
+
+	// quantizes two endpoints and writes the bc7 mode 6 block that best fits the texels with them, returns it's squared error
+	static uint32_t EncodeBC7Endpoints(const uint8_t* texels, const float* e0, const float* e1, uint8_t* block, uint32_t* indices)
+	{
+		// each endpoint is 7 bits per channel plus a p-bit shared by it's channels, the p-bit that fits best is kept
+		const float* endpoints[2] = { e0, e1 };
+		int32_t quantized[2][4] = {};
+		int32_t pbits[2] = {};
+
+		for (uint32_t e = 0; e < 2; e++)
+		{
+			float bestError = FLT_MAX;
+
+			for (int32_t p = 0; p < 2; p++)
+			{
+				int32_t q[4] = {};
+				float error = 0.0f;
+
+				for (uint32_t c = 0; c < 4; c++) {
+					q[c] = std::clamp((int32_t)std::lround((endpoints[e][c] - (float)p) * 0.5f), 0, 127);
+					float d = (float)((q[c] << 1) | p) - endpoints[e][c];
+					error += d * d;
+				}
+
+				if (error < bestError) {
+					bestError = error;
+					pbits[e] = p;
+					memcpy(quantized[e], q, sizeof(q));
+				}
+			}
+		}
+
+		int32_t palette[16][4] = {};
+
+		for (uint32_t i = 0; i < 16; i++) {
+			for (uint32_t c = 0; c < 4; c++) {
+				int32_t a = (quantized[0][c] << 1) | pbits[0];
+				int32_t b = (quantized[1][c] << 1) | pbits[1];
+				palette[i][c] = ((64 - sBC7Weights[i]) * a + sBC7Weights[i] * b + 32) >> 6;
+			}
+		}
+
+		uint32_t error = 0;
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			int32_t bestError = INT32_MAX;
+
+			for (uint32_t j = 0; j < 16; j++)
+			{
+				int32_t distance = 0;
+
+				for (uint32_t c = 0; c < 4; c++) {
+					int32_t d = (int32_t)texels[i * 4 + c] - palette[j][c];
+					distance += d * d;
+				}
+
+				if (distance < bestError) {
+					bestError = distance;
+					indices[i] = j;
+				}
+			}
+
+			error += (uint32_t)bestError;
+		}
+
+		// the first index is stored with 3 bits, swapping the endpoints mirrors the indices so it's high bit is 0
+		if (indices[0] >= 8)
+		{
+			std::swap(quantized[0], quantized[1]);
+			std::swap(pbits[0], pbits[1]);
+
+			for (uint32_t i = 0; i < 16; i++) {
+				indices[i] = 15 - indices[i];
+			}
+		}
+
+		memset(block, 0, 16);
+		BitWriter writer = { block, 0 };
+		writer.Write(1 << 6, 7);
+
+		for (uint32_t c = 0; c < 4; c++) {
+			writer.Write((uint32_t)quantized[0][c], 7);
+			writer.Write((uint32_t)quantized[1][c], 7);
+		}
+
+		writer.Write((uint32_t)pbits[0], 1);
+		writer.Write((uint32_t)pbits[1], 1);
+		writer.Write(indices[0], 3);
+
+		for (uint32_t i = 1; i < 16; i++) {
+			writer.Write(indices[i], 4);
+		}
+
+		// the indices given back are the stored ones, relative to the first endpoint written
+		return error;
+	}
+
+	void EncodeBC1(const uint8_t* texels, uint8_t* block)
+	{
+		float points[16 * 3] = {};
+
+		for (uint32_t i = 0; i < 16; i++) {
+			for (uint32_t c = 0; c < 3; c++) {
+				points[i * 3 + c] = (float)texels[i * 4 + c];
+			}
+		}
+
+		float e0[3] = {}, e1[3] = {};
+		FitEndpoints(points, 3, e0, e1);
+
+		// insetting by a sixteenth of the range keeps the extremes from pulling the whole palette out
+		for (uint32_t c = 0; c < 3; c++) {
+			float inset = (e0[c] - e1[c]) / 16.0f;
+			e0[c] -= inset;
+			e1[c] += inset;
+		}
+
+		uint32_t indices = 0;
+		uint32_t error = EncodeBC1Endpoints(texels, e0, e1, block, indices);
+
+		// the endpoints are solved again for the chosen indices, the refit is kept if it's closer
+		const float amount[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		float weights[16] = {};
+
+		for (uint32_t i = 0; i < 16; i++) {
+			weights[i] = amount[(indices >> (i * 2)) & 3];
+		}
+
+		// the palette was built from the stored endpoint order, wich may be swapped from e0/e1
+		uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+		uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+
+		if (c0 == c1 || !RefitEndpoints(points, 3, weights, e0, e1)) {
+			return;
+		}
+
+		uint8_t refit[8] = {};
+		uint32_t refitIndices = 0;
+
+		if (EncodeBC1Endpoints(texels, e0, e1, refit, refitIndices) < error) {
+			memcpy(block, refit, sizeof(refit));
+		}
+	}
+
+	void EncodeBC3(const uint8_t* texels, uint8_t* block)
+	{
+		EncodeBC4(texels, 3, block);
+		EncodeBC1(texels, block + 8);
+	}
+
+	void EncodeBC4(const uint8_t* texels, uint32_t channel, uint8_t* block)
+	{
+		int32_t lowest = 255;
+		int32_t highest = 0;
+
+		for (uint32_t i = 0; i < 16; i++) {
+			lowest = std::min(lowest, (int32_t)texels[i * 4 + channel]);
+			highest = std::max(highest, (int32_t)texels[i * 4 + channel]);
+		}
+
+		block[0] = (uint8_t)highest;
+		block[1] = (uint8_t)lowest;
+		uint64_t bits = 0;
+
+		// on equal endpoints every index is 0, wich decodes to the first one on both modes
+		if (highest > lowest)
+		{
+			int32_t palette[8] = { highest, lowest };
+
+			for (int32_t i = 2; i < 8; i++) {
+				palette[i] = ((8 - i) * highest + (i - 1) * lowest + 3) / 7;
+			}
+
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				uint64_t best = 0;
+				int32_t bestError = INT32_MAX;
+
+				for (uint32_t j = 0; j < 8; j++) {
+					int32_t distance = std::abs((int32_t)texels[i * 4 + channel] - palette[j]);
+
+					if (distance < bestError) {
+						bestError = distance;
+						best = j;
+					}
+				}
+
+				bits |= best << (i * 3);
+			}
+		}
+
+		for (uint32_t b = 0; b < 6; b++) {
+			block[2 + b] = (uint8_t)(bits >> (b * 8));
+		}
+	}
+
+	void EncodeBC5(const uint8_t* texels, uint8_t* block)
+	{
+		EncodeBC4(texels, 0, block);
+		EncodeBC4(texels, 1, block + 8);
+	}
+
+	void EncodeBC7(const uint8_t* texels, uint8_t* block)
+	{
+		float points[16 * 4] = {};
+
+		for (uint32_t i = 0; i < 64; i++) {
+			points[i] = (float)texels[i];
+		}
+
+		float e0[4] = {}, e1[4] = {};
+		FitEndpoints(points, 4, e0, e1);
+
+		uint32_t indices[16] = {};
+		uint32_t error = EncodeBC7Endpoints(texels, e0, e1, block, indices);
+
+		if (error == 0) {
+			return;
+		}
+
+		// the endpoints are solved again for the chosen indices, the stored order is read back as the indices may have been mirrored
+		BitReader reader = { block, 7 };
+		float stored[2][4] = {};
+
+		for (uint32_t c = 0; c < 4; c++) {
+			stored[0][c] = (float)reader.Read(7);
+			stored[1][c] = (float)reader.Read(7);
+		}
+
+		uint32_t p0 = reader.Read(1);
+		uint32_t p1 = reader.Read(1);
+		float weights[16] = {};
+
+		for (uint32_t i = 0; i < 16; i++) {
+			weights[i] = 1.0f - (float)sBC7Weights[indices[i]] / 64.0f;
+		}
+
+		for (uint32_t c = 0; c < 4; c++) {
+			e0[c] = stored[0][c] * 2.0f + (float)p0;
+			e1[c] = stored[1][c] * 2.0f + (float)p1;
+		}
+
+		if (!RefitEndpoints(points, 4, weights, e0, e1)) {
+			return;
+		}
+
+		uint8_t refit[16] = {};
+		uint32_t refitIndices[16] = {};
+
+		if (EncodeBC7Endpoints(texels, e0, e1, refit, refitIndices) < error) {
+			memcpy(block, refit, sizeof(refit));
+		}
+	}
+
+	void DecodeBC1(const uint8_t* block, uint8_t* texels)
+	{
+		uint16_t c0 = (uint16_t)(block[0] | (block[1] << 8));
+		uint16_t c1 = (uint16_t)(block[2] | (block[3] << 8));
+		uint32_t indices = (uint32_t)block[4] | ((uint32_t)block[5] << 8) | ((uint32_t)block[6] << 16) | ((uint32_t)block[7] << 24);
+
+		int32_t palette[4][4] = {};
+		UnpackRGB565(c0, palette[0]);
+		UnpackRGB565(c1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = 255;
+
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			if (c0 > c1) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+			}
+
+			else {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+
+		palette[3][3] = c0 > c1 ? 255 : 0;
+
+		for (uint32_t i = 0; i < 16; i++) {
+			for (uint32_t c = 0; c < 4; c++) {
+				texels[i * 4 + c] = (uint8_t)palette[(indices >> (i * 2)) & 3][c];
+			}
+		}
+	}
+
+	void DecodeBC3(const uint8_t* block, uint8_t* texels)
+	{
+		DecodeBC1(block + 8, texels);
+		DecodeBC4(block, 3, texels);
+	}
+
+	void DecodeBC4(const uint8_t* block, uint32_t channel, uint8_t* texels)
+	{
+		int32_t r0 = block[0];
+		int32_t r1 = block[1];
+		int32_t palette[8] = { r0, r1 };
+
+		if (r0 > r1)
+		{
+			for (int32_t i = 2; i < 8; i++) {
+				palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+			}
+		}
+
+		else
+		{
+			for (int32_t i = 2; i < 6; i++) {
+				palette[i] = ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+			}
+
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t bits = 0;
+
+		for (uint32_t b = 0; b < 6; b++) {
+			bits |= (uint64_t)block[2 + b] << (b * 8);
+		}
+
+		for (uint32_t i = 0; i < 16; i++) {
+			texels[i * 4 + channel] = (uint8_t)palette[(bits >> (i * 3)) & 7];
+		}
+	}
+
+	void DecodeBC5(const uint8_t* block, uint8_t* texels)
+	{
+		DecodeBC4(block, 0, texels);
+		DecodeBC4(block + 8, 1, texels);
+
+		for (uint32_t i = 0; i < 16; i++) {
+			texels[i * 4 + 2] = 0;
+			texels[i * 4 + 3] = 255;
+		}
+	}
+
+	bool DecodeBC7(const uint8_t* block, uint8_t* texels)
+	{
+		BitReader reader = { block, 0 };
+
+		if (reader.Read(7) != (1 << 6)) {
+			return false;
+		}
+
+		int32_t endpoints[2][4] = {};
+
+		for (uint32_t c = 0; c < 4; c++) {
+			endpoints[0][c] = (int32_t)reader.Read(7) << 1;
+			endpoints[1][c] = (int32_t)reader.Read(7) << 1;
+		}
+
+		uint32_t p0 = reader.Read(1);
+		uint32_t p1 = reader.Read(1);
+
+		for (uint32_t c = 0; c < 4; c++) {
+			endpoints[0][c] |= (int32_t)p0;
+			endpoints[1][c] |= (int32_t)p1;
+		}
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			int32_t weight = sBC7Weights[reader.Read(i == 0 ? 3 : 4)];
+
+			for (uint32_t c = 0; c < 4; c++) {
+				texels[i * 4 + c] = (uint8_t)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+			}
+		}
+
+		return true;
+	}
+
+	std::vector<uint8_t> CompressImage(const uint8_t* pixels, uint32_t width, uint32_t height, KTXFile::Format format)
+	{
+		uint32_t blocksX = (width + 3) / 4;
+		uint32_t blocksY = (height + 3) / 4;
+		uint32_t blockSize = KTXFile::GetBlockSize(format);
+		std::vector<uint8_t> data((size_t)blocksX * blocksY * blockSize);
+
+		ThreadPool::GetRef().ParallelFor(blocksY, [&](size_t by)
+			{
+				uint8_t texels[64] = {};
+
+				for (uint32_t bx = 0; bx < blocksX; bx++)
+				{
+					for (uint32_t y = 0; y < 4; y++) {
+						for (uint32_t x = 0; x < 4; x++) {
+							uint32_t sx = std::min(bx * 4 + x, width - 1);
+							uint32_t sy = std::min((uint32_t)by * 4 + y, height - 1);
+							memcpy(&texels[(y * 4 + x) * 4], &pixels[((size_t)sy * width + sx) * 4], 4);
+						}
+					}
+
+					uint8_t* block = &data[((size_t)by * blocksX + bx) * blockSize];
+
+					switch (format)
+					{
+						case KTXFile::Format::BC1_RGB_UNORM:
+						case KTXFile::Format::BC1_RGB_SRGB: { EncodeBC1(texels, block); break; }
+						case KTXFile::Format::BC3_UNORM:
+						case KTXFile::Format::BC3_SRGB: { EncodeBC3(texels, block); break; }
+						case KTXFile::Format::BC5_UNORM: { EncodeBC5(texels, block); break; }
+						case KTXFile::Format::BC7_UNORM:
+						case KTXFile::Format::BC7_SRGB: { EncodeBC7(texels, block); break; }
+						default: { break; }
+					}
+				}
+			});
+
+		return data;
+	}
+
+	bool DecompressImage(const uint8_t* data, uint32_t width, uint32_t height, KTXFile::Format format, std::vector<uint8_t>& pixels)
+	{
+		uint32_t blocksX = (width + 3) / 4;
+		uint32_t blocksY = (height + 3) / 4;
+		uint32_t blockSize = KTXFile::GetBlockSize(format);
+		pixels.resize((size_t)width * height * 4);
+
+		for (uint32_t by = 0; by < blocksY; by++)
+		{
+			for (uint32_t bx = 0; bx < blocksX; bx++)
+			{
+				const uint8_t* block = &data[((size_t)by * blocksX + bx) * blockSize];
+				uint8_t texels[64] = {};
+
+				switch (format)
+				{
+					case KTXFile::Format::BC1_RGB_UNORM:
+					case KTXFile::Format::BC1_RGB_SRGB: { DecodeBC1(block, texels); break; }
+					case KTXFile::Format::BC3_UNORM:
+					case KTXFile::Format::BC3_SRGB: { DecodeBC3(block, texels); break; }
+					case KTXFile::Format::BC5_UNORM: { DecodeBC5(block, texels); break; }
+					case KTXFile::Format::BC7_UNORM:
+					case KTXFile::Format::BC7_SRGB: { if (!DecodeBC7(block, texels)) return false; break; }
+					default: { return false; }
+				}
+
+				for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++) {
+					for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++) {
+						memcpy(&pixels[(((size_t)by * 4 + y) * width + bx * 4 + x) * 4], &texels[(y * 4 + x) * 4], 4);
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "KTXFile.h"
+#include <cstdint>
+#include <vector>
+
+// bc1/bc3/bc4/bc5/bc7 block encoders and decoders, they run on the cpu and don't depend on the renderer
+// texels are 4x4 blocks of rgba bytes, row by row, encoded values are taken as they're stored (srgb encoded or not)
+namespace Cosmos::Renderer
+{
+	// encodes opaque color into a bc1 block (8 bytes), the principal axis of the colors is fitted and refined by least squares
+	void EncodeBC1(const uint8_t* texels, uint8_t* block);
+
+	// encodes color and alpha into a bc3 block (16 bytes), a bc4 alpha block followed by a bc1 color block
+	void EncodeBC3(const uint8_t* texels, uint8_t* block);
+
+	// encodes a single channel into a bc4 block (8 bytes)
+	void EncodeBC4(const uint8_t* texels, uint32_t channel, uint8_t* block);
+
+	// encodes red and green into a bc5 block (16 bytes), two bc4 blocks
+	void EncodeBC5(const uint8_t* texels, uint8_t* block);
+
+	// encodes color and alpha into a bc7 block (16 bytes), always on mode 6: one subset with 7 bit endpoints, p-bits and 4 bit indices
+	void EncodeBC7(const uint8_t* texels, uint8_t* block);
+
+	// decodes a bc1 block, alpha is written as 255 or 0 on it's punch-through mode
+	void DecodeBC1(const uint8_t* block, uint8_t* texels);
+
+	// decodes a bc3 block
+	void DecodeBC3(const uint8_t* block, uint8_t* texels);
+
+	// decodes a bc4 block into a single channel, the others are left untouched
+	void DecodeBC4(const uint8_t* block, uint32_t channel, uint8_t* texels);
+
+	// decodes a bc5 block into red and green, blue is written as 0 and alpha as 255
+	void DecodeBC5(const uint8_t* block, uint8_t* texels);
+
+	// decodes a bc7 block written on mode 6, returns false for blocks on any other mode
+	bool DecodeBC7(const uint8_t* block, uint8_t* texels);
+
+	// compresses a whole rgba image into a block-compressed format, edge blocks repeat the last row/column, blocks are encoded on the thread pool
+	std::vector<uint8_t> CompressImage(const uint8_t* pixels, uint32_t width, uint32_t height, KTXFile::Format format);
+
+	// decompresses a whole block-compressed image into rgba pixels, returns false if a block couldn't be decoded
+	bool DecompressImage(const uint8_t* data, uint32_t width, uint32_t height, KTXFile::Format format, std::vector<uint8_t>& pixels);
+}
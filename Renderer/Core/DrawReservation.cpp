@@ -0,0 +1,31 @@
+#include "DrawReservation.h"
+
+namespace Cosmos::Renderer
+{
+	DrawReservation::DrawReservation(uint32_t maxDraws, uint32_t maxCommands)
+		: mMaxDraws(maxDraws), mMaxCommands(maxCommands)
+	{
+	}
+
+	bool DrawReservation::Reserve(uint32_t commandCount, uint32_t& drawIndex, uint32_t& commandIndex)
+	{
+		uint64_t reserved = mReserved.load(std::memory_order_relaxed);
+
+		do {
+			drawIndex = (uint32_t)(reserved >> 32);
+			commandIndex = (uint32_t)(reserved & 0xFFFFFFFF);
+
+			// compared as 64-bit, a huge count must not wrap around the limit
+			if (drawIndex >= mMaxDraws || (uint64_t)commandIndex + commandCount > mMaxCommands) {
+				return false;
+			}
+		} while (!mReserved.compare_exchange_weak(reserved, reserved + (1ull << 32) + commandCount, std::memory_order_relaxed));
+
+		return true;
+	}
+
+	void DrawReservation::Reset()
+	{
+		mReserved = 0;
+	}
+}
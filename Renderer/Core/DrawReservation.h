@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Cosmos::Renderer
+{
+	// hands out slots of indirect draws and the commands each one writes, recording threads reserve from it at the same time
+	// both counts live on a single 64-bit value (draws on the upper half and commands on the lower), so they're taken together and threads never leave holes
+	class DrawReservation
+	{
+	public:
+
+		// constructor
+		DrawReservation(uint32_t maxDraws, uint32_t maxCommands);
+
+		// destructor
+		~DrawReservation() = default;
+
+		// returns how many draws were reserved, only meaningful once the reserving threads are done
+		inline uint32_t GetDrawCount() const { return (uint32_t)(mReserved.load() >> 32); }
+
+		// returns how many commands were reserved, only meaningful once the reserving threads are done
+		inline uint32_t GetCommandCount() const { return (uint32_t)(mReserved.load() & 0xFFFFFFFF); }
+
+	public:
+
+		// takes a draw slot and commandCount commands after it, returns false and takes nothing when either doesn't fit
+		bool Reserve(uint32_t commandCount, uint32_t& drawIndex, uint32_t& commandIndex);
+
+		// gives everything back, no thread may be reserving
+		void Reset();
+
+	private:
+
+		uint32_t mMaxDraws = 0;
+		uint32_t mMaxCommands = 0;
+		std::atomic<uint64_t> mReserved = 0;
+	};
+}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "RenderQueue.h"
+#include <Common/Core/Defines.h>
 #include <Common/Math/Math.h>
 #include <Common/Util/Memory.h>
+#include <functional>
 
 // forward declarations
 namespace Cosmos::Engine { class Application; }
@@ -37,6 +40,9 @@ namespace Cosmos::Renderer
 		// returns a reference to the viewport boundaries, wich holds size information about the main viewport
 		inline ViewportBoundaries& GetViewportBoundariesRef() { return mViewportBoundaries; }
 
+		// returns a reference to the render queue, where draws are submitted to be sorted before being recorded
+		inline RenderQueue& GetRenderQueueRef() { return mRenderQueue; }
+
 	public:
 
 		// delete copy constructor
@@ -66,6 +72,9 @@ namespace Cosmos::Renderer
 		// called when an event happens
 		virtual void OnEvent(Shared<Platform::EventBase> event) = 0;
 
+		// records [0, count) split into contiguous ranges across the workers, each range into it's own command buffer, executed in range order
+		virtual void RecordParallel(size_t count, const std::function<void(size_t first, size_t last, void* commandBuffer)>& func) = 0;
+
 	protected:
 
 		// constructor
@@ -78,6 +87,7 @@ namespace Cosmos::Renderer
 
 		Engine::Application* mApplication = nullptr;
 		ViewportBoundaries mViewportBoundaries;
+		RenderQueue mRenderQueue{ this };
 		unsigned int mCurrentFrame = 0;
 	};
 }
\ No newline at end of file
@@ -1,13 +1,98 @@
 #include "IMesh.h"
 
+#include "ITexture.h"
 #include "Vulkan/Mesh.h"
 
+#include <Common/File/Filesystem.h>
+#include <unordered_map>
+
 namespace Cosmos::Renderer
 {
+	// meshes handed out by Acquire, an entry expires once no entity holds it's mesh anymore
+	static std::unordered_map<std::string, std::weak_ptr<IMesh>> sMeshCache = {};
+
 	Shared<IMesh> IMesh::Create()
 	{
 #if defined RENDERER_VULKAN
 		return CreateShared<Vulkan::Mesh>();
 #endif
 	}
+
+	Shared<IMesh> IMesh::Acquire(std::string path, float scale, std::string albedo)
+	{
+		// scenes save the default albedo by it's path, it's the same material as the file default
+		if (albedo == GetAssetSubDir("Texture/Default/default_1024_grey.png")) {
+			albedo.clear();
+		}
+
+		char scaleText[32];
+		snprintf(scaleText, sizeof(scaleText), "%a", scale);
+		std::string key = path + "|" + scaleText + "|" + albedo;
+
+		if (Shared<IMesh> mesh = sMeshCache[key].lock()) {
+			return mesh;
+		}
+
+		// a new key is rare (a file or material not seen before), expired entries are dropped then
+		for (auto it = sMeshCache.begin(); it != sMeshCache.end();) {
+			it = it->second.expired() && it->first != key ? sMeshCache.erase(it) : std::next(it);
+		}
+
+		Shared<IMesh> mesh = Create();
+		mesh->LoadFromFile(path, scale);
+
+		if (!albedo.empty()) {
+			mesh->GetMaterialRef().GetAlbedoTextureRef() = ITexture2D::Create(albedo, false, true);
+			mesh->Refresh();
+		}
+
+		sMeshCache[key] = mesh;
+		return mesh;
+	}
+
+	IMesh::Residency IMesh::ResidencyFromString(const std::string& name)
+	{
+		if (name == "discard") return Residency::Discard;
+		if (name == "full") return Residency::Full;
+		return Residency::Positions;
+	}
+
+	const char* IMesh::ResidencyToString(Residency residency)
+	{
+		switch (residency)
+		{
+			case Residency::Discard: return "discard";
+			case Residency::Positions: return "positions";
+			case Residency::Full: return "full";
+			default: return "unknown";
+		}
+	}
+
+	IMesh::MemoryReport IMesh::GetMemoryReport()
+	{
+		MemoryReport report = {};
+
+		for (uint32_t i = 0; i < Residency::Count; i++) {
+			report.meshes[i] = sResidentMeshes[i].load();
+			report.bytes[i] = sResidentBytes[i].load();
+		}
+
+		return report;
+	}
+
+	void IMesh::TrackResidentBytes(size_t bytes)
+	{
+		if (mTrackedResidency != Residency::Count) {
+			sResidentMeshes[mTrackedResidency]--;
+			sResidentBytes[mTrackedResidency] -= mResidentBytes;
+		}
+
+		mResidentBytes = bytes;
+		mTrackedResidency = mLoaded ? mResidency : Residency::Count;
+
+		if (mTrackedResidency != Residency::Count) {
+			sResidentMeshes[mTrackedResidency]++;
+			sResidentBytes[mTrackedResidency] += mResidentBytes;
+		}
+	}
 }
\ No newline at end of file
@@ -2,8 +2,11 @@
 
 #include "IContext.h"
 #include "Material.h"
+#include <Common/Math/BoundingBox.h>
 #include <Common/Math/Math.h>
+#include <Common/Math/TriangleBVH.h>
 #include <Common/Util/Memory.h>
+#include <atomic>
 #include <string>
 
 namespace Cosmos::Renderer
@@ -12,9 +15,55 @@ namespace Cosmos::Renderer
 	{
 	public:
 
-		// creates a mesh
+		// what is kept on cpu memory after the mesh is uploaded to the gpu
+		enum Residency : uint32_t
+		{
+			Discard = 0,	// nothing, the mesh only exists on the gpu
+			Positions,		// positions, indices and the triangle bvh, used by picking and collision
+			Full,			// all vertex attributes and indices, used when editing the mesh
+
+			Count
+		};
+
+		// features a mesh is drawn with, each combination the renderer is asked for becomes a pipeline variant
+		enum Feature : uint32_t
+		{
+			VertexColors = 1 << 0,	// albedo is multiplied by the vertex colors
+			AlphaTest = 1 << 1,		// fragments bellow the material alpha cutoff are discarded
+			Highlight = 1 << 2,		// instances are tinted as selected
+			Picking = 1 << 3		// writes the instance id instead of shading, other features are ignored
+		};
+
+		struct MemoryReport
+		{
+			size_t meshes[Residency::Count] = {};
+			size_t bytes[Residency::Count] = {};
+		};
+
+	public:
+
+		// creates a mesh, only the caller holds it
 		static Shared<IMesh> Create();
 
+		// returns the mesh of a file loaded with a scale and drawn with an albedo (empty keeps the file default), loading it on the first request
+		// everyone asking for the same gets the same mesh, so their instances are batched together and share the gpu buffers, it must not be reloaded or have it's material changed in place
+		static Shared<IMesh> Acquire(std::string path, float scale = 1.0f, std::string albedo = {});
+
+		// returns the residency new meshes are created with
+		static Residency GetDefaultResidency() { return sDefaultResidency; }
+
+		// sets the residency new meshes are created with
+		static void SetDefaultResidency(Residency residency) { sDefaultResidency = residency; }
+
+		// returns the residency matching a name (discard, positions, full), positions if unknown
+		static Residency ResidencyFromString(const std::string& name);
+
+		// returns the name of a residency
+		static const char* ResidencyToString(Residency residency);
+
+		// returns how many meshes and cpu bytes are held, per residency, across the engine
+		static MemoryReport GetMemoryReport();
+
 		// constructor
 		IMesh() = default;
 
@@ -24,9 +73,15 @@ namespace Cosmos::Renderer
 		// returns a reference to the file path
 		inline std::string& GetPathRef() { return mPath; }
 
+		// returns the scale the mesh was loaded with, it's baked into the vertices
+		inline float GetScale() const { return mScale; }
+
 		// returns a reference to the mesh material
 		inline Material& GetMaterialRef() { return mMaterial; }
 
+		// returns a reference to the mesh-space bounds of all vertices, only valid once loaded
+		inline BoundingBox& GetBoundingBoxRef() { return mBounds; }
+
 		// returns if mesh was parsed and loaded into the programs memory
 		inline bool IsLoaded() { return mLoaded; }
 
@@ -36,13 +91,25 @@ namespace Cosmos::Renderer
 		// sets the mesh as selected/unselected
 		inline void SetSelected(bool value) { mSelected = value; }
 
+		// returns the features the mesh is drawn with, meshes sharing them share a pipeline
+		inline uint32_t GetFeatures() const { return mFeatures | (mSelected ? Feature::Highlight : 0); }
+
+		// returns what the mesh keeps on cpu memory
+		inline Residency GetResidency() const { return mResidency; }
+
+		// returns how many bytes of mesh data are held on cpu memory
+		inline size_t GetResidentBytes() const { return mResidentBytes; }
+
 	public:
 
 		// updates the mesh frame-logic
 		virtual void OnUpdate(float timestep) = 0;
 
-		// renders the mesh
-		virtual void OnRender(const glm::mat4& transform, uint64_t id, IContext::Stage stage) = 0;
+		// prepares a batch of instances to be drawn on a stage, called on the main thread in draw order, returns false if it won't be drawn
+		virtual bool OnPrepare(RenderQueue::Batch& batch, IContext::Stage stage) = 0;
+
+		// records a prepared batch into the command buffer of the bind state, may be called from any recording thread
+		virtual void OnRender(const RenderQueue::Batch& batch, RenderQueue::BindState& state, IContext::Stage stage) = 0;
 
 	public:
 
@@ -55,18 +122,39 @@ namespace Cosmos::Renderer
 		// refreshes mesh configuration, applying any changes made
 		virtual void Refresh() = 0;
 
+		// changes what the mesh keeps on cpu memory, going up a level requires the mesh to be reloaded
+		virtual void SetResidency(Residency residency) = 0;
+
+		// returns the mesh-space triangle bvh, built from the cpu positions after loading, nullptr when they're not kept or it's not ready yet
+		virtual const TriangleBVH* GetTriangleBVH() = 0;
+
+	protected:
+
+		// updates the engine-wide memory report with the bytes this mesh currently holds
+		void TrackResidentBytes(size_t bytes);
+
+	private:
+
+		static inline Residency sDefaultResidency = Residency::Positions;
+		static inline std::atomic<size_t> sResidentMeshes[Residency::Count] = {};
+		static inline std::atomic<size_t> sResidentBytes[Residency::Count] = {};
+
 	protected:
 
 		// general info
 		std::string mName = {};
 		std::string mPath = {};
+		float mScale = 1.0f;
 		Material mMaterial;
 		bool mLoaded = false;
 		bool mSelected = false;
-
-		// boundaries data (untested)
-		//glm::mat4 mAABB = glm::mat4(1.0f);
-		//glm::vec3 mMin = glm::vec3(FLT_MAX);
-		//glm::vec3 mMax = glm::vec3(-FLT_MAX);
+		uint32_t mFeatures = 0;
+		Residency mResidency = sDefaultResidency;
+		Residency mTrackedResidency = Residency::Count;
+		size_t mResidentBytes = 0;
+
+		// boundaries data
+		BoundingBox mBounds = {};
+		TriangleBVH mTriangleBVH;
 	};
 }
\ No newline at end of file
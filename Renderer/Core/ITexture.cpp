@@ -4,10 +4,10 @@
 
 namespace Cosmos::Renderer
 {
-	Shared<ITexture2D> ITexture2D::Create(std::string path, bool gui)
+	Shared<ITexture2D> ITexture2D::Create(std::string path, bool gui, bool async)
 	{
 #if defined RENDERER_VULKAN
-		return CreateShared<Vulkan::Texture2D>(path, gui);
+		return CreateShared<Vulkan::Texture2D>(path, gui, async);
 #endif
 	}
 
@@ -20,8 +20,8 @@ namespace Cosmos::Renderer
 
 	public:
 
-		// returns a smart-ptr to a new 2d texture
-		static Shared<ITexture2D> Create(std::string path, bool gui = false);
+		// returns a smart-ptr to a new 2d texture, an async one is decoded on the worker threads and shows a placeholder meanwhile
+		static Shared<ITexture2D> Create(std::string path, bool gui = false, bool async = false);
 
 		// returns a smart-ptr to a new 2d texture, loads from memory
 		static Shared<ITexture2D> Create(const BufferInfo& info, bool gui = false);
@@ -0,0 +1,284 @@
+#include "KTXFile.h"
+
+#include <Common/Debug/Logger.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Cosmos::Renderer
+{
+	static const uint8_t sIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	struct Header
+	{
+		uint8_t identifier[12];
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+
+	static_assert(sizeof(Header) == 80, "KTX2 header must be 80 bytes");
+
+	// creates the data format descriptor, a basic block with one sample per channel
+	static std::vector<uint32_t> CreateDescriptor(KTXFile::Format format)
+	{
+		struct Sample
+		{
+			uint32_t channel;
+			uint32_t bitOffset;
+			uint32_t bitLength;
+		};
+
+		uint32_t model = 1; // rgbsda
+		std::vector<Sample> samples = {};
+		bool srgb = false;
+
+		// channel ids are the ones of each color model, 15 is always alpha
+		switch (format)
+		{
+			case KTXFile::Format::R8G8B8A8_SRGB: { srgb = true; [[fallthrough]]; }
+			case KTXFile::Format::R8G8B8A8_UNORM: { samples = { { 0, 0, 8 }, { 1, 8, 8 }, { 2, 16, 8 }, { 15, 24, 8 } }; break; }
+			case KTXFile::Format::BC1_RGB_SRGB: { srgb = true; [[fallthrough]]; }
+			case KTXFile::Format::BC1_RGB_UNORM: { model = 128; samples = { { 0, 0, 64 } }; break; }
+			case KTXFile::Format::BC3_SRGB: { srgb = true; [[fallthrough]]; }
+			case KTXFile::Format::BC3_UNORM: { model = 130; samples = { { 15, 0, 64 }, { 0, 64, 64 } }; break; }
+			case KTXFile::Format::BC5_UNORM: { model = 132; samples = { { 0, 0, 64 }, { 1, 64, 64 } }; break; }
+			case KTXFile::Format::BC7_SRGB: { srgb = true; [[fallthrough]]; }
+			case KTXFile::Format::BC7_UNORM: { model = 134; samples = { { 0, 0, 128 } }; break; }
+		}
+
+		bool compressed = KTXFile::IsBlockCompressed(format);
+		uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+
+		std::vector<uint32_t> dfd;
+		dfd.push_back(4 + blockSize);									// total size
+		dfd.push_back(0);												// khronos vendor, basic descriptor type
+		dfd.push_back(2 | (blockSize << 16));							// version 1.3
+		dfd.push_back(model | (1 << 8) | ((srgb ? 2 : 1) << 16));		// color model, bt709 primaries, srgb or linear transfer, straight alpha
+		dfd.push_back(compressed ? (3 | (3 << 8)) : 0);					// 4x4x1x1 or 1x1x1x1 texel block
+		dfd.push_back(KTXFile::GetBlockSize(format));					// bytes on plane 0
+		dfd.push_back(0);
+
+		for (const Sample& sample : samples)
+		{
+			// alpha is never encoded with the srgb curve
+			uint32_t linear = (srgb && sample.channel == 15) ? (1u << 28) : 0;
+
+			dfd.push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channel << 24) | linear);
+			dfd.push_back(0);											// sample position
+			dfd.push_back(0);											// lower
+			dfd.push_back(compressed ? UINT32_MAX : 255);				// upper
+		}
+
+		return dfd;
+	}
+
+	bool KTXFile::Open(std::string path)
+	{
+		mLevels.clear();
+
+		if (!mFile.Open(path)) {
+			COSMOS_LOG(Logger::Error, "Failed to open %s", path.c_str());
+			return false;
+		}
+
+		const uint8_t* data = mFile.GetData();
+		size_t size = mFile.GetSize();
+
+		Header header = {};
+		if (size < sizeof(Header) || memcmp(data, sIdentifier, sizeof(sIdentifier)) != 0) {
+			COSMOS_LOG(Logger::Error, "%s is not a KTX2 file", path.c_str());
+			mFile.Close();
+			return false;
+		}
+
+		memcpy(&header, data, sizeof(Header));
+
+		if (!IsSupported(header.vkFormat)) {
+			COSMOS_LOG(Logger::Error, "%s has an unsupported format (%u)", path.c_str(), header.vkFormat);
+			mFile.Close();
+			return false;
+		}
+
+		if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.supercompressionScheme != 0 || header.levelCount == 0) {
+			COSMOS_LOG(Logger::Error, "%s is not a 2d texture with precomputed mips and no supercompression", path.c_str());
+			mFile.Close();
+			return false;
+		}
+
+		// a chain ends on the 1x1 level, more levels would be sized by shifting past the width
+		uint32_t maxLevels = 1;
+
+		while ((std::max(header.pixelWidth, header.pixelHeight) >> maxLevels) > 0) {
+			maxLevels++;
+		}
+
+		if (header.levelCount > maxLevels) {
+			COSMOS_LOG(Logger::Error, "%s has more mip levels (%u) than it's size allows", path.c_str(), header.levelCount);
+			mFile.Close();
+			return false;
+		}
+
+		if (sizeof(Header) + (size_t)header.levelCount * 24 > size) {
+			COSMOS_LOG(Logger::Error, "%s is truncated", path.c_str());
+			mFile.Close();
+			return false;
+		}
+
+		mFormat = (Format)header.vkFormat;
+		mWidth = header.pixelWidth;
+		mHeight = header.pixelHeight;
+
+		for (uint32_t i = 0; i < header.levelCount; i++)
+		{
+			uint64_t entry[3] = {}; // offset, length and uncompressed length
+			memcpy(entry, data + sizeof(Header) + (size_t)i * 24, sizeof(entry));
+
+			uint64_t expected = GetLevelSize(mFormat, std::max(mWidth >> i, 1u), std::max(mHeight >> i, 1u));
+
+			// compared apart so values near the 64 bit limit can't wrap around
+			if (entry[0] > size || entry[1] > size - entry[0] || entry[1] < expected) {
+				COSMOS_LOG(Logger::Error, "%s has an invalid mip level %u", path.c_str(), i);
+				mLevels.clear();
+				mFile.Close();
+				return false;
+			}
+
+			mLevels.push_back({ entry[0], entry[1] });
+		}
+
+		return true;
+	}
+
+	bool KTXFile::Write(std::string path, Format format, uint32_t width, uint32_t height, const uint8_t* data, const std::vector<Level>& levels)
+	{
+		std::vector<uint32_t> dfd = CreateDescriptor(format);
+		uint64_t alignment = std::max<uint64_t>(GetBlockSize(format), 4); // lcm of the block size and 4, both are powers of two
+
+		Header header = {};
+		memcpy(header.identifier, sIdentifier, sizeof(sIdentifier));
+		header.vkFormat = format;
+		header.typeSize = 1;
+		header.pixelWidth = width;
+		header.pixelHeight = height;
+		header.pixelDepth = 0;
+		header.layerCount = 0;
+		header.faceCount = 1;
+		header.levelCount = (uint32_t)levels.size();
+		header.supercompressionScheme = 0;
+		header.dfdByteOffset = (uint32_t)(sizeof(Header) + levels.size() * 24);
+		header.dfdByteLength = (uint32_t)(dfd.size() * sizeof(uint32_t));
+
+		// the smallest level is stored first, so a reader streaming from the end only touches what it needs
+		std::vector<uint64_t> index(levels.size() * 3);
+		uint64_t position = header.dfdByteOffset + header.dfdByteLength;
+
+		for (size_t i = levels.size(); i-- > 0; )
+		{
+			position = (position + alignment - 1) / alignment * alignment;
+			index[i * 3 + 0] = position;
+			index[i * 3 + 1] = levels[i].size;
+			index[i * 3 + 2] = levels[i].size;
+			position += levels[i].size;
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open()) {
+			COSMOS_LOG(Logger::Error, "Failed to write %s", path.c_str());
+			return false;
+		}
+
+		file.write((const char*)&header, sizeof(Header));
+		file.write((const char*)index.data(), (std::streamsize)(index.size() * sizeof(uint64_t)));
+		file.write((const char*)dfd.data(), (std::streamsize)(dfd.size() * sizeof(uint32_t)));
+
+		const char padding[16] = {};
+		uint64_t written = header.dfdByteOffset + header.dfdByteLength;
+
+		for (size_t i = levels.size(); i-- > 0; )
+		{
+			file.write(padding, (std::streamsize)(index[i * 3] - written));
+			file.write((const char*)data + levels[i].offset, (std::streamsize)levels[i].size);
+			written = index[i * 3] + levels[i].size;
+		}
+
+		return file.good();
+	}
+
+	bool KTXFile::IsSupported(uint32_t format)
+	{
+		switch (format)
+		{
+			case Format::R8G8B8A8_UNORM:
+			case Format::R8G8B8A8_SRGB:
+			case Format::BC1_RGB_UNORM:
+			case Format::BC1_RGB_SRGB:
+			case Format::BC3_UNORM:
+			case Format::BC3_SRGB:
+			case Format::BC5_UNORM:
+			case Format::BC7_UNORM:
+			case Format::BC7_SRGB: return true;
+			default: return false;
+		}
+	}
+
+	bool KTXFile::IsBlockCompressed(Format format)
+	{
+		return format != Format::R8G8B8A8_UNORM && format != Format::R8G8B8A8_SRGB;
+	}
+
+	uint32_t KTXFile::GetBlockSize(Format format)
+	{
+		switch (format)
+		{
+			case Format::BC1_RGB_UNORM:
+			case Format::BC1_RGB_SRGB: return 8;
+			case Format::BC3_UNORM:
+			case Format::BC3_SRGB:
+			case Format::BC5_UNORM:
+			case Format::BC7_UNORM:
+			case Format::BC7_SRGB: return 16;
+			default: return 4;
+		}
+	}
+
+	uint64_t KTXFile::GetLevelSize(Format format, uint32_t width, uint32_t height)
+	{
+		if (IsBlockCompressed(format)) {
+			return (uint64_t)((width + 3) / 4) * (uint64_t)((height + 3) / 4) * GetBlockSize(format);
+		}
+
+		return (uint64_t)width * (uint64_t)height * GetBlockSize(format);
+	}
+
+	const char* KTXFile::GetFormatName(Format format)
+	{
+		switch (format)
+		{
+			case Format::R8G8B8A8_UNORM: return "RGBA8";
+			case Format::R8G8B8A8_SRGB: return "RGBA8 sRGB";
+			case Format::BC1_RGB_UNORM: return "BC1";
+			case Format::BC1_RGB_SRGB: return "BC1 sRGB";
+			case Format::BC3_UNORM: return "BC3";
+			case Format::BC3_SRGB: return "BC3 sRGB";
+			case Format::BC5_UNORM: return "BC5";
+			case Format::BC7_UNORM: return "BC7";
+			case Format::BC7_SRGB: return "BC7 sRGB";
+			default: return "Unknown";
+		}
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Common/File/MappedFile.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Cosmos::Renderer
+{
+	// reads and writes 2d textures on the ktx2 container, the format cooked textures are stored with
+	// only what the engine cooks is supported: a single layer and face, every mip level present and no supercompression
+	class KTXFile
+	{
+	public:
+
+		// vulkan format values, ktx2 stores textures by them
+		enum Format : uint32_t
+		{
+			R8G8B8A8_UNORM = 37,
+			R8G8B8A8_SRGB = 43,
+			BC1_RGB_UNORM = 131,
+			BC1_RGB_SRGB = 132,
+			BC3_UNORM = 137,
+			BC3_SRGB = 138,
+			BC5_UNORM = 141,
+			BC7_UNORM = 145,
+			BC7_SRGB = 146
+		};
+
+		struct Level
+		{
+			uint64_t offset = 0;								// from the start of the data the level was given/read with
+			uint64_t size = 0;
+		};
+
+	public:
+
+		// constructor
+		KTXFile() = default;
+
+		// destructor
+		~KTXFile() = default;
+
+		// delete copy constructor
+		KTXFile(const KTXFile&) = delete;
+
+		// delete assignment constructor
+		KTXFile& operator=(const KTXFile&) = delete;
+
+		// returns the texture format
+		inline Format GetFormat() const { return mFormat; }
+
+		// returns the width of the first mip level
+		inline uint32_t GetWidth() const { return mWidth; }
+
+		// returns the height of the first mip level
+		inline uint32_t GetHeight() const { return mHeight; }
+
+		// returns how many mip levels the file has
+		inline uint32_t GetLevelCount() const { return (uint32_t)mLevels.size(); }
+
+		// returns a mip level, it's offset is from the start of the file
+		inline const Level& GetLevel(uint32_t level) const { return mLevels[level]; }
+
+		// returns the whole file content
+		inline const uint8_t* GetData() const { return mFile.GetData(); }
+
+	public:
+
+		// maps and validates a file, returns false if it's not a texture the engine can load
+		bool Open(std::string path);
+
+		// writes a texture with it's mip levels, level 0 is the largest and every level is read from data at it's offset
+		static bool Write(std::string path, Format format, uint32_t width, uint32_t height, const uint8_t* data, const std::vector<Level>& levels);
+
+		// returns if a format is one of the supported ones
+		static bool IsSupported(uint32_t format);
+
+		// returns if a format stores 4x4 texel blocks instead of single texels
+		static bool IsBlockCompressed(Format format);
+
+		// returns how many bytes a texel, or a 4x4 block on block-compressed formats, takes
+		static uint32_t GetBlockSize(Format format);
+
+		// returns how many bytes a mip level of the given size takes, partial blocks on the edges take a whole block
+		static uint64_t GetLevelSize(Format format, uint32_t width, uint32_t height);
+
+		// returns the name of a format
+		static const char* GetFormatName(Format format);
+
+	private:
+
+		MappedFile mFile;
+		Format mFormat = Format::R8G8B8A8_SRGB;
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		std::vector<Level> mLevels = {};
+	};
+}
@@ -27,9 +27,16 @@ namespace Cosmos::Renderer
 		// returns a reference to the material's albedo texture
 		inline Shared<ITexture2D>& GetAlbedoTextureRef() { return mAlbedo; }
 
+		// returns the alpha bellow wich fragments are discarded, only used by alpha tested meshes
+		inline float GetAlphaCutoff() const { return mAlphaCutoff; }
+
+		// sets the alpha bellow wich fragments are discarded
+		inline void SetAlphaCutoff(float cutoff) { mAlphaCutoff = cutoff; }
+
 	private:
 
 		std::string mName = {};
 		Shared<ITexture2D> mAlbedo;
+		float mAlphaCutoff = 0.5f;
 	};
 }
\ No newline at end of file
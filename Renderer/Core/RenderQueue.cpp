@@ -0,0 +1,146 @@
+#include "RenderQueue.h"
+
+#include "IContext.h"
+#include "IMesh.h"
+#include "ITexture.h"
+
+#include <Common/Util/Algorithm.h>
+#include <Common/Util/Timer.h>
+#include <atomic>
+#include <cstring>
+
+namespace Cosmos::Renderer
+{
+	RenderQueue::RenderQueue(IContext* context)
+		: mContext(context)
+	{
+	}
+
+	uint64_t RenderQueue::MakeKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth)
+	{
+		// positive floats keep their order when compared as integers, the upper 16 bits are enough to roughly order by distance
+		uint32_t depthBits = 0;
+		depth = depth > 0.0f ? depth : 0.0f;
+		memcpy(&depthBits, &depth, sizeof(float));
+
+		return ((uint64_t)(pipeline & 0xFF) << 56) | ((uint64_t)(material & 0xFFFFF) << 36) | ((uint64_t)(mesh & 0xFFFFF) << 16) | (uint64_t)(depthBits >> 16);
+	}
+
+	void RenderQueue::Submit(IMesh* mesh, const glm::mat4& transform, uint64_t id, float depth, uint32_t pipeline)
+	{
+		// textures loaded from the same file are bound the same, meshes sharing them are kept together to skip rebinding
+		Shared<ITexture2D>& albedo = mesh->GetMaterialRef().GetAlbedoTextureRef();
+		uint32_t materialId = mMaterialIds.emplace(albedo ? albedo->GetPathRef() : std::string(), (uint32_t)mMaterialIds.size()).first->second;
+		uint32_t meshId = mMeshIds.emplace(mesh, (uint32_t)mMeshIds.size()).first->second;
+
+		Packet packet = {};
+		packet.key = MakeKey(pipeline, materialId, meshId, depth);
+		packet.mesh = mesh;
+		packet.instanceIndex = (uint32_t)mInstances.size();
+
+		Instance instance = {};
+		instance.model = transform;
+		instance.id = id;
+		instance.selected = (uint32_t)mesh->IsSelected();
+
+		mPackets.push_back(packet);
+		mInstances.push_back(instance);
+	}
+
+	void RenderQueue::Sort()
+	{
+		RadixSort(mPackets, mScratch, [](const Packet& packet) { return packet.key; });
+	}
+
+	void RenderQueue::Flush(uint32_t stage)
+	{
+		Timer sortTimer;
+		sortTimer.Start();
+		Sort();
+		mFrameStatistics.sortTime += sortTimer.Stop();
+
+		Timer submitTimer;
+		submitTimer.Start();
+
+		// instances are laid out in draw order, so every batch is a contiguous range
+		mSortedInstances.resize(mPackets.size());
+
+		for (size_t i = 0; i < mPackets.size(); i++) {
+			mSortedInstances[i] = mInstances[mPackets[i].instanceIndex];
+		}
+
+		// the depth bits are ignored when batching, the mesh of a batch draws all of it's instances
+		// ids are truncated on the key and wrap past 2^20 meshes, so the mesh itself is compared before merging
+		// preparing writes into renderer-wide state (instance buffer, residency, pipeline variants), so it's done here and in order
+		mBatches.clear();
+		size_t first = 0;
+
+		while (first < mPackets.size())
+		{
+			size_t last = first + 1;
+
+			while (last < mPackets.size() && mPackets[last].mesh == mPackets[first].mesh && (mPackets[last].key >> 16) == (mPackets[first].key >> 16)) {
+				last++;
+			}
+
+			// a batch holds a single mesh, one that isn't loaded only drops it's own packets
+			if (!mPackets[first].mesh->IsLoaded()) {
+				first = last;
+				continue;
+			}
+
+			Batch batch = {};
+			batch.mesh = mPackets[first].mesh;
+			batch.instances = &mSortedInstances[first];
+			batch.count = (uint32_t)(last - first);
+
+			if (batch.mesh->OnPrepare(batch, (IContext::Stage)stage)) {
+				mBatches.push_back(batch);
+			}
+
+			first = last;
+		}
+
+		// recording only touches the command buffer of the range, every range starts with nothing bound
+		std::atomic<uint32_t> binds = 0;
+		std::atomic<uint32_t> draws = 0;
+		std::atomic<uint32_t> ranges = 0;
+
+		mContext->RecordParallel(mBatches.size(), [&](size_t begin, size_t end, void* commandBuffer)
+			{
+				BindState state = {};
+				state.commandBuffer = commandBuffer;
+
+				for (size_t i = begin; i < end; i++) {
+					mBatches[i].mesh->OnRender(mBatches[i], state, (IContext::Stage)stage);
+				}
+
+				binds += state.binds;
+				draws += state.draws;
+				ranges++;
+			});
+
+		mFrameStatistics.submitTime += submitTimer.Stop();
+		mFrameStatistics.packets += (uint32_t)mPackets.size();
+		mFrameStatistics.batches += (uint32_t)mBatches.size();
+		mFrameStatistics.binds += binds;
+		mFrameStatistics.draws += draws;
+		mFrameStatistics.ranges += ranges;
+
+		Clear();
+	}
+
+	void RenderQueue::Clear()
+	{
+		mPackets.clear();
+		mInstances.clear();
+	}
+
+	void RenderQueue::BeginFrame()
+	{
+		mStatistics = mFrameStatistics;
+		mFrameStatistics = {};
+		mMaterialIds.clear();
+		mMeshIds.clear();
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Common/Math/Math.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer { class IContext; }
+namespace Cosmos::Renderer { class IMesh; }
+
+namespace Cosmos::Renderer
+{
+	class RenderQueue
+	{
+	public:
+
+		struct Packet
+		{
+			uint64_t key = 0;
+			IMesh* mesh = nullptr;
+			uint32_t instanceIndex = 0;
+		};
+
+		// per-instance data of a draw, packets of the same mesh are drawn together as instances
+		struct Instance
+		{
+			glm::mat4 model = glm::mat4(1.0f);
+			uint64_t id = 0;
+			uint32_t selected = 0;
+		};
+
+		// consecutive packets of the same mesh, drawn as a single instanced draw
+		struct Batch
+		{
+			IMesh* mesh = nullptr;
+			const Instance* instances = nullptr;
+			uint32_t count = 0;
+			uint32_t firstInstance = 0;							// where the renderer placed the instances, written when prepared
+			void* pipeline = nullptr;							// what the renderer draws the batch with, written when prepared
+		};
+
+		// what was last bound on the command buffer being recorded, the renderer uses it to skip redundant binds
+		// each recording thread has it's own, as each records into it's own command buffer
+		struct BindState
+		{
+			void* commandBuffer = nullptr;
+			void* pipeline = nullptr;
+			void* descriptorSet = nullptr;
+			void* vertexBuffer = nullptr;
+			void* indexBuffer = nullptr;
+			uint32_t binds = 0;
+			uint32_t draws = 0;
+		};
+
+		struct Statistics
+		{
+			uint32_t packets = 0;
+			uint32_t batches = 0;								// instanced draws the packets were merged into
+			uint32_t draws = 0;
+			uint32_t binds = 0;
+			uint32_t ranges = 0;								// how many command buffers the batches were recorded into
+			double sortTime = 0.0;
+			double submitTime = 0.0;
+		};
+
+	public:
+
+		// constructor, batches are recorded through the context owning the queue
+		RenderQueue(IContext* context);
+
+		// destructor
+		~RenderQueue() = default;
+
+		// returns a reference to the statistics of the last complete frame, all stages summed
+		inline Statistics& GetStatisticsRef() { return mStatistics; }
+
+		// returns how many packets are waiting to be drawn
+		inline size_t GetPacketCount() const { return mPackets.size(); }
+
+	public:
+
+		// returns a sort key, packets are grouped by pipeline, then material, then mesh and are drawn front-to-back inside a group
+		static uint64_t MakeKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+
+		// adds a draw into the queue, material ids are given by albedo path and mesh ids by mesh object as they're first seen on the frame
+		// meshes loaded from the same file are still separate objects (own buffers, scale, material and load state), so only packets of the same one are instanced
+		void Submit(IMesh* mesh, const glm::mat4& transform, uint64_t id, float depth, uint32_t pipeline = 0);
+
+		// sorts the packets by their keys, with a radix sort since keys are plain integers
+		void Sort();
+
+		// sorts and draws all packets on the given stage, consecutive packets with the same mesh become one instanced draw
+		// batches are prepared in order on the calling thread, then recorded by the renderer across it's workers
+		void Flush(uint32_t stage);
+
+		// removes all packets without drawing them
+		void Clear();
+
+		// publishes the statistics of the frame that ended and starts counting a new one
+		void BeginFrame();
+
+	private:
+
+		IContext* mContext = nullptr;
+		std::vector<Packet> mPackets = {};
+		std::vector<Packet> mScratch = {};
+		std::vector<Instance> mInstances = {};
+		std::vector<Instance> mSortedInstances = {};
+		std::vector<Batch> mBatches = {};
+		std::unordered_map<std::string, uint32_t> mMaterialIds = {};
+		std::unordered_map<const IMesh*, uint32_t> mMeshIds = {};
+		Statistics mFrameStatistics = {};
+		Statistics mStatistics = {};
+	};
+}
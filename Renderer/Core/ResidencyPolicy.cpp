@@ -0,0 +1,179 @@
+#include "ResidencyPolicy.h"
+
+#include <Common/Core/Defines.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Cosmos::Renderer
+{
+	void ResidencyPolicy::Register(IStreamable* texture)
+	{
+		Entry entry = {};
+		entry.lastFrame = mFrame;
+		mTextures[texture] = entry;
+	}
+
+	void ResidencyPolicy::Unregister(IStreamable* texture)
+	{
+		mTextures.erase(texture);
+	}
+
+	void ResidencyPolicy::Touch(IStreamable* texture, float screenSize)
+	{
+		auto it = mTextures.find(texture);
+
+		if (it == mTextures.end()) {
+			return;
+		}
+
+		// the first touch of a frame replaces last frame coverage
+		Entry& entry = it->second;
+		entry.screenSize = entry.lastFrame == mFrame ? std::max(entry.screenSize, screenSize) : screenSize;
+		entry.lastFrame = mFrame;
+	}
+
+	void ResidencyPolicy::Update(uint64_t usage, uint64_t budget)
+	{
+		mFrame++;
+
+		uint32_t operations = 0;
+		uint64_t watermark = budget / 100 * COSMOS_RESIDENCY_LOW_WATERMARK;
+		mStatistics.streamedIn = 0;
+		mStatistics.streamedOut = 0;
+
+		// usage is noisy, going back and forth over the budget would stream the same levels out and in again every frame
+		if (usage > budget) {
+			mReducing = true;
+		}
+
+		// over budget, the least important textures lose detail first but never drop below their fallback
+		while (mReducing && usage > watermark && operations < COSMOS_RESIDENCY_UPLOADS_PER_FRAME)
+		{
+			IStreamable* victim = nullptr;
+			float lowest = FLT_MAX;
+
+			for (auto& [texture, entry] : mTextures)
+			{
+				if (texture->IsStreaming() || texture->GetResidentLevel() >= texture->GetFallbackLevel()) {
+					continue;
+				}
+
+				float priority = GetPriority(entry);
+
+				if (priority < lowest) {
+					lowest = priority;
+					victim = texture;
+				}
+			}
+
+			if (victim == nullptr) {
+				mReducing = false;
+				break;
+			}
+
+			// textures with more detail than needed go straight to what they need, others lose a single level
+			uint32_t resident = victim->GetResidentLevel();
+			uint32_t target = std::max(GetDesiredLevel(victim, mTextures[victim]), resident + 1);
+			target = std::min(target, victim->GetFallbackLevel());
+
+			uint64_t freed = victim->GetResidentBytes(resident) - victim->GetResidentBytes(target);
+			operations++;
+
+			if (!victim->StreamToLevel(target)) {
+				break;
+			}
+
+			usage = usage > freed ? usage - freed : 0;
+			mStatistics.streamedOut++;
+		}
+
+		if (usage <= watermark) {
+			mReducing = false;
+		}
+
+		// under the watermark, the most important textures sampled with less detail than they need get it back as long as it stays under
+		while (operations < COSMOS_RESIDENCY_UPLOADS_PER_FRAME)
+		{
+			IStreamable* candidate = nullptr;
+			float highest = 0.0f;
+
+			for (auto& [texture, entry] : mTextures)
+			{
+				if (mFrame - entry.lastFrame > COSMOS_RESIDENCY_IDLE_FRAMES || texture->IsStreaming() || texture->GetResidentLevel() <= GetDesiredLevel(texture, entry)) {
+					continue;
+				}
+
+				if (entry.screenSize > highest) {
+					highest = entry.screenSize;
+					candidate = texture;
+				}
+			}
+
+			if (candidate == nullptr) {
+				break;
+			}
+
+			uint32_t resident = candidate->GetResidentLevel();
+			uint32_t target = GetDesiredLevel(candidate, mTextures[candidate]);
+
+			while (target < resident && usage + candidate->GetResidentBytes(target) - candidate->GetResidentBytes(resident) > watermark) {
+				target++;
+			}
+
+			if (target == resident) {
+				break;
+			}
+
+			uint64_t added = candidate->GetResidentBytes(target) - candidate->GetResidentBytes(resident);
+			operations++;
+
+			if (!candidate->StreamToLevel(target)) {
+				break;
+			}
+
+			usage += added;
+			mStatistics.streamedIn++;
+		}
+
+		mStatistics.budget = budget;
+		mStatistics.usage = usage;
+		mStatistics.textures = (uint32_t)mTextures.size();
+		mStatistics.textureBytes = 0;
+		mStatistics.reducedTextures = 0;
+
+		for (auto& [texture, entry] : mTextures)
+		{
+			mStatistics.textureBytes += texture->GetResidentBytes(texture->GetResidentLevel());
+
+			if (texture->GetResidentLevel() > 0) {
+				mStatistics.reducedTextures++;
+			}
+		}
+	}
+
+	uint32_t ResidencyPolicy::GetDesiredLevel(const IStreamable* texture, const Entry& entry) const
+	{
+		if (mFrame - entry.lastFrame > COSMOS_RESIDENCY_IDLE_FRAMES || entry.screenSize < 1.0f) {
+			return texture->GetFallbackLevel();
+		}
+
+		// one texel per pixel, each level halves the texture
+		float ratio = (float)texture->GetMaxDimension() / entry.screenSize;
+		uint32_t level = ratio > 1.0f ? (uint32_t)std::floor(std::log2(ratio)) : 0;
+
+		return std::min(level, texture->GetFallbackLevel());
+	}
+
+	float ResidencyPolicy::GetPriority(const Entry& entry) const
+	{
+		uint64_t idle = mFrame - entry.lastFrame;
+
+		if (idle > COSMOS_RESIDENCY_IDLE_FRAMES) {
+			return -(float)idle;
+		}
+
+		return entry.screenSize;
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace Cosmos::Renderer
+{
+	// a texture whose mip levels may be streamed in and out, level 0 is the full resolution
+	class IStreamable
+	{
+	public:
+
+		// destructor
+		virtual ~IStreamable() = default;
+
+		// returns the largest dimension of the full resolution texture
+		virtual uint32_t GetMaxDimension() const = 0;
+
+		// returns the most detailed mip level currently resident
+		virtual uint32_t GetResidentLevel() const = 0;
+
+		// returns the least detailed mip level it may drop to, it's always kept resident
+		virtual uint32_t GetFallbackLevel() const = 0;
+
+		// returns how many bytes it uses when the given level is the most detailed one resident
+		virtual uint64_t GetResidentBytes(uint32_t level) const = 0;
+
+		// returns if a stream it was asked for hasn't finished yet, it's left alone until then
+		virtual bool IsStreaming() const = 0;
+
+		// makes the given level the most detailed one resident, it may finish on a later frame, returns false if it couldn't
+		virtual bool StreamToLevel(uint32_t level) = 0;
+	};
+
+	// decides wich textures lose or regain detail to keep memory under a budget, it doesn't know the device so it runs on the cpu alone
+	class ResidencyPolicy
+	{
+	public:
+
+		struct Statistics
+		{
+			uint64_t budget = 0;
+			uint64_t usage = 0;
+			uint64_t textureBytes = 0;
+			uint32_t textures = 0;
+			uint32_t reducedTextures = 0;
+			uint32_t streamedIn = 0;
+			uint32_t streamedOut = 0;
+		};
+
+	public:
+
+		// constructor
+		ResidencyPolicy() = default;
+
+		// destructor
+		~ResidencyPolicy() = default;
+
+		// returns a reference to the last frame statistics
+		inline Statistics& GetStatisticsRef() { return mStatistics; }
+
+	public:
+
+		// starts tracking a texture, it's mips may be streamed from now on
+		void Register(IStreamable* texture);
+
+		// stops tracking a texture
+		void Unregister(IStreamable* texture);
+
+		// informs the texture was drawn this frame covering screenSize pixels, the largest coverage of the frame is kept
+		void Touch(IStreamable* texture, float screenSize);
+
+		// streams texture mips in and out given the memory in use and the budget, called once per frame
+		// once over the budget textures lose detail until the low watermark, they only regain it while staying under the watermark
+		void Update(uint64_t usage, uint64_t budget);
+
+	private:
+
+		struct Entry
+		{
+			float screenSize = 0.0f;
+			uint64_t lastFrame = 0;
+		};
+
+		// returns the mip level the texture needs given it's on-screen coverage
+		uint32_t GetDesiredLevel(const IStreamable* texture, const Entry& entry) const;
+
+		// returns how important is for the texture to keep detail, idle textures are always the least important
+		float GetPriority(const Entry& entry) const;
+
+	private:
+
+		uint64_t mFrame = 0;
+		bool mReducing = false;
+		std::unordered_map<IStreamable*, Entry> mTextures = {};
+		Statistics mStatistics = {};
+	};
+}
@@ -0,0 +1,38 @@
+#include "StagingRing.h"
+
+namespace Cosmos::Renderer
+{
+	StagingRing::StagingRing(uint64_t capacity, uint64_t alignment)
+		: mCapacity(capacity), mAlignment(alignment)
+	{
+	}
+
+	bool StagingRing::Allocate(uint64_t size, uint64_t& offset)
+	{
+		uint64_t position = (mHead + mAlignment - 1) / mAlignment * mAlignment;
+
+		// an upload is never split by the end of the ring, it starts over from the beginning instead
+		if (position % mCapacity + size > mCapacity) {
+			position = (position / mCapacity + 1) * mCapacity;
+		}
+
+		if (position + size - mTail > mCapacity) {
+			return false;
+		}
+
+		mHead = position + size;
+		offset = position % mCapacity;
+		return true;
+	}
+
+	void StagingRing::Release(uint64_t end, bool last)
+	{
+		mTail = end;
+
+		// only once the released batch is the last in flight, the later ones hold ends past the old head and rewinding would put them past it
+		if (mTail == mHead && last) {
+			mTail = 0;
+			mHead = 0;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Cosmos::Renderer
+{
+	// keeps track of the space on a staging ring, uploads are placed at the head and freed from the tail as the batches holding them retire
+	// positions grow forever and wrap by the capacity, an upload is never split by the end of the ring
+	class StagingRing
+	{
+	public:
+
+		// constructor
+		StagingRing() = default;
+
+		// constructor
+		StagingRing(uint64_t capacity, uint64_t alignment);
+
+		// destructor
+		~StagingRing() = default;
+
+		// returns where the next upload is placed, a batch frees the ring up to here once it retires
+		inline uint64_t GetHead() const { return mHead; }
+
+		// returns the oldest byte still in use by a batch in flight
+		inline uint64_t GetTail() const { return mTail; }
+
+		// returns the ring size in bytes
+		inline uint64_t GetCapacity() const { return mCapacity; }
+
+	public:
+
+		// places size bytes at the head and returns where they start on the ring, returns false and takes nothing when the space is still in use
+		// the position is worked out from the current head on every call, so a caller that frees space and tries again always sees a rewind
+		bool Allocate(uint64_t size, uint64_t& offset);
+
+		// frees the ring up to the head a batch was submitted with, batches must be released in the order they were submitted
+		// last tells it's the only batch in flight, once nothing is left on the ring the next upload starts at the beginning and is less likely to wrap
+		void Release(uint64_t end, bool last);
+
+	private:
+
+		uint64_t mCapacity = 0;
+		uint64_t mAlignment = 16;
+		uint64_t mHead = 0;
+		uint64_t mTail = 0;
+	};
+}
@@ -0,0 +1,479 @@
+#include "TextureCooker.h"
+
+#include "BlockCompression.h"
+#include <Common/Debug/Logger.h>
+#include <Common/Util/Timer.h>
+#include <Platform/Core/PlatformDetection.h>
+
+#if defined(PLATFORM_WINDOWS)
+#pragma warning(push)
+#pragma warning(disable : 26827)
+#endif
+
+#include <stb_image.h>
+
+#if defined(PLATFORM_WINDOWS)
+#pragma warning(pop)
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COSMOS_TEXTURECOOKER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Cosmos::Renderer
+{
+	// kaiser filter taps when halving, source pixels 2x - 5 to 2x + 6 contribute to destination pixel x
+	static constexpr int32_t sKaiserFirstTap = -5;
+	static constexpr int32_t sKaiserTaps = 12;
+	static constexpr double sKaiserRadius = 3.0;
+	static constexpr double sKaiserAlpha = 4.0;
+
+	// modified bessel function of the first kind, order 0
+	static double BesselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+
+		for (int32_t k = 1; k < 32 && term > sum * 1e-12; k++) {
+			term *= (x * x * 0.25) / ((double)k * (double)k);
+			sum += term;
+		}
+
+		return sum;
+	}
+
+	// normalized weights of the kaiser taps, they're the same for every destination pixel
+	struct KaiserWeights
+	{
+		float values[sKaiserTaps] = {};
+
+		KaiserWeights()
+		{
+			double total = 0.0;
+			double weights[sKaiserTaps] = {};
+
+			for (int32_t i = 0; i < sKaiserTaps; i++)
+			{
+				// distance from the destination pixel center, measured in destination pixels
+				double t = ((double)(sKaiserFirstTap + i) - 0.5) * 0.5;
+				double sinc = t == 0.0 ? 1.0 : std::sin(3.14159265358979323846 * t) / (3.14159265358979323846 * t);
+				double window = std::abs(t) >= sKaiserRadius ? 0.0 : BesselI0(sKaiserAlpha * std::sqrt(1.0 - (t / sKaiserRadius) * (t / sKaiserRadius))) / BesselI0(sKaiserAlpha);
+
+				weights[i] = sinc * window;
+				total += weights[i];
+			}
+
+			for (int32_t i = 0; i < sKaiserTaps; i++) {
+				values[i] = (float)(weights[i] / total);
+			}
+		}
+	};
+
+	// linear value of every srgb encoded byte
+	struct SRGBTable
+	{
+		float values[256] = {};
+
+		SRGBTable()
+		{
+			for (int32_t i = 0; i < 256; i++) {
+				float c = (float)i / 255.0f;
+				values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+		}
+	};
+
+	static uint8_t EncodeSRGB(float value)
+	{
+		value = std::clamp(value, 0.0f, 1.0f);
+		value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		return (uint8_t)(value * 255.0f + 0.5f);
+	}
+
+	static uint8_t EncodeLinear(float value)
+	{
+		return (uint8_t)(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	std::string TextureCooker::GetCookedPath(std::string source)
+	{
+		return std::filesystem::path(source).replace_extension(".ktx2").string();
+	}
+
+	std::string TextureCooker::FindCooked(std::string source)
+	{
+		std::error_code error;
+		std::string cooked = GetCookedPath(source);
+
+		if (!std::filesystem::exists(cooked, error)) {
+			return {};
+		}
+
+		// the source image is not required to ship, only to be older than what was cooked out of it
+		if (cooked != source && std::filesystem::exists(source, error)) {
+			if (std::filesystem::last_write_time(cooked, error) < std::filesystem::last_write_time(source, error)) {
+				return {};
+			}
+		}
+
+		return cooked;
+	}
+
+	bool TextureCooker::Cook(std::string source, Usage usage, Filter filter)
+	{
+		Timer timer;
+		timer.Start();
+
+		int32_t width, height, channels;
+		stbi_uc* pixels = stbi_load(source.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+		if (pixels == nullptr) {
+			COSMOS_LOG(Logger::Error, "Failed to cook %s, it couldn't be decoded", source.c_str());
+			return false;
+		}
+
+		// color is filtered as light, vectors and masks are not encoded with the srgb curve
+		bool srgb = usage == Usage::Uncompressed || usage == Usage::Albedo;
+		MipChain chain = GenerateMipChain(pixels, (uint32_t)width, (uint32_t)height, filter, srgb);
+		stbi_image_free(pixels);
+
+		if (usage == Usage::Normal) {
+			RenormalizeNormals(chain);
+		}
+
+		bool alpha = false;
+
+		for (size_t i = 3; i < (size_t)chain.levels[0].size && !alpha; i += 4) {
+			alpha = chain.pixels[i] != 255;
+		}
+
+		KTXFile::Format format = GetFormat(usage, alpha);
+		std::string destination = GetCookedPath(source);
+		std::vector<uint8_t> compressed = {};
+		std::vector<KTXFile::Level> levels = {};
+		double quality = 99.0; // lossless
+
+		if (KTXFile::IsBlockCompressed(format))
+		{
+			for (uint32_t i = 0; i < (uint32_t)chain.levels.size(); i++)
+			{
+				std::vector<uint8_t> blocks = CompressImage(chain.pixels.data() + chain.levels[i].offset, std::max(chain.width >> i, 1u), std::max(chain.height >> i, 1u), format);
+				levels.push_back({ (uint64_t)compressed.size(), (uint64_t)blocks.size() });
+				compressed.insert(compressed.end(), blocks.begin(), blocks.end());
+			}
+
+			quality = MeasureQuality(chain, compressed.data(), format);
+		}
+
+		else
+		{
+			compressed.swap(chain.pixels);
+			levels = chain.levels;
+		}
+
+		if (!KTXFile::Write(destination, format, chain.width, chain.height, compressed.data(), levels)) {
+			return false;
+		}
+
+		uint64_t uncompressedSize = 0;
+
+		for (const KTXFile::Level& level : chain.levels) {
+			uncompressedSize += level.size;
+		}
+
+		COSMOS_LOG(Logger::Info, "Cooked %s as %s %s (%dx%d, %zu levels, %.1fKB instead of %.1fKB, %.1fdB) in %.2fms", destination.c_str(), GetUsageName(usage), KTXFile::GetFormatName(format),
+			width, height, levels.size(), (double)compressed.size() / 1024.0, (double)uncompressedSize / 1024.0, quality, timer.Stop());
+
+		return true;
+	}
+
+	TextureCooker::Usage TextureCooker::GuessUsage(std::string source)
+	{
+		std::string name = std::filesystem::path(source).stem().string();
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+		auto endsWith = [&name](const char* suffix)
+			{
+				size_t length = strlen(suffix);
+				return name.size() >= length && name.compare(name.size() - length, length, suffix) == 0;
+			};
+
+		if (endsWith("_n") || endsWith("_nrm") || endsWith("_normal") || endsWith("_normals")) {
+			return Usage::Normal;
+		}
+
+		if (endsWith("_orm") || endsWith("_mask") || endsWith("_ao") || endsWith("_roughness") || endsWith("_metallic") || endsWith("_metalness")) {
+			return Usage::Mask;
+		}
+
+		return Usage::Albedo;
+	}
+
+	KTXFile::Format TextureCooker::GetFormat(Usage usage, bool alpha)
+	{
+		switch (usage)
+		{
+			case Usage::Albedo: return KTXFile::Format::BC7_SRGB;
+			case Usage::Normal: return KTXFile::Format::BC5_UNORM;
+			case Usage::Mask: return alpha ? KTXFile::Format::BC3_UNORM : KTXFile::Format::BC1_RGB_UNORM;
+			default: return KTXFile::Format::R8G8B8A8_SRGB;
+		}
+	}
+
+	const char* TextureCooker::GetUsageName(Usage usage)
+	{
+		switch (usage)
+		{
+			case Usage::Uncompressed: return "Uncompressed";
+			case Usage::Albedo: return "Albedo";
+			case Usage::Normal: return "Normal";
+			case Usage::Mask: return "Mask";
+			default: return "Unknown";
+		}
+	}
+
+	TextureCooker::MipChain TextureCooker::GenerateMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, Filter filter, bool srgb)
+	{
+		MipChain chain = {};
+		chain.width = width;
+		chain.height = height;
+
+		uint32_t levelCount = (uint32_t)(std::floor(std::log2(std::max(width, height)))) + 1;
+		size_t total = 0;
+
+		for (uint32_t i = 0; i < levelCount; i++) {
+			uint64_t size = (uint64_t)std::max(width >> i, 1u) * (uint64_t)std::max(height >> i, 1u) * 4;
+			chain.levels.push_back({ (uint64_t)total, size });
+			total += (size_t)size;
+		}
+
+		chain.pixels.resize(total);
+		memcpy(chain.pixels.data(), pixels, (size_t)chain.levels[0].size);
+
+		// every level is filtered from the previous one
+		for (uint32_t i = 1; i < levelCount; i++)
+		{
+			const uint8_t* src = chain.pixels.data() + chain.levels[i - 1].offset;
+			uint8_t* dst = chain.pixels.data() + chain.levels[i].offset;
+			Downsample(src, (int32_t)std::max(width >> (i - 1), 1u), (int32_t)std::max(height >> (i - 1), 1u), dst, filter, srgb);
+		}
+
+		return chain;
+	}
+
+	void TextureCooker::RenormalizeNormals(MipChain& chain)
+	{
+		for (size_t l = 1; l < chain.levels.size(); l++)
+		{
+			uint8_t* texels = chain.pixels.data() + chain.levels[l].offset;
+
+			for (size_t i = 0; i < (size_t)chain.levels[l].size; i += 4)
+			{
+				float n[3] = {};
+				float length = 0.0f;
+
+				for (size_t c = 0; c < 3; c++) {
+					n[c] = (float)texels[i + c] / 127.5f - 1.0f;
+					length += n[c] * n[c];
+				}
+
+				if (length < 1e-8f) {
+					continue;
+				}
+
+				length = std::sqrt(length);
+
+				for (size_t c = 0; c < 3; c++) {
+					texels[i + c] = (uint8_t)std::clamp((n[c] / length + 1.0f) * 127.5f + 0.5f, 0.0f, 255.0f);
+				}
+			}
+		}
+	}
+
+	double TextureCooker::MeasureQuality(const MipChain& chain, const uint8_t* compressed, KTXFile::Format format)
+	{
+		std::vector<uint8_t> decoded;
+
+		if (!DecompressImage(compressed, chain.width, chain.height, format, decoded)) {
+			return 0.0;
+		}
+
+		uint32_t channels = 4;
+
+		if (format == KTXFile::Format::BC1_RGB_UNORM || format == KTXFile::Format::BC1_RGB_SRGB) channels = 3;
+		if (format == KTXFile::Format::BC5_UNORM) channels = 2;
+
+		double error = 0.0;
+
+		for (size_t i = 0; i < decoded.size(); i += 4) {
+			for (size_t c = 0; c < channels; c++) {
+				double d = (double)decoded[i + c] - (double)chain.pixels[i + c];
+				error += d * d;
+			}
+		}
+
+		error /= (double)(decoded.size() / 4 * channels);
+		return error == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / error);
+	}
+
+	void TextureCooker::Downsample(const uint8_t* src, int32_t width, int32_t height, uint8_t* dst, Filter filter, bool srgb)
+	{
+		switch (filter)
+		{
+			case Filter::Box: { DownsampleBox(src, width, height, dst); break; }
+			case Filter::Kaiser: { DownsampleKaiser(src, width, height, dst, srgb); break; }
+		}
+	}
+
+	void TextureCooker::DownsampleBox(const uint8_t* src, int32_t width, int32_t height, uint8_t* dst)
+	{
+		int32_t halfWidth = std::max(width / 2, 1);
+		int32_t halfHeight = std::max(height / 2, 1);
+
+		for (int32_t y = 0; y < halfHeight; y++)
+		{
+			const uint8_t* row0 = &src[(size_t)std::min(y * 2, height - 1) * width * 4];
+			const uint8_t* row1 = &src[(size_t)std::min(y * 2 + 1, height - 1) * width * 4];
+			uint8_t* out = &dst[(size_t)y * halfWidth * 4];
+			int32_t x = 0;
+
+			#if defined COSMOS_TEXTURECOOKER_SSE2
+			// four destination pixels at a time out of eight source pixels on each row, the odd column left is done below
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i round = _mm_set1_epi16(2);
+			int32_t pairs = width / 2;
+
+			for (; x + 4 <= pairs; x += 4)
+			{
+				__m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+				__m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + x * 8 + 16));
+				__m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+				__m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + x * 8 + 16));
+
+				// vertical sums widened to 16 bits, two source pixels per register
+				__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+				__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+				__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+				__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+				// horizontal sums of each pair, then (sum + 2) / 4
+				__m128i h0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+				__m128i h1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+				h0 = _mm_srli_epi16(_mm_add_epi16(h0, round), 2);
+				h1 = _mm_srli_epi16(_mm_add_epi16(h1, round), 2);
+
+				_mm_storeu_si128((__m128i*)(out + x * 4), _mm_packus_epi16(h0, h1));
+			}
+			#endif
+
+			for (; x < halfWidth; x++)
+			{
+				int32_t x0 = std::min(x * 2, width - 1) * 4;
+				int32_t x1 = std::min(x * 2 + 1, width - 1) * 4;
+
+				for (int32_t c = 0; c < 4; c++) {
+					out[x * 4 + c] = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+				}
+			}
+		}
+	}
+
+	void TextureCooker::DownsampleKaiser(const uint8_t* src, int32_t width, int32_t height, uint8_t* dst, bool srgb)
+	{
+		int32_t halfWidth = std::max(width / 2, 1);
+		int32_t halfHeight = std::max(height / 2, 1);
+		static const KaiserWeights sWeights;
+		static const SRGBTable sTable;
+		const float* weights = sWeights.values;
+		const float* table = sTable.values;
+
+		// color is filtered as light, alpha is already linear
+		std::vector<float> linear((size_t)width * height * 4);
+
+		for (size_t i = 0; i < (size_t)width * height; i++)
+		{
+			for (size_t c = 0; c < 3; c++) {
+				linear[i * 4 + c] = srgb ? table[src[i * 4 + c]] : (float)src[i * 4 + c] / 255.0f;
+			}
+
+			linear[i * 4 + 3] = (float)src[i * 4 + 3] / 255.0f;
+		}
+
+		// horizontal pass, every row is halved
+		std::vector<float> horizontal((size_t)halfWidth * height * 4);
+
+		for (int32_t y = 0; y < height; y++)
+		{
+			const float* row = &linear[(size_t)y * width * 4];
+			float* out = &horizontal[(size_t)y * halfWidth * 4];
+
+			for (int32_t x = 0; x < halfWidth; x++)
+			{
+				#if defined COSMOS_TEXTURECOOKER_SSE2
+				__m128 acc = _mm_setzero_ps();
+
+				for (int32_t t = 0; t < sKaiserTaps; t++) {
+					int32_t sx = std::clamp(x * 2 + sKaiserFirstTap + t, 0, width - 1);
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(row + (size_t)sx * 4)));
+				}
+
+				_mm_storeu_ps(out + (size_t)x * 4, acc);
+				#else
+				float acc[4] = {};
+
+				for (int32_t t = 0; t < sKaiserTaps; t++) {
+					int32_t sx = std::clamp(x * 2 + sKaiserFirstTap + t, 0, width - 1);
+
+					for (int32_t c = 0; c < 4; c++) {
+						acc[c] += weights[t] * row[(size_t)sx * 4 + c];
+					}
+				}
+
+				memcpy(out + (size_t)x * 4, acc, sizeof(acc));
+				#endif
+			}
+		}
+
+		// vertical pass, the columns of the halved rows are halved and encoded back
+		for (int32_t y = 0; y < halfHeight; y++)
+		{
+			uint8_t* out = &dst[(size_t)y * halfWidth * 4];
+
+			for (int32_t x = 0; x < halfWidth; x++)
+			{
+				float value[4] = {};
+
+				#if defined COSMOS_TEXTURECOOKER_SSE2
+				__m128 acc = _mm_setzero_ps();
+
+				for (int32_t t = 0; t < sKaiserTaps; t++) {
+					int32_t sy = std::clamp(y * 2 + sKaiserFirstTap + t, 0, height - 1);
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(&horizontal[((size_t)sy * halfWidth + x) * 4])));
+				}
+
+				_mm_storeu_ps(value, acc);
+				#else
+				for (int32_t t = 0; t < sKaiserTaps; t++) {
+					int32_t sy = std::clamp(y * 2 + sKaiserFirstTap + t, 0, height - 1);
+
+					for (int32_t c = 0; c < 4; c++) {
+						value[c] += weights[t] * horizontal[((size_t)sy * halfWidth + x) * 4 + c];
+					}
+				}
+				#endif
+
+				for (int32_t c = 0; c < 3; c++) {
+					out[x * 4 + c] = srgb ? EncodeSRGB(value[c]) : EncodeLinear(value[c]);
+				}
+
+				out[x * 4 + 3] = EncodeLinear(value[3]);
+			}
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "KTXFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Cosmos::Renderer
+{
+	// turns source images into cooked textures, ktx2 files with every mip level precomputed on the cpu and block-compressed by usage
+	// cooked textures are uploaded as they are, no decoding or mip generation runs when they're loaded
+	class TextureCooker
+	{
+	public:
+
+		enum Usage
+		{
+			Uncompressed = 0,									// rgba8 srgb, 4 bytes per texel
+			Albedo,												// bc7 srgb, color and alpha at 1 byte per texel
+			Normal,												// bc5, only x and y are kept and z must be reconstructed when sampled
+			Mask												// bc1, or bc3 when there's alpha, without the srgb curve
+		};
+
+		enum Filter
+		{
+			Box = 0,											// 2x2 average in the stored encoding, fast enough to run when streaming
+			Kaiser												// windowed sinc in linear space, sharper mips at a higher cost, used when cooking
+		};
+
+		// rgba pixels of a whole mip chain, level 0 first
+		struct MipChain
+		{
+			uint32_t width = 0;
+			uint32_t height = 0;
+			std::vector<uint8_t> pixels = {};
+			std::vector<KTXFile::Level> levels = {};
+		};
+
+	public:
+
+		// returns where the cooked texture of a source image is written
+		static std::string GetCookedPath(std::string source);
+
+		// returns the cooked texture of a source image if it exists and is not older than the image, empty otherwise
+		static std::string FindCooked(std::string source);
+
+		// decodes a source image, generates it's mip chain, compresses it for the usage and writes it next to it, returns false on failure
+		static bool Cook(std::string source, Usage usage, Filter filter = Filter::Kaiser);
+
+		// returns the usage a source image most likely has by it's name suffix (_n, _normal, _orm, _mask, ...), albedo otherwise
+		static Usage GuessUsage(std::string source);
+
+		// returns the format textures of a usage are cooked into
+		static KTXFile::Format GetFormat(Usage usage, bool alpha);
+
+		// returns the name of a usage
+		static const char* GetUsageName(Usage usage);
+
+	public:
+
+		// generates every mip level of rgba pixels down to 1x1
+		static MipChain GenerateMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, Filter filter, bool srgb = true);
+
+		// halves rgba pixels into dst, wich must hold max(width / 2, 1) * max(height / 2, 1) pixels, the last row/column is repeated on odd sizes
+		static void Downsample(const uint8_t* src, int32_t width, int32_t height, uint8_t* dst, Filter filter = Filter::Box, bool srgb = true);
+
+	private:
+
+		// normalizes the vectors of every level but the first, filtering shortens them
+		static void RenormalizeNormals(MipChain& chain);
+
+		// returns the peak signal to noise ratio of the first level once compressed, on the channels the format keeps
+		static double MeasureQuality(const MipChain& chain, const uint8_t* compressed, KTXFile::Format format);
+
+		// 2x2 box filter, simd when available
+		static void DownsampleBox(const uint8_t* src, int32_t width, int32_t height, uint8_t* dst);
+
+		// separable kaiser windowed sinc, filtering happens on linear values
+		static void DownsampleKaiser(const uint8_t* src, int32_t width, int32_t height, uint8_t* dst, bool srgb);
+	};
+}
@@ -0,0 +1,358 @@
+#include "ThumbnailGenerator.h"
+
+#include "BlockCompression.h"
+#include "KTXFile.h"
+#include "TextureCooker.h"
+#include "GLTF/Source.h"
+#include <Common/Math/Math.h>
+#include <Platform/Core/PlatformDetection.h>
+
+#if defined(PLATFORM_WINDOWS)
+#pragma warning(push)
+#pragma warning(disable : 26827)
+#endif
+
+#include <stb_image.h>
+
+#if defined(PLATFORM_WINDOWS)
+#pragma warning(pop)
+#endif
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+namespace Cosmos::Renderer
+{
+	bool ThumbnailGenerator::Generate(std::string path, uint32_t size, std::vector<uint8_t>& pixels)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+		if (extension == ".gltf" || extension == ".glb") {
+			return GenerateMesh(path, size, pixels);
+		}
+
+		if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".ktx2") {
+			return GenerateImage(path, size, pixels);
+		}
+
+		return false;
+	}
+
+	bool ThumbnailGenerator::IsSupported(std::string path)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+		return extension == ".gltf" || extension == ".glb" || extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".ktx2";
+	}
+
+	bool ThumbnailGenerator::GenerateImage(std::string path, uint32_t size, std::vector<uint8_t>& pixels)
+	{
+		std::vector<uint8_t> src;
+		int32_t width = 0;
+		int32_t height = 0;
+
+		if (std::filesystem::path(path).extension() == ".ktx2")
+		{
+			KTXFile file;
+
+			if (!file.Open(path)) {
+				return false;
+			}
+
+			// there's no need to decode more texels than the thumbnail shows
+			uint32_t level = 0;
+
+			while (level + 1 < file.GetLevelCount() && std::max(file.GetWidth() >> (level + 1), file.GetHeight() >> (level + 1)) >= size) {
+				level++;
+			}
+
+			width = (int32_t)std::max(file.GetWidth() >> level, 1u);
+			height = (int32_t)std::max(file.GetHeight() >> level, 1u);
+			const uint8_t* data = file.GetData() + file.GetLevel(level).offset;
+
+			if (KTXFile::IsBlockCompressed(file.GetFormat())) {
+				if (!DecompressImage(data, (uint32_t)width, (uint32_t)height, file.GetFormat(), src)) {
+					return false;
+				}
+			}
+
+			else {
+				src.assign(data, data + (size_t)width * (size_t)height * 4);
+			}
+		}
+
+		else
+		{
+			int32_t channels;
+			stbi_uc* decoded = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+			if (decoded == nullptr) {
+				return false;
+			}
+
+			src.assign(decoded, decoded + (size_t)width * (size_t)height * 4);
+			stbi_image_free(decoded);
+		}
+
+		Fit(src, width, height, size, pixels);
+		return true;
+	}
+
+	bool ThumbnailGenerator::GenerateMesh(std::string path, uint32_t size, std::vector<uint8_t>& pixels)
+	{
+		tinygltf::Model model;
+		GLTF::Source source;
+		std::string error, warning;
+
+		if (!source.Load(path, model, error, warning) || model.scenes.empty()) {
+			return false;
+		}
+
+		// triangles of every node on world space
+		std::vector<glm::vec3> triangles;
+
+		// the file isn't trusted, indices are checked before use
+		// nodes form a tree, so each is gathered once, wich stops cycles and shared children, and the depth bounds the recursion
+		constexpr uint32_t maxDepth = 256;
+		auto valid = [](int32_t index, size_t count) { return index >= 0 && (size_t)index < count; };
+		std::vector<bool> gathered(model.nodes.size(), false);
+
+		auto gather = [&](int32_t index, const glm::mat4& parent, uint32_t depth, auto& self) -> void
+			{
+				if (depth >= maxDepth || !valid(index, model.nodes.size()) || gathered[index]) {
+					return;
+				}
+
+				gathered[index] = true;
+
+				const tinygltf::Node& node = model.nodes[index];
+				glm::mat4 local = glm::mat4(1.0f);
+
+				if (node.matrix.size() == 16) {
+					local = glm::make_mat4x4(node.matrix.data());
+				}
+
+				else {
+					if (node.translation.size() == 3) local = glm::translate(local, glm::vec3(glm::make_vec3(node.translation.data())));
+					if (node.rotation.size() == 4) local = local * glm::mat4(glm::quat(glm::make_quat(node.rotation.data())));
+					if (node.scale.size() == 3) local = glm::scale(local, glm::vec3(glm::make_vec3(node.scale.data())));
+				}
+
+				glm::mat4 world = parent * local;
+
+				if (valid(node.mesh, model.meshes.size()))
+				{
+					for (const tinygltf::Primitive& primitive : model.meshes[node.mesh].primitives)
+					{
+						auto attribute = primitive.attributes.find("POSITION");
+
+						if (primitive.mode != TINYGLTF_MODE_TRIANGLES || attribute == primitive.attributes.end() || !valid(attribute->second, model.accessors.size())) {
+							continue;
+						}
+
+						const tinygltf::Accessor& accessor = model.accessors[attribute->second];
+
+						if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != TINYGLTF_TYPE_VEC3 || !source.IsAccessorValid(model, accessor)) {
+							continue;
+						}
+
+						const uint8_t* positions = source.GetAccessorData(model, accessor);
+						int32_t stride = accessor.ByteStride(model.bufferViews[accessor.bufferView]);
+						stride = stride > 0 ? stride : (int32_t)sizeof(glm::vec3);
+
+						auto position = [&](size_t i)
+							{
+								glm::vec3 p;
+								memcpy(&p, positions + i * (size_t)stride, sizeof(glm::vec3));
+								return glm::vec3(world * glm::vec4(p, 1.0f));
+							};
+
+						if (primitive.indices > -1)
+						{
+							if (!valid(primitive.indices, model.accessors.size())) {
+								continue;
+							}
+
+							const tinygltf::Accessor& indexAccessor = model.accessors[primitive.indices];
+							bool integer = indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT || indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT || indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE;
+
+							// indices are read tightly packed, a strided view is rejected instead of read past
+							if (!integer || indexAccessor.type != TINYGLTF_TYPE_SCALAR || !source.IsAccessorValid(model, indexAccessor) || model.bufferViews[indexAccessor.bufferView].byteStride != 0) {
+								continue;
+							}
+
+							const uint8_t* indices = source.GetAccessorData(model, indexAccessor);
+
+							for (size_t i = 0; i < indexAccessor.count; i++)
+							{
+								uint32_t index = 0;
+
+								switch (indexAccessor.componentType)
+								{
+									case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: { memcpy(&index, indices + i * 4, 4); break; }
+									case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: { uint16_t value; memcpy(&value, indices + i * 2, 2); index = value; break; }
+									case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: { index = indices[i]; break; }
+								}
+
+								triangles.push_back(index < accessor.count ? position(index) : glm::vec3(0.0f));
+							}
+						}
+
+						else
+						{
+							for (size_t i = 0; i < accessor.count; i++) {
+								triangles.push_back(position(i));
+							}
+						}
+
+						triangles.resize(triangles.size() / 3 * 3);
+					}
+				}
+
+				for (int32_t child : node.children) {
+					self(child, world, depth + 1, self);
+				}
+			};
+
+		const tinygltf::Scene& scene = model.scenes[valid(model.defaultScene, model.scenes.size()) ? model.defaultScene : 0];
+
+		for (int32_t node : scene.nodes) {
+			gather(node, glm::mat4(1.0f), 0, gather);
+		}
+
+		if (triangles.empty()) {
+			return false;
+		}
+
+		// seen from the front-right-top, the view is fitted to the projected bounds
+		glm::mat4 view = glm::rotate(glm::mat4(1.0f), glm::radians(25.0f), glm::vec3(1.0f, 0.0f, 0.0f)) * glm::rotate(glm::mat4(1.0f), glm::radians(-35.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+
+		for (glm::vec3& p : triangles) {
+			p = glm::vec3(view * glm::vec4(p, 1.0f));
+			min = glm::min(min, p);
+			max = glm::max(max, p);
+		}
+
+		// rendered at twice the size and halved, edges come out antialiased
+		const int32_t resolution = (int32_t)size * 2;
+		float extent = std::max({ max.x - min.x, max.y - min.y, 1e-6f });
+		float scale = (float)resolution * 0.9f / extent;
+		glm::vec2 offset = glm::vec2((float)resolution) * 0.5f - glm::vec2(max.x + min.x, -(max.y + min.y)) * 0.5f * scale;
+
+		std::vector<uint8_t> target((size_t)resolution * (size_t)resolution * 4, 0);
+		std::vector<float> depth((size_t)resolution * (size_t)resolution, FLT_MAX);
+		const glm::vec3 light = glm::normalize(glm::vec3(-0.4f, 0.6f, 0.7f));
+
+		for (size_t t = 0; t < triangles.size(); t += 3)
+		{
+			// screen space, y grows downwards and the camera looks at -z
+			glm::vec3 v[3];
+
+			for (size_t i = 0; i < 3; i++) {
+				v[i] = glm::vec3(offset.x + triangles[t + i].x * scale, offset.y - triangles[t + i].y * scale, -triangles[t + i].z);
+			}
+
+			float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+
+			if (std::abs(area) < 1e-12f) {
+				continue;
+			}
+
+			// both faces are lit, gltf winding isn't always consistent
+			glm::vec3 normal = glm::cross(triangles[t + 1] - triangles[t], triangles[t + 2] - triangles[t]);
+			float length = glm::length(normal);
+			float lit = length > 0.0f ? std::abs(glm::dot(normal / length, light)) : 0.0f;
+			uint8_t shade = (uint8_t)(60.0f + 180.0f * lit);
+
+			int32_t x0 = std::max((int32_t)std::floor(std::min({ v[0].x, v[1].x, v[2].x })), 0);
+			int32_t x1 = std::min((int32_t)std::ceil(std::max({ v[0].x, v[1].x, v[2].x })), resolution - 1);
+			int32_t y0 = std::max((int32_t)std::floor(std::min({ v[0].y, v[1].y, v[2].y })), 0);
+			int32_t y1 = std::min((int32_t)std::ceil(std::max({ v[0].y, v[1].y, v[2].y })), resolution - 1);
+
+			for (int32_t y = y0; y <= y1; y++)
+			{
+				for (int32_t x = x0; x <= x1; x++)
+				{
+					float px = (float)x + 0.5f;
+					float py = (float)y + 0.5f;
+					float w0 = ((v[2].x - v[1].x) * (py - v[1].y) - (v[2].y - v[1].y) * (px - v[1].x)) / area;
+					float w1 = ((v[0].x - v[2].x) * (py - v[2].y) - (v[0].y - v[2].y) * (px - v[2].x)) / area;
+					float w2 = 1.0f - w0 - w1;
+
+					if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+						continue;
+					}
+
+					size_t i = (size_t)y * (size_t)resolution + (size_t)x;
+					float z = w0 * v[0].z + w1 * v[1].z + w2 * v[2].z;
+
+					if (z >= depth[i]) {
+						continue;
+					}
+
+					depth[i] = z;
+					target[i * 4 + 0] = shade;
+					target[i * 4 + 1] = shade;
+					target[i * 4 + 2] = shade;
+					target[i * 4 + 3] = 255;
+				}
+			}
+		}
+
+		Fit(target, resolution, resolution, size, pixels);
+		return true;
+	}
+
+	void ThumbnailGenerator::Fit(std::vector<uint8_t>& src, int32_t width, int32_t height, uint32_t size, std::vector<uint8_t>& pixels)
+	{
+		std::vector<uint8_t> half;
+
+		// the bilinear pass only reads 2x2 texels, it's source must be less than twice the thumbnail
+		while (std::max(width, height) >= (int32_t)size * 2) {
+			half.resize((size_t)std::max(width / 2, 1) * (size_t)std::max(height / 2, 1) * 4);
+			TextureCooker::Downsample(src.data(), width, height, half.data());
+			src.swap(half);
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+
+		float scale = (float)size / (float)std::max(width, height);
+		int32_t fitWidth = std::clamp((int32_t)std::lround((float)width * scale), 1, (int32_t)size);
+		int32_t fitHeight = std::clamp((int32_t)std::lround((float)height * scale), 1, (int32_t)size);
+		int32_t left = ((int32_t)size - fitWidth) / 2;
+		int32_t top = ((int32_t)size - fitHeight) / 2;
+
+		pixels.assign((size_t)size * (size_t)size * 4, 0);
+
+		for (int32_t y = 0; y < fitHeight; y++)
+		{
+			float sy = std::clamp(((float)y + 0.5f) * (float)height / (float)fitHeight - 0.5f, 0.0f, (float)(height - 1));
+			int32_t y0 = (int32_t)sy;
+			int32_t y1 = std::min(y0 + 1, height - 1);
+			float fy = sy - (float)y0;
+
+			for (int32_t x = 0; x < fitWidth; x++)
+			{
+				float sx = std::clamp(((float)x + 0.5f) * (float)width / (float)fitWidth - 0.5f, 0.0f, (float)(width - 1));
+				int32_t x0 = (int32_t)sx;
+				int32_t x1 = std::min(x0 + 1, width - 1);
+				float fx = sx - (float)x0;
+
+				uint8_t* dst = &pixels[((size_t)(top + y) * size + (size_t)(left + x)) * 4];
+
+				for (size_t c = 0; c < 4; c++) {
+					float a = src[((size_t)y0 * (size_t)width + (size_t)x0) * 4 + c] * (1.0f - fx) + src[((size_t)y0 * (size_t)width + (size_t)x1) * 4 + c] * fx;
+					float b = src[((size_t)y1 * (size_t)width + (size_t)x0) * 4 + c] * (1.0f - fx) + src[((size_t)y1 * (size_t)width + (size_t)x1) * 4 + c] * fx;
+					dst[c] = (uint8_t)(a * (1.0f - fy) + b * fy + 0.5f);
+				}
+			}
+		}
+	}
+}
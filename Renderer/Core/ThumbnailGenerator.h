@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Cosmos::Renderer
+{
+	// creates small previews of assets on the cpu, it doesn't touch the gpu and may run on any thread
+	// thumbnails are square rgba (srgb encoded) images, the content is centered keeping it's aspect and the rest is transparent
+	class ThumbnailGenerator
+	{
+	public:
+
+		// generates the thumbnail of an image (png, jpg, ktx2) or a mesh (gltf, glb), returns false if the file isn't one or couldn't be read
+		static bool Generate(std::string path, uint32_t size, std::vector<uint8_t>& pixels);
+
+		// returns if a file has a thumbnail by it's extension
+		static bool IsSupported(std::string path);
+
+	private:
+
+		// decodes an image, cooked textures are decoded from their smallest level still larger than the thumbnail
+		static bool GenerateImage(std::string path, uint32_t size, std::vector<uint8_t>& pixels);
+
+		// renders a mesh from the front-right-top with a single directional light
+		static bool GenerateMesh(std::string path, uint32_t size, std::vector<uint8_t>& pixels);
+
+		// fits rgba pixels into the center of the thumbnail, halving them on the box filter before a final bilinear pass
+		static void Fit(std::vector<uint8_t>& src, int32_t width, int32_t height, uint32_t size, std::vector<uint8_t>& pixels);
+	};
+}
@@ -0,0 +1,186 @@
+#include "Accessor.h"
+
+#include "Wrapper/tinygltf.h"
+#include <Common/Debug/Logger.h>
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COSMOS_ACCESSOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Cosmos::Renderer::GLTF
+{
+	void GatherFloats(const float* src, size_t srcStride, uint32_t components, size_t count, float scale, void* dst, size_t dstStride)
+	{
+		uint8_t* out = (uint8_t*)dst;
+
+		#if defined COSMOS_ACCESSOR_SSE2
+		__m128 scale4 = _mm_set1_ps(scale);
+
+		switch (components)
+		{
+			case 2:
+			{
+				for (size_t i = 0; i < count; i++, src += srcStride, out += dstStride) {
+					__m128 v = _mm_castpd_ps(_mm_load_sd((const double*)src));
+					_mm_store_sd((double*)out, _mm_castps_pd(_mm_mul_ps(v, scale4)));
+				}
+				return;
+			}
+
+			case 3:
+			{
+				// two loads to never read past the end of the accessor
+				for (size_t i = 0; i < count; i++, src += srcStride, out += dstStride) {
+					__m128 xy = _mm_castpd_ps(_mm_load_sd((const double*)src));
+					__m128 z = _mm_load_ss(src + 2);
+					__m128 v = _mm_mul_ps(_mm_movelh_ps(xy, z), scale4);
+					_mm_store_sd((double*)out, _mm_castps_pd(v));
+					_mm_store_ss((float*)out + 2, _mm_movehl_ps(v, v));
+				}
+				return;
+			}
+
+			case 4:
+			{
+				for (size_t i = 0; i < count; i++, src += srcStride, out += dstStride) {
+					_mm_storeu_ps((float*)out, _mm_mul_ps(_mm_loadu_ps(src), scale4));
+				}
+				return;
+			}
+		}
+		#endif
+
+		for (size_t i = 0; i < count; i++, src += srcStride, out += dstStride) {
+			float* element = (float*)out;
+
+			for (uint32_t c = 0; c < components; c++) {
+				element[c] = src[c] * scale;
+			}
+		}
+	}
+
+	void FillFloats(const float* value, uint32_t components, size_t count, void* dst, size_t dstStride)
+	{
+		uint8_t* out = (uint8_t*)dst;
+
+		for (size_t i = 0; i < count; i++, out += dstStride) {
+			memcpy(out, value, components * sizeof(float));
+		}
+	}
+
+	void NormalizeVec3(void* dst, size_t dstStride, size_t count)
+	{
+		uint8_t* out = (uint8_t*)dst;
+		size_t i = 0;
+
+		#if defined COSMOS_ACCESSOR_SSE2
+		// four vectors per iteration on structure-of-arrays form, same operation order as glm: v * (1 / sqrt((x*x + y*y) + z*z))
+		__m128 one = _mm_set1_ps(1.0f);
+
+		for (; i + 4 <= count; i += 4, out += dstStride * 4) {
+			float* v0 = (float*)(out);
+			float* v1 = (float*)(out + dstStride);
+			float* v2 = (float*)(out + dstStride * 2);
+			float* v3 = (float*)(out + dstStride * 3);
+
+			__m128 x = _mm_set_ps(v3[0], v2[0], v1[0], v0[0]);
+			__m128 y = _mm_set_ps(v3[1], v2[1], v1[1], v0[1]);
+			__m128 z = _mm_set_ps(v3[2], v2[2], v1[2], v0[2]);
+
+			__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+			__m128 inverse = _mm_div_ps(one, _mm_sqrt_ps(dot));
+
+			alignas(16) float rx[4], ry[4], rz[4];
+			_mm_store_ps(rx, _mm_mul_ps(x, inverse));
+			_mm_store_ps(ry, _mm_mul_ps(y, inverse));
+			_mm_store_ps(rz, _mm_mul_ps(z, inverse));
+
+			v0[0] = rx[0]; v0[1] = ry[0]; v0[2] = rz[0];
+			v1[0] = rx[1]; v1[1] = ry[1]; v1[2] = rz[1];
+			v2[0] = rx[2]; v2[1] = ry[2]; v2[2] = rz[2];
+			v3[0] = rx[3]; v3[1] = ry[3]; v3[2] = rz[3];
+		}
+		#endif
+
+		for (; i < count; i++, out += dstStride) {
+			float* v = (float*)out;
+			float inverse = 1.0f / std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+			v[0] *= inverse;
+			v[1] *= inverse;
+			v[2] *= inverse;
+		}
+	}
+
+	void WidenJoints(const void* src, int32_t componentType, size_t srcStride, size_t count, void* dst, size_t dstStride)
+	{
+		uint8_t* out = (uint8_t*)dst;
+
+		switch (componentType)
+		{
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+			{
+				const uint16_t* in = (const uint16_t*)src;
+
+				for (size_t i = 0; i < count; i++, in += srcStride, out += dstStride) {
+					#if defined COSMOS_ACCESSOR_SSE2
+					__m128i zero = _mm_setzero_si128();
+					__m128i v = _mm_loadl_epi64((const __m128i*)in);
+					_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi16(v, zero));
+					#else
+					uint32_t* joint = (uint32_t*)out;
+					joint[0] = in[0]; joint[1] = in[1]; joint[2] = in[2]; joint[3] = in[3];
+					#endif
+				}
+
+				break;
+			}
+
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			{
+				const uint8_t* in = (const uint8_t*)src;
+
+				for (size_t i = 0; i < count; i++, in += srcStride, out += dstStride) {
+					#if defined COSMOS_ACCESSOR_SSE2
+					__m128i zero = _mm_setzero_si128();
+					int32_t packed = 0;
+					memcpy(&packed, in, sizeof(int32_t));
+					__m128i v = _mm_cvtsi32_si128(packed);
+					_mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero));
+					#else
+					uint32_t* joint = (uint32_t*)out;
+					joint[0] = in[0]; joint[1] = in[1]; joint[2] = in[2]; joint[3] = in[3];
+					#endif
+				}
+
+				break;
+			}
+
+			default:
+			{
+				COSMOS_LOG(Logger::Error, "Joint component type %d is not supported", componentType);
+				break;
+			}
+		}
+	}
+
+	void FixZeroWeights(void* dst, size_t dstStride, size_t count)
+	{
+		uint8_t* out = (uint8_t*)dst;
+
+		for (size_t i = 0; i < count; i++, out += dstStride) {
+			float* w = (float*)out;
+
+			// same addition order as glm::length on vec4
+			if ((w[0] * w[0] + w[1] * w[1]) + (w[2] * w[2] + w[3] * w[3]) == 0.0f) {
+				w[0] = 1.0f;
+				w[1] = 0.0f;
+				w[2] = 0.0f;
+				w[3] = 0.0f;
+			}
+		}
+	}
+}
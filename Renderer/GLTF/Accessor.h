@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// conversion kernels used when decoding gltf accessors into interleaved vertices
+// source strides are given in components, destination strides in bytes
+namespace Cosmos::Renderer::GLTF
+{
+	// copies count elements of n floats (2, 3 or 4) from a strided source into a strided destination, multiplying them by scale
+	void GatherFloats(const float* src, size_t srcStride, uint32_t components, size_t count, float scale, void* dst, size_t dstStride);
+
+	// writes the same n floats (2, 3 or 4) into count strided destination elements
+	void FillFloats(const float* value, uint32_t components, size_t count, void* dst, size_t dstStride);
+
+	// normalizes count strided vec3, matches glm::normalize bit by bit
+	void NormalizeVec3(void* dst, size_t dstStride, size_t count);
+
+	// widens count strided u8/u16 vec4 into strided u32 vec4
+	void WidenJoints(const void* src, int32_t componentType, size_t srcStride, size_t count, void* dst, size_t dstStride);
+
+	// replaces vec4 with zero length by (1, 0, 0, 0), so an unskinned vertex is fully weighted to the first joint
+	void FixZeroWeights(void* dst, size_t dstStride, size_t count);
+}
@@ -1,6 +1,7 @@
 #include "Animation.h"
 
 #include "Node.h"
+#include "Source.h"
 #include <Common/Debug/Logger.h>
 
 namespace Cosmos::Renderer::GLTF
@@ -125,7 +126,7 @@ namespace Cosmos::Renderer::GLTF
 		}
     }
 
-	std::vector<Animation> Animation::LoadAnimations(const tinygltf::Model& model, std::vector<Node*>& nodes)
+	std::vector<Animation> Animation::LoadAnimations(const tinygltf::Model& model, const Source& sourceData, std::vector<Node*>& nodes)
     {
 		std::vector<Animation> animations = {};
 
@@ -159,12 +160,9 @@ namespace Cosmos::Renderer::GLTF
 				// read sampler input time values
 				{
 					const tinygltf::Accessor& accessor = model.accessors[samp.input];
-					const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-					const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
-
 					assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
 
-					const void* dataPtr = &buffer.data[accessor.byteOffset + bufferView.byteOffset];
+					const void* dataPtr = sourceData.GetAccessorData(model, accessor);
 					const float* buf = static_cast<const float*>(dataPtr);
 
 					for (size_t index = 0; index < accessor.count; index++) {
@@ -185,12 +183,9 @@ namespace Cosmos::Renderer::GLTF
 				// read sampler output T/R/S values 
 				{
 					const tinygltf::Accessor& accessor = model.accessors[samp.output];
-					const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-					const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
-
 					assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
 
-					const void* dataPtr = &buffer.data[accessor.byteOffset + bufferView.byteOffset];
+					const void* dataPtr = sourceData.GetAccessorData(model, accessor);
 
 					switch (accessor.type)
 					{
@@ -6,6 +6,7 @@
 
 // forward declarations
 namespace Cosmos::Renderer::GLTF { class Node; }
+namespace Cosmos::Renderer::GLTF { class Source; }
 
 namespace Cosmos::Renderer::GLTF
 {
@@ -74,7 +75,7 @@ namespace Cosmos::Renderer::GLTF
 	public:
 
 		// loads and returns the model animations
-    	static std::vector<Animation> LoadAnimations(const tinygltf::Model& model, std::vector<Node*>& nodesRef);
+    	static std::vector<Animation> LoadAnimations(const tinygltf::Model& model, const Source& sourceData, std::vector<Node*>& nodesRef);
 
 	private:
 
@@ -1,5 +1,7 @@
 #include "Mesh.h"
 
+#include "Renderer/Vulkan/Context.h"
+#include "Renderer/Vulkan/DeletionQueue.h"
 #include "Renderer/Vulkan/Device.h"
 #include <Common/Debug/Logger.h>
 
@@ -34,12 +36,9 @@ namespace Cosmos::Renderer::GLTF
 
 	Mesh::~Mesh()
 	{
-		COSMOS_LOG(Logger::Info, "Implement deletion queue");
-
-		vkDeviceWaitIdle(mDevice->GetLogicalDevice());
-		
+		// frames in flight may still read the uniform buffer, unmapping doesn't affect them
 		vmaUnmapMemory(mDevice->GetAllocator(), mUniformBuffer.memory);
-		vmaDestroyBuffer(mDevice->GetAllocator(), mUniformBuffer.buffer, mUniformBuffer.memory);
+		((Vulkan::Context*)IContext::GetRef())->GetDeletionQueueRef()->ReleaseBuffer(mUniformBuffer.buffer, mUniformBuffer.memory);
 		
 		for (Primitive* p : mPrimitives) {
 			delete p;
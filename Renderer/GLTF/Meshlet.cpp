@@ -0,0 +1,152 @@
+#include "Meshlet.h"
+
+#include <Common/Core/Defines.h>
+
+namespace Cosmos::Renderer::GLTF
+{
+	bool Meshlet::IsVisible(const Frustum& frustum, const glm::vec3& cameraPosition) const
+	{
+		if (!frustum.ContainsSphere(mCenter, mRadius)) {
+			return false;
+		}
+
+		return !IsBackfacing(cameraPosition);
+	}
+
+	bool Meshlet::IsBackfacing(const glm::vec3& cameraPosition) const
+	{
+		if (mConeCutoff >= 1.0f) {
+			return false;
+		}
+
+		glm::vec3 direction = mCenter - cameraPosition;
+		return glm::dot(direction, mConeAxis) >= mConeCutoff * glm::length(direction) + mRadius;
+	}
+
+	std::vector<Meshlet> Meshlet::Build(const Vertex* vertices, const uint32_t* indices, uint32_t firstIndex, uint32_t indexCount)
+	{
+		std::vector<Meshlet> meshlets = {};
+		uint32_t used[COSMOS_MESHLET_MAX_VERTICES] = {};
+
+		Meshlet current = {};
+		current.mFirstIndex = firstIndex;
+
+		// greedy clustering along the index order, keeps each meshlet a contiguous index range so no index rewrite is required
+		for (uint32_t i = firstIndex; i + 2 < firstIndex + indexCount; i += 3) {
+			uint32_t newVertices = 0;
+
+			for (uint32_t c = 0; c < 3; c++) {
+				bool found = false;
+
+				for (uint32_t v = 0; v < current.mVertexCount; v++) {
+					if (used[v] == indices[i + c]) {
+						found = true;
+						break;
+					}
+				}
+
+				// same vertex repeated in a degenerate triangle
+				if (!found && ((c > 0 && indices[i + c] == indices[i]) || (c > 1 && indices[i + c] == indices[i + 1]))) {
+					found = true;
+				}
+
+				newVertices += found ? 0 : 1;
+			}
+
+			bool full = current.mVertexCount + newVertices > COSMOS_MESHLET_MAX_VERTICES || current.mIndexCount / 3 >= COSMOS_MESHLET_MAX_TRIANGLES;
+
+			if (full) {
+				current.ComputeBounds(vertices, indices);
+				meshlets.push_back(current);
+
+				current = {};
+				current.mFirstIndex = i;
+			}
+
+			for (uint32_t c = 0; c < 3; c++) {
+				bool found = false;
+
+				for (uint32_t v = 0; v < current.mVertexCount; v++) {
+					if (used[v] == indices[i + c]) {
+						found = true;
+						break;
+					}
+				}
+
+				if (!found) {
+					used[current.mVertexCount++] = indices[i + c];
+				}
+			}
+
+			current.mIndexCount += 3;
+		}
+
+		if (current.mIndexCount > 0) {
+			current.ComputeBounds(vertices, indices);
+			meshlets.push_back(current);
+		}
+
+		return meshlets;
+	}
+
+	void Meshlet::ComputeBounds(const Vertex* vertices, const uint32_t* indices)
+	{
+		// bounding sphere, centered on the meshlet aabb
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+
+		for (uint32_t i = mFirstIndex; i < mFirstIndex + mIndexCount; i++) {
+			min = glm::min(min, vertices[indices[i]].position);
+			max = glm::max(max, vertices[indices[i]].position);
+		}
+
+		mCenter = (min + max) * 0.5f;
+		mRadius = 0.0f;
+
+		for (uint32_t i = mFirstIndex; i < mFirstIndex + mIndexCount; i++) {
+			mRadius = glm::max(mRadius, glm::distance(mCenter, vertices[indices[i]].position));
+		}
+
+		// normal cone, from the face normals
+		glm::vec3 axis = glm::vec3(0.0f);
+		uint32_t triangles = 0;
+
+		for (uint32_t i = mFirstIndex; i < mFirstIndex + mIndexCount; i += 3) {
+			glm::vec3 normal = glm::cross(vertices[indices[i + 1]].position - vertices[indices[i]].position, vertices[indices[i + 2]].position - vertices[indices[i]].position);
+			float length = glm::length(normal);
+
+			if (length > 0.0f) {
+				axis += normal / length;
+				triangles++;
+			}
+		}
+
+		float axisLength = glm::length(axis);
+
+		if (triangles == 0 || axisLength <= 0.0f) {
+			mConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+			mConeCutoff = 1.0f;
+			return;
+		}
+
+		mConeAxis = axis / axisLength;
+		float minDot = 1.0f;
+
+		for (uint32_t i = mFirstIndex; i < mFirstIndex + mIndexCount; i += 3) {
+			glm::vec3 normal = glm::cross(vertices[indices[i + 1]].position - vertices[indices[i]].position, vertices[indices[i + 2]].position - vertices[indices[i]].position);
+			float length = glm::length(normal);
+
+			if (length > 0.0f) {
+				minDot = glm::min(minDot, glm::dot(normal / length, mConeAxis));
+			}
+		}
+
+		// spread is too wide (over ~85 degrees), the meshlet is never fully backfacing
+		if (minDot <= 0.1f) {
+			mConeCutoff = 1.0f;
+			return;
+		}
+
+		mConeCutoff = glm::sqrt(1.0f - minDot * minDot);
+	}
+}
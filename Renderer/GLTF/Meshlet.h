@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Core/Vertex.h"
+#include <Common/Math/Frustum.h>
+#include <Common/Math/Math.h>
+#include <vector>
+
+namespace Cosmos::Renderer::GLTF
+{
+	class Meshlet
+	{
+	public:
+
+		// constructor
+		Meshlet() = default;
+
+		// destructor
+		~Meshlet() = default;
+
+		// returns the first index of the meshlet inside the mesh index buffer
+		inline uint32_t GetFirstIndex() const { return mFirstIndex; }
+
+		// returns how many indices the meshlet has
+		inline uint32_t GetIndexCount() const { return mIndexCount; }
+
+		// returns how many unique vertices the meshlet references
+		inline uint32_t GetVertexCount() const { return mVertexCount; }
+
+		// returns the center of the meshlet bounding sphere
+		inline glm::vec3 GetCenter() const { return mCenter; }
+
+		// returns the radius of the meshlet bounding sphere
+		inline float GetRadius() const { return mRadius; }
+
+		// returns the average direction the meshlet triangles are facing
+		inline glm::vec3 GetConeAxis() const { return mConeAxis; }
+
+		// returns the sine of the normal cone spread, 1.0 means the meshlet can't be backface culled
+		inline float GetConeCutoff() const { return mConeCutoff; }
+
+	public:
+
+		// returns if the meshlet is inside the frustum and facing the camera, both must be on meshlet space
+		bool IsVisible(const Frustum& frustum, const glm::vec3& cameraPosition) const;
+
+		// returns if all triangles of the meshlet are facing away from the camera
+		bool IsBackfacing(const glm::vec3& cameraPosition) const;
+
+	public:
+
+		// splits a range of triangles into meshlets, indices must be absolute into the vertices array
+		static std::vector<Meshlet> Build(const Vertex* vertices, const uint32_t* indices, uint32_t firstIndex, uint32_t indexCount);
+
+	private:
+
+		// calculates the bounding sphere and normal cone of the meshlet
+		void ComputeBounds(const Vertex* vertices, const uint32_t* indices);
+
+	private:
+
+		uint32_t mFirstIndex = 0;
+		uint32_t mIndexCount = 0;
+		uint32_t mVertexCount = 0;
+		glm::vec3 mCenter = glm::vec3(0.0f);
+		float mRadius = 0.0f;
+		glm::vec3 mConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+		float mConeCutoff = 1.0f;
+	};
+}
@@ -1,9 +1,13 @@
 #include "Node.h"
 
+#include "Accessor.h"
 #include "Mesh.h"
+#include "Meshlet.h"
+#include "Source.h"
 #include "Skin.h"
 #include "Vulkan/Context.h"
 #include <Common/Debug/Logger.h>
+#include <Common/Util/ThreadPool.h>
 
 namespace Cosmos::Renderer::GLTF
 {
@@ -75,16 +79,22 @@ namespace Cosmos::Renderer::GLTF
 			const tinygltf::Mesh mesh = model.meshes[node.mesh];
 			for (size_t i = 0; i < mesh.primitives.size(); i++) {
 				auto primitive = mesh.primitives[i];
-				vertexCount += model.accessors[primitive.attributes.find("POSITION")->second].count;
+				auto position = primitive.attributes.find("POSITION");
 
-				if (primitive.indices > -1) {
+				if (position == primitive.attributes.end() || position->second < 0 || position->second >= (int)model.accessors.size()) {
+					continue;
+				}
+
+				vertexCount += model.accessors[position->second].count;
+
+				if (primitive.indices > -1 && primitive.indices < (int)model.accessors.size()) {
 					indexCount += model.accessors[primitive.indices].count;
 				}
 			}
 		}
     }
 
-     void Node::LoadNode(Node* parent, const tinygltf::Node& node, uint32_t nodeIndex, const tinygltf::Model& model, MeshLoaderInfo& loader, std::vector<Node*>& nodes, std::vector<Node*>& linearNodes, Material& materialRef, std::vector<Vertex>& verticesRef, float globalScale)
+     void Node::LoadNode(Node* parent, const tinygltf::Node& node, uint32_t nodeIndex, const tinygltf::Model& model, MeshLoaderInfo& loader, std::vector<Node*>& nodes, std::vector<Node*>& linearNodes, Material& materialRef)
 	{
 		GLTF::Node* newNode = new Node(parent, node.name, nodeIndex, node.skin);
 
@@ -114,13 +124,13 @@ namespace Cosmos::Renderer::GLTF
 
 		// call children nodes
 		for(size_t i = 0; i < node.children.size(); i++) {
-			LoadNode(newNode, model.nodes[node.children[i]], node.children[i], model, loader, nodes, linearNodes, materialRef, verticesRef, globalScale);
+			LoadNode(newNode, model.nodes[node.children[i]], node.children[i], model, loader, nodes, linearNodes, materialRef);
 		}
 
 		// node contains mesh data
 		if (node.mesh > -1)
 		{
-			const tinygltf::Mesh mesh = model.meshes[node.mesh];
+			const tinygltf::Mesh& mesh = model.meshes[node.mesh];
 
 			Renderer::Vulkan::Context* renderer = (Renderer::Vulkan::Context*)(Renderer::IContext::GetRef());
 
@@ -129,201 +139,35 @@ namespace Cosmos::Renderer::GLTF
 			for (size_t j = 0; j < mesh.primitives.size(); j++)
 			{
 				const tinygltf::Primitive& primitive = mesh.primitives[j];
-				uint32_t vertexStart = (uint32_t)(loader.vertexPos);
-				uint32_t indexStart = (uint32_t)(loader.indexPos);
-				uint32_t indexCount = 0;
-				uint32_t vertexCount = 0;
-				glm::vec3 posMin = {};
-				glm::vec3 posMax = {};
-				bool hasSkin = false;
-				bool hasIndices = primitive.indices > -1;
-
-				// vertices
-				{
-					const float* bufferPos = nullptr;
-					const float* bufferNormals = nullptr;
-					const float* bufferTexCoordSet0 = nullptr;
-					const float* bufferTexCoordSet1 = nullptr;
-					const float* bufferColorSet0 = nullptr;
-					const void* bufferJoints = nullptr;
-					const float* bufferWeights = nullptr;
-
-					int posByteStride;
-					int normByteStride;
-					int uv0ByteStride;
-					int color0ByteStride;
-					int jointByteStride;
-					int weightByteStride;
-
-					int jointComponentType;
-
-					// Position attribute is required
-					assert(primitive.attributes.find("POSITION") != primitive.attributes.end());
-
-					const tinygltf::Accessor& posAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
-					const tinygltf::BufferView& posView = model.bufferViews[posAccessor.bufferView];
-					bufferPos = reinterpret_cast<const float*>(&(model.buffers[posView.buffer].data[posAccessor.byteOffset + posView.byteOffset]));
-					posMin = glm::vec3(posAccessor.minValues[0], posAccessor.minValues[1], posAccessor.minValues[2]);
-					posMax = glm::vec3(posAccessor.maxValues[0], posAccessor.maxValues[1], posAccessor.maxValues[2]);
-					vertexCount = (uint32_t)(posAccessor.count);
-					posByteStride = posAccessor.ByteStride(posView) ? (posAccessor.ByteStride(posView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
-
-					if (primitive.attributes.find("NORMAL") != primitive.attributes.end()) {
-						const tinygltf::Accessor& normAccessor = model.accessors[primitive.attributes.find("NORMAL")->second];
-						const tinygltf::BufferView& normView = model.bufferViews[normAccessor.bufferView];
-						bufferNormals = reinterpret_cast<const float*>(&(model.buffers[normView.buffer].data[normAccessor.byteOffset + normView.byteOffset]));
-						normByteStride = normAccessor.ByteStride(normView) ? (normAccessor.ByteStride(normView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
-					}
-
-					// uv0
-					if (primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end()) {
-						const tinygltf::Accessor& uvAccessor = model.accessors[primitive.attributes.find("TEXCOORD_0")->second];
-						const tinygltf::BufferView& uvView = model.bufferViews[uvAccessor.bufferView];
-						bufferTexCoordSet0 = reinterpret_cast<const float*>(&(model.buffers[uvView.buffer].data[uvAccessor.byteOffset + uvView.byteOffset]));
-						uv0ByteStride = uvAccessor.ByteStride(uvView) ? (uvAccessor.ByteStride(uvView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC2);
-					}
-
-					// vertex colors
-					if (primitive.attributes.find("COLOR_0") != primitive.attributes.end()) {
-						const tinygltf::Accessor& accessor = model.accessors[primitive.attributes.find("COLOR_0")->second];
-						const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
-						bufferColorSet0 = reinterpret_cast<const float*>(&(model.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
-						color0ByteStride = accessor.ByteStride(view) ? (accessor.ByteStride(view) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC3);
-					}
-
-					// skinning joints
-					if (primitive.attributes.find("JOINTS_0") != primitive.attributes.end()) {
-						const tinygltf::Accessor& jointAccessor = model.accessors[primitive.attributes.find("JOINTS_0")->second];
-						const tinygltf::BufferView& jointView = model.bufferViews[jointAccessor.bufferView];
-						bufferJoints = &(model.buffers[jointView.buffer].data[jointAccessor.byteOffset + jointView.byteOffset]);
-						jointComponentType = jointAccessor.componentType;
-						jointByteStride = jointAccessor.ByteStride(jointView) ? (jointAccessor.ByteStride(jointView) / tinygltf::GetComponentSizeInBytes(jointComponentType)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC4);
-					}
+				std::string reason;
 
-					// skinning weights
-					if (primitive.attributes.find("WEIGHTS_0") != primitive.attributes.end()) {
-						const tinygltf::Accessor& weightAccessor = model.accessors[primitive.attributes.find("WEIGHTS_0")->second];
-						const tinygltf::BufferView& weightView = model.bufferViews[weightAccessor.bufferView];
-						bufferWeights = reinterpret_cast<const float*>(&(model.buffers[weightView.buffer].data[weightAccessor.byteOffset + weightView.byteOffset]));
-						weightByteStride = weightAccessor.ByteStride(weightView) ? (weightAccessor.ByteStride(weightView) / sizeof(float)) : tinygltf::GetNumComponentsInType(TINYGLTF_TYPE_VEC4);
-					}
-
-					hasSkin = (bufferJoints && bufferWeights);
-
-					for (size_t v = 0; v < posAccessor.count; v++) {
-						Vertex& vert = loader.vertexBuffer[loader.vertexPos];
-						vert.position = glm::vec4(glm::make_vec3(&bufferPos[v * posByteStride]), 1.0f);
-						vert.normal = glm::normalize(glm::vec3(bufferNormals ? glm::make_vec3(&bufferNormals[v * normByteStride]) : glm::vec3(0.0f)));
-						vert.uv = bufferTexCoordSet0 ? glm::make_vec2(&bufferTexCoordSet0[v * uv0ByteStride]) : glm::vec3(0.0f);
-						vert.color = bufferColorSet0 ? glm::make_vec4(&bufferColorSet0[v * color0ByteStride]) : glm::vec4(1.0f);
-
-						if (hasSkin) {
-							switch (jointComponentType)
-							{
-								case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-								{
-									const uint16_t* buf = static_cast<const uint16_t*>(bufferJoints);
-									vert.joint = glm::uvec4(glm::make_vec4(&buf[v * jointByteStride]));
-									break;
-								}
-
-								case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-								{
-									const uint8_t* buf = static_cast<const uint8_t*>(bufferJoints);
-									vert.joint = glm::vec4(glm::make_vec4(&buf[v * jointByteStride]));
-									break;
-								}
-
-								default:
-								{
-									COSMOS_LOG(Logger::Error, "Joint component type %d is not supported", jointComponentType);
-									break;
-								}
-							}
-						}
-
-						else {
-							vert.joint = glm::vec4(0.0f);
-						}
-
-						vert.weight = hasSkin ? glm::make_vec4(&bufferWeights[v * weightByteStride]) : glm::vec4(0.0f);
-
-						// fix for all zero weights
-						if (glm::length(vert.weight) == 0.0f) {
-							vert.weight = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-						}
-
-						loader.vertexPos++;
-						verticesRef[v] = vert;
-					}
+				// the decoding reads straight from the mapped buffers, an accessor out of them would read past the file
+				if (!IsPrimitiveValid(model, primitive, *loader.source, reason)) {
+					COSMOS_LOG(Logger::Error, "Skipping primitive %zu of mesh %s, %s", j, mesh.name.c_str(), reason.c_str());
+					continue;
 				}
 
-				// indices
-				if (hasIndices) {
-					const tinygltf::Accessor& accessor = model.accessors[primitive.indices > -1 ? primitive.indices : 0];
-					const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-					const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
-
-					indexCount = (uint32_t)(accessor.count);
-					const void* dataPtr = &(buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-
-					switch (accessor.componentType)
-					{
-						case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT:
-						{
-							const uint32_t* buf = (const uint32_t*)(dataPtr);
-							for (size_t index = 0; index < accessor.count; index++) {
-								loader.indexBuffer[loader.indexPos] = buf[index] + vertexStart;
-								loader.indexPos++;
-							}
-
-							break;
-						}
-
-						case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT:
-						{
-							const uint16_t* buf = (const uint16_t*)(dataPtr);
-							for (size_t index = 0; index < accessor.count; index++) {
-								loader.indexBuffer[loader.indexPos] = buf[index] + vertexStart;
-								loader.indexPos++;
-							}
-
-							break;
-						}
-
-						case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE:
-						{
-							const uint8_t* buf = (const uint8_t*)(dataPtr);
-							for (size_t index = 0; index < accessor.count; index++) {
-								loader.indexBuffer[loader.indexPos] = buf[index] + vertexStart;
-								loader.indexPos++;
-							}
-
-							break;
-						}
-
-						default:
-						{
-							COSMOS_LOG(Logger::Error, "Inex component type %d is not supported");
-							return;
-						}
-					}
-				}
+				const tinygltf::Accessor& posAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
+				glm::vec3 posMin = glm::vec3(posAccessor.minValues[0], posAccessor.minValues[1], posAccessor.minValues[2]);
+				glm::vec3 posMax = glm::vec3(posAccessor.maxValues[0], posAccessor.maxValues[1], posAccessor.maxValues[2]);
+				uint32_t vertexCount = (uint32_t)(posAccessor.count);
+				uint32_t indexCount = primitive.indices > -1 ? (uint32_t)(model.accessors[primitive.indices].count) : 0;
 
-				GLTF::Primitive* newPrimitive = new GLTF::Primitive(materialRef, vertexCount, indexCount, indexStart);
+				GLTF::Primitive* newPrimitive = new GLTF::Primitive(materialRef, vertexCount, indexCount, (uint32_t)loader.indexPos);
 				newPrimitive->SetBoundingBox(posMin, posMax);
 				newMesh->GetPrimitivesRef().push_back(newPrimitive);
-			}
 
-			// set mesh bounding box from bounding boxes of primitives
-			for (auto p : newMesh->GetPrimitivesRef()) {
-				if (p->GetBoundingBoxRef().IsValid() && !newMesh->GetBoundingBoxRef().IsValid()) {
-					newMesh->GetBoundingBoxRef() = p->GetBoundingBoxRef();
-					newMesh->GetBoundingBoxRef().SetValid(true);;
-				}
-
-				newMesh->GetBoundingBoxRef().SetMin(glm::min(newMesh->GetBoundingBoxRef().GetMin(), p->GetBoundingBoxRef().GetMin()));
-				newMesh->GetBoundingBoxRef().SetMax(glm::max(newMesh->GetBoundingBoxRef().GetMax(), p->GetBoundingBoxRef().GetMax()));
+				// reserve the primitive range, decoding happens later on LoadPrimitives
+				PrimitiveLoaderInfo info = {};
+				info.primitive = newPrimitive;
+				info.mesh = newMesh;
+				info.source = &primitive;
+				info.vertexStart = loader.vertexPos;
+				info.indexStart = loader.indexPos;
+				loader.primitives.push_back(info);
+
+				loader.vertexPos += vertexCount;
+				loader.indexPos += indexCount;
 			}
 
 			newNode->SetMesh(newMesh);
@@ -372,4 +216,221 @@ namespace Cosmos::Renderer::GLTF
 		}
 		return found;
     }
+
+	void Node::LoadPrimitives(const tinygltf::Model& model, MeshLoaderInfo& loader, float globalScale)
+	{
+		ThreadPool::GetRef().ParallelFor(loader.primitives.size(), [&](size_t i)
+			{
+				LoadPrimitive(model, loader, loader.primitives[i], globalScale);
+			});
+
+		// set mesh bounding box from bounding boxes of primitives, only now they follow the scaled positions
+		for (const PrimitiveLoaderInfo& info : loader.primitives) {
+			Mesh* mesh = info.mesh;
+			Primitive* p = info.primitive;
+
+			if (p->GetBoundingBoxRef().IsValid() && !mesh->GetBoundingBoxRef().IsValid()) {
+				mesh->GetBoundingBoxRef() = p->GetBoundingBoxRef();
+				mesh->GetBoundingBoxRef().SetValid(true);
+			}
+
+			mesh->GetBoundingBoxRef().SetMin(glm::min(mesh->GetBoundingBoxRef().GetMin(), p->GetBoundingBoxRef().GetMin()));
+			mesh->GetBoundingBoxRef().SetMax(glm::max(mesh->GetBoundingBoxRef().GetMax(), p->GetBoundingBoxRef().GetMax()));
+		}
+	}
+
+	bool Node::IsPrimitiveValid(const tinygltf::Model& model, const tinygltf::Primitive& primitive, const Source& source, std::string& reason)
+	{
+		auto position = primitive.attributes.find("POSITION");
+
+		if (position == primitive.attributes.end()) {
+			reason = "it has no positions";
+			return false;
+		}
+
+		// every accessor is checked, even the ones the decoding doesn't use yet
+		for (const auto& attribute : primitive.attributes) {
+			if (attribute.second < 0 || attribute.second >= (int)model.accessors.size() || !source.IsAccessorValid(model, model.accessors[attribute.second])) {
+				reason = "attribute " + attribute.first + " lies outside it's buffer";
+				return false;
+			}
+		}
+
+		const tinygltf::Accessor& positions = model.accessors[position->second];
+
+		if (positions.minValues.size() != 3 || positions.maxValues.size() != 3) {
+			reason = "positions have no bounds";
+			return false;
+		}
+
+		// attributes are decoded as floats of a fixed size, joints as small integers, and must cover every position
+		struct Layout { const char* name; int type; int type2; bool joints; };
+		const Layout layouts[] =
+		{
+			{ "POSITION", TINYGLTF_TYPE_VEC3, TINYGLTF_TYPE_VEC3, false },
+			{ "NORMAL", TINYGLTF_TYPE_VEC3, TINYGLTF_TYPE_VEC3, false },
+			{ "TEXCOORD_0", TINYGLTF_TYPE_VEC2, TINYGLTF_TYPE_VEC2, false },
+			{ "COLOR_0", TINYGLTF_TYPE_VEC3, TINYGLTF_TYPE_VEC4, false },
+			{ "JOINTS_0", TINYGLTF_TYPE_VEC4, TINYGLTF_TYPE_VEC4, true },
+			{ "WEIGHTS_0", TINYGLTF_TYPE_VEC4, TINYGLTF_TYPE_VEC4, false }
+		};
+
+		for (const Layout& layout : layouts) {
+			auto it = primitive.attributes.find(layout.name);
+
+			if (it == primitive.attributes.end()) {
+				continue;
+			}
+
+			const tinygltf::Accessor& accessor = model.accessors[it->second];
+			bool componentValid = layout.joints
+				? (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+				: accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT;
+
+			if (!componentValid || (accessor.type != layout.type && accessor.type != layout.type2) || accessor.count < positions.count) {
+				reason = std::string("attribute ") + layout.name + " has an unsupported layout";
+				return false;
+			}
+		}
+
+		if (primitive.indices > -1) {
+			if (primitive.indices >= (int)model.accessors.size() || !source.IsAccessorValid(model, model.accessors[primitive.indices])) {
+				reason = "indices lie outside their buffer";
+				return false;
+			}
+
+			const tinygltf::Accessor& indices = model.accessors[primitive.indices];
+			bool componentValid = indices.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
+				|| indices.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT
+				|| indices.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+
+			// indices are read tightly packed
+			if (!componentValid || indices.type != TINYGLTF_TYPE_SCALAR || model.bufferViews[indices.bufferView].byteStride != 0) {
+				reason = "indices have an unsupported layout";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void Node::LoadPrimitive(const tinygltf::Model& model, MeshLoaderInfo& loader, const PrimitiveLoaderInfo& info, float globalScale)
+	{
+		const tinygltf::Primitive& primitive = *info.source;
+		Vertex* vertices = &loader.vertexBuffer[info.vertexStart];
+		size_t vertexCount = info.primitive->GetVertexCount();
+		const size_t stride = sizeof(Vertex);
+
+		// returns the accessor data and it's stride in components, or nullptr if the primitive doesn't have the attribute
+		auto getAttribute = [&](const char* name, int defaultType, size_t& componentStride) -> const void*
+			{
+				auto it = primitive.attributes.find(name);
+
+				if (it == primitive.attributes.end()) {
+					return nullptr;
+				}
+
+				const tinygltf::Accessor& accessor = model.accessors[it->second];
+				const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+				int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+				componentStride = accessor.ByteStride(view) ? (accessor.ByteStride(view) / componentSize) : tinygltf::GetNumComponentsInType(defaultType);
+				return loader.source->GetAccessorData(model, accessor);
+			};
+
+		// vertices, decoded attribute by attribute
+		{
+			size_t posStride = 0, normStride = 0, uv0Stride = 0, color0Stride = 0, jointStride = 0, weightStride = 0;
+			const float* bufferPos = (const float*)getAttribute("POSITION", TINYGLTF_TYPE_VEC3, posStride);
+			const float* bufferNormals = (const float*)getAttribute("NORMAL", TINYGLTF_TYPE_VEC3, normStride);
+			const float* bufferTexCoordSet0 = (const float*)getAttribute("TEXCOORD_0", TINYGLTF_TYPE_VEC2, uv0Stride);
+			auto colorAttribute = primitive.attributes.find("COLOR_0");
+			int colorType = colorAttribute != primitive.attributes.end() ? model.accessors[colorAttribute->second].type : TINYGLTF_TYPE_VEC4;
+			const float* bufferColorSet0 = (const float*)getAttribute("COLOR_0", colorType, color0Stride);
+			const void* bufferJoints = getAttribute("JOINTS_0", TINYGLTF_TYPE_VEC4, jointStride);
+			const float* bufferWeights = (const float*)getAttribute("WEIGHTS_0", TINYGLTF_TYPE_VEC4, weightStride);
+			bool hasSkin = (bufferJoints && bufferWeights);
+
+			const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			const float one[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+			GatherFloats(bufferPos, posStride, 3, vertexCount, globalScale, &vertices->position, stride);
+
+			// accessor bounds are read before decoding, they must follow the scaled positions
+			BoundingBox& bounds = info.primitive->GetBoundingBoxRef();
+			info.primitive->SetBoundingBox(bounds.GetMin() * globalScale, bounds.GetMax() * globalScale);
+
+			if (bufferNormals) GatherFloats(bufferNormals, normStride, 3, vertexCount, 1.0f, &vertices->normal, stride);
+			else FillFloats(zero, 3, vertexCount, &vertices->normal, stride);
+			NormalizeVec3(&vertices->normal, stride, vertexCount);
+
+			if (bufferTexCoordSet0) GatherFloats(bufferTexCoordSet0, uv0Stride, 2, vertexCount, 1.0f, &vertices->uv, stride);
+			else FillFloats(zero, 2, vertexCount, &vertices->uv, stride);
+
+			// rgb colors keep an alpha of one
+			if (!bufferColorSet0 || colorType == TINYGLTF_TYPE_VEC3) FillFloats(one, 4, vertexCount, &vertices->color, stride);
+			if (bufferColorSet0) GatherFloats(bufferColorSet0, color0Stride, colorType == TINYGLTF_TYPE_VEC3 ? 3 : 4, vertexCount, 1.0f, &vertices->color, stride);
+
+			if (hasSkin) {
+				int jointComponentType = model.accessors[primitive.attributes.find("JOINTS_0")->second].componentType;
+				WidenJoints(bufferJoints, jointComponentType, jointStride, vertexCount, &vertices->joint, stride);
+				GatherFloats(bufferWeights, weightStride, 4, vertexCount, 1.0f, &vertices->weight, stride);
+			}
+
+			else {
+				FillFloats(zero, 4, vertexCount, &vertices->joint, stride);
+				FillFloats(zero, 4, vertexCount, &vertices->weight, stride);
+			}
+
+			FixZeroWeights(&vertices->weight, stride, vertexCount);
+		}
+
+		// indices
+		if (primitive.indices > -1) {
+			const tinygltf::Accessor& accessor = model.accessors[primitive.indices];
+			const void* dataPtr = loader.source->GetAccessorData(model, accessor);
+			uint32_t* indices = &loader.indexBuffer[info.indexStart];
+			uint32_t vertexStart = (uint32_t)info.vertexStart;
+
+			switch (accessor.componentType)
+			{
+				case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT:
+				{
+					const uint32_t* buf = (const uint32_t*)(dataPtr);
+					for (size_t index = 0; index < accessor.count; index++) {
+						indices[index] = buf[index] + vertexStart;
+					}
+
+					break;
+				}
+
+				case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT:
+				{
+					const uint16_t* buf = (const uint16_t*)(dataPtr);
+					for (size_t index = 0; index < accessor.count; index++) {
+						indices[index] = buf[index] + vertexStart;
+					}
+
+					break;
+				}
+
+				case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE:
+				{
+					const uint8_t* buf = (const uint8_t*)(dataPtr);
+					for (size_t index = 0; index < accessor.count; index++) {
+						indices[index] = buf[index] + vertexStart;
+					}
+
+					break;
+				}
+
+				default:
+				{
+					COSMOS_LOG(Logger::Error, "Index component type %d is not supported", accessor.componentType);
+					return;
+				}
+			}
+
+			info.primitive->GetMeshletsRef() = GLTF::Meshlet::Build(loader.vertexBuffer, loader.indexBuffer, (uint32_t)info.indexStart, info.primitive->GetIndexCount());
+		}
+	}
 }
\ No newline at end of file
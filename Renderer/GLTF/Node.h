@@ -9,7 +9,9 @@
 
 // forward declarations
 namespace Cosmos::Renderer::GLTF { class Mesh; }
+namespace Cosmos::Renderer::GLTF { class Primitive; }
 namespace Cosmos::Renderer::GLTF { class Skin; }
+namespace Cosmos::Renderer::GLTF { class Source; }
 
 namespace Cosmos::Renderer::GLTF
 {
@@ -78,19 +80,34 @@ namespace Cosmos::Renderer::GLTF
 
 	public:
 
+		struct PrimitiveLoaderInfo
+		{
+			Primitive* primitive = nullptr;
+			Mesh* mesh = nullptr;						// owns the primitive, it's bounds are merged once the primitive is decoded
+			const tinygltf::Primitive* source = nullptr;
+			size_t vertexStart = 0;
+			size_t indexStart = 0;
+		};
+
 		struct MeshLoaderInfo
 		{
 			uint32_t* indexBuffer;
 			Vertex* vertexBuffer;
 			size_t indexPos = 0;
 			size_t vertexPos = 0;
+			Source* source = nullptr;
+			std::vector<PrimitiveLoaderInfo> primitives = {};
 		};
 
-		// returns the tinygltf node vertex and index count
+		// returns the tinygltf node vertex and index count, an upper bound since primitives failing validation are skipped later
 		static void GetNodeVertexAndIndexCount(const tinygltf::Node& node, const tinygltf::Model& model, size_t& vertexCount, size_t& indexCount);
 
-    	// loads the node and it's children into the vector of vertices
-    	static void LoadNode(Node* parent, const tinygltf::Node& node, uint32_t nodeIndex, const tinygltf::Model& model, MeshLoaderInfo& loader, std::vector<Node*>& nodes, std::vector<Node*>& linearNodes, Material& materialRef, std::vector<Vertex>& verticesRef, float globalScale = 1.0f);
+    	// loads the node and it's children, reserving their primitives range on the loader vertex and index buffers
+    	static void LoadNode(Node* parent, const tinygltf::Node& node, uint32_t nodeIndex, const tinygltf::Model& model, MeshLoaderInfo& loader, std::vector<Node*>& nodes, std::vector<Node*>& linearNodes, Material& materialRef);
+
+		// decodes all reserved primitives into the loader vertex and index buffers, each primitive is decoded by a worker thread
+		// the mesh bounds are merged from the primitive ones afterwards, when they're already scaled
+		static void LoadPrimitives(const tinygltf::Model& model, MeshLoaderInfo& loader, float globalScale = 1.0f);
 
 		// returns the node index starting by the root of nodes
 		static Node* GetNodeFromIndex(uint32_t index, std::vector<Node*>& nodesRef);
@@ -100,6 +117,12 @@ namespace Cosmos::Renderer::GLTF
 		// returns the node index, starting by a parent
 		static Node* GetNode(Node* parent, uint32_t index);
 
+		// returns if every accessor of a primitive can be read and has the layout the decoding expects, otherwise tells why on reason
+		static bool IsPrimitiveValid(const tinygltf::Model& model, const tinygltf::Primitive& primitive, const Source& source, std::string& reason);
+
+		// decodes the vertices and indices of a single primitive into it's reserved range
+		static void LoadPrimitive(const tinygltf::Model& model, MeshLoaderInfo& loader, const PrimitiveLoaderInfo& info, float globalScale);
+
 	private:
 
 		Node* mParent = nullptr;
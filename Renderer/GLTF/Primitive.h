@@ -1,7 +1,9 @@
 #pragma once
 
+#include "Meshlet.h"
 #include "Core/Material.h"
 #include <Common/Math/BoundingBox.h>
+#include <vector>
 
 namespace Cosmos::Renderer::GLTF
 {
@@ -33,6 +35,9 @@ namespace Cosmos::Renderer::GLTF
 		// returns how many vertices the primitive has
 		inline uint32_t GetVertexCount() { return mVertexCount; }
 
+		// returns a reference to the clusters of triangles the primitive is split into
+		inline std::vector<Meshlet>& GetMeshletsRef() { return mMeshlets; }
+
 	public:
 
 		// calculates the bounding box of this primitive
@@ -45,5 +50,6 @@ namespace Cosmos::Renderer::GLTF
 		uint32_t mFirstIndex = 0;
 		uint32_t mIndexCount = 0;
 		uint32_t mVertexCount = 0;
+		std::vector<Meshlet> mMeshlets = {};
 	};
 }
\ No newline at end of file
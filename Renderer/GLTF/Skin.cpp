@@ -1,10 +1,11 @@
 #include "Skin.h"
 
 #include "Node.h"
+#include "Source.h"
 
 namespace Cosmos::Renderer::GLTF
 {
-    std::vector<Skin*> Skin::LoadSkins(const tinygltf::Model &model, std::vector<Node*>& nodesRef)
+    std::vector<Skin*> Skin::LoadSkins(const tinygltf::Model &model, const Source& sourceData, std::vector<Node*>& nodesRef)
     {
         std::vector<Skin*> skins = {};
 
@@ -29,10 +30,8 @@ namespace Cosmos::Renderer::GLTF
 			// get inverse bind matrices from buffer
 			if (source.inverseBindMatrices > -1) {
 				const tinygltf::Accessor& accessor = model.accessors[source.inverseBindMatrices];
-				const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-				const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
 				newSkin->GetInverseBindMatrices().resize(accessor.count);
-				memcpy(newSkin->GetInverseBindMatrices().data(), &buffer.data[accessor.byteOffset + bufferView.byteOffset], accessor.count * sizeof(glm::mat4));
+				memcpy(newSkin->GetInverseBindMatrices().data(), sourceData.GetAccessorData(model, accessor), accessor.count * sizeof(glm::mat4));
 			}
 
 			skins.push_back(newSkin);
@@ -7,6 +7,7 @@
 
 // forward declarations
 namespace Cosmos::Renderer::GLTF { class Node; }
+namespace Cosmos::Renderer::GLTF { class Source; }
 namespace Cosmos::Renderer::Vulkan { class Device; }
 
 namespace Cosmos::Renderer::GLTF
@@ -39,7 +40,7 @@ namespace Cosmos::Renderer::GLTF
 	public:
 
 		// loads and returns the model skins
-		static std::vector<Skin*> LoadSkins(const tinygltf::Model& model, std::vector<Node*>& nodesRef);
+		static std::vector<Skin*> LoadSkins(const tinygltf::Model& model, const Source& sourceData, std::vector<Node*>& nodesRef);
 
 	private:
 
@@ -0,0 +1,228 @@
+#include "Source.h"
+
+#include <document.h>
+#include <stringbuffer.h>
+#include <writer.h>
+
+#include <cstring>
+#include <filesystem>
+
+namespace Cosmos::Renderer::GLTF
+{
+	// glb container layout, all values are little-endian
+	static constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+	static constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+	static constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942; // "BIN\0"
+
+	// smallest buffer tinygltf accepts, replaces buffers that are read from mapped memory
+	static const char* s_PlaceholderURI = "data:application/octet-stream;base64,AA==";
+
+	// returns the value of an hex digit, -1 if it's not one
+	static int32_t HexDigit(char c)
+	{
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	// decodes %XX escapes on uris, returns false if an escape is cut short or isn't hex
+	static bool DecodeURI(const std::string& uri, std::string& decoded)
+	{
+		decoded.clear();
+
+		for (size_t i = 0; i < uri.size(); i++) {
+			if (uri[i] != '%') {
+				decoded.push_back(uri[i]);
+				continue;
+			}
+
+			int32_t high = i + 2 < uri.size() ? HexDigit(uri[i + 1]) : -1;
+			int32_t low = i + 2 < uri.size() ? HexDigit(uri[i + 2]) : -1;
+
+			if (high < 0 || low < 0) {
+				return false;
+			}
+
+			decoded.push_back((char)(high * 16 + low));
+			i += 2;
+		}
+
+		return true;
+	}
+
+	bool Source::Load(std::string path, tinygltf::Model& model, std::string& error, std::string& warning)
+	{
+		if (!mFile.Open(path)) {
+			error = "Could not open file " + path;
+			return false;
+		}
+
+		const char* json = (const char*)mFile.GetData();
+		size_t jsonSize = mFile.GetSize();
+		const uint8_t* binary = nullptr;
+		size_t binarySize = 0;
+
+		// binary gltf, json and binary chunks are located on the mapped file
+		uint32_t header[5] = {};
+
+		if (mFile.GetSize() >= sizeof(header)) {
+			memcpy(header, mFile.GetData(), sizeof(header));
+		}
+
+		if (header[0] == GLB_MAGIC) {
+			if (header[1] != 2 || header[2] > mFile.GetSize() || header[4] != GLB_CHUNK_JSON || 20ull + header[3] > header[2]) {
+				error = "Invalid glb header on " + path;
+				return false;
+			}
+
+			json = (const char*)(mFile.GetData() + 20);
+			jsonSize = header[3];
+
+			size_t binaryChunk = 20 + (size_t)header[3];
+
+			if (binaryChunk + 8 <= header[2]) {
+				uint32_t chunk[2] = {};
+				memcpy(chunk, mFile.GetData() + binaryChunk, sizeof(chunk));
+
+				if (chunk[1] == GLB_CHUNK_BIN && binaryChunk + 8 + chunk[0] <= header[2]) {
+					binary = mFile.GetData() + binaryChunk + 8;
+					binarySize = chunk[0];
+				}
+			}
+		}
+
+		rapidjson::Document document;
+		document.Parse(json, jsonSize);
+
+		if (document.HasParseError() || !document.IsObject()) {
+			error = "Failed to parse json of " + path;
+			return false;
+		}
+
+		// map external and embedded buffers, replacing them with a placeholder so tinygltf doesn't read them
+		std::string baseDir = std::filesystem::path(path).parent_path().string();
+		auto& allocator = document.GetAllocator();
+		mBuffers.clear();
+		mBufferSizes.clear();
+
+		if (document.HasMember("buffers") && document["buffers"].IsArray()) {
+			for (auto& buffer : document["buffers"].GetArray()) {
+				if (!buffer.IsObject()) {
+					error = "Invalid buffer on " + path;
+					return false;
+				}
+
+				size_t byteLength = buffer.HasMember("byteLength") && buffer["byteLength"].IsUint64() ? (size_t)buffer["byteLength"].GetUint64() : 0;
+				std::string uri = buffer.HasMember("uri") && buffer["uri"].IsString() ? buffer["uri"].GetString() : "";
+				const uint8_t* data = nullptr;
+
+				// data uris are small enough to be left for tinygltf
+				if (uri.rfind("data:", 0) == 0) {
+					mBuffers.push_back(nullptr);
+					mBufferSizes.push_back(0);
+					continue;
+				}
+
+				if (uri.empty()) {
+					if (binary == nullptr || byteLength > binarySize) {
+						error = "Buffer without uri is not backed by the glb binary chunk on " + path;
+						return false;
+					}
+
+					data = binary;
+				}
+
+				else {
+					std::string decoded = {};
+
+					if (!DecodeURI(uri, decoded)) {
+						error = "Invalid escape on buffer uri " + uri + " of " + path;
+						return false;
+					}
+
+					Unique<MappedFile> file = CreateUnique<MappedFile>();
+					std::string filepath = (std::filesystem::path(baseDir) / decoded).string();
+
+					if (!file->Open(filepath) || file->GetSize() < byteLength) {
+						error = "Could not map buffer " + filepath;
+						return false;
+					}
+
+					data = file->GetData();
+					mExternalFiles.push_back(std::move(file));
+				}
+
+				mBuffers.push_back(data);
+				mBufferSizes.push_back(byteLength);
+				mMappedBytes += byteLength;
+
+				// a missing or malformed byteLength is replaced as well, the placeholder is a single byte
+				buffer.RemoveMember("uri");
+				buffer.AddMember("uri", rapidjson::Value(s_PlaceholderURI, allocator), allocator);
+				buffer.RemoveMember("byteLength");
+				buffer.AddMember("byteLength", rapidjson::Value((uint64_t)1), allocator);
+			}
+		}
+
+		document.RemoveMember("images");
+		document.RemoveMember("textures");
+
+		rapidjson::StringBuffer stripped;
+		rapidjson::Writer<rapidjson::StringBuffer> writer(stripped);
+		document.Accept(writer);
+
+		tinygltf::TinyGLTF context;
+		bool loaded = context.LoadASCIIFromString(&model, &error, &warning, stripped.GetString(), (unsigned int)stripped.GetSize(), baseDir);
+
+		if (!loaded) {
+			return false;
+		}
+
+		for (size_t i = 0; i < mBuffers.size() && i < model.buffers.size(); i++) {
+			if (mBuffers[i] == nullptr) {
+				mBuffers[i] = model.buffers[i].data.data();
+				mBufferSizes[i] = model.buffers[i].data.size();
+			}
+		}
+
+		return true;
+	}
+
+	const uint8_t* Source::GetAccessorData(const tinygltf::Model& model, const tinygltf::Accessor& accessor) const
+	{
+		const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+		return mBuffers[view.buffer] + view.byteOffset + accessor.byteOffset;
+	}
+
+	bool Source::IsAccessorValid(const tinygltf::Model& model, const tinygltf::Accessor& accessor) const
+	{
+		if (accessor.sparse.isSparse || accessor.bufferView < 0 || accessor.bufferView >= (int32_t)model.bufferViews.size()) {
+			return false;
+		}
+
+		const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+
+		if (view.buffer < 0 || view.buffer >= (int32_t)mBuffers.size() || mBuffers[view.buffer] == nullptr || view.byteOffset + view.byteLength > mBufferSizes[view.buffer]) {
+			return false;
+		}
+
+		int32_t componentSize = tinygltf::GetComponentSizeInBytes((uint32_t)accessor.componentType);
+		int32_t componentCount = tinygltf::GetNumComponentsInType((uint32_t)accessor.type);
+
+		if (componentSize <= 0 || componentCount <= 0) {
+			return false;
+		}
+
+		// the last element only needs it's own size, not a whole stride
+		size_t elementSize = (size_t)componentSize * (size_t)componentCount;
+		int32_t stride = accessor.ByteStride(view);
+
+		if (stride <= 0 || accessor.byteOffset + elementSize > view.byteLength) {
+			return false;
+		}
+
+		// divided instead of multiplied, counts come from the file and may overflow
+		return accessor.count == 0 || accessor.count - 1 <= (view.byteLength - accessor.byteOffset - elementSize) / (size_t)stride;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Wrapper/tinygltf.h"
+#include <Common/File/MappedFile.h>
+#include <Common/Util/Memory.h>
+#include <string>
+#include <vector>
+
+namespace Cosmos::Renderer::GLTF
+{
+	// loads .gltf and .glb files, binary buffers are memory-mapped and read in-place instead of copied into tinygltf::Buffer
+	class Source
+	{
+	public:
+
+		// constructor
+		Source() = default;
+
+		// destructor
+		~Source() = default;
+
+		// returns how many bytes of buffers are being read straight from mapped files
+		inline size_t GetMappedBytes() const { return mMappedBytes; }
+
+	public:
+
+		// parses the gltf/glb file and resolves all it's buffers, images are not loaded since meshes don't use them
+		bool Load(std::string path, tinygltf::Model& model, std::string& error, std::string& warning);
+
+		// returns the address of the first element of an accessor
+		const uint8_t* GetAccessorData(const tinygltf::Model& model, const tinygltf::Accessor& accessor) const;
+
+		// returns if every element of an accessor lies within it's buffer view and the view within it's buffer, sparse or view-less accessors aren't
+		bool IsAccessorValid(const tinygltf::Model& model, const tinygltf::Accessor& accessor) const;
+
+	private:
+
+		MappedFile mFile;
+		std::vector<Unique<MappedFile>> mExternalFiles = {};
+		std::vector<const uint8_t*> mBuffers = {};
+		std::vector<size_t> mBufferSizes = {};
+		size_t mMappedBytes = 0;
+	};
+}
@@ -154,6 +154,7 @@ namespace Cosmos::Renderer
 	bool CustomWidget::Vector3Control(const char* label, glm::vec3& values)
 	{
 		ImGui::PushID(label);
+		bool changed = false;
 
 		constexpr ImVec4 colorX = ImVec4{ 0.8f, 0.1f, 0.15f, 1.0f };
 		constexpr ImVec4 colorY = ImVec4{ 0.25f, 0.7f, 0.2f, 1.0f };
@@ -169,7 +170,7 @@ namespace Cosmos::Renderer
 			ImGui::SmallButton("X");
 			ImGui::SameLine();
 			ImGui::PushItemWidth(50);
-			ImGui::DragFloat("##X", &values.x, 0.1f, 0.0f, 0.0f, "%.2f");
+			changed |= ImGui::DragFloat("##X", &values.x, 0.1f, 0.0f, 0.0f, "%.2f");
 			ImGui::SameLine();
 			ImGui::PopItemWidth();
 
@@ -185,7 +186,7 @@ namespace Cosmos::Renderer
 			ImGui::SmallButton("Y");
 			ImGui::SameLine();
 			ImGui::PushItemWidth(50);
-			ImGui::DragFloat("##Y", &values.y, 0.1f, 0.0f, 0.0f, "%.2f");
+			changed |= ImGui::DragFloat("##Y", &values.y, 0.1f, 0.0f, 0.0f, "%.2f");
 			ImGui::SameLine();
 			ImGui::PopItemWidth();
 
@@ -201,7 +202,7 @@ namespace Cosmos::Renderer
 			ImGui::SmallButton("Z");
 			ImGui::SameLine();
 			ImGui::PushItemWidth(50);
-			ImGui::DragFloat("##Z", &values.z, 0.1f, 0.0f, 0.0f, "%.2f");
+			changed |= ImGui::DragFloat("##Z", &values.z, 0.1f, 0.0f, 0.0f, "%.2f");
 			ImGui::SameLine();
 			ImGui::PopItemWidth();
 
@@ -212,7 +213,7 @@ namespace Cosmos::Renderer
 
 		ImGui::PopID();
 
-		return true;
+		return changed;
 	}
 
 	void CustomWidget::TextCentered(std::string text)
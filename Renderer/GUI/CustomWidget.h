@@ -15,7 +15,7 @@ namespace Cosmos::Renderer
 		// custom checkbox with color on the selected mark
 		static bool Checkbox(const char* label, bool* v);
 
-		// custom vector-3 controls
+		// custom vector-3 controls, returns if any of the values was changed
 		static bool Vector3Control(const char* label, glm::vec3& values);
 
 		// adds a centered text on the window
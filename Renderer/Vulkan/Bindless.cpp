@@ -0,0 +1,344 @@
+#if defined RENDERER_VULKAN
+#include "Bindless.h"
+
+#include "Buffer.h"
+#include "Device.h"
+
+#include <Common/Core/Defines.h>
+#include <Common/Debug/Logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	Bindless::Bindless(Shared<Device> device, Library<Shared<Buffer>>& buffersLib)
+		: mDevice(device), mBuffersLib(buffersLib)
+	{
+		COSMOS_ASSERT(mDevice->IsDescriptorIndexingSupported(), "Descriptor indexing (non-uniform indexing, partially bound and update after bind sampled images) is required by the global descriptor set");
+
+		mPendingTextures.resize(CONCURENTLY_RENDERED_FRAMES);
+		mPendingMaterials.resize(CONCURENTLY_RENDERED_FRAMES);
+
+		// material records are read by the frame being rendered, each frame has it's copy
+		mBuffersLib.Insert("Materials", CreateShared<Buffer>(mDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(Material) * COSMOS_BINDLESS_MAX_MATERIALS));
+
+		for (size_t i = 0; i < CONCURENTLY_RENDERED_FRAMES; i++) {
+			memset(mBuffersLib.GetRef("Materials")->GetMappedDataRef()[i], 0, sizeof(Material) * COSMOS_BINDLESS_MAX_MATERIALS);
+		}
+
+		CreateDescriptors();
+	}
+
+	Bindless::~Bindless()
+	{
+		vkDeviceWaitIdle(mDevice->GetLogicalDevice());
+
+		vkDestroyDescriptorPool(mDevice->GetLogicalDevice(), mDescriptorPool, nullptr);
+		vkDestroyDescriptorSetLayout(mDevice->GetLogicalDevice(), mDescriptorSetLayout, nullptr);
+
+		mBuffersLib.Erase("Materials");
+	}
+
+	void Bindless::BeginFrame(uint32_t currentFrame)
+	{
+		mRecordingFrame = currentFrame;
+		mStatistics.writes = 0;
+
+		Flush(currentFrame);
+	}
+
+	void Bindless::EndFrame()
+	{
+		mRecordingFrame = Invalid;
+	}
+
+	uint32_t Bindless::RegisterTexture(VkImageView view, VkSampler sampler)
+	{
+		uint32_t index = Invalid;
+
+		if (!mFreeTextures.empty()) {
+			index = mFreeTextures.back();
+			mFreeTextures.pop_back();
+		}
+
+		else if (mTextures.size() < mMaxTextures) {
+			index = (uint32_t)mTextures.size();
+			mTextures.emplace_back();
+		}
+
+		else {
+			COSMOS_LOG(Logger::Error, "The global descriptor set has no room for more than %u textures", mMaxTextures);
+			return Invalid;
+		}
+
+		mTextures[index].used = true;
+		mStatistics.textures++;
+
+		UpdateTexture(index, view, sampler);
+		return index;
+	}
+
+	void Bindless::UpdateTexture(uint32_t index, VkImageView view, VkSampler sampler)
+	{
+		if (index >= mTextures.size() || !mTextures[index].used) {
+			return;
+		}
+
+		mTextures[index].view = view;
+		mTextures[index].sampler = sampler;
+
+		for (auto& pending : mPendingTextures) {
+			pending.push_back(index);
+		}
+
+		// the frame being recorded is not in use by the gpu, the textures binding may be written after it was bound
+		if (mRecordingFrame != Invalid) {
+			Flush(mRecordingFrame);
+		}
+	}
+
+	void Bindless::UnregisterTexture(uint32_t index)
+	{
+		if (index >= mTextures.size() || !mTextures[index].used) {
+			return;
+		}
+
+		// the descriptor is left as is, a partially bound array only requires the slots actually sampled to be valid
+		mTextures[index] = TextureSlot();
+		mFreeTextures.push_back(index);
+		mStatistics.textures--;
+	}
+
+	uint32_t Bindless::RegisterMaterial(const Material& material)
+	{
+		uint32_t index = Invalid;
+
+		if (!mFreeMaterials.empty()) {
+			index = mFreeMaterials.back();
+			mFreeMaterials.pop_back();
+		}
+
+		else if (mMaterials.size() < COSMOS_BINDLESS_MAX_MATERIALS) {
+			index = (uint32_t)mMaterials.size();
+			mMaterials.emplace_back();
+			mUsedMaterials.push_back(false);
+		}
+
+		else {
+			COSMOS_LOG(Logger::Error, "The global descriptor set has no room for more than %u materials", COSMOS_BINDLESS_MAX_MATERIALS);
+			return Invalid;
+		}
+
+		mUsedMaterials[index] = true;
+		mStatistics.materials++;
+
+		UpdateMaterial(index, material);
+		return index;
+	}
+
+	void Bindless::UpdateMaterial(uint32_t index, const Material& material)
+	{
+		if (index >= mMaterials.size() || !mUsedMaterials[index]) {
+			return;
+		}
+
+		mMaterials[index] = material;
+
+		for (auto& pending : mPendingMaterials) {
+			pending.push_back(index);
+		}
+
+		if (mRecordingFrame != Invalid) {
+			Flush(mRecordingFrame);
+		}
+	}
+
+	void Bindless::UnregisterMaterial(uint32_t index)
+	{
+		if (index >= mMaterials.size() || !mUsedMaterials[index]) {
+			return;
+		}
+
+		mMaterials[index] = Material();
+		mUsedMaterials[index] = false;
+		mFreeMaterials.push_back(index);
+		mStatistics.materials--;
+	}
+
+	void Bindless::CreateDescriptors()
+	{
+		// textures are clamped to what the device allows on a set updated after bind
+		VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = {};
+		indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 properties = {};
+		properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties.pNext = &indexingProperties;
+		vkGetPhysicalDeviceProperties2(mDevice->GetPhysicalDevice(), &properties);
+
+		mMaxTextures = std::min
+		({
+			COSMOS_BINDLESS_MAX_TEXTURES,
+			indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+			indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+			indexingProperties.maxDescriptorSetUpdateAfterBindSamplers
+		});
+
+		mStatistics.maxTextures = mMaxTextures;
+
+		// descriptor set layout
+		std::array<VkDescriptorSetLayoutBinding, 5> bindings = {};
+		// 0: camera ubo
+		bindings[0].binding = 0;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		bindings[0].descriptorCount = 1;
+		bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		// 1: instances, indexed through the instance indices
+		bindings[1].binding = 1;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[1].descriptorCount = 1;
+		bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		// 2: materials, indexed by the instance material
+		bindings[2].binding = 2;
+		bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[2].descriptorCount = 1;
+		bindings[2].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		// 3: textures, indexed by the material
+		bindings[3].binding = 3;
+		bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[3].descriptorCount = mMaxTextures;
+		bindings[3].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		// 4: instance indices, what gl_InstanceIndex reads the instance through
+		bindings[4].binding = 4;
+		bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[4].descriptorCount = 1;
+		bindings[4].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+		std::array<VkDescriptorBindingFlags, 5> bindingFlags = {};
+		bindingFlags[3] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCI = {};
+		bindingFlagsCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsCI.bindingCount = (uint32_t)bindingFlags.size();
+		bindingFlagsCI.pBindingFlags = bindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo descSetLayoutCI = {};
+		descSetLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		descSetLayoutCI.pNext = &bindingFlagsCI;
+		descSetLayoutCI.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		descSetLayoutCI.bindingCount = (uint32_t)bindings.size();
+		descSetLayoutCI.pBindings = bindings.data();
+		COSMOS_ASSERT(vkCreateDescriptorSetLayout(mDevice->GetLogicalDevice(), &descSetLayoutCI, nullptr, &mDescriptorSetLayout) == VK_SUCCESS, "Failed to create descriptor set layout");
+
+		// a single pool and one set per frame, no matter how many meshes and textures exist
+		std::array<VkDescriptorPoolSize, 3> poolSizes = {};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		poolSizes[0].descriptorCount = CONCURENTLY_RENDERED_FRAMES;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[1].descriptorCount = CONCURENTLY_RENDERED_FRAMES * 3;
+		poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[2].descriptorCount = CONCURENTLY_RENDERED_FRAMES * mMaxTextures;
+
+		VkDescriptorPoolCreateInfo descPoolCI = {};
+		descPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descPoolCI.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		descPoolCI.poolSizeCount = (uint32_t)poolSizes.size();
+		descPoolCI.pPoolSizes = poolSizes.data();
+		descPoolCI.maxSets = CONCURENTLY_RENDERED_FRAMES;
+		COSMOS_ASSERT(vkCreateDescriptorPool(mDevice->GetLogicalDevice(), &descPoolCI, nullptr, &mDescriptorPool) == VK_SUCCESS, "Failed to create descriptor pool");
+
+		std::vector<VkDescriptorSetLayout> layouts(CONCURENTLY_RENDERED_FRAMES, mDescriptorSetLayout);
+
+		VkDescriptorSetAllocateInfo descSetAllocInfo = {};
+		descSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descSetAllocInfo.descriptorPool = mDescriptorPool;
+		descSetAllocInfo.descriptorSetCount = (uint32_t)CONCURENTLY_RENDERED_FRAMES;
+		descSetAllocInfo.pSetLayouts = layouts.data();
+
+		mDescriptorSets.resize(CONCURENTLY_RENDERED_FRAMES);
+		COSMOS_ASSERT(vkAllocateDescriptorSets(mDevice->GetLogicalDevice(), &descSetAllocInfo, mDescriptorSets.data()) == VK_SUCCESS, "Failed to allocate descriptor sets");
+
+		// the buffers never change, their descriptors are written once
+		for (size_t i = 0; i < CONCURENTLY_RENDERED_FRAMES; i++) {
+			// textures (binding 3) are written as they're registered
+			std::array<uint32_t, 4> bufferBindings = { 0, 1, 2, 4 };
+			std::array<VkDescriptorBufferInfo, 4> bufferInfos = {};
+			bufferInfos[0] = { mBuffersLib.GetRef("Camera")->GetBuffersRef()[i], 0, sizeof(CameraBuffer) };
+			bufferInfos[1] = { mBuffersLib.GetRef("Instances")->GetBuffersRef()[i], 0, VK_WHOLE_SIZE };
+			bufferInfos[2] = { mBuffersLib.GetRef("Materials")->GetBuffersRef()[i], 0, VK_WHOLE_SIZE };
+			bufferInfos[3] = { mBuffersLib.GetRef("InstanceIndices")->GetBuffersRef()[i], 0, VK_WHOLE_SIZE };
+
+			std::array<VkWriteDescriptorSet, 4> writes = {};
+
+			for (uint32_t w = 0; w < (uint32_t)writes.size(); w++) {
+				writes[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writes[w].dstSet = mDescriptorSets[i];
+				writes[w].dstBinding = bufferBindings[w];
+				writes[w].dstArrayElement = 0;
+				writes[w].descriptorType = bindings[bufferBindings[w]].descriptorType;
+				writes[w].descriptorCount = 1;
+				writes[w].pBufferInfo = &bufferInfos[w];
+			}
+
+			vkUpdateDescriptorSets(mDevice->GetLogicalDevice(), (uint32_t)writes.size(), writes.data(), 0, nullptr);
+		}
+	}
+
+	void Bindless::Flush(uint32_t frame)
+	{
+		// textures, slots freed after the change was queued are skipped
+		std::vector<uint32_t>& pendingTextures = mPendingTextures[frame];
+
+		if (!pendingTextures.empty()) {
+			std::vector<VkDescriptorImageInfo> imageInfos = {};
+			std::vector<VkWriteDescriptorSet> writes = {};
+			imageInfos.reserve(pendingTextures.size());
+			writes.reserve(pendingTextures.size());
+
+			for (uint32_t index : pendingTextures) {
+				const TextureSlot& slot = mTextures[index];
+
+				if (!slot.used) {
+					continue;
+				}
+
+				VkDescriptorImageInfo& imageInfo = imageInfos.emplace_back();
+				imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageInfo.imageView = slot.view;
+				imageInfo.sampler = slot.sampler;
+
+				VkWriteDescriptorSet& write = writes.emplace_back();
+				write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				write.dstSet = mDescriptorSets[frame];
+				write.dstBinding = 3;
+				write.dstArrayElement = index;
+				write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				write.descriptorCount = 1;
+				write.pImageInfo = &imageInfo;
+			}
+
+			vkUpdateDescriptorSets(mDevice->GetLogicalDevice(), (uint32_t)writes.size(), writes.data(), 0, nullptr);
+			mStatistics.writes += (uint32_t)writes.size();
+			pendingTextures.clear();
+		}
+
+		// materials, the records are copied into this frame buffer
+		std::vector<uint32_t>& pendingMaterials = mPendingMaterials[frame];
+
+		if (!pendingMaterials.empty()) {
+			Material* records = (Material*)mBuffersLib.GetRef("Materials")->GetMappedDataRef()[frame];
+
+			for (uint32_t index : pendingMaterials) {
+				records[index] = mMaterials[index];
+			}
+
+			mStatistics.writes += (uint32_t)pendingMaterials.size();
+			pendingMaterials.clear();
+		}
+	}
+}
+
+#endif
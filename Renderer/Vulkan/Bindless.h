@@ -0,0 +1,120 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Wrapper/vulkan.h"
+#include <Common/Util/Library.h>
+#include <Common/Util/Memory.h>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer::Vulkan { class Buffer; }
+namespace Cosmos::Renderer::Vulkan { class Device; }
+
+namespace Cosmos::Renderer::Vulkan
+{
+	class Bindless
+	{
+	public:
+
+		// value returned when there's no room left or the slot was never registered
+		static constexpr uint32_t Invalid = UINT32_MAX;
+
+		// a material record, mirrors the layout used on mesh.frag
+		struct Material
+		{
+			alignas(4) uint32_t albedo = 0;						// index of the albedo texture on the textures array
+			alignas(4) float alphaCutoff = 0.5f;				// only read by alpha tested pipelines
+			alignas(4) uint32_t padding[2] = {};				// keeps the std430 array stride
+		};
+
+		struct Statistics
+		{
+			uint32_t textures = 0;								// texture slots in use
+			uint32_t materials = 0;								// material slots in use
+			uint32_t maxTextures = 0;							// texture slots the device allows
+			uint32_t writes = 0;								// descriptor and material writes on the last frame
+		};
+
+	public:
+
+		// constructor
+		Bindless(Shared<Device> device, Library<Shared<Buffer>>& buffersLib);
+
+		// destructor
+		~Bindless();
+
+	public:
+
+		// returns the layout shared by every pipeline drawing with the global set
+		inline VkDescriptorSetLayout GetDescriptorSetLayout() const { return mDescriptorSetLayout; }
+
+		// returns the global descriptor set of a given frame
+		inline VkDescriptorSet GetDescriptorSet(uint32_t frame) const { return mDescriptorSets[frame]; }
+
+		// returns a reference to the statistics
+		inline Statistics& GetStatisticsRef() { return mStatistics; }
+
+	public:
+
+		// starts a new frame, must be called after the frame fence is waited, changes made while the frame was in flight are written
+		void BeginFrame(uint32_t currentFrame);
+
+		// ends the frame, must be called once it's command buffers are submitted
+		void EndFrame();
+
+		// adds a texture into the textures array, returns it's index
+		uint32_t RegisterTexture(VkImageView view, VkSampler sampler);
+
+		// changes the image used by a texture slot, frames in flight keep sampling the old one until they're rendered again
+		void UpdateTexture(uint32_t index, VkImageView view, VkSampler sampler);
+
+		// frees a texture slot, the image must not be in use anymore
+		void UnregisterTexture(uint32_t index);
+
+		// adds a material record, returns it's index
+		uint32_t RegisterMaterial(const Material& material);
+
+		// changes a material record, frames in flight keep reading the old one until they're rendered again
+		void UpdateMaterial(uint32_t index, const Material& material);
+
+		// frees a material slot
+		void UnregisterMaterial(uint32_t index);
+
+	private:
+
+		// creates the layout, pool and the per-frame global sets
+		void CreateDescriptors();
+
+		// writes the pending texture and material changes of a frame
+		void Flush(uint32_t frame);
+
+	private:
+
+		struct TextureSlot
+		{
+			VkImageView view = VK_NULL_HANDLE;
+			VkSampler sampler = VK_NULL_HANDLE;
+			bool used = false;
+		};
+
+		Shared<Device> mDevice;
+		Library<Shared<Buffer>>& mBuffersLib;
+		uint32_t mMaxTextures = 0;
+		uint32_t mRecordingFrame = Invalid;
+		Statistics mStatistics = {};
+
+		VkDescriptorSetLayout mDescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+		std::vector<VkDescriptorSet> mDescriptorSets = {};
+
+		std::vector<TextureSlot> mTextures = {};
+		std::vector<uint32_t> mFreeTextures = {};
+		std::vector<Material> mMaterials = {};
+		std::vector<bool> mUsedMaterials = {};
+		std::vector<uint32_t> mFreeMaterials = {};
+		std::vector<std::vector<uint32_t>> mPendingTextures = {};
+		std::vector<std::vector<uint32_t>> mPendingMaterials = {};
+	};
+}
+
+#endif
@@ -60,5 +60,14 @@ namespace Cosmos::Renderer::Vulkan
 		alignas(8) uint64_t id = 0;								// holds the unique identifier of the object
 		alignas(16) glm::mat4 model = glm::mat4(1.0f);			// holds the model matrix of the object
 	};
+
+	// information the renderer needs to know about each drawn instance, read on shaders with gl_InstanceIndex
+	struct InstanceData
+	{
+		alignas(16) glm::mat4 model = glm::mat4(1.0f);			// holds the model matrix of the object
+		alignas(8) uint64_t id = 0;								// holds the unique identifier of the object
+		alignas(4) uint32_t selected = 0;						// marks if the object is selected
+		alignas(4) uint32_t material = 0;						// index of the material record on the global descriptor set
+	};
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+#if defined RENDERER_VULKAN
+#include "CommandRecorder.h"
+
+#include "Device.h"
+#include <Common/Core/Defines.h>
+#include <Common/Debug/Logger.h>
+#include <Common/Util/ThreadPool.h>
+
+#include <algorithm>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	CommandRecorder::CommandRecorder(Shared<Device> device)
+		: mDevice(device)
+	{
+		mRangeSlotCount = ThreadPool::GetRef().GetThreadCount() + 1;
+
+		Device::QueueFamilyIndices indices = mDevice->FindQueueFamilies(mDevice->GetPhysicalDevice(), mDevice->GetSurface());
+
+		// buffers are re-recorded every frame, the pool is reset instead of each buffer
+		VkCommandPoolCreateInfo cmdPoolInfo = {};
+		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cmdPoolInfo.queueFamilyIndex = indices.graphics.value();
+		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		mSlots.resize(CONCURENTLY_RENDERED_FRAMES);
+
+		for (auto& slots : mSlots) {
+			slots.resize(mRangeSlotCount + 1);
+
+			for (Slot& slot : slots) {
+				COSMOS_ASSERT(vkCreateCommandPool(mDevice->GetLogicalDevice(), &cmdPoolInfo, nullptr, &slot.pool) == VK_SUCCESS, "Failed to create command pool");
+			}
+		}
+	}
+
+	CommandRecorder::~CommandRecorder()
+	{
+		vkDeviceWaitIdle(mDevice->GetLogicalDevice());
+
+		// destroying a pool frees it's buffers
+		for (auto& slots : mSlots) {
+			for (Slot& slot : slots) {
+				vkDestroyCommandPool(mDevice->GetLogicalDevice(), slot.pool, nullptr);
+			}
+		}
+	}
+
+	VkCommandBuffer CommandRecorder::GetCommandBuffer()
+	{
+		COSMOS_ASSERT(mRecording, "No render pass is being recorded");
+
+		if (mCurrent == VK_NULL_HANDLE) {
+			mCurrent = Acquire(mRangeSlotCount);
+		}
+
+		return mCurrent;
+	}
+
+	void CommandRecorder::BeginFrame(uint32_t currentFrame)
+	{
+		mCurrentFrame = currentFrame;
+
+		for (Slot& slot : mSlots[mCurrentFrame]) {
+			vkResetCommandPool(mDevice->GetLogicalDevice(), slot.pool, 0);
+			slot.used = 0;
+		}
+	}
+
+	void CommandRecorder::BeginPass(VkRenderPass renderPass, VkFramebuffer framebuffer, const VkViewport& viewport, const VkRect2D& scissor)
+	{
+		COSMOS_ASSERT(!mRecording, "A render pass is already being recorded");
+
+		mRecording = true;
+		mRenderPass = renderPass;
+		mFramebuffer = framebuffer;
+		mViewport = viewport;
+		mScissor = scissor;
+		mCurrent = VK_NULL_HANDLE;
+		mRecorded.clear();
+	}
+
+	void CommandRecorder::RecordParallel(size_t count, const std::function<void(size_t first, size_t last, VkCommandBuffer commandBuffer)>& func)
+	{
+		COSMOS_ASSERT(mRecording, "No render pass is being recorded");
+
+		if (count == 0) {
+			return;
+		}
+
+		// too little work doesn't pay for the extra secondaries and the wake up of the workers
+		size_t ranges = std::min<size_t>(mRangeSlotCount, std::max<size_t>(1, count / COSMOS_RECORD_MIN_BATCHES));
+
+		if (ranges == 1) {
+			func(0, count, GetCommandBuffer());
+			return;
+		}
+
+		// whatever comes after on the calling thread must execute after the ranges, so it goes into a new secondary
+		mCurrent = VK_NULL_HANDLE;
+
+		// buffers are acquired here so they're executed in range order, each range only ever touches it's own slot pool
+		std::vector<VkCommandBuffer> buffers(ranges);
+
+		for (size_t i = 0; i < ranges; i++) {
+			buffers[i] = Acquire((uint32_t)i);
+		}
+
+		ThreadPool::GetRef().ParallelFor(ranges, [&](size_t i)
+			{
+				func(count * i / ranges, count * (i + 1) / ranges, buffers[i]);
+			});
+	}
+
+	void CommandRecorder::EndPass(VkCommandBuffer primary)
+	{
+		COSMOS_ASSERT(mRecording, "No render pass is being recorded");
+
+		for (VkCommandBuffer cmdBuffer : mRecorded) {
+			COSMOS_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS, "Failed to end command buffer recording");
+		}
+
+		if (!mRecorded.empty()) {
+			vkCmdExecuteCommands(primary, (uint32_t)mRecorded.size(), mRecorded.data());
+		}
+
+		mRecording = false;
+		mCurrent = VK_NULL_HANDLE;
+		mRecorded.clear();
+	}
+
+	VkCommandBuffer CommandRecorder::Acquire(uint32_t slotIndex)
+	{
+		Slot& slot = mSlots[mCurrentFrame][slotIndex];
+
+		if (slot.used == (uint32_t)slot.buffers.size()) {
+			VkCommandBufferAllocateInfo cmdBufferAllocInfo = {};
+			cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			cmdBufferAllocInfo.commandPool = slot.pool;
+			cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			cmdBufferAllocInfo.commandBufferCount = 1;
+
+			VkCommandBuffer cmdBuffer = VK_NULL_HANDLE;
+			COSMOS_ASSERT(vkAllocateCommandBuffers(mDevice->GetLogicalDevice(), &cmdBufferAllocInfo, &cmdBuffer) == VK_SUCCESS, "Failed to allocate command buffers");
+			slot.buffers.push_back(cmdBuffer);
+		}
+
+		VkCommandBuffer cmdBuffer = slot.buffers[slot.used++];
+
+		VkCommandBufferInheritanceInfo inheritanceInfo = {};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = mRenderPass;
+		inheritanceInfo.subpass = 0;
+		inheritanceInfo.framebuffer = mFramebuffer;
+
+		VkCommandBufferBeginInfo cmdBeginInfo = {};
+		cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cmdBeginInfo.pNext = nullptr;
+		cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		cmdBeginInfo.pInheritanceInfo = &inheritanceInfo;
+		COSMOS_ASSERT(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to begin command buffer recording");
+
+		// dynamic state is not inherited from the primary
+		vkCmdSetViewport(cmdBuffer, 0, 1, &mViewport);
+		vkCmdSetScissor(cmdBuffer, 0, 1, &mScissor);
+
+		mRecorded.push_back(cmdBuffer);
+		return cmdBuffer;
+	}
+}
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Wrapper/vulkan.h"
+#include <Common/Util/Memory.h>
+#include <functional>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer::Vulkan { class Device; }
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// records the contents of a render pass into secondary command buffers, splitting the draws across the thread pool workers
+	// every recording slot has it's own command pool per frame, a pool is never used by two threads at once and is reset as a whole
+	class CommandRecorder
+	{
+	public:
+
+		// constructor
+		CommandRecorder(Shared<Device> device);
+
+		// destructor
+		~CommandRecorder();
+
+		// delete copy constructor
+		CommandRecorder(const CommandRecorder&) = delete;
+
+		// delete assignment constructor
+		CommandRecorder& operator=(const CommandRecorder&) = delete;
+
+	public:
+
+		// returns how many ranges may be recorded at once, one per worker plus the calling thread
+		inline uint32_t GetRangeSlotCount() const { return mRangeSlotCount; }
+
+		// returns if a render pass is being recorded
+		inline bool IsRecording() const { return mRecording; }
+
+		// returns the command buffer the calling thread records into, anything drawn outside the parallel ranges goes here in order
+		VkCommandBuffer GetCommandBuffer();
+
+	public:
+
+		// starts a new frame, must be called after the frame fence is waited as the frame secondaries are reset
+		void BeginFrame(uint32_t currentFrame);
+
+		// starts recording a render pass, the primary must have begun it with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		void BeginPass(VkRenderPass renderPass, VkFramebuffer framebuffer, const VkViewport& viewport, const VkRect2D& scissor);
+
+		// records [0, count) split into contiguous ranges across the workers, blocks until every range is recorded
+		void RecordParallel(size_t count, const std::function<void(size_t first, size_t last, VkCommandBuffer commandBuffer)>& func);
+
+		// ends the secondaries of the pass and executes them on the primary in order, the render pass can then be ended
+		void EndPass(VkCommandBuffer primary);
+
+	private:
+
+		struct Slot
+		{
+			VkCommandPool pool = VK_NULL_HANDLE;
+			std::vector<VkCommandBuffer> buffers = {};			// grows as needed, kept between frames
+			uint32_t used = 0;									// how many buffers were handed out this frame
+		};
+
+		// returns a secondary of a slot, begun with the pass inheritance and the pass viewport and scissor set
+		VkCommandBuffer Acquire(uint32_t slotIndex);
+
+	private:
+
+		Shared<Device> mDevice;
+		uint32_t mRangeSlotCount = 0;
+		uint32_t mCurrentFrame = 0;
+		std::vector<std::vector<Slot>> mSlots = {};				// per frame, range slots first and the calling thread slot last
+
+		bool mRecording = false;
+		VkRenderPass mRenderPass = VK_NULL_HANDLE;
+		VkFramebuffer mFramebuffer = VK_NULL_HANDLE;
+		VkViewport mViewport = {};
+		VkRect2D mScissor = {};
+		VkCommandBuffer mCurrent = VK_NULL_HANDLE;				// calling thread secondary, closed whenever ranges are recorded after it
+		std::vector<VkCommandBuffer> mRecorded = {};			// secondaries of the pass in execution order
+	};
+}
+
+#endif
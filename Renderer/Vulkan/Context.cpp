@@ -1,19 +1,27 @@
 #include "Context.h"
 
+#include "Bindless.h"
 #include "Buffer.h"
-#include "Context.h"
+#include "CommandRecorder.h"
+#include "Culling.h"
+#include "DeletionQueue.h"
 #include "Device.h"
 #include "GUI.h"
 #include "Instance.h"
 #include "Picking.h"
 #include "Pipeline.h"
 #include "Renderpass.h"
+#include "ResidencyManager.h"
 #include "Shader.h"
+#include "ShaderReloader.h"
 #include "Swapchain.h"
+#include "TextureLoader.h"
+#include "Uploader.h"
 
 #include "Core/IGUI.h"
 #include "Core/IMesh.h"
 
+#include <Common/Core/Defines.h>
 #include <Common/Debug/Logger.h>
 #include <Common/Debug/Profiler.h>
 #include <Common/File/Filesystem.h>
@@ -34,21 +42,48 @@ namespace Cosmos::Renderer::Vulkan
 		
 		auto& settings = mApplication->GetProjectRef()->GetSettingsRef();
 		mViewportBoundaries.size = { settings.width, settings.height };
+		IMesh::SetDefaultResidency(IMesh::ResidencyFromString(settings.meshresidency));
 
 		mInstance = CreateShared<Vulkan::Instance>(settings.enginename, settings.gamename, settings.validations, settings.version, settings.vulkanversion);
 		mDevice = CreateShared<Vulkan::Device>(mInstance, 2);
+		mDeletionQueue = CreateShared<Vulkan::DeletionQueue>(mDevice);
+		mResidencyManager = CreateShared<Vulkan::ResidencyManager>(mDevice, mDeletionQueue, (VkDeviceSize)settings.gpubudget * 1024 * 1024);
+		mTextureLoader = CreateShared<Vulkan::TextureLoader>();
 		mSwapchain = CreateShared<Vulkan::Swapchain>(mDevice, mRenderpasses);
-		mPicking = CreateShared<Vulkan::Picking>(mApplication, mDevice, mSwapchain, mRenderpasses);
+		mCommandRecorder = CreateShared<Vulkan::CommandRecorder>(mDevice);
+		mPicking = CreateShared<Vulkan::Picking>(mApplication, mDevice, mSwapchain, mCommandRecorder, mRenderpasses);
 
 		mMainRenderpass = mRenderpasses.GetRef("Swapchain");
 		mBuffers.Insert("Camera", CreateShared<Vulkan::Buffer>(mDevice, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(Vulkan::CameraBuffer)));
+		mBuffers.Insert("Instances", CreateShared<Vulkan::Buffer>(mDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(Vulkan::InstanceData) * COSMOS_RENDER_MAX_INSTANCES));
+		// instances are drawn through an index list, the cpu writes the first part as is and the gpu culling packs the visible ones of each draw past it
+		mBuffers.Insert("InstanceIndices", CreateShared<Vulkan::Buffer>(mDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(uint32_t) * (COSMOS_RENDER_MAX_INSTANCES + COSMOS_CULLING_MAX_INSTANCES)));
+		mBindless = CreateShared<Vulkan::Bindless>(mDevice, mBuffers);
+		mCulling = CreateShared<Vulkan::Culling>(mDevice, mBuffers);
 
-		Vulkan::DefaultPipelinesCreateInfo ci = { mDevice, mMainRenderpass, mPipelines, mRenderpasses };
+		Vulkan::DefaultPipelinesCreateInfo ci = { mDevice, mMainRenderpass, mPipelines, mRenderpasses, mBindless->GetDescriptorSetLayout() };
 		Vulkan::CreateDefaultPipelines(ci);
+
+		mShaderReloader = CreateShared<Vulkan::ShaderReloader>(mDevice, mPipelines, GetAssetSubDir("Shader"));
 	}
 
 	void Context::OnUpdate()
 	{
+		// textures decoded on the workers get their images before any command is recorded
+		{
+			PROFILER_SCOPE("Texture Loading");
+			mTextureLoader->OnUpdate();
+		}
+
+		// stream textures in and out before any command is recorded
+		{
+			PROFILER_SCOPE("Residency");
+			mResidencyManager->OnUpdate();
+		}
+
+		mRenderQueue.BeginFrame();
+		mInstanceCount = 0;
+
 		// send data to gpu
 		{
 			PROFILER_SCOPE("Send Data");
@@ -83,10 +118,30 @@ namespace Cosmos::Renderer::Vulkan
 			vkResetFences(mDevice->GetLogicalDevice(), 1, &mSwapchain->GetInFlightFencesRef()[mCurrentFrame]);
 		}
 
+		// the frame fence was waited, objects released while it was last recorded are destroyed, pipelines can be swapped and the secondaries, culling buffers and global descriptor set of this frame are free to be written
+		mDeletionQueue->BeginFrame(mCurrentFrame);
+		mShaderReloader->OnUpdate();
+		mCommandRecorder->BeginFrame(mCurrentFrame);
+		mBindless->BeginFrame(mCurrentFrame);
+		mCulling->BeginFrame(mCurrentFrame);
+		mPicking->BeginFrame(mCurrentFrame);
+
 		// manage render passes
 		{
 			ManageRenderpasses(mSwapchain->GetImageIndexRef());
 		}
+
+		// draws were registered while recording the render passes, they're culled before any of them executes
+		{
+			PROFILER_SCOPE("Culling");
+			mCulling->RecordCommands();
+		}
+
+		// uploads recorded up to now go out first, the frame sees them in submission order
+		{
+			PROFILER_SCOPE("Upload");
+			mDevice->GetUploaderRef()->Submit();
+		}
 		
 		// submits command buffers
 		VkSwapchainKHR swapChains[] = { mSwapchain->GetSwapchain() };
@@ -96,9 +151,15 @@ namespace Cosmos::Renderer::Vulkan
 		{
 			PROFILER_SCOPE("Submit");
 		
-			std::vector<VkCommandBuffer> submitCommandBuffers = { mRenderpasses.GetRef("Swapchain")->GetCommandfuffersRef()[mCurrentFrame] };
+			std::vector<VkCommandBuffer> submitCommandBuffers = {};
+
+			if (mCulling->IsSupported()) {
+				submitCommandBuffers.push_back(mCulling->GetCommandBuffer(mCurrentFrame));
+			}
+
+			submitCommandBuffers.push_back(mRenderpasses.GetRef("Swapchain")->GetCommandfuffersRef()[mCurrentFrame]);
 		
-			if (mRenderpasses.Exists("Picking")) {
+			if (mRenderpasses.Exists("Picking") && mPicking->IsRecorded()) {
 				submitCommandBuffers.push_back(mRenderpasses.GetRef("Picking")->GetCommandfuffersRef()[mCurrentFrame]);
 			}
 		
@@ -121,6 +182,7 @@ namespace Cosmos::Renderer::Vulkan
 			submitInfo.signalSemaphoreCount = 1;
 			submitInfo.pSignalSemaphores = signalSemaphores;
 			COSMOS_ASSERT(vkQueueSubmit(mDevice->GetGraphicsQueue(), 1, &submitInfo, mSwapchain->GetInFlightFencesRef()[mCurrentFrame]) == VK_SUCCESS, "Failed to submit draw command");
+			mBindless->EndFrame();
 		}
 
 		
@@ -164,6 +226,42 @@ namespace Cosmos::Renderer::Vulkan
 		mPicking->OnEvent(event);
 	}
 
+	Vulkan::Pipeline* Context::GetMeshPipeline(uint32_t features)
+	{
+		// every variant was built with the default pipelines, nothing is built while recording
+		return mPipelines.GetRef(Vulkan::GetMeshPipelineName(features)).get();
+	}
+
+	void Context::RecordParallel(size_t count, const std::function<void(size_t first, size_t last, void* commandBuffer)>& func)
+	{
+		mCommandRecorder->RecordParallel(count, [&func](size_t first, size_t last, VkCommandBuffer commandBuffer) { func(first, last, commandBuffer); });
+	}
+
+	uint32_t Context::WriteInstances(const RenderQueue::Instance* instances, uint32_t count, uint32_t material)
+	{
+		if (mInstanceCount + count > COSMOS_RENDER_MAX_INSTANCES) {
+			COSMOS_LOG(Logger::Warn, "Instance buffer is full, %u instance(s) won't be drawn this frame", count);
+			return UINT32_MAX;
+		}
+
+		// the buffer is only read by this frame commands, wich have already finished on the gpu when it's written again
+		Vulkan::InstanceData* data = (Vulkan::InstanceData*)mBuffers.GetRef("Instances")->GetMappedDataRef()[mCurrentFrame] + mInstanceCount;
+		uint32_t* indices = (uint32_t*)mBuffers.GetRef("InstanceIndices")->GetMappedDataRef()[mCurrentFrame] + mInstanceCount;
+
+		// draws not culled on the gpu read their instances straight through
+		for (uint32_t i = 0; i < count; i++) {
+			data[i].model = instances[i].model;
+			data[i].id = instances[i].id;
+			data[i].selected = instances[i].selected;
+			data[i].material = material;
+			indices[i] = mInstanceCount + i;
+		}
+
+		uint32_t first = mInstanceCount;
+		mInstanceCount += count;
+		return first;
+	}
+
 	void Context::ManageRenderpasses(uint32_t swapchainImageIndex)
 	{
 		std::vector<VkClearValue> clearValues(2);
@@ -192,7 +290,6 @@ namespace Cosmos::Renderer::Vulkan
 			renderPassBeginInfo.renderArea.extent = mSwapchain->GetExtent();
 			renderPassBeginInfo.clearValueCount = (uint32_t)clearValues.size();
 			renderPassBeginInfo.pClearValues = clearValues.data();
-			vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
 			// set frame commandbuffer viewport
 			VkViewport viewport = {};
@@ -202,22 +299,28 @@ namespace Cosmos::Renderer::Vulkan
 			viewport.height = (float)mSwapchain->GetExtent().height;
 			viewport.minDepth = 0.0f;
 			viewport.maxDepth = 1.0f;
-			vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
 
 			// set frame commandbuffer scissor
 			VkRect2D scissor = {};
 			scissor.offset = { 0, 0 };
 			scissor.extent = mSwapchain->GetExtent();
-			vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
 
-			// if we have a viewport, don't draw on swapchain
+			// if we have a viewport, don't draw on swapchain, it's only cleared
 			if (!mRenderpasses.Exists("Viewport")) {
+				vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+				mCommandRecorder->BeginPass(renderPass, frameBuffer, viewport, scissor);
 
 				// render objects
 				mApplication->OnRender(IContext::Stage::Default);
 
 				// render ui 
 				IGUI::GetRef()->OnRender();
+
+				mCommandRecorder->EndPass(cmdBuffer);
+			}
+
+			else {
+				vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 			}
 
 			vkCmdEndRenderPass(cmdBuffer);
@@ -252,7 +355,7 @@ namespace Cosmos::Renderer::Vulkan
 			renderPassBeginInfo.renderArea.extent = mSwapchain->GetExtent();
 			renderPassBeginInfo.clearValueCount = (uint32_t)clearValues.size();
 			renderPassBeginInfo.pClearValues = clearValues.data();
-			vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+			vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
 			// set frame commandbuffer viewport
 			VkViewport viewport = {};
@@ -262,13 +365,14 @@ namespace Cosmos::Renderer::Vulkan
 			viewport.height = (float)mSwapchain->GetExtent().height;
 			viewport.minDepth = 0.0f;
 			viewport.maxDepth = 1.0f;
-			vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
 
 			// set frame commandbuffer scissor
 			VkRect2D scissor = {};
 			scissor.offset = { 0, 0 };
 			scissor.extent = mSwapchain->GetExtent();
-			vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+			// everything inside the pass is recorded into secondaries, the scene draws are split across the workers
+			mCommandRecorder->BeginPass(renderPass, frameBuffer, viewport, scissor);
 
 			// render objects
 			mApplication->OnRender(IContext::Stage::Default);
@@ -276,6 +380,7 @@ namespace Cosmos::Renderer::Vulkan
 			// render ui 
 			IGUI::GetRef()->OnRender();
 
+			mCommandRecorder->EndPass(cmdBuffer);
 			vkCmdEndRenderPass(cmdBuffer);
 
 			// end command buffer
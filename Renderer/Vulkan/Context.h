@@ -8,13 +8,20 @@
 #include <Common/Util/Memory.h>
 
 // forward declarations
+namespace Cosmos::Renderer::Vulkan { class Bindless; }
 namespace Cosmos::Renderer::Vulkan { class Buffer; }
+namespace Cosmos::Renderer::Vulkan { class CommandRecorder; }
+namespace Cosmos::Renderer::Vulkan { class Culling; }
+namespace Cosmos::Renderer::Vulkan { class DeletionQueue; }
 namespace Cosmos::Renderer::Vulkan { class Device; }
 namespace Cosmos::Renderer::Vulkan { class Instance; }
 namespace Cosmos::Renderer::Vulkan { class Pipeline; }
 namespace Cosmos::Renderer::Vulkan { class Picking; }
 namespace Cosmos::Renderer::Vulkan { class Renderpass; }
+namespace Cosmos::Renderer::Vulkan { class ResidencyManager; }
+namespace Cosmos::Renderer::Vulkan { class ShaderReloader; }
 namespace Cosmos::Renderer::Vulkan { class Swapchain; }
+namespace Cosmos::Renderer::Vulkan { class TextureLoader; }
 
 namespace Cosmos::Renderer::Vulkan
 {
@@ -39,12 +46,33 @@ namespace Cosmos::Renderer::Vulkan
 		// returns the swapchain
 		inline Shared<Vulkan::Swapchain> GetSwapchain() { return mSwapchain; }
 
+		// returns a reference to the deletion queue, released objects are destroyed once no frame in flight uses them
+		inline Shared<Vulkan::DeletionQueue>& GetDeletionQueueRef() { return mDeletionQueue; }
+
 		// return a reference to the main render pass at the momment
 		inline Shared<Vulkan::Renderpass>& GetMainRenderpassRef() { return mMainRenderpass; }
 
+		// returns a reference to the command recorder, wich holds the secondary command buffers the render passes are recorded into
+		inline Shared<Vulkan::CommandRecorder>& GetCommandRecorderRef() { return mCommandRecorder; }
+
 		// returns a reference to the picking functionality
 		inline Shared<Vulkan::Picking>& GetPickingRef() { return mPicking; }
 
+		// returns a reference to the residency manager, wich streams textures according to the gpu memory budget
+		inline Shared<Vulkan::ResidencyManager>& GetResidencyManagerRef() { return mResidencyManager; }
+
+		// returns a reference to the texture loader, wich decodes textures on the worker threads
+		inline Shared<Vulkan::TextureLoader>& GetTextureLoaderRef() { return mTextureLoader; }
+
+		// returns a reference to the gpu culling, wich decides on compute what instances are drawn
+		inline Shared<Vulkan::Culling>& GetCullingRef() { return mCulling; }
+
+		// returns a reference to the global descriptor set, wich holds every texture and material by index
+		inline Shared<Vulkan::Bindless>& GetBindlessRef() { return mBindless; }
+
+		// returns a reference to the shader hot-reload, wich rebuilds pipelines when their shaders change on disk
+		inline Shared<Vulkan::ShaderReloader>& GetShaderReloaderRef() { return mShaderReloader; }
+
 		// returns a reference to the render passes
 		inline Library<Shared<Vulkan::Renderpass>>& GetRenderpassesLibraryRef() { return mRenderpasses; }
 
@@ -54,6 +82,12 @@ namespace Cosmos::Renderer::Vulkan
 		// returns a reference to the pipelines
 		inline Library<Shared<Vulkan::Pipeline>>& GetPipelinesLibraryRef() { return mPipelines; }
 
+		// returns the mesh pipeline for a IMesh::Feature combination, all of them are built with the default pipelines
+		Vulkan::Pipeline* GetMeshPipeline(uint32_t features);
+
+		// copies instances of a material into this frame instance buffer, returns the first instance index or UINT32_MAX when the buffer is full
+		uint32_t WriteInstances(const RenderQueue::Instance* instances, uint32_t count, uint32_t material);
+
 	public:
 
 		// called for updating the renderer
@@ -62,6 +96,9 @@ namespace Cosmos::Renderer::Vulkan
 		// called when an event happens
 		virtual void OnEvent(Shared<Platform::EventBase> event) override;
 
+		// records [0, count) split into contiguous ranges across the workers, each range into it's own secondary command buffer
+		virtual void RecordParallel(size_t count, const std::function<void(size_t first, size_t last, void* commandBuffer)>& func) override;
+
 	private:
 
 		// make all necessary draw-calls
@@ -71,12 +108,20 @@ namespace Cosmos::Renderer::Vulkan
 
 		Shared<Vulkan::Instance> mInstance;
 		Shared<Vulkan::Device> mDevice;
+		Shared<Vulkan::DeletionQueue> mDeletionQueue; // everything below may release into it, must be destroyed after them
 		Shared<Vulkan::Swapchain> mSwapchain;
 		Shared<Vulkan::Renderpass> mMainRenderpass;
+		Shared<Vulkan::CommandRecorder> mCommandRecorder;
 		Shared<Vulkan::Picking> mPicking;
+		Shared<Vulkan::ResidencyManager> mResidencyManager;
+		Shared<Vulkan::TextureLoader> mTextureLoader; // it's placeholder releases into the deletion queue
 		Library<Shared<Vulkan::Renderpass>> mRenderpasses;
 		Library<Shared<Vulkan::Buffer>> mBuffers;
 		Library<Shared<Vulkan::Pipeline>> mPipelines;
+		Shared<Vulkan::Bindless> mBindless; // uses the buffers library, must be destroyed before it
+		Shared<Vulkan::Culling> mCulling; // uses the buffers library, must be destroyed before it
+		Shared<Vulkan::ShaderReloader> mShaderReloader; // uses the pipelines library, must be destroyed before it
+		uint32_t mInstanceCount = 0;
 	};
 }
 
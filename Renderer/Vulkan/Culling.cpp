@@ -0,0 +1,298 @@
+#if defined RENDERER_VULKAN
+#include "Culling.h"
+
+#include "Buffer.h"
+#include "Device.h"
+#include "Shader.h"
+
+#include <Common/Core/Defines.h>
+#include <Common/Debug/Logger.h>
+#include <Common/File/Filesystem.h>
+
+#include <array>
+#include <cstring>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	Culling::Culling(Shared<Device> device, Library<Shared<Buffer>>& buffersLib)
+		: mDevice(device), mBuffersLib(buffersLib)
+	{
+		mSupported = mDevice->IsIndirectFirstInstanceSupported();
+
+		if (!mSupported) {
+			COSMOS_LOG(Logger::Warn, "drawIndirectFirstInstance is not available, instances will be culled on the cpu");
+			return;
+		}
+
+		CreateBuffers();
+		CreatePipeline();
+		CreateCommandBuffers();
+	}
+
+	Culling::~Culling()
+	{
+		if (!mSupported) {
+			return;
+		}
+
+		vkDeviceWaitIdle(mDevice->GetLogicalDevice());
+
+		vkFreeCommandBuffers(mDevice->GetLogicalDevice(), mCommandPool, (uint32_t)mCommandBuffers.size(), mCommandBuffers.data());
+		vkDestroyCommandPool(mDevice->GetLogicalDevice(), mCommandPool, nullptr);
+		vkDestroyDescriptorPool(mDevice->GetLogicalDevice(), mDescriptorPool, nullptr);
+		vkDestroyPipeline(mDevice->GetLogicalDevice(), mPipeline, nullptr);
+		vkDestroyPipelineLayout(mDevice->GetLogicalDevice(), mPipelineLayout, nullptr);
+		vkDestroyDescriptorSetLayout(mDevice->GetLogicalDevice(), mDescriptorSetLayout, nullptr);
+
+		for (size_t i = 0; i < mCommands.size(); i++) {
+			vmaDestroyBuffer(mDevice->GetAllocator(), mCommands[i], mCommandsMemory[i]);
+		}
+
+		mBuffersLib.Erase("CullingDraws");
+		mBuffersLib.Erase("CullingCounts");
+	}
+
+	void Culling::BeginFrame(uint32_t currentFrame)
+	{
+		mCurrentFrame = currentFrame;
+
+		if (!mSupported) {
+			return;
+		}
+
+		// the gpu is done with this frame, it's counts tell how many instances survived the last time it was rendered
+		const uint32_t* counts = (const uint32_t*)mBuffersLib.GetRef("CullingCounts")->GetMappedDataRef()[mCurrentFrame];
+		mStatistics.visible = 0;
+
+		for (uint32_t i = 0; i < mFrameDrawCounts[mCurrentFrame]; i++) {
+			mStatistics.visible += counts[i];
+		}
+
+		mStatistics.draws = mDrawCount;
+		mStatistics.instances = mCommandCount;
+		mReservation.Reset();
+		mDrawCount = 0;
+		mCommandCount = 0;
+	}
+
+	bool Culling::DrawIndexed(VkCommandBuffer commandBuffer, const glm::vec4& sphere, uint32_t indexCount, uint32_t firstIndex, uint32_t instanceCount, uint32_t firstInstance)
+	{
+		if (!IsEnabled()) {
+			return false;
+		}
+
+		// a slot and it's commands are taken at once, nothing is taken when either doesn't fit
+		uint32_t drawIndex = 0;
+		uint32_t commandIndex = 0;
+
+		if (!mReservation.Reserve(instanceCount, drawIndex, commandIndex)) {
+			return false;
+		}
+
+		// every instance gets a slot on the index list past the ones the cpu writes, the gpu packs the visible ones at the start and draws them with one command
+		Draw* draws = (Draw*)mBuffersLib.GetRef("CullingDraws")->GetMappedDataRef()[mCurrentFrame];
+		Draw& draw = draws[drawIndex];
+		draw.sphere = sphere;
+		draw.indexCount = indexCount;
+		draw.firstIndex = firstIndex;
+		draw.firstInstance = firstInstance;
+		draw.instanceCount = instanceCount;
+		draw.firstVisible = COSMOS_RENDER_MAX_INSTANCES + commandIndex;
+
+		VkDeviceSize commandOffset = (VkDeviceSize)drawIndex * sizeof(VkDrawIndexedIndirectCommand);
+		vkCmdDrawIndexedIndirect(commandBuffer, mCommands[mCurrentFrame], commandOffset, 1, sizeof(VkDrawIndexedIndirectCommand));
+		return true;
+	}
+
+	void Culling::RecordCommands()
+	{
+		if (!mSupported) {
+			return;
+		}
+
+		// recording threads have all joined by now
+		mDrawCount = mReservation.GetDrawCount();
+		mCommandCount = mReservation.GetCommandCount();
+
+		VkCommandBuffer cmdBuffer = mCommandBuffers[mCurrentFrame];
+		vkResetCommandBuffer(cmdBuffer, /*VkCommandBufferResetFlagBits*/ 0);
+
+		VkCommandBufferBeginInfo cmdBeginInfo = {};
+		cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cmdBeginInfo.pNext = nullptr;
+		cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		COSMOS_ASSERT(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to begin command buffer recording");
+
+		if (mDrawCount > 0)
+		{
+			// one workgroup per draw, it's invocations stride over the draw instances
+			vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipeline);
+			vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout, 0, 1, &mDescriptorSets[mCurrentFrame], 0, nullptr);
+			vkCmdDispatch(cmdBuffer, mDrawCount, 1, 1);
+
+			// barriers reach commands submitted later on the queue, the render passes read the commands and the packed indices after this
+			VkMemoryBarrier cullBarrier = {};
+			cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+		}
+
+		COSMOS_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS, "Failed to end command buffer recording");
+		mFrameDrawCounts[mCurrentFrame] = mDrawCount;
+	}
+
+	void Culling::CreatePipeline()
+	{
+		// descriptor set layout
+		std::array<VkDescriptorSetLayoutBinding, 6> bindings = {};
+		// 0: camera ubo
+		bindings[0].binding = 0;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		bindings[0].descriptorCount = 1;
+		bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		// 1: instances, 2: draws, 3: commands, 4: counts, 5: instance indices
+		for (uint32_t i = 1; i < (uint32_t)bindings.size(); i++) {
+			bindings[i].binding = i;
+			bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[i].descriptorCount = 1;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		VkDescriptorSetLayoutCreateInfo descSetLayoutCI = {};
+		descSetLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		descSetLayoutCI.pNext = nullptr;
+		descSetLayoutCI.flags = 0;
+		descSetLayoutCI.bindingCount = (uint32_t)bindings.size();
+		descSetLayoutCI.pBindings = bindings.data();
+		COSMOS_ASSERT(vkCreateDescriptorSetLayout(mDevice->GetLogicalDevice(), &descSetLayoutCI, nullptr, &mDescriptorSetLayout) == VK_SUCCESS, "Failed to create descriptor set layout");
+
+		// pipeline layout
+		VkPipelineLayoutCreateInfo pipelineLayoutCI = {};
+		pipelineLayoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCI.pNext = nullptr;
+		pipelineLayoutCI.flags = 0;
+		pipelineLayoutCI.setLayoutCount = 1;
+		pipelineLayoutCI.pSetLayouts = &mDescriptorSetLayout;
+		COSMOS_ASSERT(vkCreatePipelineLayout(mDevice->GetLogicalDevice(), &pipelineLayoutCI, nullptr, &mPipelineLayout) == VK_SUCCESS, "Failed to create pipeline layout");
+
+		// compute pipeline, the shader module is not needed after it's creation
+		{
+			Shared<Shader> shader = CreateShared<Shader>(mDevice, ShaderType::Compute, "Culling.comp", GetAssetSubDir("Shader/culling.comp").c_str());
+
+			VkComputePipelineCreateInfo pipelineCI = {};
+			pipelineCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			pipelineCI.pNext = nullptr;
+			pipelineCI.flags = 0;
+			pipelineCI.stage = shader->GetShaderStageCreateInfoRef();
+			pipelineCI.layout = mPipelineLayout;
+			COSMOS_ASSERT(vkCreateComputePipelines(mDevice->GetLogicalDevice(), mDevice->GetPipelineCache(), 1, &pipelineCI, nullptr, &mPipeline) == VK_SUCCESS, "Failed to create compute pipeline");
+		}
+
+		// descriptor pool and descriptor sets
+		std::array<VkDescriptorPoolSize, 2> poolSizes = {};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		poolSizes[0].descriptorCount = CONCURENTLY_RENDERED_FRAMES;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[1].descriptorCount = CONCURENTLY_RENDERED_FRAMES * 5;
+
+		VkDescriptorPoolCreateInfo descPoolCI = {};
+		descPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descPoolCI.poolSizeCount = (uint32_t)poolSizes.size();
+		descPoolCI.pPoolSizes = poolSizes.data();
+		descPoolCI.maxSets = CONCURENTLY_RENDERED_FRAMES;
+		COSMOS_ASSERT(vkCreateDescriptorPool(mDevice->GetLogicalDevice(), &descPoolCI, nullptr, &mDescriptorPool) == VK_SUCCESS, "Failed to create descriptor pool");
+
+		std::vector<VkDescriptorSetLayout> layouts(CONCURENTLY_RENDERED_FRAMES, mDescriptorSetLayout);
+
+		VkDescriptorSetAllocateInfo descSetAllocInfo = {};
+		descSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descSetAllocInfo.descriptorPool = mDescriptorPool;
+		descSetAllocInfo.descriptorSetCount = (uint32_t)CONCURENTLY_RENDERED_FRAMES;
+		descSetAllocInfo.pSetLayouts = layouts.data();
+
+		mDescriptorSets.resize(CONCURENTLY_RENDERED_FRAMES);
+		COSMOS_ASSERT(vkAllocateDescriptorSets(mDevice->GetLogicalDevice(), &descSetAllocInfo, mDescriptorSets.data()) == VK_SUCCESS, "Failed to allocate descriptor sets");
+
+		// the buffers never change, descriptors are written once
+		for (size_t i = 0; i < CONCURENTLY_RENDERED_FRAMES; i++) {
+			std::array<VkDescriptorBufferInfo, 6> bufferInfos = {};
+			bufferInfos[0] = { mBuffersLib.GetRef("Camera")->GetBuffersRef()[i], 0, sizeof(CameraBuffer) };
+			bufferInfos[1] = { mBuffersLib.GetRef("Instances")->GetBuffersRef()[i], 0, VK_WHOLE_SIZE };
+			bufferInfos[2] = { mBuffersLib.GetRef("CullingDraws")->GetBuffersRef()[i], 0, VK_WHOLE_SIZE };
+			bufferInfos[3] = { mCommands[i], 0, VK_WHOLE_SIZE };
+			bufferInfos[4] = { mBuffersLib.GetRef("CullingCounts")->GetBuffersRef()[i], 0, VK_WHOLE_SIZE };
+			bufferInfos[5] = { mBuffersLib.GetRef("InstanceIndices")->GetBuffersRef()[i], 0, VK_WHOLE_SIZE };
+
+			std::array<VkWriteDescriptorSet, 6> writes = {};
+
+			for (uint32_t binding = 0; binding < (uint32_t)writes.size(); binding++) {
+				writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writes[binding].dstSet = mDescriptorSets[i];
+				writes[binding].dstBinding = binding;
+				writes[binding].dstArrayElement = 0;
+				writes[binding].descriptorType = bindings[binding].descriptorType;
+				writes[binding].descriptorCount = 1;
+				writes[binding].pBufferInfo = &bufferInfos[binding];
+			}
+
+			vkUpdateDescriptorSets(mDevice->GetLogicalDevice(), (uint32_t)writes.size(), writes.data(), 0, nullptr);
+		}
+	}
+
+	void Culling::CreateBuffers()
+	{
+		// draws are written by the cpu while recording, the shader writes every draw count and they're read back for statistics
+		mBuffersLib.Insert("CullingDraws", CreateShared<Buffer>(mDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(Draw) * COSMOS_CULLING_MAX_DRAWS));
+		mBuffersLib.Insert("CullingCounts", CreateShared<Buffer>(mDevice, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sizeof(uint32_t) * COSMOS_CULLING_MAX_DRAWS));
+
+		// commands only live on the gpu, one per draw
+		mCommands.resize(CONCURENTLY_RENDERED_FRAMES);
+		mCommandsMemory.resize(CONCURENTLY_RENDERED_FRAMES);
+
+		for (size_t i = 0; i < CONCURENTLY_RENDERED_FRAMES; i++)
+		{
+			COSMOS_ASSERT
+			(
+				mDevice->CreateBuffer
+				(
+					VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+					sizeof(VkDrawIndexedIndirectCommand) * COSMOS_CULLING_MAX_DRAWS,
+					&mCommands[i],
+					&mCommandsMemory[i]
+				) == VK_SUCCESS,
+				"Failed to create indirect commands buffer"
+			);
+		}
+
+		// nothing was drawn yet, statistics read zeroes
+		for (size_t i = 0; i < CONCURENTLY_RENDERED_FRAMES; i++) {
+			memset(mBuffersLib.GetRef("CullingCounts")->GetMappedDataRef()[i], 0, sizeof(uint32_t) * COSMOS_CULLING_MAX_DRAWS);
+		}
+	}
+
+	void Culling::CreateCommandBuffers()
+	{
+		Device::QueueFamilyIndices indices = mDevice->FindQueueFamilies(mDevice->GetPhysicalDevice(), mDevice->GetSurface());
+
+		// culling runs on the graphics queue, right before the render passes on the same submission
+		VkCommandPoolCreateInfo cmdPoolInfo = {};
+		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cmdPoolInfo.queueFamilyIndex = indices.graphics.value();
+		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		COSMOS_ASSERT(vkCreateCommandPool(mDevice->GetLogicalDevice(), &cmdPoolInfo, nullptr, &mCommandPool) == VK_SUCCESS, "Failed to create command pool");
+
+		mCommandBuffers.resize(CONCURENTLY_RENDERED_FRAMES);
+		mFrameDrawCounts.resize(CONCURENTLY_RENDERED_FRAMES);
+
+		VkCommandBufferAllocateInfo cmdBufferAllocInfo = {};
+		cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		cmdBufferAllocInfo.commandPool = mCommandPool;
+		cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cmdBufferAllocInfo.commandBufferCount = (uint32_t)mCommandBuffers.size();
+		COSMOS_ASSERT(vkAllocateCommandBuffers(mDevice->GetLogicalDevice(), &cmdBufferAllocInfo, mCommandBuffers.data()) == VK_SUCCESS, "Failed to allocate command buffers");
+	}
+}
+
+#endif
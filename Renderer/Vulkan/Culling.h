@@ -0,0 +1,114 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Core/DrawReservation.h"
+#include "Wrapper/vulkan.h"
+#include <Common/Core/Defines.h>
+#include <Common/Math/Math.h>
+#include <Common/Util/Library.h>
+#include <Common/Util/Memory.h>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer::Vulkan { class Buffer; }
+namespace Cosmos::Renderer::Vulkan { class Device; }
+
+namespace Cosmos::Renderer::Vulkan
+{
+	class Culling
+	{
+	public:
+
+		// a primitive drawn for a range of instances, mirrors the layout used on culling.comp
+		struct Draw
+		{
+			alignas(16) glm::vec4 sphere = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);	// mesh space bounding sphere, a negative radius is never culled
+			alignas(4) uint32_t indexCount = 0;									// how many indices the primitive has
+			alignas(4) uint32_t firstIndex = 0;									// first index of the primitive on the index buffer
+			alignas(4) uint32_t firstInstance = 0;								// first instance on the instance buffer
+			alignas(4) uint32_t instanceCount = 0;								// how many instances are tested
+			alignas(4) uint32_t firstVisible = 0;								// where the visible instances are packed on the instance index list, the draw command starts there
+			alignas(4) uint32_t padding[3] = {};								// keeps the std430 array stride
+		};
+
+		struct Statistics
+		{
+			uint32_t draws = 0;
+			uint32_t instances = 0;
+			uint32_t visible = 0;
+		};
+
+	public:
+
+		// constructor
+		Culling(Shared<Device> device, Library<Shared<Buffer>>& buffersLib);
+
+		// destructor
+		~Culling();
+
+	public:
+
+		// returns if the device can draw with counts written by the gpu
+		inline bool IsSupported() const { return mSupported; }
+
+		// returns if primitives are being culled on the gpu
+		inline bool IsEnabled() const { return mSupported && mEnabled; }
+
+		// enables or disables gpu culling, instances are then only culled by the scene
+		inline void SetEnabled(bool enabled) { mEnabled = enabled; }
+
+		// returns a reference to the statistics, visible instances are read back from the last time the frame was rendered
+		inline Statistics& GetStatisticsRef() { return mStatistics; }
+
+		// returns the command buffer with the culling of a given frame
+		inline VkCommandBuffer GetCommandBuffer(uint32_t frame) const { return mCommandBuffers[frame]; }
+
+	public:
+
+		// starts a new frame, must be called after the frame fence is waited
+		void BeginFrame(uint32_t currentFrame);
+
+		// records a single indirect draw of a primitive for it's instances that are inside the view, returns false when out of space
+		// may be called from several recording threads at once, each on it's own command buffer
+		bool DrawIndexed(VkCommandBuffer commandBuffer, const glm::vec4& sphere, uint32_t indexCount, uint32_t firstIndex, uint32_t instanceCount, uint32_t firstInstance);
+
+		// records the culling of all draws of the frame, it's command buffer must be submitted before the ones drawing
+		void RecordCommands();
+
+	private:
+
+		// creates the compute pipeline and it's descriptors
+		void CreatePipeline();
+
+		// creates the buffers the gpu writes the commands and counts into
+		void CreateBuffers();
+
+		// creates the per-frame command buffers
+		void CreateCommandBuffers();
+
+	private:
+
+		Shared<Device> mDevice;
+		Library<Shared<Buffer>>& mBuffersLib;
+		bool mSupported = false;
+		bool mEnabled = true;
+		uint32_t mCurrentFrame = 0;
+		DrawReservation mReservation{ COSMOS_CULLING_MAX_DRAWS, COSMOS_CULLING_MAX_INSTANCES };
+		uint32_t mDrawCount = 0;
+		uint32_t mCommandCount = 0;
+		Statistics mStatistics = {};
+
+		VkDescriptorSetLayout mDescriptorSetLayout = VK_NULL_HANDLE;
+		VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline mPipeline = VK_NULL_HANDLE;
+		VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+		VkCommandPool mCommandPool = VK_NULL_HANDLE;
+		std::vector<VkDescriptorSet> mDescriptorSets = {};
+		std::vector<VkCommandBuffer> mCommandBuffers = {};
+		std::vector<uint32_t> mFrameDrawCounts = {};
+		std::vector<VkBuffer> mCommands = {};
+		std::vector<VmaAllocation> mCommandsMemory = {};
+	};
+}
+
+#endif
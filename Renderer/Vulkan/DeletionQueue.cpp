@@ -0,0 +1,229 @@
+#if defined RENDERER_VULKAN
+#include "DeletionQueue.h"
+
+#include "Device.h"
+#include "Uploader.h"
+#include <Common/Core/Defines.h>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	DeletionQueue::DeletionQueue(Shared<Device> device)
+		: mDevice(device)
+	{
+		mSlots.resize(CONCURENTLY_RENDERED_FRAMES);
+	}
+
+	DeletionQueue::~DeletionQueue()
+	{
+		// uploads still being recorded may reference released objects, they must not be submitted after these are gone
+		mDevice->GetUploaderRef()->Submit();
+		vkDeviceWaitIdle(mDevice->GetLogicalDevice());
+
+		// oldest slot first, a descriptor set may be released before the pool it came from
+		for (size_t i = 1; i <= mSlots.size(); i++) {
+			Flush(mSlots[(mCurrentSlot + i) % mSlots.size()]);
+		}
+	}
+
+	void DeletionQueue::BeginFrame(uint32_t currentFrame)
+	{
+		Slot slot = {};
+
+		// the slot is taken out so the destruction doesn't hold the lock
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			std::swap(slot, mSlots[currentFrame]);
+			mCurrentSlot = currentFrame;
+		}
+
+		Flush(slot);
+	}
+
+	size_t DeletionQueue::GetPendingCount()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		size_t count = 0;
+
+		for (const Slot& slot : mSlots) {
+			count += CountSlot(slot);
+		}
+
+		return count;
+	}
+
+	VkDeviceSize DeletionQueue::GetPendingImageBytes()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		VkDeviceSize bytes = 0;
+
+		for (const Slot& slot : mSlots) {
+			bytes += slot.imageBytes;
+		}
+
+		return bytes;
+	}
+
+	void DeletionQueue::ReleaseBuffer(VkBuffer buffer, VmaAllocation memory)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].buffers.push_back({ buffer, memory });
+	}
+
+	void DeletionQueue::ReleaseImage(VkImage image, VmaAllocation memory)
+	{
+		VmaAllocationInfo info = {};
+
+		if (memory != VK_NULL_HANDLE) {
+			vmaGetAllocationInfo(mDevice->GetAllocator(), memory, &info);
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].images.push_back({ image, memory });
+		mSlots[mCurrentSlot].imageBytes += info.size;
+	}
+
+	void DeletionQueue::ReleaseImageView(VkImageView view)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].views.push_back(view);
+	}
+
+	void DeletionQueue::ReleaseSampler(VkSampler sampler)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].samplers.push_back(sampler);
+	}
+
+	void DeletionQueue::ReleaseDescriptorPool(VkDescriptorPool pool)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].descriptorPools.push_back(pool);
+	}
+
+	void DeletionQueue::ReleaseDescriptorSet(VkDescriptorPool pool, VkDescriptorSet descriptorSet)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].descriptorSets.push_back({ pool, descriptorSet });
+	}
+
+	void DeletionQueue::ReleaseCommandBuffer(VkCommandPool pool, VkCommandBuffer commandBuffer)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].commandBuffers.push_back({ pool, commandBuffer });
+	}
+
+	void DeletionQueue::ReleaseCommandPool(VkCommandPool pool)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].commandPools.push_back(pool);
+	}
+
+	void DeletionQueue::ReleaseFence(VkFence fence)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].fences.push_back(fence);
+	}
+
+	void DeletionQueue::ReleaseFramebuffer(VkFramebuffer framebuffer)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].framebuffers.push_back(framebuffer);
+	}
+
+	void DeletionQueue::ReleaseRenderPass(VkRenderPass renderPass)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].renderPasses.push_back(renderPass);
+	}
+
+	void DeletionQueue::ReleasePipeline(VkPipeline pipeline)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].pipelines.push_back(pipeline);
+	}
+
+	void DeletionQueue::ReleasePipelineLayout(VkPipelineLayout layout)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].pipelineLayouts.push_back(layout);
+	}
+
+	void DeletionQueue::ReleaseDescriptorSetLayout(VkDescriptorSetLayout layout)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSlots[mCurrentSlot].descriptorSetLayouts.push_back(layout);
+	}
+
+	void DeletionQueue::Flush(Slot& slot)
+	{
+		VkDevice device = mDevice->GetLogicalDevice();
+		VmaAllocator allocator = mDevice->GetAllocator();
+
+		for (auto& [pool, commandBuffer] : slot.commandBuffers) {
+			vkFreeCommandBuffers(device, pool, 1, &commandBuffer);
+		}
+
+		for (VkCommandPool pool : slot.commandPools) {
+			vkDestroyCommandPool(device, pool, nullptr);
+		}
+
+		for (VkPipeline pipeline : slot.pipelines) {
+			vkDestroyPipeline(device, pipeline, nullptr);
+		}
+
+		for (VkPipelineLayout layout : slot.pipelineLayouts) {
+			vkDestroyPipelineLayout(device, layout, nullptr);
+		}
+
+		for (VkDescriptorSetLayout layout : slot.descriptorSetLayouts) {
+			vkDestroyDescriptorSetLayout(device, layout, nullptr);
+		}
+
+		for (auto& [pool, descriptorSet] : slot.descriptorSets) {
+			vkFreeDescriptorSets(device, pool, 1, &descriptorSet);
+		}
+
+		for (VkDescriptorPool pool : slot.descriptorPools) {
+			vkDestroyDescriptorPool(device, pool, nullptr);
+		}
+
+		for (VkFramebuffer framebuffer : slot.framebuffers) {
+			vkDestroyFramebuffer(device, framebuffer, nullptr);
+		}
+
+		for (VkRenderPass renderPass : slot.renderPasses) {
+			vkDestroyRenderPass(device, renderPass, nullptr);
+		}
+
+		for (VkImageView view : slot.views) {
+			vkDestroyImageView(device, view, nullptr);
+		}
+
+		for (VkSampler sampler : slot.samplers) {
+			vkDestroySampler(device, sampler, nullptr);
+		}
+
+		for (auto& [image, memory] : slot.images) {
+			vmaDestroyImage(allocator, image, memory);
+		}
+
+		for (auto& [buffer, memory] : slot.buffers) {
+			vmaDestroyBuffer(allocator, buffer, memory);
+		}
+
+		for (VkFence fence : slot.fences) {
+			vkDestroyFence(device, fence, nullptr);
+		}
+
+		slot = {};
+	}
+
+	size_t DeletionQueue::CountSlot(const Slot& slot)
+	{
+		return slot.buffers.size() + slot.images.size() + slot.views.size() + slot.samplers.size() + slot.descriptorPools.size() + slot.descriptorSets.size()
+			+ slot.commandBuffers.size() + slot.commandPools.size() + slot.fences.size() + slot.framebuffers.size()
+			+ slot.renderPasses.size() + slot.pipelines.size() + slot.pipelineLayouts.size() + slot.descriptorSetLayouts.size();
+	}
+}
+
+#endif
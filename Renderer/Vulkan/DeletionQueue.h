@@ -0,0 +1,125 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Wrapper/vulkan.h"
+#include <Common/Util/Memory.h>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer::Vulkan { class Device; }
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// holds released vulkan objects until no frame in flight may still use them, instead of waiting for the device to idle
+	// objects go into the slot of the last frame that could have recorded them, the slot is destroyed once that frame's fence is waited again
+	// releasing is thread-safe, pipelines may be dropped by worker threads
+	class DeletionQueue
+	{
+	public:
+
+		// constructor
+		DeletionQueue(Shared<Device> device);
+
+		// destructor
+		~DeletionQueue();
+
+		// delete copy constructor
+		DeletionQueue(const DeletionQueue&) = delete;
+
+		// delete assignment constructor
+		DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+	public:
+
+		// destroys what was released while this frame was last recorded, must be called right after the frame fence is waited
+		void BeginFrame(uint32_t currentFrame);
+
+		// returns how many objects are waiting to be destroyed
+		size_t GetPendingCount();
+
+		// returns how many bytes the images waiting to be destroyed hold, the allocator still counts them as used
+		VkDeviceSize GetPendingImageBytes();
+
+	public:
+
+		// releases a buffer and it's memory
+		void ReleaseBuffer(VkBuffer buffer, VmaAllocation memory);
+
+		// releases an image and it's memory
+		void ReleaseImage(VkImage image, VmaAllocation memory);
+
+		// releases an image view
+		void ReleaseImageView(VkImageView view);
+
+		// releases a sampler
+		void ReleaseSampler(VkSampler sampler);
+
+		// releases a descriptor pool, it's descriptor sets are freed with it
+		void ReleaseDescriptorPool(VkDescriptorPool pool);
+
+		// releases a descriptor set back to it's pool, the pool must allow freeing sets
+		void ReleaseDescriptorSet(VkDescriptorPool pool, VkDescriptorSet descriptorSet);
+
+		// releases a command buffer back to it's pool
+		void ReleaseCommandBuffer(VkCommandPool pool, VkCommandBuffer commandBuffer);
+
+		// releases a command pool, it's command buffers are freed with it
+		void ReleaseCommandPool(VkCommandPool pool);
+
+		// releases a fence
+		void ReleaseFence(VkFence fence);
+
+		// releases a framebuffer
+		void ReleaseFramebuffer(VkFramebuffer framebuffer);
+
+		// releases a render pass
+		void ReleaseRenderPass(VkRenderPass renderPass);
+
+		// releases a pipeline
+		void ReleasePipeline(VkPipeline pipeline);
+
+		// releases a pipeline layout
+		void ReleasePipelineLayout(VkPipelineLayout layout);
+
+		// releases a descriptor set layout
+		void ReleaseDescriptorSetLayout(VkDescriptorSetLayout layout);
+
+	private:
+
+		struct Slot
+		{
+			std::vector<std::pair<VkBuffer, VmaAllocation>> buffers = {};
+			std::vector<std::pair<VkImage, VmaAllocation>> images = {};
+			std::vector<VkImageView> views = {};
+			std::vector<VkSampler> samplers = {};
+			std::vector<VkDescriptorPool> descriptorPools = {};
+			std::vector<std::pair<VkDescriptorPool, VkDescriptorSet>> descriptorSets = {};
+			std::vector<std::pair<VkCommandPool, VkCommandBuffer>> commandBuffers = {};
+			std::vector<VkCommandPool> commandPools = {};
+			std::vector<VkFence> fences = {};
+			std::vector<VkFramebuffer> framebuffers = {};
+			std::vector<VkRenderPass> renderPasses = {};
+			std::vector<VkPipeline> pipelines = {};
+			std::vector<VkPipelineLayout> pipelineLayouts = {};
+			std::vector<VkDescriptorSetLayout> descriptorSetLayouts = {};
+			VkDeviceSize imageBytes = 0;
+		};
+
+		// destroys everything in a slot, users first and what they use last
+		void Flush(Slot& slot);
+
+		// returns how many objects a slot holds
+		static size_t CountSlot(const Slot& slot);
+
+	private:
+
+		Shared<Device> mDevice;
+		std::mutex mMutex;
+		std::vector<Slot> mSlots = {};
+		uint32_t mCurrentSlot = 0;
+	};
+}
+
+#endif
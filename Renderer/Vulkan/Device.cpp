@@ -2,15 +2,36 @@
 #include "Device.h"
 
 #include "Instance.h"
+#include "Uploader.h"
+#include <Common/Core/Defines.h>
 #include <Common/Debug/Logger.h>
+#include <Common/File/Filesystem.h>
+#include <Common/Util/Hash.h>
 #include <Platform/Core/MainWindow.h>
 
 #include <GLFW/glfw3.h>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <set>
 
 namespace Cosmos::Renderer::Vulkan
 {
+	// written before the driver's cache data, the data is only handed to the driver when all of it matches the running device
+	struct PipelineCacheHeader
+	{
+		uint32_t magic = 0x43505343;						// "CSPC"
+		uint32_t version = 2;								// bumped when this header changes
+		uint32_t vendorID = 0;
+		uint32_t deviceID = 0;
+		uint32_t driverVersion = 0;
+		uint8_t uuid[VK_UUID_SIZE] = {};					// pipelineCacheUUID, changes with anything that makes the driver data incompatible
+		uint64_t dataSize = 0;
+		uint64_t dataHash = 0;								// detects truncated or corrupted files
+		double coldBuildTime = 0.0;							// milliseconds the default pipelines took on the run that started the cache
+	};
+
 	Device::Device(Shared<Instance> instance, uint32_t samples)
 		: mInstance(instance)
 	{
@@ -24,6 +45,9 @@ namespace Cosmos::Renderer::Vulkan
 
 		CreateLogicalDevice();
 		CreateAllocator();
+		LoadPipelineCache();
+
+		mUploader = CreateShared<Uploader>(this, COSMOS_UPLOAD_RING_SIZE);
 
 		switch (samples)
 		{
@@ -45,6 +69,11 @@ namespace Cosmos::Renderer::Vulkan
 
 	Device::~Device()
 	{
+		mUploader.reset();
+
+		SavePipelineCache();
+		vkDestroyPipelineCache(mDevice, mPipelineCache, nullptr);
+
 		vmaDestroyAllocator(mAllocator);
 
 		vkDestroyDevice(mDevice, nullptr);
@@ -74,6 +103,18 @@ namespace Cosmos::Renderer::Vulkan
 			if (indices.IsComplete()) break;
 		}
 
+		// a family with transfer but neither graphics nor compute is usually a dedicated copy engine
+		for (uint32_t j = 0; j < queueFamilyCount; j++)
+		{
+			VkQueueFlags flags = queueFamilies[j].queueFlags;
+
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && !(flags & VK_QUEUE_COMPUTE_BIT))
+			{
+				indices.transfer = j;
+				break;
+			}
+		}
+
 		if (!indices.compute.has_value())
 		{
 			COSMOS_LOG(Logger::Warn, "A compute queue was not found");
@@ -124,7 +165,7 @@ namespace Cosmos::Renderer::Vulkan
 		VkBufferCreateInfo bufferCI = {};
 		bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 		bufferCI.size = size;
-		bufferCI.usage = usage;
+		bufferCI.usage = data != nullptr ? usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT : usage;
 		bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		COSMOS_ASSERT(vmaCreateBuffer(mAllocator, &bufferCI, &allocCI, buffer, memory, &allocInfo) == VK_SUCCESS, "Failed to create buffer");
 
@@ -145,6 +186,12 @@ namespace Cosmos::Renderer::Vulkan
 			vmaUnmapMemory(mAllocator, *memory);
 		}
 
+		// vma placed it where the cpu can't write, the data goes through the staging ring with the next batch
+		else if (data != nullptr)
+		{
+			mUploader->UploadBuffer(*buffer, 0, data, size);
+		}
+
 		return VK_SUCCESS;
 	}
 
@@ -234,8 +281,17 @@ namespace Cosmos::Renderer::Vulkan
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
 
-		vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(mGraphicsQueue);
+		// waits only for this submission, the queue may still be running frames and uploads
+		VkFenceCreateInfo fenceCI = {};
+		fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceCI.flags = 0;
+
+		VkFence fence = VK_NULL_HANDLE;
+		COSMOS_ASSERT(vkCreateFence(mDevice, &fenceCI, nullptr, &fence) == VK_SUCCESS, "Failed to create fence");
+
+		vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, fence);
+		vkWaitForFences(mDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+		vkDestroyFence(mDevice, fence, nullptr);
 
 		vkFreeCommandBuffers(mDevice, commandPool, 1, &commandBuffer);
 	}
@@ -461,6 +517,11 @@ namespace Cosmos::Renderer::Vulkan
 		std::vector<VkDeviceQueueCreateInfo> deviceQueueCIs;
 		std::set<uint32_t> uniqueQueueFamilies = { indices.graphics.value(), indices.present.value(), indices.compute.value() };
 
+		if (indices.transfer.has_value())
+		{
+			uniqueQueueFamilies.insert(indices.transfer.value());
+		}
+
 		for (uint32_t queueFamily : uniqueQueueFamilies)
 		{
 			VkDeviceQueueCreateInfo deviceQueueCI = {};
@@ -479,9 +540,50 @@ namespace Cosmos::Renderer::Vulkan
 		extensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
 #endif
 
+		// memory budget is optional, it lets vma report the real heap usage and budget instead of estimating it
+		uint32_t availableCount = 0;
+		vkEnumerateDeviceExtensionProperties(mPhysicalDevice, nullptr, &availableCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(availableCount);
+		vkEnumerateDeviceExtensionProperties(mPhysicalDevice, nullptr, &availableCount, availableExtensions.data());
+
+		for (const VkExtensionProperties& extension : availableExtensions)
+		{
+			if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+			{
+				extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+				mMemoryBudget = true;
+			}
+
+			// core on vulkan 1.2, the extension is still enabled for drivers reporting it
+			if (strcmp(extension.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0)
+			{
+				extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+			}
+		}
+
+		// the global descriptor set indexes textures by material, only the features it uses are enabled
+		VkPhysicalDeviceDescriptorIndexingFeatures availableIndexing = {};
+		availableIndexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+		VkPhysicalDeviceFeatures2 availableFeatures = {};
+		availableFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		availableFeatures.pNext = &availableIndexing;
+		vkGetPhysicalDeviceFeatures2(mPhysicalDevice, &availableFeatures);
+
+		VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+		indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+		indexingFeatures.shaderSampledImageArrayNonUniformIndexing = availableIndexing.shaderSampledImageArrayNonUniformIndexing;
+		indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = availableIndexing.descriptorBindingSampledImageUpdateAfterBind;
+		indexingFeatures.descriptorBindingPartiallyBound = availableIndexing.descriptorBindingPartiallyBound;
+		indexingFeatures.runtimeDescriptorArray = availableIndexing.runtimeDescriptorArray;
+
+		mDescriptorIndexing = indexingFeatures.shaderSampledImageArrayNonUniformIndexing && indexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+			&& indexingFeatures.descriptorBindingPartiallyBound && indexingFeatures.runtimeDescriptorArray;
+
 		VkDeviceCreateInfo deviceCI = {};
 		deviceCI.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-		deviceCI.pNext = nullptr;
+		deviceCI.pNext = &indexingFeatures;
 		deviceCI.flags = 0;
 		deviceCI.queueCreateInfoCount = (uint32_t)deviceQueueCIs.size();
 		deviceCI.pQueueCreateInfos = deviceQueueCIs.data();
@@ -507,6 +609,128 @@ namespace Cosmos::Renderer::Vulkan
 		vkGetDeviceQueue(mDevice, indices.graphics.value(), 0, &mGraphicsQueue);
 		vkGetDeviceQueue(mDevice, indices.present.value(), 0, &mPresentQueue);
 		vkGetDeviceQueue(mDevice, indices.compute.value(), 0, &mComputeQueue);
+
+		if (indices.transfer.has_value())
+		{
+			vkGetDeviceQueue(mDevice, indices.transfer.value(), 0, &mTransferQueue);
+		}
+	}
+
+	void Device::SetColdBuildTime(double buildTime)
+	{
+		if (!mPipelineCacheWarm && mColdBuildTime == 0.0) {
+			mColdBuildTime = buildTime;
+		}
+	}
+
+	void Device::LoadPipelineCache()
+	{
+		std::string path = GetCacheSubDir("pipeline.cache");
+		std::vector<char> data = {};
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+		if (file.is_open()) {
+			size_t fileSize = (size_t)file.tellg();
+			PipelineCacheHeader header = {};
+			file.seekg(0);
+
+			if (fileSize >= sizeof(header) && file.read((char*)&header, sizeof(header))) {
+				PipelineCacheHeader expected = {};
+				expected.vendorID = mProperties.vendorID;
+				expected.deviceID = mProperties.deviceID;
+				expected.driverVersion = mProperties.driverVersion;
+				memcpy(expected.uuid, mProperties.pipelineCacheUUID, VK_UUID_SIZE);
+
+				bool matches = header.magic == expected.magic && header.version == expected.version
+					&& header.vendorID == expected.vendorID && header.deviceID == expected.deviceID && header.driverVersion == expected.driverVersion
+					&& memcmp(header.uuid, expected.uuid, VK_UUID_SIZE) == 0 && header.dataSize == fileSize - sizeof(header);
+
+				if (matches) {
+					data.resize((size_t)header.dataSize);
+					file.read(data.data(), (std::streamsize)data.size());
+
+					if (!file || HashBytes(data.data(), data.size()) != header.dataHash) {
+						COSMOS_LOG(Logger::Warn, "Pipeline cache %s is corrupted, pipelines will be created cold", path.c_str());
+						data.clear();
+					}
+
+					else {
+						mColdBuildTime = header.coldBuildTime;
+					}
+				}
+
+				else {
+					COSMOS_LOG(Logger::Info, "Pipeline cache %s was made by another device or driver, pipelines will be created cold", path.c_str());
+				}
+			}
+		}
+
+		VkPipelineCacheCreateInfo pipelineCacheCI = {};
+		pipelineCacheCI.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		pipelineCacheCI.pNext = nullptr;
+		pipelineCacheCI.flags = 0;
+		pipelineCacheCI.initialDataSize = data.size();
+		pipelineCacheCI.pInitialData = data.empty() ? nullptr : data.data();
+
+		// the driver may still refuse data it doesn't like, an empty cache is created instead
+		if (vkCreatePipelineCache(mDevice, &pipelineCacheCI, nullptr, &mPipelineCache) != VK_SUCCESS) {
+			pipelineCacheCI.initialDataSize = 0;
+			pipelineCacheCI.pInitialData = nullptr;
+			data.clear();
+			mColdBuildTime = 0.0;
+			COSMOS_ASSERT(vkCreatePipelineCache(mDevice, &pipelineCacheCI, nullptr, &mPipelineCache) == VK_SUCCESS, "Failed to create pipeline cache");
+		}
+
+		mPipelineCacheWarm = !data.empty();
+	}
+
+	void Device::SavePipelineCache()
+	{
+		if (mPipelineCache == VK_NULL_HANDLE) {
+			return;
+		}
+
+		size_t dataSize = 0;
+		vkGetPipelineCacheData(mDevice, mPipelineCache, &dataSize, nullptr);
+
+		std::vector<char> data(dataSize);
+
+		if (dataSize == 0 || vkGetPipelineCacheData(mDevice, mPipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+			return;
+		}
+
+		PipelineCacheHeader header = {};
+		header.vendorID = mProperties.vendorID;
+		header.deviceID = mProperties.deviceID;
+		header.driverVersion = mProperties.driverVersion;
+		memcpy(header.uuid, mProperties.pipelineCacheUUID, VK_UUID_SIZE);
+		header.dataSize = dataSize;
+		header.dataHash = HashBytes(data.data(), dataSize);
+		header.coldBuildTime = mColdBuildTime;
+
+		// written aside and then renamed, a crash while saving never leaves a half-written cache behind
+		std::string path = GetCacheSubDir("pipeline.cache");
+		std::string temporary = path + ".tmp";
+		{
+			std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+			file.write((const char*)&header, sizeof(header));
+			file.write(data.data(), (std::streamsize)dataSize);
+
+			if (!file) {
+				COSMOS_LOG(Logger::Error, "Failed to write pipeline cache %s", temporary.c_str());
+				return;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary, path, error);
+
+		if (error) {
+			COSMOS_LOG(Logger::Error, "Failed to save pipeline cache %s: %s", path.c_str(), error.message().c_str());
+			return;
+		}
+
+		COSMOS_LOG(Logger::Trace, "Saved %.2fKB of pipeline cache into %s", dataSize / 1024.0, path.c_str());
 	}
 
 	void Device::CreateAllocator()
@@ -542,7 +766,7 @@ namespace Cosmos::Renderer::Vulkan
 		//functions.vkGetDeviceImageMemoryRequirements = vkGetDeviceImageMemoryRequirements;
 
 		VmaAllocatorCreateInfo ci = {};
-		ci.flags = 0;
+		ci.flags = mMemoryBudget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0;
 		ci.physicalDevice = mPhysicalDevice;
 		ci.device = mDevice;
 		ci.preferredLargeHeapBlockSize = 0;
@@ -8,6 +8,7 @@
 
 // forward declaration
 namespace Cosmos::Renderer::Vulkan { class Instance; }
+namespace Cosmos::Renderer::Vulkan { class Uploader; }
 
 namespace Cosmos::Renderer::Vulkan
 {
@@ -20,6 +21,7 @@ namespace Cosmos::Renderer::Vulkan
 			std::optional<uint32_t> graphics;
 			std::optional<uint32_t> present;
 			std::optional<uint32_t> compute;
+			std::optional<uint32_t> transfer;				// transfer-only family, not required
 
 			// returns if found all queues
 			inline bool IsComplete() const { return graphics.has_value() && present.has_value() && compute.has_value(); }
@@ -51,6 +53,12 @@ namespace Cosmos::Renderer::Vulkan
 		// returns the compute queue
 		inline VkQueue GetComputeQueue() const { return mComputeQueue; }
 
+		// returns the transfer-only queue, null if the device has no such family
+		inline VkQueue GetTransferQueue() const { return mTransferQueue; }
+
+		// returns a reference to the upload queue
+		inline Shared<Uploader>& GetUploaderRef() { return mUploader; }
+
 		// returns the sampling in use
 		inline VkSampleCountFlagBits GetMSAA() const { return mMSAACount; }
 
@@ -66,6 +74,30 @@ namespace Cosmos::Renderer::Vulkan
 		// returns a reference to the vulkan physical device memory properties
 		inline VkPhysicalDeviceMemoryProperties& GetMemoryPropertiesRef() { return mMemoryProperties; }
 
+		// returns if the driver reports the real memory budget and usage (VK_EXT_memory_budget), vma estimates them otherwise
+		inline bool IsMemoryBudgetSupported() const { return mMemoryBudget; }
+
+		// returns if indirect draws may start past the first instance, gpu culling draws each primitive from where it packed the visible instances
+		inline bool IsIndirectFirstInstanceSupported() const { return mFeatures.drawIndirectFirstInstance == VK_TRUE; }
+
+		// returns if textures can be indexed from a partially bound array updated after bind, required by the global descriptor set
+		inline bool IsDescriptorIndexingSupported() const { return mDescriptorIndexing; }
+
+		// returns the pipeline cache shared by all pipelines, it's loaded from disk on startup and saved on shutdown
+		inline VkPipelineCache GetPipelineCache() const { return mPipelineCache; }
+
+		// returns if the pipeline cache was loaded from disk, pipelines created with it are warm
+		inline bool IsPipelineCacheWarm() const { return mPipelineCacheWarm; }
+
+	public: // pipeline cache
+
+		// returns how long the default pipelines took to build on the last run that started with an empty cache, zero if it's unknown
+		inline double GetColdBuildTime() const { return mColdBuildTime; }
+
+		// records the default pipelines build time of a run started with an empty cache, it's saved with the cache so warm runs can compare against it
+		// only the first build counts, the ones after it already hit the cache in memory
+		void SetColdBuildTime(double buildTime);
+
 	public: // device
 
 		// returns the queue indices for all available queues
@@ -125,6 +157,12 @@ namespace Cosmos::Renderer::Vulkan
 		// creates a logical device out of the choosen physical device
 		void CreateLogicalDevice();
 
+		// creates the shared pipeline cache, with the data saved by the last run if it was made by this same device and driver
+		void LoadPipelineCache();
+
+		// writes the shared pipeline cache to disk
+		void SavePipelineCache();
+
 		// creates the vma
 		void CreateAllocator();
 
@@ -140,8 +178,16 @@ namespace Cosmos::Renderer::Vulkan
 		VkQueue mGraphicsQueue = VK_NULL_HANDLE;
 		VkQueue mPresentQueue = VK_NULL_HANDLE;
 		VkQueue mComputeQueue = VK_NULL_HANDLE;
+		VkQueue mTransferQueue = VK_NULL_HANDLE;
 		VkSampleCountFlagBits mMSAACount = VK_SAMPLE_COUNT_1_BIT;
 		VmaAllocator mAllocator = VK_NULL_HANDLE;
+		Shared<Uploader> mUploader;
+		bool mMemoryBudget = false;
+		bool mDescriptorIndexing = false;
+
+		VkPipelineCache mPipelineCache = VK_NULL_HANDLE;
+		bool mPipelineCacheWarm = false;
+		double mColdBuildTime = 0.0;
 	};
 }
 
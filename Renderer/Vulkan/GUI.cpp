@@ -2,6 +2,7 @@
 #ifdef RENDERER_VULKAN
 
 #include "Context.h"
+#include "DeletionQueue.h"
 #include "Device.h"
 #include "Instance.h"
 #include "Renderpass.h"
@@ -200,6 +201,13 @@ namespace Cosmos::Renderer::Vulkan
 		return descriptorSet;
 	}
 
+	void GUI::RemoveTexture(void* descriptor)
+	{
+		ImGui_ImplVulkan_Data* bd = ImGui_ImplVulkan_GetBackendData();
+		auto* renderer = (Vulkan::Context*)Context::GetRef();
+		renderer->GetDeletionQueueRef()->ReleaseDescriptorSet(bd->VulkanInitInfo.DescriptorPool, (VkDescriptorSet)descriptor);
+	}
+
 	void GUI::SetImageCount(uint32_t count)
 	{
 		ImGui_ImplVulkan_SetMinImageCount(count);
@@ -369,6 +377,7 @@ namespace Cosmos::Renderer::Vulkan
 		initInfo.PhysicalDevice = renderer->GetDevice()->GetPhysicalDevice();
 		initInfo.Device = renderer->GetDevice()->GetLogicalDevice();
 		initInfo.Queue = renderer->GetDevice()->GetGraphicsQueue();
+		initInfo.PipelineCache = renderer->GetDevice()->GetPipelineCache();
 		initInfo.DescriptorPool = renderpass->GetDescriptorPoolRef();
 		initInfo.MinImageCount = renderer->GetSwapchain()->GetImageCount();
 		initInfo.ImageCount = renderer->GetSwapchain()->GetImageCount();
@@ -34,6 +34,9 @@ namespace Cosmos::Renderer::Vulkan
 		// adds a texture to be used on the ui
 		virtual void* AddTexture(Shared<ITexture2D> texture) override;
 
+		// frees a descriptor set returned by AddTexture once no frame in flight uses it
+		void RemoveTexture(void* descriptor);
+
 	public:
 
 		// sets how many frames are simultaneously being rendered
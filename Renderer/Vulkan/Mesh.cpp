@@ -1,18 +1,29 @@
 #if defined RENDERER_VULKAN
 #include "Mesh.h"
 
+#include "Bindless.h"
 #include "Buffer.h"
 #include "Context.h"
+#include "Culling.h"
+#include "DeletionQueue.h"
 #include "Device.h"
 #include "Pipeline.h"
 #include "Renderpass.h"
+#include "ResidencyManager.h"
 #include "Texture.h"
+#include "Uploader.h"
+#include "GLTF/Source.h"
 #include "Wrapper/tinygltf.h"
 
 #include <Common/Core/Defines.h>
 #include <Common/Debug/Logger.h>
 #include <Common/File/Filesystem.h>
+#include <Common/Util/ThreadPool.h>
+#include <Common/Util/Timer.h>
+#include <Engine/Entity/Camera.h>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 
 namespace Cosmos::Renderer::Vulkan
@@ -33,57 +44,89 @@ namespace Cosmos::Renderer::Vulkan
 		ProcessAnimation(timestep);
 	}
 
-	void Mesh::OnRender(const glm::mat4& transform, uint64_t id, IContext::Stage stage)
+	bool Mesh::OnPrepare(RenderQueue::Batch& batch, IContext::Stage stage)
 	{
-		if (!mLoaded) {
-			return;
+		// instances come already culled by the scene, the gpu culls them again per primitive when supported
+		if (!mLoaded || batch.count == 0) {
+			return false;
 		}
 
 		Context* renderer = (Vulkan::Context*)Context::GetRef();
-		VkDeviceSize offsets[] = { 0 };
-
-		VkCommandBuffer cmdBuffer = VK_NULL_HANDLE;
-		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
-		VkPipeline pipelinePtr = VK_NULL_HANDLE;
+		Pipeline* pipeline = nullptr;
 
 		switch (stage)
 		{
 			case Cosmos::Renderer::IContext::Stage::Default: 
 			{ 
-				cmdBuffer = renderer->GetMainRenderpassRef()->GetCommandfuffersRef()[renderer->GetCurrentFrame()];
-				pipelineLayout = renderer->GetPipelinesLibraryRef().GetRef("Mesh")->GetPipelineLayout();
-				pipelinePtr = renderer->GetPipelinesLibraryRef().GetRef("Mesh")->GetPipeline();
+				pipeline = renderer->GetMeshPipeline(GetFeatures());
+				TouchTextures(batch.instances, batch.count);
 				break; 
 			}
 
 			case Cosmos::Renderer::IContext::Stage::Picking:
 			{
-				cmdBuffer = renderer->GetRenderpassesLibraryRef().GetRef("Picking")->GetCommandfuffersRef()[renderer->GetCurrentFrame()];
-				pipelineLayout = renderer->GetPipelinesLibraryRef().GetRef("Picking")->GetPipelineLayout();
-				pipelinePtr = renderer->GetPipelinesLibraryRef().GetRef("Picking")->GetPipeline();
+				pipeline = renderer->GetMeshPipeline(Feature::Picking);
 				break;
 			}
 			
 			case Cosmos::Renderer::IContext::Stage::Wireframe:
 			{
 				COSMOS_LOG(Logger::Error, "Not implemented");
-				break;
+				return false;
 			}
 		}
-		
-		vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &mGPUData.vertexBuffer, offsets);
-		vkCmdBindIndexBuffer(cmdBuffer, mGPUData.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &mGPUData.descriptorSets[renderer->GetCurrentFrame()], 0, NULL);
-		vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelinePtr);
-		
-		PushConstant constants = {};
-		constants.id = id;
-		constants.selected = (uint32_t)mSelected;
-		constants.model = transform;
-		vkCmdPushConstants(cmdBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstant), &constants);
-		
+
+		batch.firstInstance = renderer->WriteInstances(batch.instances, batch.count, mGPUData.material);
+		batch.pipeline = pipeline;
+		return batch.firstInstance != UINT32_MAX;
+	}
+
+	void Mesh::OnRender(const RenderQueue::Batch& batch, RenderQueue::BindState& state, IContext::Stage stage)
+	{
+		Context* renderer = (Vulkan::Context*)Context::GetRef();
+		VkDeviceSize offsets[] = { 0 };
+
+		VkCommandBuffer cmdBuffer = (VkCommandBuffer)state.commandBuffer;
+		Pipeline* pipeline = (Pipeline*)batch.pipeline;
+		VkPipelineLayout pipelineLayout = pipeline->GetPipelineLayout();
+		VkPipeline pipelinePtr = pipeline->GetPipeline();
+
+		// draws come sorted from the render queue, anything already bound by the previous draw is not bound again, all meshes share the global descriptor set
+		VkDescriptorSet descriptorSet = renderer->GetBindlessRef()->GetDescriptorSet(renderer->GetCurrentFrame());
+
+		if (state.pipeline != pipelinePtr) {
+			vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelinePtr);
+			state.pipeline = pipelinePtr;
+			state.descriptorSet = nullptr;
+			state.binds++;
+		}
+
+		if (state.descriptorSet != descriptorSet) {
+			vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
+			state.descriptorSet = descriptorSet;
+			state.binds++;
+		}
+
+		if (state.vertexBuffer != mGPUData.vertexBuffer) {
+			vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &mGPUData.vertexBuffer, offsets);
+			state.vertexBuffer = mGPUData.vertexBuffer;
+			state.binds++;
+		}
+
+		if (state.indexBuffer != mGPUData.indexBuffer) {
+			vkCmdBindIndexBuffer(cmdBuffer, mGPUData.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			state.indexBuffer = mGPUData.indexBuffer;
+			state.binds++;
+		}
+
+		// meshlets are culled on mesh space and only for a single instance, vertices are not transformed by the node matrix on the shaders
+		Engine::Camera& camera = Engine::Camera::GetRef();
+		const glm::mat4& model = batch.instances[0].model;
+		Frustum frustum(camera.GetProjectionRef() * camera.GetViewRef() * model);
+		glm::vec3 cameraPosition = glm::vec3(glm::inverse(camera.GetViewRef() * model)[3]);
+
 		for (auto& node : mNodes) {
-			RenderNode(node, cmdBuffer);
+			RenderNode(node, state, frustum, cameraPosition, batch.count, batch.firstInstance);
 		}
 	}
 
@@ -94,19 +137,30 @@ namespace Cosmos::Renderer::Vulkan
 		}
 
 		Context* renderer = (Vulkan::Context*)Context::GetRef();
-		VkResult res = vkGetFenceStatus(renderer->GetDevice()->GetLogicalDevice(), mGPUData.transferFence);
-		return res == VK_SUCCESS ? false : true;
+		return !renderer->GetDevice()->GetUploaderRef()->IsComplete(mGPUData.uploadTicket);
 	}
 
 	void Mesh::LoadFromFile(std::string path, float scale)
 	{
 		Clear();
 
+		mMaterial.SetName("Default Material");
+		mMaterial.GetAlbedoTextureRef() = CreateShared<Texture2D>(GetAssetSubDir("Texture/Default/default_1024_grey.png"));
+
+		LoadGeometry(path, scale);
+	}
+
+	void Mesh::LoadGeometry(std::string path, float scale)
+	{
+		Timer loadTimer;
+		loadTimer.Start();
+
 		tinygltf::Model model;
-		tinygltf::TinyGLTF context;
+		GLTF::Source source;
 		std::string error, warning;
 
-		bool fileLoaded = context.LoadASCIIFromFile(&model, &error, &warning, path);
+		// both .gltf and .glb are accepted, buffers are read in-place from memory-mapped files
+		bool fileLoaded = source.Load(path, model, error, warning);
 
 		if (!fileLoaded) {
 			COSMOS_LOG(Logger::Error, "Failed to load mesh %s, error: %s", path.c_str(), error.c_str());
@@ -126,26 +180,75 @@ namespace Cosmos::Renderer::Vulkan
 			GLTF::Node::GetNodeVertexAndIndexCount(model.nodes[scene.nodes[i]], model, verticesCount, indicesCount);
 		}
 		
-		mVertices.resize(verticesCount);
-		
 		// load and parse gltf properties
 		mName = std::filesystem::path(path).filename().string();
 		mPath = path;
+		mScale = scale;
 
-		mMaterial.SetName("Default Material");
-		mMaterial.GetAlbedoTextureRef() = CreateShared<Texture2D>(GetAssetSubDir("Texture/Default/default_1024_grey.png"));
+		// vertices and indices are decoded straight into the mesh copy, released later according to the residency
+		mVertices.resize(verticesCount);
+		mIndices.resize(indicesCount);
 
 		GLTF::Node::MeshLoaderInfo info = {};
-		info.vertexBuffer = new Vertex[verticesCount];
-		info.indexBuffer = new uint32_t[indicesCount];
+		info.vertexBuffer = mVertices.data();
+		info.indexBuffer = mIndices.data();
+		info.source = &source;
 
 		for (size_t i = 0; i < scene.nodes.size(); i++) {
 			const tinygltf::Node node = model.nodes[scene.nodes[i]];
-			GLTF::Node::LoadNode(nullptr, node, scene.nodes[i], model, info, mNodes, mLinearNodes, mMaterial, mVertices, scale);
+			GLTF::Node::LoadNode(nullptr, node, scene.nodes[i], model, info, mNodes, mLinearNodes, mMaterial);
+		}
+
+		// primitives failing validation were skipped and left their range unused
+		verticesCount = info.vertexPos;
+		indicesCount = info.indexPos;
+		mVertices.resize(verticesCount);
+		mIndices.resize(indicesCount);
+
+		if (verticesCount == 0) {
+			COSMOS_LOG(Logger::Error, "Failed to load mesh %s, it has no valid primitive", path.c_str());
+			Clear();
+			return;
 		}
 
-		mAnimations = GLTF::Animation::LoadAnimations(model, mNodes);
-		mSkins = GLTF::Skin::LoadSkins(model, mNodes);
+		Timer decodeTimer;
+		decodeTimer.Start();
+		GLTF::Node::LoadPrimitives(model, info, scale);
+		COSMOS_LOG(Logger::Trace, "Decoded %s (%zu vertices, %zu primitives) in %.3fms using %d worker(s)", mName.c_str(), verticesCount, info.primitives.size(), decodeTimer.Stop(), ThreadPool::GetRef().GetThreadCount() + 1);
+
+		// mesh-space bounds, used to measure how big the mesh is on screen
+		glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+		glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+
+		for (const Vertex& vertex : mVertices) {
+			boundsMin = glm::min(boundsMin, vertex.position);
+			boundsMax = glm::max(boundsMax, vertex.position);
+		}
+
+		mBounds = BoundingBox(boundsMin, boundsMax);
+		mBounds.SetValid(!mVertices.empty());
+
+		// features are only enabled when the file uses them, meshes without them are drawn by cheaper pipeline variants
+		mFeatures = 0;
+
+		for (const tinygltf::Mesh& gltfMesh : model.meshes) {
+			for (const tinygltf::Primitive& primitive : gltfMesh.primitives) {
+				if (primitive.attributes.find("COLOR_0") != primitive.attributes.end()) {
+					mFeatures |= Feature::VertexColors;
+				}
+			}
+		}
+
+		for (const tinygltf::Material& material : model.materials) {
+			if (material.alphaMode == "MASK") {
+				mFeatures |= Feature::AlphaTest;
+				mMaterial.SetAlphaCutoff((float)material.alphaCutoff);
+				break;
+			}
+		}
+
+		mAnimations = GLTF::Animation::LoadAnimations(model, source, mNodes);
+		mSkins = GLTF::Skin::LoadSkins(model, source, mNodes);
 
 		// assign skins and initial positions
 		for (auto node : mLinearNodes) {
@@ -160,58 +263,62 @@ namespace Cosmos::Renderer::Vulkan
 
 		// gpu resources
 		CreateRendererResources((uint32_t)verticesCount, (uint32_t)indicesCount, info);
-		SetupDescriptors();
-		UpdateDescriptors();
-
-		// free resources
-		delete[] info.vertexBuffer;
-		delete[] info.indexBuffer;
+		UpdateMaterial();
 
 		mLoaded = true;
+		ApplyResidency();
+		BuildTriangleBVH();
+
+		size_t resident = verticesCount * sizeof(Vertex) + indicesCount * sizeof(uint32_t);
+		COSMOS_LOG(Logger::Trace, "Loaded %s in %.3fms, %.2fMB of buffers read in-place from mapped files, %.2fMB decoded, %.2fMB kept (%s)", mName.c_str(), loadTimer.Stop(), source.GetMappedBytes() / (1024.0 * 1024.0), resident / (1024.0 * 1024.0), mResidentBytes / (1024.0 * 1024.0), ResidencyToString(mResidency));
+	}
+
+	const TriangleBVH* Mesh::GetTriangleBVH()
+	{
+		// built on a worker after loading, until it's done rays are tested against the mesh bounds
+		if (mTriangleBVHBuild.valid() && mTriangleBVHBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			mTriangleBVH = mTriangleBVHBuild.get();
+			TrackResidentBytes(mVertices.size() * sizeof(Vertex) + mPositions.size() * sizeof(glm::vec3) + mIndices.size() * sizeof(uint32_t) + mTriangleBVH.GetMemoryBytes());
+		}
+
+		return mTriangleBVH.IsEmpty() ? nullptr : &mTriangleBVH;
 	}
 
     void Mesh::Refresh()
     {
-		UpdateDescriptors();
+		UpdateMaterial();
     }
 
+	void Mesh::SetResidency(Residency residency)
+	{
+		if (residency == mResidency) {
+			return;
+		}
+
+		Residency previous = mResidency;
+		mResidency = residency;
+
+		if (!mLoaded) {
+			return;
+		}
+
+		// released data can only be brought back by reading the file again, with the same scale it was baked with, the material is kept as it is
+		if (residency > previous) {
+			Clear();
+			LoadGeometry(mPath, mScale);
+			return;
+		}
+
+		ApplyResidency();
+	}
+
     void Mesh::CreateRendererResources(uint32_t verticesCount, uint32_t indicesCount, GLTF::Node::MeshLoaderInfo& info)
     {
 		size_t verticesBufferSize = verticesCount * sizeof(Vertex);
 		size_t indicesBufferSize = indicesCount * sizeof(uint32_t);
 
-		// create staging buffers
-		struct StagingBuffer
-		{
-			VkBuffer buffer;
-			VmaAllocation memory;
-		} vertexStaging, indexStaging;
-
 		Context* renderer = (Vulkan::Context*)Context::GetRef();
 
-		COSMOS_ASSERT(renderer->GetDevice()->CreateBuffer
-		(
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			verticesBufferSize,
-			&vertexStaging.buffer,
-			&vertexStaging.memory,
-			info.vertexBuffer) == VK_SUCCESS, "Failed to create vertex staging buffer"
-		);
-
-		if (indicesBufferSize > 0)
-		{
-			COSMOS_ASSERT(renderer->GetDevice()->CreateBuffer
-			(
-				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				indicesBufferSize,
-				&indexStaging.buffer,
-				&indexStaging.memory,
-				info.indexBuffer) == VK_SUCCESS, "Failed to create index staging buffer"
-			);
-		}
-
 		// create local buffers
 		COSMOS_ASSERT(renderer->GetDevice()->CreateBuffer
 		(
@@ -234,151 +341,84 @@ namespace Cosmos::Renderer::Vulkan
 			);
 		}
 
-		// copy from staging buffer to device local buffer
-		COSMOS_LOG(Logger::Info, "Send a signal/fence alongside the copy command in order to know when transfering is complete");
-
-		auto& renderpass = renderer->GetMainRenderpassRef();
-		VkCommandBuffer cmdbuffer = renderer->GetDevice()->CreateCommandBuffer(renderpass->GetCommandPoolRef(), VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-
-		VkBufferCopy copyRegion = {};
-		copyRegion.size = verticesBufferSize;
-		vkCmdCopyBuffer(cmdbuffer, vertexStaging.buffer, mGPUData.vertexBuffer, 1, &copyRegion);
+		// copies go out with the next upload batch, the mesh is drawn once it retires
+		Shared<Uploader>& uploader = renderer->GetDevice()->GetUploaderRef();
+		mGPUData.uploadTicket = uploader->UploadBuffer(mGPUData.vertexBuffer, 0, info.vertexBuffer, verticesBufferSize);
 
 		if (indicesBufferSize > 0) {
-			copyRegion.size = indicesBufferSize;
-			vkCmdCopyBuffer(cmdbuffer, indexStaging.buffer, mGPUData.indexBuffer, 1, &copyRegion);
+			mGPUData.uploadTicket = uploader->UploadBuffer(mGPUData.indexBuffer, 0, info.indexBuffer, indicesBufferSize);
 		}
+    }
 
-		COSMOS_ASSERT(vkEndCommandBuffer(cmdbuffer) == VK_SUCCESS, "Failed to end the recording of the command buffer");
-
-		// submit to gpu
-		VkSubmitInfo submitInfo = {};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.pNext = nullptr;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &cmdbuffer;
-
-		VkFenceCreateInfo fenceCI = {};
-		fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceCI.pNext = nullptr;
-		fenceCI.flags = 0;
+    void Mesh::UpdateMaterial()
+    {
+		Context* renderer = (Vulkan::Context*)Context::GetRef();
+		Texture2D* albedo = (Texture2D*)mMaterial.GetAlbedoTextureRef().get();
 
-		COSMOS_ASSERT(vkCreateFence(renderer->GetDevice()->GetLogicalDevice(), &fenceCI, nullptr, &mGPUData.transferFence) == VK_SUCCESS, "Failed to create fence for command buffer submission");
-		COSMOS_ASSERT(vkQueueSubmit(renderer->GetDevice()->GetGraphicsQueue(), 1, &submitInfo, mGPUData.transferFence) == VK_SUCCESS, "Failed to submit command buffer");
-		COSMOS_LOG(Logger::Info, "Todo: Command buffers deletion queue must be implemented, they're currently not being deleted. Make an assets manager to handle such things");
+		// the record only holds texture indices, streaming an albedo doesn't change it, a texture without index falls back to the first one
+		Bindless::Material material = {};
+		material.albedo = albedo && albedo->GetBindlessIndex() != Bindless::Invalid ? albedo->GetBindlessIndex() : 0;
+		material.alphaCutoff = mMaterial.GetAlphaCutoff();
 
-		// free staging resources
-		vmaDestroyBuffer(renderer->GetDevice()->GetAllocator(), vertexStaging.buffer, vertexStaging.memory);
+		if (mGPUData.material == Bindless::Invalid) {
+			mGPUData.material = renderer->GetBindlessRef()->RegisterMaterial(material);
+		}
 
-		if (indicesBufferSize > 0) {
-			vmaDestroyBuffer(renderer->GetDevice()->GetAllocator(), indexStaging.buffer, indexStaging.memory);
+		else {
+			renderer->GetBindlessRef()->UpdateMaterial(mGPUData.material, material);
 		}
     }
 
-    void Mesh::SetupDescriptors()
-    {
+	void Mesh::TouchTextures(const RenderQueue::Instance* instances, uint32_t count)
+	{
 		Context* renderer = (Vulkan::Context*)Context::GetRef();
 
-		// descriptor pool and descriptor sets
-		std::array<VkDescriptorPoolSize, 3> poolSizes = {};
-		// 0: Camera data
-		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[0].descriptorCount = CONCURENTLY_RENDERED_FRAMES;
-		// 1: Albedo map
-		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = CONCURENTLY_RENDERED_FRAMES;
-		// 2: Storage buffer
-		poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-		poolSizes[2].descriptorCount = CONCURENTLY_RENDERED_FRAMES;
-
-		VkDescriptorPoolCreateInfo descPoolCI = {};
-		descPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		descPoolCI.poolSizeCount = (uint32_t)poolSizes.size();
-		descPoolCI.pPoolSizes = poolSizes.data();
-		descPoolCI.maxSets = CONCURENTLY_RENDERED_FRAMES;
-		COSMOS_ASSERT(vkCreateDescriptorPool(renderer->GetDevice()->GetLogicalDevice(), &descPoolCI, nullptr, &mGPUData.descriptorPool) == VK_SUCCESS, "Failed to create descriptor pool");
-
-		std::vector<VkDescriptorSetLayout> layouts(CONCURENTLY_RENDERED_FRAMES, renderer->GetPipelinesLibraryRef().GetRef("Mesh")->GetDescriptorSetLayout());
-
-		VkDescriptorSetAllocateInfo descSetAllocInfo = {};
-		descSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		descSetAllocInfo.descriptorPool = mGPUData.descriptorPool;
-		descSetAllocInfo.descriptorSetCount = (uint32_t)CONCURENTLY_RENDERED_FRAMES;
-		descSetAllocInfo.pSetLayouts = layouts.data();
-
-		mGPUData.descriptorSets.resize(CONCURENTLY_RENDERED_FRAMES);
-		COSMOS_ASSERT(vkAllocateDescriptorSets(renderer->GetDevice()->GetLogicalDevice(), &descSetAllocInfo, mGPUData.descriptorSets.data()) == VK_SUCCESS, "Failed to allocate descriptor sets");
-    }
+		if (!mBounds.IsValid() || !renderer->GetResidencyManagerRef()) {
+			return;
+		}
 
-    void Mesh::UpdateDescriptors()
-    {
-		Context* renderer = (Vulkan::Context*)Context::GetRef();
+		Engine::Camera& camera = Engine::Camera::GetRef();
+		glm::vec3 cameraPosition = glm::vec3(glm::inverse(camera.GetViewRef())[3]);
+		float height = renderer->GetViewportBoundariesRef().size.y;
+		float screenSize = 0.0f;
 
-		for (size_t i = 0; i < CONCURENTLY_RENDERED_FRAMES; i++) {
+		// the closest instance decides, all of them sample the same texture
+		for (uint32_t i = 0; i < count; i++) {
+			const glm::mat4& transform = instances[i].model;
 
-			// 0: Camera data
-			{
-				VkDescriptorBufferInfo bufferInfo = {};
-				bufferInfo.buffer = renderer->GetBuffersLibraryRef().GetRef("Camera")->GetBuffersRef()[i];
-				bufferInfo.offset = 0;
-				bufferInfo.range = sizeof(Renderer::Vulkan::CameraBuffer);
-
-				VkWriteDescriptorSet cameraDesc = {};
-				cameraDesc.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				cameraDesc.dstSet = mGPUData.descriptorSets[i];
-				cameraDesc.dstBinding = 0;
-				cameraDesc.dstArrayElement = 0;
-				cameraDesc.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-				cameraDesc.descriptorCount = 1;
-				cameraDesc.pBufferInfo = &bufferInfo;
-
-				vkUpdateDescriptorSets(renderer->GetDevice()->GetLogicalDevice(), 1, &cameraDesc, 0, nullptr);
-			}
+			// bounding sphere on world space, the radius follows the largest scale axis
+			glm::vec3 center = glm::vec3(transform * glm::vec4((mBounds.GetMin() + mBounds.GetMax()) * 0.5f, 1.0f));
+			float scale = std::max({ glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])) });
+			float radius = glm::length(mBounds.GetMax() - mBounds.GetMin()) * 0.5f * scale;
+			float distance = glm::length(cameraPosition - center);
 
-			// 1: Albedo map
-			{
-				VkDescriptorImageInfo colorMapInfo = {};
-				colorMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-				colorMapInfo.imageView = (VkImageView)mMaterial.GetAlbedoTextureRef()->GetView();
-				colorMapInfo.sampler = (VkSampler)mMaterial.GetAlbedoTextureRef()->GetSampler();
-
-				VkWriteDescriptorSet colorMapDesc = {};
-				colorMapDesc.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				colorMapDesc.dstSet = mGPUData.descriptorSets[i];
-				colorMapDesc.dstBinding = 1;
-				colorMapDesc.dstArrayElement = 0;
-				colorMapDesc.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-				colorMapDesc.descriptorCount = 1;
-				colorMapDesc.pImageInfo = &colorMapInfo;
-
-				vkUpdateDescriptorSets(renderer->GetDevice()->GetLogicalDevice(), 1, &colorMapDesc, 0, nullptr);
-			}
+			// projected diameter in pixels, the camera inside the sphere means the mesh covers the whole viewport
+			screenSize = std::max(screenSize, distance > radius ? radius * std::abs(camera.GetProjectionRef()[1][1]) / distance * height : height);
 		}
-    }
+
+		renderer->GetResidencyManagerRef()->Touch((Texture2D*)mMaterial.GetAlbedoTextureRef().get(), screenSize);
+	}
 
 	void Mesh::Clear()
 	{
 		Context* renderer = (Vulkan::Context*)Context::GetRef();
-		vkDeviceWaitIdle(renderer->GetDevice()->GetLogicalDevice());
 		
-		if (mGPUData.transferFence != VK_NULL_HANDLE) {
-			vkDestroyFence(renderer->GetDevice()->GetLogicalDevice(), mGPUData.transferFence, nullptr);
-			mGPUData.transferFence = VK_NULL_HANDLE;
-		}
-		
-		if (mGPUData.descriptorPool != VK_NULL_HANDLE) {
-			vkDestroyDescriptorPool(renderer->GetDevice()->GetLogicalDevice(), mGPUData.descriptorPool, nullptr);
-			mGPUData.descriptorPool = VK_NULL_HANDLE;
+		if (mGPUData.material != Bindless::Invalid) {
+			renderer->GetBindlessRef()->UnregisterMaterial(mGPUData.material);
+			mGPUData.material = Bindless::Invalid;
 		}
 		
+		// frames in flight may still use them, the upload is only waited when the mesh is cleared right after being loaded
+		renderer->GetDevice()->GetUploaderRef()->Wait(mGPUData.uploadTicket);
+
 		if (mGPUData.vertexBuffer != VK_NULL_HANDLE) {
-			vmaDestroyBuffer(renderer->GetDevice()->GetAllocator(), mGPUData.vertexBuffer, mGPUData.vertexMemory);
+			renderer->GetDeletionQueueRef()->ReleaseBuffer(mGPUData.vertexBuffer, mGPUData.vertexMemory);
 			mGPUData.vertexBuffer = VK_NULL_HANDLE;
 			mGPUData.vertexMemory = VK_NULL_HANDLE;
 		}
 		
 		if (mGPUData.indexBuffer != VK_NULL_HANDLE) {
-			vmaDestroyBuffer(renderer->GetDevice()->GetAllocator(), mGPUData.indexBuffer, mGPUData.indexMemory);
+			renderer->GetDeletionQueueRef()->ReleaseBuffer(mGPUData.indexBuffer, mGPUData.indexMemory);
 			mGPUData.indexBuffer = VK_NULL_HANDLE;
 			mGPUData.indexMemory = VK_NULL_HANDLE;
 		}
@@ -395,21 +435,148 @@ namespace Cosmos::Renderer::Vulkan
 		mSkins.resize(0);
 		mNodes.resize(0);
 		mLinearNodes.resize(0);
+		mVertices = {};
+		mPositions = {};
+		mIndices = {};
+		mTriangleBVH = {};
+		mTriangleBVHBuild = {};
 		mLoaded = false;
+		TrackResidentBytes(0);
 	}
 
-	void Mesh::RenderNode(GLTF::Node* node, VkCommandBuffer commandBuffer)
+	void Mesh::ApplyResidency()
 	{
+		switch (mResidency)
+		{
+			case Residency::Discard:
+			{
+				mVertices = {};
+				mPositions = {};
+				mIndices = {};
+				mTriangleBVH = {};
+				mTriangleBVHBuild = {};
+				break;
+			}
+
+			case Residency::Positions:
+			{
+				if (!mVertices.empty()) {
+					mPositions.resize(mVertices.size());
+
+					for (size_t i = 0; i < mVertices.size(); i++) {
+						mPositions[i] = mVertices[i].position;
+					}
+				}
+
+				mVertices = {};
+				break;
+			}
+
+			case Residency::Full:
+			{
+				mPositions = {};
+				break;
+			}
+
+			default: break;
+		}
+
+		TrackResidentBytes(mVertices.size() * sizeof(Vertex) + mPositions.size() * sizeof(glm::vec3) + mIndices.size() * sizeof(uint32_t) + mTriangleBVH.GetMemoryBytes());
+	}
+
+	void Mesh::BuildTriangleBVH()
+	{
+		// discarded meshes are only ever hit on their bounds
+		if (mIndices.empty() || (mVertices.empty() && mPositions.empty())) {
+			return;
+		}
+
+		// the task owns copies of the triangles, the mesh may be cleared or reloaded before it's done
+		std::vector<glm::vec3> positions = mPositions;
+		std::vector<uint32_t> indices = mIndices;
+		std::string name = mName;
+
+		if (positions.empty()) {
+			positions.resize(mVertices.size());
+
+			for (size_t i = 0; i < mVertices.size(); i++) {
+				positions[i] = mVertices[i].position;
+			}
+		}
+
+		// ray queries go through the triangles on mesh space, wich is where the vertices are drawn from
+		mTriangleBVHBuild = ThreadPool::GetRef().EnqueueBackground([positions = std::move(positions), indices = std::move(indices), name]() -> TriangleBVH
+			{
+				Timer timer;
+				timer.Start();
+
+				TriangleBVH bvh;
+				bvh.Build(positions.data(), indices.data(), indices.size());
+
+				COSMOS_LOG(Logger::Trace, "Built the triangle bvh of %s (%zu triangles, %zu nodes) in %.3fms", name.c_str(), bvh.GetTriangleCount(), bvh.GetNodeCount(), timer.Stop());
+				return bvh;
+			});
+	}
+
+	void Mesh::RenderNode(GLTF::Node* node, RenderQueue::BindState& state, const Frustum& frustum, const glm::vec3& cameraPosition, uint32_t instanceCount, uint32_t firstInstance)
+	{
+		Context* renderer = (Vulkan::Context*)Context::GetRef();
+		VkCommandBuffer commandBuffer = (VkCommandBuffer)state.commandBuffer;
+
 		if (node->GetMesh() != nullptr) {
 			for (GLTF::Primitive* primitive : node->GetMesh()->GetPrimitivesRef()) {
-				if (primitive->GetIndexCount() > 0) {
-					vkCmdDrawIndexed(commandBuffer, primitive->GetIndexCount(), 1, primitive->GetFirstIndex(), 0, 0);
+				if (primitive->GetIndexCount() == 0) {
+					continue;
+				}
+
+				// every batch is culled on the gpu when it's supported, one instance or many, each instance against the primitive bounds
+				BoundingBox& bounds = primitive->GetBoundingBoxRef().IsValid() ? primitive->GetBoundingBoxRef() : mBounds;
+				glm::vec4 sphere = glm::vec4((bounds.GetMin() + bounds.GetMax()) * 0.5f, bounds.IsValid() ? glm::length(bounds.GetMax() - bounds.GetMin()) * 0.5f : -1.0f);
+
+				if (renderer->GetCullingRef()->DrawIndexed(commandBuffer, sphere, primitive->GetIndexCount(), primitive->GetFirstIndex(), instanceCount, firstInstance)) {
+					state.draws++;
+					continue;
+				}
+
+				// without it, skinned vertices move away from their bind pose bounds and each instance sees different meshlets, those are drawn whole
+				if (node->GetSkin() != nullptr || primitive->GetMeshletsRef().empty() || instanceCount > 1) {
+					vkCmdDrawIndexed(commandBuffer, primitive->GetIndexCount(), instanceCount, primitive->GetFirstIndex(), 0, firstInstance);
+					state.draws++;
+					continue;
+				}
+
+				// meshlets are contiguous on the index buffer, adjacent visible ones are merged into a single draw
+				uint32_t firstIndex = 0;
+				uint32_t indexCount = 0;
+
+				for (const GLTF::Meshlet& meshlet : primitive->GetMeshletsRef()) {
+					if (!meshlet.IsVisible(frustum, cameraPosition)) {
+						continue;
+					}
+
+					if (indexCount > 0 && firstIndex + indexCount == meshlet.GetFirstIndex()) {
+						indexCount += meshlet.GetIndexCount();
+						continue;
+					}
+
+					if (indexCount > 0) {
+						vkCmdDrawIndexed(commandBuffer, indexCount, 1, firstIndex, 0, firstInstance);
+						state.draws++;
+					}
+
+					firstIndex = meshlet.GetFirstIndex();
+					indexCount = meshlet.GetIndexCount();
+				}
+
+				if (indexCount > 0) {
+					vkCmdDrawIndexed(commandBuffer, indexCount, 1, firstIndex, 0, firstInstance);
+					state.draws++;
 				}
 			}
 		}
 		
 		for (auto& child : node->GetChildrenRef()) {
-			RenderNode(child, commandBuffer);
+			RenderNode(child, state, frustum, cameraPosition, instanceCount, firstInstance);
 		}
 	}
 
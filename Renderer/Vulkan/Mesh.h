@@ -8,6 +8,9 @@
 #include "GLTF/Mesh.h"
 #include "GLTF/Skin.h"
 #include "Wrapper/vulkan.h"
+#include <Common/Math/BoundingBox.h>
+#include <Common/Math/Frustum.h>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -30,9 +33,8 @@ namespace Cosmos::Renderer::Vulkan
 			VmaAllocation vertexMemory = VK_NULL_HANDLE;
 			VkBuffer indexBuffer = VK_NULL_HANDLE;
 			VmaAllocation indexMemory = VK_NULL_HANDLE;
-			VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
-			std::vector<VkDescriptorSet> descriptorSets = {};
-			VkFence transferFence = VK_NULL_HANDLE;
+			uint32_t material = UINT32_MAX;		// material record on the global descriptor set
+			uint64_t uploadTicket = 0;			// upload batch of the vertex and index buffers
 		};
 
 	public:
@@ -48,8 +50,11 @@ namespace Cosmos::Renderer::Vulkan
 		// updates the mesh frame-logic
 		virtual void OnUpdate(float timestep) override;
 
-		// renders the mesh
-		virtual void OnRender(const glm::mat4& transform, uint64_t id, IContext::Stage stage) override;
+		// picks the pipeline and writes the instances of a batch into this frame instance buffer
+		virtual bool OnPrepare(RenderQueue::Batch& batch, IContext::Stage stage) override;
+
+		// records a prepared batch, only touches the bind state command buffer and the gpu culling (wich is thread-safe)
+		virtual void OnRender(const RenderQueue::Batch& batch, RenderQueue::BindState& state, IContext::Stage stage) override;
 
 	public:
 
@@ -62,22 +67,48 @@ namespace Cosmos::Renderer::Vulkan
 		// refreshes mesh configuration, applying any changes made
 		virtual void Refresh() override;
 
+		// changes what the mesh keeps on cpu memory, going up a level requires the mesh to be reloaded
+		virtual void SetResidency(Residency residency) override;
+
+		// returns the mesh-space triangle bvh, nullptr when the positions aren't kept or it's still being built
+		virtual const TriangleBVH* GetTriangleBVH() override;
+
+	public:
+
+		// returns a reference to the cpu vertices, only kept with full residency
+		inline std::vector<Vertex>& GetVerticesRef() { return mVertices; }
+
+		// returns a reference to the cpu positions, only kept with positions residency (full residency has them on the vertices)
+		inline std::vector<glm::vec3>& GetPositionsRef() { return mPositions; }
+
+		// returns a reference to the cpu indices, kept with positions and full residency
+		inline std::vector<uint32_t>& GetIndicesRef() { return mIndices; }
+
 	private:
 
+		// reads the nodes, vertices and indices of a gltf file and uploads them, the material albedo is left untouched
+		void LoadGeometry(std::string path, float scale);
+
 		// creates all used resources by the renderer api
 		void CreateRendererResources(uint32_t verticesCount, uint32_t indicesCount, GLTF::Node::MeshLoaderInfo& info);
 
-		// configures the descriptors used by the mesh
-		void SetupDescriptors();
+		// registers or updates the mesh material record on the global descriptor set
+		void UpdateMaterial();
 
-		// sends the descriptor data into the gpu
-		void UpdateDescriptors();
+		// informs the residency manager how big the mesh instances are on screen, so it's albedo gets the detail it needs
+		void TouchTextures(const RenderQueue::Instance* instances, uint32_t count);
 
 		// clears the resoruces used by the mesh, usefull when reloading another mesh
 		void Clear();
 
-		// draws a particular node
-		void RenderNode(GLTF::Node* node, VkCommandBuffer commandBuffer);
+		// releases the cpu mesh data the current residency doesn't require
+		void ApplyResidency();
+
+		// builds the triangle bvh from the kept positions on a background worker, picking falls back to the bounds until it's done
+		void BuildTriangleBVH();
+
+		// draws a particular node for all instances, culled on the gpu when supported, otherwise a single instance skips meshlets outside the frustum or facing away from the camera (both on mesh space)
+		void RenderNode(GLTF::Node* node, RenderQueue::BindState& state, const Frustum& frustum, const glm::vec3& cameraPosition, uint32_t instanceCount, uint32_t firstInstance);
 
 		// updates the animation requests
 		void ProcessAnimation(float timestep, int32_t index = -1);
@@ -87,10 +118,13 @@ namespace Cosmos::Renderer::Vulkan
 		// gltf and mesh data
 		GPUData mGPUData;
 		std::vector<Vertex> mVertices = {};
+		std::vector<glm::vec3> mPositions = {};
+		std::vector<uint32_t> mIndices = {};
 		std::vector<GLTF::Node*> mNodes = {};
 		std::vector<GLTF::Node*> mLinearNodes = {};
 		std::vector<GLTF::Skin*> mSkins = {};
 		std::vector<GLTF::Animation> mAnimations = {};
+		std::future<TriangleBVH> mTriangleBVHBuild = {};
 	};
 }
 
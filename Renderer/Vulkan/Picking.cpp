@@ -1,5 +1,8 @@
 #include "Picking.h"
 
+#include "CommandRecorder.h"
+#include "Context.h"
+#include "DeletionQueue.h"
 #include "Device.h"
 #include "Renderpass.h"
 #include "Swapchain.h"
@@ -9,27 +12,59 @@
 #include <Common/Debug/Logger.h>
 #include <Common/Math/Math.h>
 #include <Engine/Core/Application.h>
-#include <Platform/Core/MainWindow.h>
 #include <Platform/Event/WindowEvent.h>
 
+#include <algorithm>
+
 namespace Cosmos::Renderer::Vulkan
 {
-	Picking::Picking(Engine::Application* application, Shared<Device> device, Shared<Swapchain> swapchain, Library<Shared<Renderpass>>& renderpassesLib)
-		: mApplication(application), mDevice(device), mSwapchain(swapchain), mRenderpassesLib(renderpassesLib)
+	// creates a host visible buffer the gpu copies into and the cpu reads from
+	static void CreateReadbackBuffer(VmaAllocator allocator, VkDeviceSize size, VkBuffer& buffer, VmaAllocation& memory, void** mapped)
+	{
+		VmaAllocationCreateInfo allocCI = {};
+		allocCI.usage = VMA_MEMORY_USAGE_AUTO;
+		allocCI.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		VkBufferCreateInfo bufferCI = {};
+		bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCI.size = size;
+		bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocationInfo allocInfo = {};
+		COSMOS_ASSERT(vmaCreateBuffer(allocator, &bufferCI, &allocCI, &buffer, &memory, &allocInfo) == VK_SUCCESS, "Failed to create readback buffer");
+		*mapped = allocInfo.pMappedData;
+	}
+
+	Picking::Picking(Engine::Application* application, Shared<Device> device, Shared<Swapchain> swapchain, Shared<CommandRecorder> commandRecorder, Library<Shared<Renderpass>>& renderpassesLib)
+		: mApplication(application), mDevice(device), mSwapchain(swapchain), mCommandRecorder(commandRecorder), mRenderpassesLib(renderpassesLib)
 	{
 		CreateRenderpass();
 		CreateImages();
+
+		// a click only needs a single texel, buffers grow when a larger region is requested
+		mReadbacks.resize(CONCURENTLY_RENDERED_FRAMES);
+
+		for (Readback& readback : mReadbacks) {
+			readback.size = mTexelSize;
+			CreateReadbackBuffer(mDevice->GetAllocator(), readback.size, readback.buffer, readback.memory, &readback.mapped);
+		}
 	}
 
 	Picking::~Picking()
 	{
-		vkDeviceWaitIdle(mDevice->GetLogicalDevice());
-		vkDestroyImageView(mDevice->GetLogicalDevice(), mDepthView, nullptr);
-		vmaDestroyImage(mDevice->GetAllocator(), mDepthImage, mDepthMemory);
+		// the attachments may still be written by frames in flight
+		auto& deletionQueue = ((Context*)IContext::GetRef())->GetDeletionQueueRef();
+		deletionQueue->ReleaseImageView(mDepthView);
+		deletionQueue->ReleaseImage(mDepthImage, mDepthMemory);
 
 		for (size_t i = 0; i < mSwapchain->GetImagesRef().size(); i++) {
-			vkDestroyImageView(mDevice->GetLogicalDevice(), mColorViews[i], nullptr);
-			vmaDestroyImage(mDevice->GetAllocator(), mColorImages[i], mColorMemories[i]);
+			deletionQueue->ReleaseImageView(mColorViews[i]);
+			deletionQueue->ReleaseImage(mColorImages[i], mColorMemories[i]);
+		}
+
+		for (Readback& readback : mReadbacks) {
+			deletionQueue->ReleaseBuffer(readback.buffer, readback.memory);
 		}
 	}
 
@@ -54,8 +89,66 @@ namespace Cosmos::Renderer::Vulkan
 		}
 	}
 
+	void Picking::BeginFrame(uint32_t currentFrame)
+	{
+		Readback& readback = mReadbacks[currentFrame];
+
+		if (readback.texels == 0) {
+			return;
+		}
+
+		// every texel holds an id split into it's lower and upper 32 bits, regions often cover the same object many times
+		vmaInvalidateAllocation(mDevice->GetAllocator(), readback.memory, 0, VK_WHOLE_SIZE);
+		const uint32_t* texels = (const uint32_t*)readback.mapped;
+		std::vector<uint64_t> ids = {};
+
+		for (uint32_t i = 0; i < readback.texels; i++) {
+			uint64_t id = ((uint64_t)texels[i * 2 + 1] << 32) | texels[i * 2];
+
+			if (id != 0) {
+				ids.push_back(id);
+			}
+		}
+
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+		Callback callback = std::move(readback.callback);
+		readback.callback = {};
+		readback.texels = 0;
+
+		if (callback) {
+			callback(ids);
+		}
+	}
+
+	void Picking::RequestPick(glm::vec2 min, glm::vec2 max, Callback callback)
+	{
+		mRequest.min = glm::min(min, max);
+		mRequest.max = glm::max(min, max);
+		mRequest.callback = std::move(callback);
+		mRequest.pending = true;
+	}
+
 	void Picking::ManageRenderpass(uint32_t currentFrame, uint32_t swapchainIndex)
 	{
+		// the pass only exists to answer picks, frames without one don't record nor submit it
+		mRecorded = mRequest.pending;
+
+		if (!mRecorded) {
+			return;
+		}
+
+		// clamped now, the window may have been resized since it was requested
+		VkExtent2D extent = mSwapchain->GetExtent();
+		glm::vec2 limit = glm::vec2((float)extent.width - 1.0f, (float)extent.height - 1.0f);
+		glm::vec2 first = glm::clamp(mRequest.min, glm::vec2(0.0f), limit);
+		glm::vec2 last = glm::clamp(mRequest.max, glm::vec2(0.0f), limit);
+
+		VkRect2D region = {};
+		region.offset = { (int32_t)first.x, (int32_t)first.y };
+		region.extent = { (uint32_t)last.x - (uint32_t)first.x + 1, (uint32_t)last.y - (uint32_t)first.y + 1 };
+
 		std::vector<VkClearValue> clearValues(2);
 		clearValues[0].color = { {0.0f, 0.0f, 0.0f, 0.0f} };
 		clearValues[1].depthStencil = { 1.0f, 0 };
@@ -78,14 +171,12 @@ namespace Cosmos::Renderer::Vulkan
 			renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 			renderPassBeginInfo.renderPass = renderPass;
 			renderPassBeginInfo.framebuffer = frameBuffer;
-			renderPassBeginInfo.renderArea.offset = { 0, 0 };
-			renderPassBeginInfo.renderArea.extent = mSwapchain->GetExtent();
+			renderPassBeginInfo.renderArea = region; // only the region is cleared and stored
 			renderPassBeginInfo.clearValueCount = (uint32_t)clearValues.size();
 			renderPassBeginInfo.pClearValues = clearValues.data();
-			vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+			vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
 			// set frame commandbuffer viewport
-			VkExtent2D extent = mSwapchain->GetExtent();
 			VkViewport viewport = {};
 			viewport.x = 0.0f;
 			viewport.y = 0.0f;
@@ -93,104 +184,94 @@ namespace Cosmos::Renderer::Vulkan
 			viewport.height = (float)extent.height;
 			viewport.minDepth = 0.0f;
 			viewport.maxDepth = 1.0f;
-			vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
 
-			auto& boundaries = IContext::GetRef()->GetViewportBoundariesRef();
-			glm::vec2 mousePos = glm::clamp(Platform::MainWindow::GetRef().GetViewportCursorPos(boundaries.position, boundaries.size), glm::vec2(0.0f, 0.0f), glm::vec2(extent.width, extent.height));
-			
-			VkRect2D scissor = {};
-			scissor.offset = { (int32_t)mousePos.x, (int32_t)mousePos.y };
-			scissor.extent = { 1, 1 };
-			vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+			// nothing outside the requested region is rasterized
+			VkRect2D scissor = region;
 
-			// render objects
+			// render objects, split across the workers into secondaries
+			mCommandRecorder->BeginPass(renderPass, frameBuffer, viewport, scissor);
 			mApplication->OnRender(IContext::Stage::Picking);
+			mCommandRecorder->EndPass(cmdBuffer);
 
 			// end render pass
 			vkCmdEndRenderPass(cmdBuffer);
 
+			RecordReadback(cmdBuffer, currentFrame, swapchainIndex, region);
+
 			// end command buffer
 			COSMOS_ASSERT(vkEndCommandBuffer(cmdBuffer) == VK_SUCCESS, "Failed to end command buffer recording");
 		}
 	}
 
-	void Picking::ReadImagePixels(glm::vec2 pos)
+	void Picking::RecordReadback(VkCommandBuffer cmdBuffer, uint32_t currentFrame, uint32_t swapchainIndex, VkRect2D region)
 	{
-		auto renderpass = mRenderpassesLib.GetRef("Picking");
-		VkCommandBuffer cmdBuffer = mDevice->BeginSingleTimeCommand(renderpass->GetCommandPoolRef());
+		Readback& readback = mReadbacks[currentFrame];
+		VkDeviceSize size = (VkDeviceSize)region.extent.width * region.extent.height * mTexelSize;
+
+		// the frame's fence was waited, it's old buffer is no longer read by the gpu but the deletion queue keeps the ordering simple
+		if (readback.size < size) {
+			((Context*)IContext::GetRef())->GetDeletionQueueRef()->ReleaseBuffer(readback.buffer, readback.memory);
+			readback.size = size;
+			CreateReadbackBuffer(mDevice->GetAllocator(), readback.size, readback.buffer, readback.memory, &readback.mapped);
+		}
 
-		// convert the image into transferable
+		VkImage image = mColorImages[swapchainIndex];
+
+		// the render pass leaves the image as shader read only, it's written by the pass just recorded
 		mDevice->InsertImageMemoryBarrier
 		(
 			cmdBuffer,
-			mColorImages[mSwapchain->GetImageIndexRef()], // we'll be testing with only one image for now
+			image,
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
 			VK_ACCESS_TRANSFER_READ_BIT,
-			VK_ACCESS_MEMORY_READ_BIT,
 			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
 			VK_PIPELINE_STAGE_TRANSFER_BIT,
 			VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
 		);
 
-		// create the staging buffer
-		VkBuffer stagingBuffer;
-		VmaAllocation stagingBufferMemory;
-
-		mDevice->CreateBuffer
-		(
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			mImageSize,
-			&stagingBuffer,
-			&stagingBufferMemory
-		);
+		VkBufferImageCopy copy = {};
+		copy.bufferOffset = 0;
+		copy.bufferRowLength = 0;
+		copy.bufferImageHeight = 0;
+		copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copy.imageSubresource.mipLevel = 0;
+		copy.imageSubresource.baseArrayLayer = 0;
+		copy.imageSubresource.layerCount = 1;
+		copy.imageOffset = { region.offset.x, region.offset.y, 0 };
+		copy.imageExtent = { region.extent.width, region.extent.height, 1 };
+		vkCmdCopyImageToBuffer(cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &copy);
+
+		// the cpu reads it once the frame's fence signals
+		VkBufferMemoryBarrier bufferBarrier = {};
+		bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.buffer = readback.buffer;
+		bufferBarrier.offset = 0;
+		bufferBarrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
 
-		// copy the image to the buffer
-		VkBufferImageCopy region = {};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
-		region.imageOffset = { (int32_t)pos.x, (int32_t)pos.y, 0 };
-		region.imageExtent = { 1, 1, 1 };
-		vkCmdCopyImageToBuffer(cmdBuffer, mColorImages[mSwapchain->GetImageIndexRef()], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, 1, &region);
-
-		// convert the image into shader optimal again
 		mDevice->InsertImageMemoryBarrier
 		(
 			cmdBuffer,
-			mColorImages[mSwapchain->GetImageIndexRef()], // we'll be testing with only one image for now
+			image,
 			VK_ACCESS_TRANSFER_READ_BIT,
-			VK_ACCESS_MEMORY_READ_BIT,
+			VK_ACCESS_SHADER_READ_BIT,
 			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
 			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
 			VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
 		);
 
-		mDevice->EndSingleTimeCommand(renderpass->GetCommandPoolRef(), cmdBuffer);
-
-		// map the buffer memory and read the pixels
-		void* data;
-		vmaMapMemory(mDevice->GetAllocator(), stagingBufferMemory, &data);
-
-		uint32_t* mappedData = reinterpret_cast<uint32_t*>(data);
-		uint32_t x = mappedData[0]; // first component of vec2
-		uint32_t y = mappedData[1]; // second component of vec2
-		uint32_t lowerBits = (uint32_t)x; // first float as uint
-		uint32_t upperBits = (uint32_t)y; // second float as uint
-		uint64_t reconstructedValue = ((uint64_t)upperBits << 32) | lowerBits;
-		COSMOS_LOG(Logger::Trace, "ID: %llu", reconstructedValue);
-
-		vmaUnmapMemory(mDevice->GetAllocator(), stagingBufferMemory);
-
-		// cleanup
-		vmaDestroyBuffer(mDevice->GetAllocator(), stagingBuffer, stagingBufferMemory);
+		readback.texels = region.extent.width * region.extent.height;
+		readback.callback = std::move(mRequest.callback);
+		mRequest.callback = {};
+		mRequest.pending = false;
 	}
 
 	void Picking::CreateRenderpass()
@@ -199,7 +280,7 @@ namespace Cosmos::Renderer::Vulkan
 		mRenderpassesLib.Insert("Picking", renderpass);
 
 		mSurfaceFormat = VK_FORMAT_R32G32_UINT;
-		mImageSize = 2 * 8; // (RED + GREEN) * 8 bits
+		mTexelSize = 2 * sizeof(uint32_t); // red and green, 32 bits each
 		mDepthFormat = mDevice->FindSuitableDepthFormat();
 
 		// create render pass
@@ -5,23 +5,32 @@
 #include <Common/Math/Math.h>
 #include <Common/Util/Library.h>
 #include <Common/Util/Memory.h>
+#include <functional>
 #include <vector>
 
 // forward declarations
 namespace Cosmos::Engine { class Application; }
 namespace Cosmos::Platform { class EventBase; }
+namespace Cosmos::Renderer::Vulkan { class CommandRecorder; }
 namespace Cosmos::Renderer::Vulkan { class Device; }
 namespace Cosmos::Renderer::Vulkan { class Swapchain; }
 namespace Cosmos::Renderer::Vulkan { class Renderpass; }
 
 namespace Cosmos::Renderer::Vulkan
 {
+	// renders the object ids into an image and reads back the ones under a region of the viewport
+	// readbacks never stall, the region is copied by the frame's own commands and delivered once it's fence is waited, one or two frames later
 	class Picking
 	{
+	public:
+
+		// receives the ids found on a picked region, without repeats and without the cleared background
+		using Callback = std::function<void(const std::vector<uint64_t>& ids)>;
+
 	public:
 
 		// constructor
-		Picking(Engine::Application* application, Shared<Device> device, Shared<Swapchain> swapchain, Library<Shared<Renderpass>>& renderpassesLib);
+		Picking(Engine::Application* application, Shared<Device> device, Shared<Swapchain> swapchain, Shared<CommandRecorder> commandRecorder, Library<Shared<Renderpass>>& renderpassesLib);
 
 		// destructor
 		~Picking();
@@ -31,11 +40,17 @@ namespace Cosmos::Renderer::Vulkan
 		// called when an event happens
 		void OnEvent(Shared<Platform::EventBase> event);
 
-		// called for sending what to draw on the picking-phase
+		// called once the frame's fence is waited, delivers the ids read back when the frame was last recorded
+		void BeginFrame(uint32_t currentFrame);
+
+		// records the picking-phase when a pick was requested, nothing is recorded otherwise
 		void ManageRenderpass(uint32_t currentFrame, uint32_t swapchainIndex);
 
-		// reads the image pixels, for picking
-		void ReadImagePixels(glm::vec2 pos);
+		// returns if the pass was recorded this frame and must be submitted
+		inline bool IsRecorded() const { return mRecorded; }
+
+		// requests the ids on a region of the viewport, corners are inclusive and a click is a 1x1 region, a newer request replaces one not yet recorded
+		void RequestPick(glm::vec2 min, glm::vec2 max, Callback callback);
 
 	private:
 
@@ -45,17 +60,42 @@ namespace Cosmos::Renderer::Vulkan
 		// creates the images used for picking
 		void CreateImages();
 
+		// records the copy of the requested region into the frame's readback buffer
+		void RecordReadback(VkCommandBuffer cmdBuffer, uint32_t currentFrame, uint32_t swapchainIndex, VkRect2D region);
+
+	private:
+
+		struct Request
+		{
+			glm::vec2 min = glm::vec2(0.0f);
+			glm::vec2 max = glm::vec2(0.0f);
+			Callback callback = {};
+			bool pending = false;
+		};
+
+		// persistently mapped, one per frame in flight
+		struct Readback
+		{
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VmaAllocation memory = VK_NULL_HANDLE;
+			void* mapped = nullptr;
+			VkDeviceSize size = 0;
+			uint32_t texels = 0;								// copied when the frame was last recorded, 0 if nothing was
+			Callback callback = {};
+		};
+
 	private:
 
 		Engine::Application* mApplication;
 		Shared<Device> mDevice;
 		Shared<Swapchain> mSwapchain;
+		Shared<CommandRecorder> mCommandRecorder;
 		Library<Shared<Renderpass>>& mRenderpassesLib;
 
 		VkSampleCountFlagBits mMSAA = VK_SAMPLE_COUNT_1_BIT;
 		VkFormat mSurfaceFormat = VK_FORMAT_UNDEFINED;
 		VkFormat mDepthFormat = VK_FORMAT_UNDEFINED;
-		VkDeviceSize mImageSize = 0;
+		VkDeviceSize mTexelSize = 0;
 		VkImage mDepthImage = VK_NULL_HANDLE;
 		VmaAllocation mDepthMemory = VK_NULL_HANDLE;
 		VkImageView mDepthView = VK_NULL_HANDLE;
@@ -63,6 +103,10 @@ namespace Cosmos::Renderer::Vulkan
 		std::vector<VkImage> mColorImages;
 		std::vector<VmaAllocation> mColorMemories;
 		std::vector<VkImageView> mColorViews;
+
+		Request mRequest = {};
+		bool mRecorded = false;
+		std::vector<Readback> mReadbacks = {};
 	};
 }
 #endif
\ No newline at end of file
@@ -2,11 +2,15 @@
 #include "Pipeline.h"
 
 #include "Buffer.h"
+#include "Context.h"
+#include "DeletionQueue.h"
 #include "Device.h"
 #include "Renderpass.h"
 #include "Shader.h"
+#include "Core/IMesh.h"
 #include <Common/Debug/Logger.h>
 #include <Common/File/Filesystem.h>
+#include <Common/Util/Timer.h>
 
 namespace Cosmos::Renderer::Vulkan
 {
@@ -16,14 +20,36 @@ namespace Cosmos::Renderer::Vulkan
         // assign shader stages
         mCreateInfo.shaderStagesCI = { mCreateInfo.vertexShader->GetShaderStageCreateInfoRef(),  mCreateInfo.fragmentShader->GetShaderStageCreateInfoRef() };
 
-        // descriptor set
-        VkDescriptorSetLayoutCreateInfo descSetLayoutCI = {};
-        descSetLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        descSetLayoutCI.pNext = nullptr;
-        descSetLayoutCI.flags = 0;
-        descSetLayoutCI.bindingCount = (uint32_t)mCreateInfo.bindings.size();
-        descSetLayoutCI.pBindings = mCreateInfo.bindings.data();
-        COSMOS_ASSERT(vkCreateDescriptorSetLayout(mDevice->GetLogicalDevice(), &descSetLayoutCI, nullptr, &mDescriptorSetLayout) == VK_SUCCESS, "Failed to create descriptor set layout");
+        // specialization constants, stages without a given constant id ignore it
+        if (!mCreateInfo.specializationEntries.empty())
+        {
+            mSpecializationInfo.mapEntryCount = (uint32_t)mCreateInfo.specializationEntries.size();
+            mSpecializationInfo.pMapEntries = mCreateInfo.specializationEntries.data();
+            mSpecializationInfo.dataSize = mCreateInfo.specializationData.size();
+            mSpecializationInfo.pData = mCreateInfo.specializationData.data();
+
+            for (auto& stage : mCreateInfo.shaderStagesCI) {
+                stage.pSpecializationInfo = &mSpecializationInfo;
+            }
+        }
+
+        // descriptor set, pipelines drawing with the global descriptor set share it's layout
+        if (mCreateInfo.descriptorSetLayout != VK_NULL_HANDLE)
+        {
+            mDescriptorSetLayout = mCreateInfo.descriptorSetLayout;
+            mOwnsDescriptorSetLayout = false;
+        }
+
+        else
+        {
+            VkDescriptorSetLayoutCreateInfo descSetLayoutCI = {};
+            descSetLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            descSetLayoutCI.pNext = nullptr;
+            descSetLayoutCI.flags = 0;
+            descSetLayoutCI.bindingCount = (uint32_t)mCreateInfo.bindings.size();
+            descSetLayoutCI.pBindings = mCreateInfo.bindings.data();
+            COSMOS_ASSERT(vkCreateDescriptorSetLayout(mDevice->GetLogicalDevice(), &descSetLayoutCI, nullptr, &mDescriptorSetLayout) == VK_SUCCESS, "Failed to create descriptor set layout");
+        }
 
         // pipeline layout
         VkPipelineLayoutCreateInfo pipelineLayoutCI = {};
@@ -107,11 +133,14 @@ namespace Cosmos::Renderer::Vulkan
 
     Pipeline::~Pipeline()
     {
-        vkDeviceWaitIdle(mDevice->GetLogicalDevice());
+        // frames in flight may still use the pipeline, it's destroyed once they're done
+        auto& deletionQueue = ((Context*)Context::GetRef())->GetDeletionQueueRef();
+        deletionQueue->ReleasePipeline(mPipeline);
+        deletionQueue->ReleasePipelineLayout(mPipelineLayout);
 
-        vkDestroyPipeline(mDevice->GetLogicalDevice(), mPipeline, nullptr);
-        vkDestroyPipelineLayout(mDevice->GetLogicalDevice(), mPipelineLayout, nullptr);
-        vkDestroyDescriptorSetLayout(mDevice->GetLogicalDevice(), mDescriptorSetLayout, nullptr);
+        if (mOwnsDescriptorSetLayout) {
+            deletionQueue->ReleaseDescriptorSetLayout(mDescriptorSetLayout);
+        }
     }
 
     void Pipeline::Build()
@@ -203,93 +232,36 @@ namespace Cosmos::Renderer::Vulkan
 
     void CreateDefaultPipelines(DefaultPipelinesCreateInfo& ci)
     {
-        // mesh
-        {
-            if (ci.pipelineLibrary.Exists("Mesh")) {
-                ci.pipelineLibrary.Erase("Mesh");
-            }
-
-            Vulkan::Pipeline::CreateInfo meshSpecification = {};
-            meshSpecification.renderPass = ci.mainRenderpass;
-            meshSpecification.vertexShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Vertex, "Mesh.vert", GetAssetSubDir("Shader/mesh.vert").c_str());
-            meshSpecification.fragmentShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Fragment, "Mesh.frag", GetAssetSubDir("Shader/mesh.frag").c_str());
-            meshSpecification.vertexComponents =
-            {
-                Vertex::Component::POSITION,
-                Vertex::Component::NORMAL,
-                Vertex::Component::UV
-            };
-
-            // drawable push constants
-            VkPushConstantRange pushConstant = {};
-            pushConstant.offset = 0;
-            pushConstant.size = sizeof(Vulkan::PushConstant);
-            pushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-            meshSpecification.pushConstants.push_back(pushConstant);
-
-            meshSpecification.bindings.resize(2);
-            // camera ubo
-            meshSpecification.bindings[0].binding = 0;
-            meshSpecification.bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            meshSpecification.bindings[0].descriptorCount = 1;
-            meshSpecification.bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-            meshSpecification.bindings[0].pImmutableSamplers = nullptr;
-
-            // color map
-            meshSpecification.bindings[1].binding = 1;
-            meshSpecification.bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            meshSpecification.bindings[1].descriptorCount = 1;
-            meshSpecification.bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-            meshSpecification.bindings[1].pImmutableSamplers = nullptr;
-
-            // create
-            ci.pipelineLibrary.Insert("Mesh", CreateShared<Vulkan::Pipeline>(ci.device, meshSpecification, nullptr));
-            ci.pipelineLibrary.GetRef("Mesh")->GetCreateInfoRef().RSCI.cullMode = VK_CULL_MODE_BACK_BIT;
-            ci.pipelineLibrary.GetRef("Mesh")->Build();
+        // only pipeline building is timed, it's what the pipeline cache speeds up
+        Timer timer;
+        double buildTime = 0.0;
+
+        // every shader is compiled at once on the thread pool, the shaders below then come straight from the shader cache
+        Shader::Precompile
+        ({
+            { Vulkan::ShaderType::Vertex, GetAssetSubDir("Shader/mesh.vert") },
+            { Vulkan::ShaderType::Fragment, GetAssetSubDir("Shader/mesh.frag") },
+            { Vulkan::ShaderType::Vertex, GetAssetSubDir("Shader/mesh.vert"), { "VERTEX_COLORS" } },
+            { Vulkan::ShaderType::Fragment, GetAssetSubDir("Shader/mesh.frag"), { "VERTEX_COLORS" } },
+            { Vulkan::ShaderType::Vertex, GetAssetSubDir("Shader/picking.vert") },
+            { Vulkan::ShaderType::Fragment, GetAssetSubDir("Shader/picking.frag") },
+            { Vulkan::ShaderType::Vertex, GetAssetSubDir("Shader/skybox.vert") },
+            { Vulkan::ShaderType::Fragment, GetAssetSubDir("Shader/skybox.frag") },
+            { Vulkan::ShaderType::Vertex, GetAssetSubDir("Shader/grid.vert") },
+            { Vulkan::ShaderType::Fragment, GetAssetSubDir("Shader/grid.frag") }
+        });
+
+        // every combination of the mesh features is built up front, a mesh asking for a new one while recording would stall the frame on it's build
+        // they replace the ones made for the previous render pass, the spir-v of both shader variants is already on the shader cache
+        uint32_t variants = 0;
+
+        for (uint32_t features = 0; features < IMesh::Feature::Picking; features++) {
+            buildTime += CreateMeshPipeline(ci, features);
+            variants++;
         }
 
         // picking
-        {
-            if (ci.pipelineLibrary.Exists("Picking")) {
-                ci.pipelineLibrary.Erase("Picking");
-            }
-
-            Vulkan::Pipeline::CreateInfo pickingSpecification = {};
-            pickingSpecification.renderPass = ci.renderpassLibrary.GetRef("Picking");
-            pickingSpecification.vertexShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Vertex, "Picking.vert", GetAssetSubDir("Shader/picking.vert").c_str());
-            pickingSpecification.fragmentShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Fragment, "Picking.frag", GetAssetSubDir("Shader/picking.frag").c_str());
-            pickingSpecification.vertexComponents =
-            {
-                Vertex::Component::POSITION
-            };
-
-            // drawable push constants
-            VkPushConstantRange pushConstant = {};
-            pushConstant.offset = 0;
-            pushConstant.size = sizeof(Vulkan::PushConstant);
-            pushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-            pickingSpecification.pushConstants.push_back(pushConstant);
-
-            pickingSpecification.bindings.resize(2);
-            // camera ubo
-            pickingSpecification.bindings[0].binding = 0;
-            pickingSpecification.bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            pickingSpecification.bindings[0].descriptorCount = 1;
-            pickingSpecification.bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-            pickingSpecification.bindings[0].pImmutableSamplers = nullptr;
-
-            // color map
-            pickingSpecification.bindings[1].binding = 1;
-            pickingSpecification.bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            pickingSpecification.bindings[1].descriptorCount = 1;
-            pickingSpecification.bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-            pickingSpecification.bindings[1].pImmutableSamplers = nullptr;
-
-            // create
-            ci.pipelineLibrary.Insert("Picking", CreateShared<Vulkan::Pipeline>(ci.device, pickingSpecification, nullptr));
-            ci.pipelineLibrary.GetRef("Picking")->GetCreateInfoRef().RSCI.cullMode = VK_CULL_MODE_BACK_BIT;
-            ci.pipelineLibrary.GetRef("Picking")->Build();
-        }
+        buildTime += CreateMeshPipeline(ci, IMesh::Feature::Picking);
 
         // skybox
         {
@@ -330,9 +302,11 @@ namespace Cosmos::Renderer::Vulkan
             skyboxSpecification.bindings[1].pImmutableSamplers = nullptr;
 
             // create
-            ci.pipelineLibrary.Insert("Skybox", CreateShared<Vulkan::Pipeline>(ci.device, skyboxSpecification, nullptr));
+            ci.pipelineLibrary.Insert("Skybox", CreateShared<Vulkan::Pipeline>(ci.device, skyboxSpecification, ci.device->GetPipelineCache()));
             ci.pipelineLibrary.GetRef("Skybox")->GetCreateInfoRef().RSCI.cullMode = VK_CULL_MODE_FRONT_BIT;
+            timer.Start();
             ci.pipelineLibrary.GetRef("Skybox")->Build();
+            buildTime += timer.Stop();
         }
 
         // grid
@@ -348,19 +322,122 @@ namespace Cosmos::Renderer::Vulkan
             gridSpecificaiton.fragmentShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Fragment, "Grid.frag", GetAssetSubDir("Shader/grid.frag").c_str());
             gridSpecificaiton.vertexComponents = { };
             gridSpecificaiton.passingVertexData = false;
-            gridSpecificaiton.bindings.resize(1);
 
-            // camera ubo
-            gridSpecificaiton.bindings[0].binding = 0;
-            gridSpecificaiton.bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            gridSpecificaiton.bindings[0].descriptorCount = 1;
-            gridSpecificaiton.bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-            gridSpecificaiton.bindings[0].pImmutableSamplers = nullptr;
+            // only the camera ubo of the global descriptor set is used
+            gridSpecificaiton.descriptorSetLayout = ci.globalDescriptorSetLayout;
 
             // create
-            ci.pipelineLibrary.Insert("Grid", CreateShared<Renderer::Vulkan::Pipeline>(ci.device, gridSpecificaiton, nullptr));
+            ci.pipelineLibrary.Insert("Grid", CreateShared<Renderer::Vulkan::Pipeline>(ci.device, gridSpecificaiton, ci.device->GetPipelineCache()));
+            timer.Start();
             ci.pipelineLibrary.GetRef("Grid")->Build();
+            buildTime += timer.Stop();
         }
+
+        // a warm run is compared against the cold one that started the cache, the header of the cache file keeps it's time
+        ci.device->SetColdBuildTime(buildTime);
+
+        if (ci.device->IsPipelineCacheWarm() && ci.device->GetColdBuildTime() > 0.0) {
+            COSMOS_LOG(Logger::Info, "Built default pipelines (%u mesh variants) in %.3fms, pipeline cache loaded from disk (warm), %.1fx faster than the last cold run (%.3fms)",
+                variants, buildTime, ci.device->GetColdBuildTime() / buildTime, ci.device->GetColdBuildTime());
+        }
+
+        else {
+            COSMOS_LOG(Logger::Info, "Built default pipelines (%u mesh variants) in %.3fms, pipeline cache %s", variants, buildTime, ci.device->IsPipelineCacheWarm() ? "loaded from disk (warm)" : "started empty (cold)");
+        }
+    }
+
+
+    std::string GetMeshPipelineName(uint32_t features)
+    {
+        if (features & IMesh::Feature::Picking) {
+            return "Picking";
+        }
+
+        if (features == 0) {
+            return "Mesh";
+        }
+
+        const char* names[] = { "VertexColors", "AlphaTest", "Highlight" };
+        std::string name = "Mesh:";
+
+        for (uint32_t i = 0; i < 3; i++) {
+            if (features & (1u << i)) {
+                name.append(name.back() == ':' ? "" : "+");
+                name.append(names[i]);
+            }
+        }
+
+        return name;
+    }
+
+    double CreateMeshPipeline(DefaultPipelinesCreateInfo& ci, uint32_t features)
+    {
+        // picking ignores every other feature
+        if (features & IMesh::Feature::Picking) {
+            features = IMesh::Feature::Picking;
+        }
+
+        std::string name = GetMeshPipelineName(features);
+
+        if (ci.pipelineLibrary.Exists(name)) {
+            ci.pipelineLibrary.Erase(name);
+        }
+
+        Vulkan::Pipeline::CreateInfo specification = {};
+
+        // camera, instances, materials and textures come from the global descriptor set
+        specification.descriptorSetLayout = ci.globalDescriptorSetLayout;
+
+        if (features & IMesh::Feature::Picking)
+        {
+            specification.renderPass = ci.renderpassLibrary.GetRef("Picking");
+            specification.vertexShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Vertex, "Picking.vert", GetAssetSubDir("Shader/picking.vert").c_str());
+            specification.fragmentShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Fragment, "Picking.frag", GetAssetSubDir("Shader/picking.frag").c_str());
+            specification.vertexComponents = { Vertex::Component::POSITION };
+        }
+
+        else
+        {
+            // vertex colors change the shader interface and are a preprocessor variant, the other features are specialization constants of the same spir-v
+            std::vector<std::string> defines = {};
+
+            if (features & IMesh::Feature::VertexColors) {
+                defines.push_back("VERTEX_COLORS");
+            }
+
+            specification.renderPass = ci.mainRenderpass;
+            specification.vertexShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Vertex, "Mesh.vert", GetAssetSubDir("Shader/mesh.vert").c_str(), defines);
+            specification.fragmentShader = CreateShared<Vulkan::Shader>(ci.device, Vulkan::ShaderType::Fragment, "Mesh.frag", GetAssetSubDir("Shader/mesh.frag").c_str(), defines);
+            specification.vertexComponents =
+            {
+                Vertex::Component::POSITION,
+                Vertex::Component::NORMAL,
+                Vertex::Component::UV
+            };
+
+            if (features & IMesh::Feature::VertexColors) {
+                specification.vertexComponents.push_back(Vertex::Component::COLOR);
+            }
+
+            // constant_id 0 is ALPHA_TEST and 1 is HIGHLIGHT on mesh.frag
+            VkBool32 constants[2] = {};
+            constants[0] = (features & IMesh::Feature::AlphaTest) ? VK_TRUE : VK_FALSE;
+            constants[1] = (features & IMesh::Feature::Highlight) ? VK_TRUE : VK_FALSE;
+
+            specification.specializationEntries = { { 0, 0, sizeof(VkBool32) }, { 1, sizeof(VkBool32), sizeof(VkBool32) } };
+            specification.specializationData.resize(sizeof(constants));
+            memcpy(specification.specializationData.data(), constants, sizeof(constants));
+        }
+
+        // create
+        ci.pipelineLibrary.Insert(name, CreateShared<Vulkan::Pipeline>(ci.device, specification, ci.device->GetPipelineCache()));
+        ci.pipelineLibrary.GetRef(name)->GetCreateInfoRef().RSCI.cullMode = VK_CULL_MODE_BACK_BIT;
+
+        Timer timer;
+        timer.Start();
+        ci.pipelineLibrary.GetRef(name)->Build();
+
+        return timer.Stop();
     }
 
 }
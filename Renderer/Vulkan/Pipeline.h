@@ -7,6 +7,7 @@
 #include <Common/Util/Library.h>
 #include <Common/Util/Memory.h>
 
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -30,7 +31,10 @@ namespace Cosmos::Renderer::Vulkan
 			std::vector<Vertex::Component> vertexComponents = {};       // components the vertex have
 			bool passingVertexData = true;								// disable this when not passing vertex data to the shader
 			std::vector<VkDescriptorSetLayoutBinding> bindings = {};    // binding data (buffer, textures, etc)
+			VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE; // optionally an existing layout used instead of the bindings, it's not owned by the pipeline
 			std::vector<VkPushConstantRange> pushConstants = {};        // optioanlly push constant when creating pipeline
+			std::vector<VkSpecializationMapEntry> specializationEntries = {}; // optionally specialization constants, given to every stage
+			std::vector<uint8_t> specializationData = {};               // values the specialization entries point into
 
 			// these will be auto generated, but can be previously modified between Pipeline constructor and Build
 			std::vector<VkDynamicState> dynamicStates{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
@@ -94,8 +98,10 @@ namespace Cosmos::Renderer::Vulkan
 		CreateInfo mCreateInfo = {};
 		VkPipelineCache mPipelineCache = VK_NULL_HANDLE;
 		VkDescriptorSetLayout mDescriptorSetLayout = VK_NULL_HANDLE;
+		bool mOwnsDescriptorSetLayout = true;
 		VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
 		VkPipeline mPipeline = VK_NULL_HANDLE;
+		VkSpecializationInfo mSpecializationInfo = {};
 
 		std::vector<VkVertexInputBindingDescription> mBindingDescriptions = {};
 		std::vector<VkVertexInputAttributeDescription> mAttributeDescriptions = {};
@@ -107,8 +113,15 @@ namespace Cosmos::Renderer::Vulkan
 		Shared<Renderpass>& mainRenderpass;
 		Library<Shared<Pipeline>>& pipelineLibrary;
 		Library<Shared<Renderpass>>& renderpassLibrary;
+		VkDescriptorSetLayout globalDescriptorSetLayout;
 	};
-	// creates all pipelines used by the renderer
+	// creates all pipelines used by the renderer, including every mesh variant
 	void CreateDefaultPipelines(DefaultPipelinesCreateInfo& ci);
+
+	// returns the pipeline library name of a mesh variant, the variant without features is "Mesh" and picking is always "Picking"
+	std::string GetMeshPipelineName(uint32_t features);
+
+	// creates the mesh pipeline variant of the given IMesh::Feature combination, returns how long it took to build in milliseconds
+	double CreateMeshPipeline(DefaultPipelinesCreateInfo& ci, uint32_t features);
 }
 #endif
\ No newline at end of file
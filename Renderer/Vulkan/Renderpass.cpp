@@ -2,6 +2,7 @@
 #include "Renderpass.h"
 
 #include "Context.h"
+#include "DeletionQueue.h"
 #include "Device.h"
 #include "Core/Defines.h"
 #include <Common/Debug/Logger.h>
@@ -15,16 +16,14 @@ namespace Cosmos::Renderer::Vulkan
 
 	Renderpass::~Renderpass()
 	{
-		vkDeviceWaitIdle(mDevice->GetLogicalDevice());
-
-		vkDestroyDescriptorPool(mDevice->GetLogicalDevice(), mDescriptorPool, nullptr);
-		vkDestroyRenderPass(mDevice->GetLogicalDevice(), mRenderPass, nullptr);
-
-		vkFreeCommandBuffers(mDevice->GetLogicalDevice(), mCommandPool, (uint32_t)mCommandfuffers.size(), mCommandfuffers.data());
-		vkDestroyCommandPool(mDevice->GetLogicalDevice(), mCommandPool, nullptr);
+		// the command buffers may still be executing, everything goes once the frames in flight are done
+		auto& deletionQueue = ((Context*)Context::GetRef())->GetDeletionQueueRef();
+		deletionQueue->ReleaseDescriptorPool(mDescriptorPool);
+		deletionQueue->ReleaseRenderPass(mRenderPass);
+		deletionQueue->ReleaseCommandPool(mCommandPool);
 
 		for (auto& framebuffer : mFramebuffers) {
-			vkDestroyFramebuffer(mDevice->GetLogicalDevice(), framebuffer, nullptr);
+			deletionQueue->ReleaseFramebuffer(framebuffer);
 		}
 
 		mFramebuffers.clear();
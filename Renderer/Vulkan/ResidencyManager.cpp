@@ -0,0 +1,79 @@
+#if defined RENDERER_VULKAN
+#include "ResidencyManager.h"
+
+#include "DeletionQueue.h"
+#include "Device.h"
+#include "Texture.h"
+
+#include <Common/Debug/Logger.h>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	ResidencyManager::ResidencyManager(Shared<Device> device, Shared<DeletionQueue> deletionQueue, VkDeviceSize budget)
+		: mDevice(device), mDeletionQueue(deletionQueue), mBudget(budget)
+	{
+		if (!mDevice->IsMemoryBudgetSupported()) {
+			COSMOS_LOG(Logger::Warn, "VK_EXT_memory_budget is not available, gpu memory usage will be estimated by the allocator");
+		}
+	}
+
+	void ResidencyManager::Register(Texture2D* texture)
+	{
+		mPolicy.Register(texture);
+	}
+
+	void ResidencyManager::Unregister(Texture2D* texture)
+	{
+		mPolicy.Unregister(texture);
+	}
+
+	void ResidencyManager::Touch(Texture2D* texture, float screenSize)
+	{
+		mPolicy.Touch(texture, screenSize);
+	}
+
+	void ResidencyManager::OnUpdate()
+	{
+		VkDeviceSize usage = 0;
+		VkDeviceSize heapBudget = 0;
+		QueryMemory(usage, heapBudget);
+
+		// some headroom is left when following the driver budget, transient allocations (staging, swapchain recreation) need it
+		mPolicy.Update(usage, mBudget > 0 ? mBudget : heapBudget / 10 * 9);
+	}
+
+	void ResidencyManager::QueryMemory(VkDeviceSize& usage, VkDeviceSize& budget) const
+	{
+		VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+		vmaGetHeapBudgets(mDevice->GetAllocator(), budgets);
+
+		const VkPhysicalDeviceMemoryProperties& properties = mDevice->GetMemoryPropertiesRef();
+		usage = 0;
+		budget = 0;
+
+		for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+		{
+			if (properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			{
+				usage += budgets[i].usage;
+				budget += budgets[i].budget;
+			}
+		}
+
+		// software devices may not expose a device-local heap, everything is system memory there
+		if (budget == 0)
+		{
+			for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+			{
+				usage += budgets[i].usage;
+				budget += budgets[i].budget;
+			}
+		}
+
+		// streamed out images are still allocated for a couple of frames, counting them would stream out more than needed
+		VkDeviceSize pending = mDeletionQueue->GetPendingImageBytes();
+		usage = usage > pending ? usage - pending : 0;
+	}
+}
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Wrapper/vulkan.h"
+#include "Core/ResidencyPolicy.h"
+#include <Common/Util/Memory.h>
+
+// forward declarations
+namespace Cosmos::Renderer::Vulkan { class DeletionQueue; }
+namespace Cosmos::Renderer::Vulkan { class Device; }
+namespace Cosmos::Renderer::Vulkan { class Texture2D; }
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// feeds the residency policy with the memory the device reports, the policy decides what's streamed
+	class ResidencyManager
+	{
+	public:
+
+		// constructor, a budget of zero follows what the driver reports for the device-local heaps
+		ResidencyManager(Shared<Device> device, Shared<DeletionQueue> deletionQueue, VkDeviceSize budget = 0);
+
+		// destructor
+		~ResidencyManager() = default;
+
+	public:
+
+		// returns the budget in bytes, zero means the driver budget is used
+		inline VkDeviceSize GetBudget() const { return mBudget; }
+
+		// sets a new budget in bytes, zero means the driver budget is used
+		inline void SetBudget(VkDeviceSize budget) { mBudget = budget; }
+
+		// returns a reference to the last frame statistics
+		inline ResidencyPolicy::Statistics& GetStatisticsRef() { return mPolicy.GetStatisticsRef(); }
+
+	public:
+
+		// starts tracking a texture, it's mips may be streamed from now on
+		void Register(Texture2D* texture);
+
+		// stops tracking a texture
+		void Unregister(Texture2D* texture);
+
+		// informs the texture was drawn this frame covering screenSize pixels, the largest coverage of the frame is kept
+		void Touch(Texture2D* texture, float screenSize);
+
+		// streams texture mips in and out respecting the budget, must be called once per frame before recording
+		void OnUpdate();
+
+	private:
+
+		// returns the memory used on device-local heaps, minus the images about to be destroyed, and the budget the driver allows for them
+		void QueryMemory(VkDeviceSize& usage, VkDeviceSize& budget) const;
+
+	private:
+
+		Shared<Device> mDevice;
+		Shared<DeletionQueue> mDeletionQueue;
+		VkDeviceSize mBudget = 0;
+		ResidencyPolicy mPolicy;
+	};
+}
+
+#endif
@@ -4,6 +4,9 @@
 #include "Device.h"
 #include <Common/Debug/Logger.h>
 #include <Common/File/Filesystem.h>
+#include <Common/Util/Hash.h>
+#include <Common/Util/ThreadPool.h>
+#include <Common/Util/Timer.h>
 
 #if defined(_MSC_VER)
 #pragma warning( push )
@@ -14,87 +17,322 @@
 # pragma warning(pop)
 #endif
 
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <set>
 #include <sstream>
 
 namespace Cosmos::Renderer::Vulkan
 {
-	Shader::Shader(Shared<Device> device, ShaderType type, const char* name, const char* path)
-		: mDevice(device), mType(type), mName(name), mPath(path)
+	// bumped whenever the compile options change in a way the key doesn't see
+	static constexpr uint32_t ShaderCacheVersion = 1;
+
+	// first word of every spir-v binary
+	static constexpr uint32_t SPIRVMagic = 0x07230203;
+
+	// reads a whole text file, returns false if it couldn't be opened
+	static bool ReadText(const std::string& path, std::string& text)
 	{
-		// reads raw shader
-		std::ifstream read(path);
-		std::stringstream buffer;
+		std::ifstream read(path, std::ios::binary);
 
+		if (!read.is_open()) {
+			return false;
+		}
+
+		std::stringstream buffer;
 		buffer << read.rdbuf();
-		read.close();
+		text = buffer.str();
+
+		return true;
+	}
 
-		std::string auxname = path;
-		auxname += ".spv";
+	// resolves an include relative to the file including it
+	static std::string ResolveInclude(const std::string& requesting, const std::string& requested)
+	{
+		return (std::filesystem::path(requesting).parent_path() / requested).generic_string();
+	}
 
-		// writes compiled shared
-		std::vector<uint32_t> bin = Compile(buffer.str().c_str(), type, false);
-		std::ofstream write(auxname.c_str(), std::ios::out | std::ios::binary);
+	// hashes every file reached through #include directives, so changing a header invalidates the shaders using it
+	static uint64_t HashIncludes(const std::string& path, const std::string& source, uint64_t hash, std::set<std::string>& visited)
+	{
+		std::istringstream lines(source);
+		std::string line;
 
-		if (write.is_open())
-		{
-			write.write(reinterpret_cast<char*>(&bin[0]), bin.size() * sizeof(bin[0]));
-			write.close();
+		while (std::getline(lines, line)) {
+			size_t directive = line.find_first_not_of(" \t");
+
+			if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0) {
+				continue;
+			}
+
+			size_t begin = line.find_first_of("\"<", directive + 8);
+			size_t end = begin == std::string::npos ? std::string::npos : line.find_first_of("\">", begin + 1);
+
+			if (end == std::string::npos) {
+				continue;
+			}
+
+			std::string include = ResolveInclude(path, line.substr(begin + 1, end - begin - 1));
+
+			if (!visited.insert(include).second) {
+				continue;
+			}
+
+			std::string text;
+			ReadText(include, text);
+
+			hash = HashString(include, hash);
+			hash = HashString(text, hash);
+			hash = HashIncludes(include, text, hash, visited);
 		}
 
-		CreateShaderModule(ReadSPIRV());
-		CreateShaderStage();
+		return hash;
 	}
 
-	Shader::~Shader()
+	// key of a shader on the cache, covers everything that changes the generated spir-v
+	static uint64_t ComputeShaderKey(ShaderType type, const std::string& path, const std::string& source, const std::vector<std::string>& defines, bool optimize)
 	{
-		vkDestroyShaderModule(mDevice->GetLogicalDevice(), mShaderModule, nullptr);
+		uint64_t hash = HashBytes(&ShaderCacheVersion, sizeof(ShaderCacheVersion));
+		hash = HashBytes(&type, sizeof(type), hash);
+		hash = HashBytes(&optimize, sizeof(optimize), hash);
+
+		for (const std::string& define : defines) {
+			hash = HashString(define, hash);
+			hash = HashBytes("\n", 1, hash);
+		}
+
+		hash = HashString(source, hash);
+
+		std::set<std::string> visited = {};
+		return HashIncludes(path, source, hash, visited);
 	}
 
-	std::vector<char> Shader::ReadSPIRV()
+	// returns where the spir-v of a given key is kept
+	static std::string GetShaderCachePath(const std::string& path, uint64_t key)
 	{
-		std::string name = mPath;
-		name += ".spv";
+		char hex[17] = {};
+		snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)key);
+
+		std::string name = std::filesystem::path(path).filename().string();
+		return GetCacheSubDir(name + "." + hex + ".spv");
+	}
+
+	// reads a cached spir-v binary, returns false if it's missing or doesn't look like spir-v
+	static bool ReadCachedSPIRV(const std::string& cachePath, std::vector<uint32_t>& binary)
+	{
+		std::ifstream read(cachePath, std::ios::ate | std::ios::binary);
+
+		if (!read.is_open()) {
+			return false;
+		}
 
-		std::ifstream bin(name, std::ios::ate | std::ios::binary);
+		size_t fileSize = (size_t)read.tellg();
 
-		size_t fileSize = (size_t)bin.tellg();
-		std::vector<char> buffer(fileSize);
+		if (fileSize < sizeof(uint32_t) || fileSize % sizeof(uint32_t) != 0) {
+			return false;
+		}
 
-		bin.seekg(0);
-		bin.read(buffer.data(), fileSize);
-		bin.close();
+		binary.resize(fileSize / sizeof(uint32_t));
+		read.seekg(0);
+		read.read((char*)binary.data(), fileSize);
 
-		return buffer;
+		return read && binary[0] == SPIRVMagic;
 	}
 
-	std::vector<uint32_t> Shader::Compile(const char* source, ShaderType type, bool optimize)
+	// writes a spir-v binary into the cache, written aside and renamed so a reader never sees it half-written
+	static void WriteCachedSPIRV(const std::string& cachePath, const std::vector<uint32_t>& binary)
+	{
+		std::string temporary = cachePath + ".tmp";
+		{
+			std::ofstream write(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+			write.write((const char*)binary.data(), binary.size() * sizeof(uint32_t));
+
+			if (!write) {
+				COSMOS_LOG(Logger::Warn, "Failed to write shader cache %s", temporary.c_str());
+				return;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary, cachePath, error);
+
+		if (error) {
+			COSMOS_LOG(Logger::Warn, "Failed to write shader cache %s: %s", cachePath.c_str(), error.message().c_str());
+		}
+	}
+
+	// resolves the #include directives for shaderc, relative to the including file
+	class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
+	{
+	public:
+
+		virtual shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type type, const char* requestingSource, size_t includeDepth) override
+		{
+			Include* include = new Include();
+			include->name = ResolveInclude(requestingSource, requestedSource);
+
+			// an empty name tells shaderc the include failed, the content is then the error message
+			if (!ReadText(include->name, include->content)) {
+				include->content = "Failed to open include " + include->name;
+				include->name.clear();
+			}
+
+			include->result.source_name = include->name.c_str();
+			include->result.source_name_length = include->name.size();
+			include->result.content = include->content.c_str();
+			include->result.content_length = include->content.size();
+			include->result.user_data = include;
+
+			return &include->result;
+		}
+
+		virtual void ReleaseInclude(shaderc_include_result* data) override
+		{
+			delete (Include*)data->user_data;
+		}
+
+	private:
+
+		struct Include
+		{
+			shaderc_include_result result = {};
+			std::string name;
+			std::string content;
+		};
+	};
+
+	// compiles a shader source into spir-v, a new compiler is used per call so it may run on any thread, returns false with the compiler message on errors
+	static bool CompileSPIRV(ShaderType type, const std::string& path, const std::string& source, const std::vector<std::string>& defines, bool optimize, std::vector<uint32_t>& binary, std::string& error)
 	{
 		shaderc::Compiler compiler;
 		shaderc::CompileOptions options;
+		options.SetIncluder(std::make_unique<ShaderIncluder>());
 
 		if (optimize)
 		{
 			options.SetOptimizationLevel(shaderc_optimization_level_size);
 		}
 
-		shaderc::SpvCompilationResult res = compiler.CompileGlslToSpv(source, (shaderc_shader_kind)type, mPath, options);
-		std::ostringstream msg;
-		msg << "Failed to Compile shader " << mPath << "Details: " << res.GetErrorMessage();
+		for (const std::string& define : defines) {
+			size_t separator = define.find('=');
+
+			if (separator == std::string::npos) {
+				options.AddMacroDefinition(define);
+			}
+
+			else {
+				options.AddMacroDefinition(define.substr(0, separator), define.substr(separator + 1));
+			}
+		}
+
+		shaderc::SpvCompilationResult res = compiler.CompileGlslToSpv(source, (shaderc_shader_kind)type, path.c_str(), options);
+
+		if (res.GetCompilationStatus() != shaderc_compilation_status_success) {
+			std::ostringstream msg;
+			msg << "Failed to Compile shader " << path << " Details: " << res.GetErrorMessage();
+			error = msg.str();
+			return false;
+		}
+
+		binary = { res.cbegin(), res.cend() };
+		return true;
+	}
+
+	// returns the spir-v of a shader, from the cache when possible, sets hit to whether it was cached
+	static bool LoadOrCompileSPIRV(ShaderType type, const std::string& path, const std::vector<std::string>& defines, bool optimize, std::vector<uint32_t>& binary, bool& hit, std::string& error)
+	{
+		std::string source;
+		hit = false;
+
+		if (!ReadText(path, source)) {
+			error = "Failed to read shader source " + path;
+			return false;
+		}
+
+		uint64_t key = ComputeShaderKey(type, path, source, defines, optimize);
+		std::string cachePath = GetShaderCachePath(path, key);
+
+		hit = ReadCachedSPIRV(cachePath, binary);
+
+		if (hit) {
+			return true;
+		}
+
+		if (!CompileSPIRV(type, path, source, defines, optimize, binary, error)) {
+			return false;
+		}
+
+		WriteCachedSPIRV(cachePath, binary);
+		return true;
+	}
+
+	Shader::Shader(Shared<Device> device, ShaderType type, const char* name, const char* path, const std::vector<std::string>& defines, bool optimize)
+		: mDevice(device), mType(type), mName(name), mPath(path), mDefines(defines), mOptimize(optimize)
+	{
+		bool hit = false;
+		std::string error;
+		std::vector<uint32_t> binary = {};
+
+		COSMOS_ASSERT(LoadOrCompileSPIRV(type, mPath, defines, optimize, binary, hit, error), error.c_str());
+
+		if (!hit) {
+			COSMOS_LOG(Logger::Trace, "Shader %s was not on the shader cache and was compiled", mName.c_str());
+		}
+
+		CreateShaderModule(binary);
+		CreateShaderStage();
+	}
+
+	Shader::Shader(Shared<Device> device, const char* name, const Source& source, const std::vector<uint32_t>& binary)
+		: mDevice(device), mType(source.type), mName(name), mPath(source.path), mDefines(source.defines), mOptimize(source.optimize)
+	{
+		CreateShaderModule(binary);
+		CreateShaderStage();
+	}
+
+	Shader::~Shader()
+	{
+		vkDestroyShaderModule(mDevice->GetLogicalDevice(), mShaderModule, nullptr);
+	}
+
+	bool Shader::Load(const Source& source, std::vector<uint32_t>& binary, std::string& error)
+	{
+		bool hit = false;
+		return LoadOrCompileSPIRV(source.type, source.path, source.defines, source.optimize, binary, hit, error);
+	}
+
+	void Shader::Precompile(const std::vector<Source>& sources)
+	{
+		Timer timer;
+		timer.Start();
+
+		std::atomic<uint32_t> compiled = 0;
+
+		// errors are left for the shader constructor to report
+		ThreadPool::GetRef().ParallelFor(sources.size(), [&](size_t i)
+			{
+				bool hit = false;
+				std::string error;
+				std::vector<uint32_t> binary = {};
 
-		COSMOS_ASSERT(res.GetCompilationStatus() == shaderc_compilation_status_success, msg.str().c_str());
+				if (LoadOrCompileSPIRV(sources[i].type, sources[i].path, sources[i].defines, sources[i].optimize, binary, hit, error) && !hit) {
+					compiled++;
+				}
+			});
 
-		return { res.cbegin(), res.cend() };
+		COSMOS_LOG(Logger::Info, "Prepared %u shaders in %.3fms, %u compiled and %u from the shader cache", (uint32_t)sources.size(), timer.Stop(), compiled.load(), (uint32_t)sources.size() - compiled.load());
 	}
 
-	void Shader::CreateShaderModule(const std::vector<char>& binary)
+	void Shader::CreateShaderModule(const std::vector<uint32_t>& binary)
 	{
 		VkShaderModuleCreateInfo shaderModuleCI = {};
 		shaderModuleCI.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 		shaderModuleCI.pNext = nullptr;
 		shaderModuleCI.flags = 0;
-		shaderModuleCI.codeSize = binary.size();
-		shaderModuleCI.pCode = reinterpret_cast<const uint32_t*>(binary.data());
+		shaderModuleCI.codeSize = binary.size() * sizeof(uint32_t);
+		shaderModuleCI.pCode = binary.data();
 
 		COSMOS_ASSERT(vkCreateShaderModule(mDevice->GetLogicalDevice(), &shaderModuleCI, nullptr, &mShaderModule) == VK_SUCCESS, "Failed to create shader module");
 	}
@@ -3,6 +3,7 @@
 #include "Wrapper/vulkan.h"
 
 #include <Common/Util/Memory.h>
+#include <string>
 #include <vector>
 
 // forward declaration
@@ -24,8 +25,22 @@ namespace Cosmos::Renderer::Vulkan
 	{
 	public:
 
-		// constructor
-		Shader(Shared<Device> device, ShaderType type, const char* name, const char* path);
+		// a shader to be compiled ahead of it's creation
+		struct Source
+		{
+			ShaderType type = ShaderType::Vertex;
+			std::string path;
+			std::vector<std::string> defines = {};		// NAME or NAME=VALUE
+			bool optimize = false;
+		};
+
+	public:
+
+		// constructor, the spir-v is loaded from the shader cache and only compiled if the source (or anything it depends on) changed
+		Shader(Shared<Device> device, ShaderType type, const char* name, const char* path, const std::vector<std::string>& defines = {}, bool optimize = false);
+
+		// constructor, from an already compiled spir-v binary of the source
+		Shader(Shared<Device> device, const char* name, const Source& source, const std::vector<uint32_t>& binary);
 
 		// destructor
 		~Shader();
@@ -34,27 +49,32 @@ namespace Cosmos::Renderer::Vulkan
 		inline ShaderType GetType() { return mType; }
 
 		// returnsa reference to the shader name
-		inline const char* GetName() { return mName; }
+		inline const char* GetName() { return mName.c_str(); }
 
 		// returns a reference to the shader path
-		inline const char* GetPath() { return mPath; }
+		inline const char* GetPath() { return mPath.c_str(); }
 
 		// returns the shader module
 		inline VkShaderModule GetModule() { return mShaderModule; }
 
+		// returns what the shader was compiled from
+		inline Source GetSource() const { return { mType, mPath, mDefines, mOptimize }; }
+
 		// returns a reference to the shader stage info
 		VkPipelineShaderStageCreateInfo& GetShaderStageCreateInfoRef() { return mShaderStageCI; }
 
-	private:
+	public:
 
-		// reads and returns shader's binary
-		std::vector<char> ReadSPIRV();
+		// loads the spir-v of a shader from the shader cache, compiling it when missing, returns false with the compiler message on errors instead of asserting
+		static bool Load(const Source& source, std::vector<uint32_t>& binary, std::string& error);
 
-		// compiles and returns a source shader
-		std::vector<uint32_t> Compile(const char* source, ShaderType type, bool optimize = false);
+		// compiles the shaders missing from the shader cache in parallel on the thread pool, creating them afterwards costs no compilation
+		static void Precompile(const std::vector<Source>& sources);
+
+	private:
 
 		// creates the shader's module of the spir-v binary
-		void CreateShaderModule(const std::vector<char>& binary);
+		void CreateShaderModule(const std::vector<uint32_t>& binary);
 
 		// creates the shaders tage specification
 		void CreateShaderStage();
@@ -63,8 +83,10 @@ namespace Cosmos::Renderer::Vulkan
 
 		Shared<Device> mDevice;
 		ShaderType mType;
-		const char* mName;
-		const char* mPath;
+		std::string mName;
+		std::string mPath;
+		std::vector<std::string> mDefines;
+		bool mOptimize = false;
 		VkShaderModule mShaderModule = VK_NULL_HANDLE;
 		VkPipelineShaderStageCreateInfo mShaderStageCI = {};
 	};
@@ -0,0 +1,164 @@
+#if defined RENDERER_VULKAN
+#include "ShaderReloader.h"
+
+#include "Device.h"
+#include <Common/Debug/Logger.h>
+#include <Common/Util/ThreadPool.h>
+
+#include <filesystem>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// returns a path in a form that can be compared against others
+	static std::string NormalizePath(const std::string& path)
+	{
+		std::error_code error;
+		return std::filesystem::weakly_canonical(path, error).generic_string();
+	}
+
+	// returns if a file is a shader stage, other files are taken as includes
+	static bool IsShaderStage(const std::string& path)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		return extension == ".vert" || extension == ".frag" || extension == ".comp" || extension == ".geom" || extension == ".tesc" || extension == ".tese";
+	}
+
+	ShaderReloader::ShaderReloader(Shared<Device> device, Library<Shared<Pipeline>>& pipelinesLib, std::string directory)
+		: mDevice(device), mPipelinesLib(pipelinesLib), mWatcher(directory)
+	{
+		if (mWatcher.IsWatching()) {
+			COSMOS_LOG(Logger::Trace, "Watching %s for shader changes", mWatcher.GetDirectory().c_str());
+		}
+	}
+
+	ShaderReloader::~ShaderReloader()
+	{
+		if (mTask.valid()) {
+			mTask.wait();
+		}
+	}
+
+	void ShaderReloader::OnUpdate()
+	{
+		if (mTask.valid() && mTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			std::vector<Result> results = mTask.get();
+			Swap(results);
+		}
+
+		for (const FileWatcher::Change& change : mWatcher.Poll()) {
+			std::string extension = std::filesystem::path(change.path).extension().string();
+
+			if (change.directory || change.action == FileWatcher::Action::Removed || extension == ".spv" || extension == ".tmp") {
+				continue;
+			}
+
+			mChanged.insert(NormalizePath(change.path));
+		}
+
+		// changes made while rebuilding wait for the current rebuild to finish
+		if (!mChanged.empty() && !mTask.valid()) {
+			Dispatch();
+		}
+	}
+
+	void ShaderReloader::Dispatch()
+	{
+		bool includeChanged = false;
+
+		for (const std::string& path : mChanged) {
+			if (!IsShaderStage(path)) {
+				includeChanged = true;
+				break;
+			}
+		}
+
+		// the pipeline state is copied now, the worker never touches the library
+		std::vector<Rebuild> rebuilds = {};
+
+		for (auto& [name, pipeline] : mPipelinesLib.GetAllRefs()) {
+			Pipeline::CreateInfo& ci = pipeline->GetCreateInfoRef();
+
+			if (!ci.vertexShader || !ci.fragmentShader) {
+				continue;
+			}
+
+			bool affected = includeChanged
+				|| mChanged.count(NormalizePath(ci.vertexShader->GetPath())) > 0
+				|| mChanged.count(NormalizePath(ci.fragmentShader->GetPath())) > 0;
+
+			if (affected) {
+				rebuilds.push_back({ name, pipeline.get(), ci, ci.vertexShader->GetSource(), ci.fragmentShader->GetSource() });
+			}
+		}
+
+		mChanged.clear();
+
+		if (rebuilds.empty()) {
+			return;
+		}
+
+		COSMOS_LOG(Logger::Trace, "Shaders changed, rebuilding %u pipeline(s)", (uint32_t)rebuilds.size());
+
+		mTask = ThreadPool::GetRef().Enqueue([this, device = mDevice, rebuilds = std::move(rebuilds)]() mutable
+			{
+				return RebuildPipelines(device, std::move(rebuilds));
+			});
+	}
+
+	void ShaderReloader::Swap(std::vector<Result>& results)
+	{
+		for (Result& result : results) {
+			if (!result.error.empty()) {
+				COSMOS_LOG(Logger::Error, "Failed to reload pipeline %s, keeping the previous one. %s", result.name.c_str(), result.error.c_str());
+				continue;
+			}
+
+			// the pipelines were recreated meanwhile (swapchain or viewport resize), they already use the current shaders
+			if (!mPipelinesLib.Exists(result.name) || mPipelinesLib.GetRef(result.name).get() != result.current) {
+				continue;
+			}
+
+			// the replaced pipeline goes through the deletion queue, frames in flight may still use it
+			mPipelinesLib.Erase(result.name);
+			mPipelinesLib.Insert(result.name, result.pipeline);
+
+			COSMOS_LOG(Logger::Info, "Reloaded pipeline %s", result.name.c_str());
+		}
+	}
+
+	std::vector<ShaderReloader::Result> ShaderReloader::RebuildPipelines(Shared<Device> device, std::vector<Rebuild> rebuilds)
+	{
+		std::vector<Result> results = {};
+
+		for (Rebuild& rebuild : rebuilds) {
+			Result& result = results.emplace_back();
+			result.name = rebuild.name;
+			result.current = rebuild.current;
+
+			std::vector<uint32_t> vertexBinary = {};
+			std::vector<uint32_t> fragmentBinary = {};
+
+			if (!Shader::Load(rebuild.vertex, vertexBinary, result.error) || !Shader::Load(rebuild.fragment, fragmentBinary, result.error)) {
+				continue;
+			}
+
+			Pipeline::CreateInfo ci = rebuild.ci;
+			ci.vertexShader = CreateShared<Shader>(device, rebuild.ci.vertexShader->GetName(), rebuild.vertex, vertexBinary);
+			ci.fragmentShader = CreateShared<Shader>(device, rebuild.ci.fragmentShader->GetName(), rebuild.fragment, fragmentBinary);
+
+			// the constructor resets the fixed function state, the changes made to the previous pipeline before it was built are kept
+			// the shared pipeline cache is internally synchronized, so it's used from here as well
+			result.pipeline = CreateShared<Pipeline>(device, ci, device->GetPipelineCache());
+			result.pipeline->GetCreateInfoRef().IASCI = rebuild.ci.IASCI;
+			result.pipeline->GetCreateInfoRef().RSCI = rebuild.ci.RSCI;
+			result.pipeline->GetCreateInfoRef().MSCI = rebuild.ci.MSCI;
+			result.pipeline->GetCreateInfoRef().DSSCI = rebuild.ci.DSSCI;
+			result.pipeline->GetCreateInfoRef().CBAS = rebuild.ci.CBAS;
+			result.pipeline->Build();
+		}
+
+		return results;
+	}
+}
+
+#endif
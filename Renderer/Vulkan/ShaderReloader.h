@@ -0,0 +1,74 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Pipeline.h"
+#include "Shader.h"
+#include <Common/File/FileWatcher.h>
+#include <Common/Util/Library.h>
+#include <Common/Util/Memory.h>
+#include <future>
+#include <set>
+#include <string>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer::Vulkan { class Device; }
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// watches the shader directory and rebuilds the pipelines using a changed shader on a worker thread, swapping them in between frames
+	class ShaderReloader
+	{
+	public:
+
+		// constructor
+		ShaderReloader(Shared<Device> device, Library<Shared<Pipeline>>& pipelinesLib, std::string directory);
+
+		// destructor
+		~ShaderReloader();
+
+	public:
+
+		// must be called at a frame boundary, after the frame fence is waited and before any command is recorded
+		void OnUpdate();
+
+	private:
+
+		// a pipeline to be rebuilt with it's current state
+		struct Rebuild
+		{
+			std::string name;
+			Pipeline* current = nullptr;						// discarded if the library no longer holds this one when the rebuild ends
+			Pipeline::CreateInfo ci = {};
+			Shader::Source vertex = {};
+			Shader::Source fragment = {};
+		};
+
+		struct Result
+		{
+			std::string name;
+			Pipeline* current = nullptr;
+			Shared<Pipeline> pipeline;
+			std::string error;
+		};
+
+		// starts rebuilding the pipelines using the changed files
+		void Dispatch();
+
+		// swaps the rebuilt pipelines into the library
+		void Swap(std::vector<Result>& results);
+
+		// rebuilds the pipelines, runs on a worker thread
+		std::vector<Result> RebuildPipelines(Shared<Device> device, std::vector<Rebuild> rebuilds);
+
+	private:
+
+		Shared<Device> mDevice;
+		Library<Shared<Pipeline>>& mPipelinesLib;
+		FileWatcher mWatcher;
+		std::set<std::string> mChanged = {};
+		std::future<std::vector<Result>> mTask;
+	};
+}
+
+#endif
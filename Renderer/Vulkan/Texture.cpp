@@ -1,12 +1,21 @@
 #if defined RENDERER_VULKAN
 #include "Texture.h"
 
+#include "Bindless.h"
+#include "Core/KTXFile.h"
+#include "Core/TextureCooker.h"
 #include "Context.h"
+#include "DeletionQueue.h"
 #include "Device.h"
 #include "GUI.h"
 #include "Renderpass.h"
+#include "ResidencyManager.h"
+#include "TextureLoader.h"
+#include "Uploader.h"
 
+#include <Common/Core/Defines.h>
 #include <Common/Debug/Logger.h>
+#include <Common/Util/Timer.h>
 #include <Platform/Core/PlatformDetection.h>
 
 #if defined(PLATFORM_WINDOWS)
@@ -25,34 +34,30 @@
 
 namespace Cosmos::Renderer::Vulkan
 {
-	Texture2D::Texture2D(std::string path, bool gui)
+	Texture2D::Texture2D(std::string path, bool gui, bool async)
 	{
 		ITexture2D::mPath = path;
+		mGUI = gui;
 
-		LoadTexture(gui);
-		auto* renderer = (Vulkan::Context*)Context::GetRef();
+		// the placeholder is shown on the ui and sampled by index until the loader finishes the texture
+		if (async)
+		{
+			auto* renderer = (Vulkan::Context*)Context::GetRef();
+			Texture2D* placeholder = renderer->GetTextureLoaderRef()->GetPlaceholder();
 
-		// image view
-		mView = renderer->GetDevice()->CreateImageView
-		(
-			mImage,
-			VK_FORMAT_R8G8B8A8_SRGB,
-			VK_IMAGE_ASPECT_COLOR_BIT,
-			mMipLevels
-		);
+			mPending = true;
+			mDescriptorSet = (VkDescriptorSet)GUI::GetRef()->AddTexture(placeholder->GetSampler(), placeholder->GetView());
 
-		// sampler
-		mSampler = renderer->GetDevice()->CreateSampler
-		(
-			VK_FILTER_LINEAR,
-			VK_FILTER_LINEAR,
-			VK_SAMPLER_ADDRESS_MODE_REPEAT,
-			VK_SAMPLER_ADDRESS_MODE_REPEAT,
-			VK_SAMPLER_ADDRESS_MODE_REPEAT,
-			(float)mMipLevels
-		);
+			if (!gui && renderer->GetBindlessRef()) {
+				mBindlessIndex = renderer->GetBindlessRef()->RegisterTexture((VkImageView)placeholder->GetView(), (VkSampler)placeholder->GetSampler());
+			}
 
-		mDescriptorSet = (VkDescriptorSet)GUI::GetRef()->AddTexture(mSampler, mView);
+			renderer->GetTextureLoaderRef()->Load(this);
+			return;
+		}
+
+		LoadTexture(gui);
+		CreateResources(gui);
 	}
 
 	Texture2D::Texture2D(const BufferInfo& info, bool gui)
@@ -64,7 +69,7 @@ namespace Cosmos::Renderer::Vulkan
 		mView = renderer->GetDevice()->CreateImageView
 		(
 			mImage,
-			VK_FORMAT_R8G8B8A8_SRGB,
+			mFormat,
 			VK_IMAGE_ASPECT_COLOR_BIT,
 			mMipLevels
 		);
@@ -81,26 +86,56 @@ namespace Cosmos::Renderer::Vulkan
 		);
 
 		mDescriptorSet = (VkDescriptorSet)GUI::GetRef()->AddTexture(mSampler, mView);
+
+		if (!gui && renderer->GetBindlessRef()) {
+			mBindlessIndex = renderer->GetBindlessRef()->RegisterTexture(mView, mSampler);
+		}
 	}
 
 	Texture2D::~Texture2D()
 	{
 		auto* renderer = (Vulkan::Context*)Context::GetRef();
-		vkDeviceWaitIdle(renderer->GetDevice()->GetLogicalDevice());
 
-		vkDestroyImageView(renderer->GetDevice()->GetLogicalDevice(), mView, nullptr);
-		vkDestroyImage(renderer->GetDevice()->GetLogicalDevice(), mImage, nullptr);
-		vmaFreeMemory(renderer->GetDevice()->GetAllocator(), mMemory);
-		vkDestroySampler(renderer->GetDevice()->GetLogicalDevice(), mSampler, nullptr);
+		if (mPending || mStreaming) {
+			renderer->GetTextureLoaderRef()->Cancel(this);
+		}
+
+		if (mStreamable && renderer->GetResidencyManagerRef()) {
+			renderer->GetResidencyManagerRef()->Unregister(this);
+		}
+
+		if (mBindlessIndex != UINT32_MAX && renderer->GetBindlessRef()) {
+			renderer->GetBindlessRef()->UnregisterTexture(mBindlessIndex);
+		}
+
+		// frames in flight may still use them, the upload is only waited when the texture dies right after being created
+		renderer->GetDevice()->GetUploaderRef()->Wait(std::max(mUploadTicket, mStreamTicket));
+
+		auto& deletionQueue = renderer->GetDeletionQueueRef();
+		deletionQueue->ReleaseImageView(mView);
+		deletionQueue->ReleaseImage(mImage, mMemory);
+		deletionQueue->ReleaseSampler(mSampler);
+
+		if (mStreamImage != VK_NULL_HANDLE) {
+			deletionQueue->ReleaseImage(mStreamImage, mStreamMemory);
+		}
 	}
 
 	void* Texture2D::GetView()
 	{
+		if (mPending) {
+			return ((Vulkan::Context*)Context::GetRef())->GetTextureLoaderRef()->GetPlaceholder()->GetView();
+		}
+
 		return mView;
 	}
 
 	void* Texture2D::GetSampler()
 	{
+		if (mPending) {
+			return ((Vulkan::Context*)Context::GetRef())->GetTextureLoaderRef()->GetPlaceholder()->GetSampler();
+		}
+
 		return mSampler;
 	}
 
@@ -109,248 +144,346 @@ namespace Cosmos::Renderer::Vulkan
 		return mDescriptorSet;
 	}
 
-	void Texture2D::LoadTexture(bool gui)
+	VkDeviceSize Texture2D::GetResidentBytes(uint32_t level) const
 	{
-		int32_t channels;
-		stbi_uc* pixels = nullptr;
+		VkDeviceSize bytes = 0;
 
-		pixels = stbi_load(mPath.c_str(), &mWidth, &mHeight, &channels, STBI_rgb_alpha);
+		for (uint32_t i = level; i < (uint32_t)mMipLevels; i++) {
+			bytes += (VkDeviceSize)KTXFile::GetLevelSize((KTXFile::Format)mFormat, (uint32_t)std::max(mWidth >> i, 1), (uint32_t)std::max(mHeight >> i, 1));
+		}
 
-		if (pixels == nullptr) {
-			COSMOS_LOG(Logger::Assert, "Failed to load %s texture", mPath.c_str());
+		return bytes;
+	}
+
+	bool Texture2D::StreamToLevel(uint32_t level)
+	{
+		level = std::min(level, (uint32_t)mMipLevels - 1);
+
+		if (!mStreamable || mStreaming || level == mResidentLevel) {
+			return false;
+		}
+
+		// reading and downsampling take longer than a frame, the current image is sampled until the new one is uploaded
+		auto* renderer = (Vulkan::Context*)Context::GetRef();
+		renderer->GetTextureLoaderRef()->Stream(this, level, !mCookedPath.empty());
+
+		mStreaming = true;
+		mStreamLevel = level;
+		return true;
+	}
+
+	bool Texture2D::FinishStreaming(Decoded* decoded)
+	{
+		VkImage image = mImage;
+		VmaAllocation memory = mMemory;
+		uint64_t ticket = mUploadTicket;
+		bool created = false;
+
+		// cooked textures must still be cooked, they have a different format than the source image
+		if (decoded != nullptr && decoded->cooked && !mCookedPath.empty()) {
+			created = LoadCookedTexture(*decoded->cooked, decoded->cookedPath, mStreamLevel, false);
+		}
+
+		else if (decoded != nullptr && !decoded->cooked && mCookedPath.empty() && decoded->width == mWidth && decoded->height == mHeight && decoded->level == mStreamLevel)
+		{
+			// only the requested level and the ones below it are uploaded, the rest of the chain is blitted on the gpu as usual
+			CreateImageFromPixels(decoded->pixels.data(), std::max(mWidth >> mStreamLevel, 1), std::max(mHeight >> mStreamLevel, 1), mMipLevels - (int32_t)mStreamLevel, false);
+			created = true;
+		}
+
+		if (!created) {
+			COSMOS_LOG(Logger::Error, "Failed to stream %s texture, the file is missing or has changed", mPath.c_str());
+			mStreaming = false;
+			return false;
+		}
+
+		// the new image is kept aside, the current one is sampled until the upload retires
+		mStreamImage = mImage;
+		mStreamMemory = mMemory;
+		mStreamTicket = mUploadTicket;
+		mImage = image;
+		mMemory = memory;
+		mUploadTicket = ticket;
+		return true;
+	}
+
+	bool Texture2D::SwapStreamed()
+	{
+		auto* renderer = (Vulkan::Context*)Context::GetRef();
+
+		if (!renderer->GetDevice()->GetUploaderRef()->IsComplete(mStreamTicket)) {
+			return false;
+		}
+
+		// batches retire in order, the old image upload is done as well and only frames in flight may still sample it
+		renderer->GetDeletionQueueRef()->ReleaseImageView(mView);
+		renderer->GetDeletionQueueRef()->ReleaseImage(mImage, mMemory);
+
+		mImage = mStreamImage;
+		mMemory = mStreamMemory;
+		mUploadTicket = mStreamTicket;
+		mStreamImage = VK_NULL_HANDLE;
+		mStreamMemory = VK_NULL_HANDLE;
+		mView = renderer->GetDevice()->CreateImageView(mImage, mFormat, VK_IMAGE_ASPECT_COLOR_BIT, mMipLevels - mStreamLevel);
+
+		// the ui descriptor may be bound by frames in flight, it can't be rewritten so a new one replaces it
+		GUI* gui = (GUI*)GUI::GetRef();
+		gui->RemoveTexture(mDescriptorSet);
+		mDescriptorSet = (VkDescriptorSet)gui->AddTexture(mSampler, mView);
+
+		// the global descriptor set keeps the same index, frames are given the new view as they're rendered
+		if (mBindlessIndex != UINT32_MAX) {
+			renderer->GetBindlessRef()->UpdateTexture(mBindlessIndex, mView, mSampler);
+		}
+
+		COSMOS_LOG(Logger::Trace, "Streamed %s from mip %u to mip %u (%dx%d)", mPath.c_str(), mResidentLevel, mStreamLevel, std::max(mWidth >> mStreamLevel, 1), std::max(mHeight >> mStreamLevel, 1));
+
+		mResidentLevel = mStreamLevel;
+		mStreaming = false;
+		mViewVersion++;
+		return true;
+	}
+
+	void Texture2D::FinishLoading(Decoded& decoded)
+	{
+		if (!CreateFromDecoded(decoded, mGUI)) {
+			COSMOS_LOG(Logger::Error, "Failed to load %s texture, the placeholder is kept", mPath.c_str());
 			return;
 		}
 
-		mMipLevels = gui ? 1 : (uint32_t)(std::floor(std::log2(std::max(mWidth, mHeight)))) + 1;
-		VkDeviceSize imgSize = (VkDeviceSize)(mWidth * mHeight * 4); // enforce 4 channels
+		// the placeholder descriptors are replaced, the bindless index stays the same
+		mPending = false;
+		CreateResources(mGUI);
+		mViewVersion++;
+	}
 
-		// create staging buffer for image
-		VkBuffer stagingBuffer;
-		VmaAllocation stagingMemory;
-		Context* renderer = (Vulkan::Context*)Context::GetRef();
+	bool Texture2D::Decode(std::string path, Decoded& decoded, bool cooked, uint32_t level)
+	{
+		Timer timer;
+		timer.Start();
+		decoded = {};
 
-		renderer->GetDevice()->CreateBuffer
-		(
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			imgSize,
-			&stagingBuffer,
-			&stagingMemory
-		);
+		// a cooked texture has it's mips precomputed, the source image is only decoded when there's none up to date
+		if (cooked)
+		{
+			decoded.cookedPath = TextureCooker::FindCooked(path);
+
+			if (!decoded.cookedPath.empty())
+			{
+				decoded.cooked = CreateShared<KTXFile>();
+
+				if (decoded.cooked->Open(decoded.cookedPath)) {
+					decoded.time = timer.Stop();
+					return true;
+				}
+
+				decoded.cooked.reset();
+				decoded.cookedPath.clear();
+			}
+		}
 
-		void* gpuData = nullptr;
-		vmaMapMemory(renderer->GetDevice()->GetAllocator(), stagingMemory, &gpuData);
-		memcpy(gpuData, pixels, (size_t)imgSize);
-		vmaUnmapMemory(renderer->GetDevice()->GetAllocator(), stagingMemory);
+		int32_t channels;
+		stbi_uc* pixels = stbi_load(path.c_str(), &decoded.width, &decoded.height, &channels, STBI_rgb_alpha);
+
+		if (pixels == nullptr) {
+			return false;
+		}
 
+		decoded.pixels.assign(pixels, pixels + (size_t)decoded.width * (size_t)decoded.height * 4);
 		stbi_image_free(pixels);
 
-		auto& renderpass = renderer->GetMainRenderpassRef();
+		// each level halves the previous one, as the gpu blits them
+		std::vector<uint8_t> half;
+		int32_t width = decoded.width;
+		int32_t height = decoded.height;
+
+		for (decoded.level = 0; decoded.level < level && (width > 1 || height > 1); decoded.level++) {
+			half.resize((size_t)std::max(width / 2, 1) * (size_t)std::max(height / 2, 1) * 4);
+			TextureCooker::Downsample(decoded.pixels.data(), width, height, half.data());
+			decoded.pixels.swap(half);
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
 
-		// create image resource
-		renderer->GetDevice()->CreateImage
+		decoded.time = timer.Stop();
+		return true;
+	}
+
+	void Texture2D::LoadTexture(bool gui)
+	{
+		Decoded decoded;
+
+		if (!Decode(mPath, decoded) || !CreateFromDecoded(decoded, gui)) {
+			COSMOS_LOG(Logger::Assert, "Failed to load %s texture", mPath.c_str());
+		}
+	}
+
+	bool Texture2D::CreateFromDecoded(Decoded& decoded, bool gui)
+	{
+		// a cooked texture the device can't sample falls back to the source image
+		if (decoded.cooked && !LoadCookedTexture(*decoded.cooked, decoded.cookedPath, 0, gui) && !Decode(mPath, decoded, false)) {
+			return false;
+		}
+
+		if (decoded.cooked) {
+			COSMOS_LOG(Logger::Trace, "Loaded %s in %.2fms, %d precomputed mip level(s)", decoded.cookedPath.c_str(), decoded.time, mMipLevels);
+			return true;
+		}
+
+		mWidth = decoded.width;
+		mHeight = decoded.height;
+		mMipLevels = gui ? 1 : (uint32_t)(std::floor(std::log2(std::max(mWidth, mHeight)))) + 1;
+		CreateImageFromPixels(decoded.pixels.data(), mWidth, mHeight, mMipLevels, gui);
+
+		COSMOS_LOG(Logger::Trace, "Loaded %s in %.2fms, %d mip level(s) generated on the gpu", mPath.c_str(), decoded.time, mMipLevels - 1);
+		return true;
+	}
+
+	void Texture2D::CreateResources(bool gui)
+	{
+		auto* renderer = (Vulkan::Context*)Context::GetRef();
+
+		// image view
+		mView = renderer->GetDevice()->CreateImageView
 		(
-			mWidth,
-			mHeight,
-			mMipLevels,
-			1,
-			gui ? VK_SAMPLE_COUNT_1_BIT : renderpass->GetMSAA(),
-			VK_FORMAT_R8G8B8A8_SRGB,
-			VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			mImage,
-			mMemory
+			mFormat,
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			mMipLevels
 		);
 
-		// transition layout to transfer data
-		renderer->GetDevice()->TransitionImageLayout
+		// sampler
+		mSampler = renderer->GetDevice()->CreateSampler
 		(
-			renderpass->GetCommandPoolRef(),
-			mImage,
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			mMipLevels
+			VK_FILTER_LINEAR,
+			VK_FILTER_LINEAR,
+			VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			VK_SAMPLER_ADDRESS_MODE_REPEAT,
+			(float)mMipLevels
 		);
 
-		// copy buffer to image
+		// a texture loaded asynchronously had the placeholder's descriptor, frames in flight may still use it
+		if (mDescriptorSet != VK_NULL_HANDLE) {
+			((GUI*)GUI::GetRef())->RemoveTexture(mDescriptorSet);
+		}
+
+		mDescriptorSet = (VkDescriptorSet)GUI::GetRef()->AddTexture(mSampler, mView);
+
+		// scene textures are sampled by index from the global descriptor set
+		if (!gui && renderer->GetBindlessRef())
 		{
-			VkCommandBuffer cmdBuffer = renderer->GetDevice()->BeginSingleTimeCommand(renderpass->GetCommandPoolRef());
-
-			VkBufferImageCopy region = {};
-			region.bufferOffset = 0;
-			region.bufferRowLength = 0;
-			region.bufferImageHeight = 0;
-			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			region.imageSubresource.mipLevel = 0;
-			region.imageSubresource.baseArrayLayer = 0;
-			region.imageSubresource.layerCount = 1;
-			region.imageOffset.x = 0;
-			region.imageOffset.y = 0;
-			region.imageOffset.z = 0;
-			region.imageExtent.width = mWidth;
-			region.imageExtent.height = mHeight;
-			region.imageExtent.depth = 1;
-			vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer, mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-			renderer->GetDevice()->EndSingleTimeCommand(renderpass->GetCommandPoolRef(), cmdBuffer);
+			if (mBindlessIndex != UINT32_MAX) {
+				renderer->GetBindlessRef()->UpdateTexture(mBindlessIndex, mView, mSampler);
+			}
+
+			else {
+				mBindlessIndex = renderer->GetBindlessRef()->RegisterTexture(mView, mSampler);
+			}
 		}
 
-		// free staging buffer
-		vkDestroyBuffer(renderer->GetDevice()->GetLogicalDevice(), stagingBuffer, nullptr);
-		vmaFreeMemory(renderer->GetDevice()->GetAllocator(), stagingMemory);
+		// scene textures may have their mips streamed, the levels at or below the fallback size are never released
+		if (!gui && mImage != VK_NULL_HANDLE && renderer->GetResidencyManagerRef())
+		{
+			while (mFallbackLevel + 1 < (uint32_t)mMipLevels && (GetMaxDimension() >> mFallbackLevel) > COSMOS_TEXTURE_FALLBACK_SIZE) {
+				mFallbackLevel++;
+			}
 
-		CreateMipmaps();
+			mStreamable = true;
+			renderer->GetResidencyManagerRef()->Register(this);
+		}
 	}
 
-	void Texture2D::LoadTextureFromBuffer(const BufferInfo& info, bool gui)
+	bool Texture2D::LoadCookedTexture(const KTXFile& file, std::string path, uint32_t level, bool gui)
 	{
-		mWidth = info.width;
-		mHeight = info.height;
+		Context* renderer = (Vulkan::Context*)Context::GetRef();
+		VkFormat format = (VkFormat)file.GetFormat();
 
-		mMipLevels = gui ? 1 : (uint32_t)(std::floor(std::log2(std::max(mWidth, mHeight)))) + 1;
-		VkDeviceSize imgSize = (VkDeviceSize)info.length;
+		// block-compressed formats are optional, the source image is decoded instead when the device can't sample them
+		VkFormatProperties properties = {};
+		vkGetPhysicalDeviceFormatProperties(renderer->GetDevice()->GetPhysicalDevice(), format, &properties);
+
+		if ((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0) {
+			COSMOS_LOG(Logger::Warn, "%s is %s, wich the device can't sample", path.c_str(), KTXFile::GetFormatName(file.GetFormat()));
+			return false;
+		}
+
+		// when streaming, the file must still be the one the texture was loaded from
+		if (!mCookedPath.empty() && (file.GetWidth() != (uint32_t)mWidth || file.GetHeight() != (uint32_t)mHeight || file.GetLevelCount() != (uint32_t)mMipLevels || format != mFormat)) {
+			return false;
+		}
+
+		mWidth = (int32_t)file.GetWidth();
+		mHeight = (int32_t)file.GetHeight();
+		mMipLevels = (int32_t)file.GetLevelCount();
+		mFormat = format;
+		mCookedPath = path;
+		level = std::min(level, (uint32_t)mMipLevels - 1);
+
+		// the levels kept are read in one go, from the first byte of any of them to the last
+		uint64_t begin = UINT64_MAX;
+		uint64_t end = 0;
+
+		for (uint32_t i = level; i < (uint32_t)mMipLevels; i++) {
+			begin = std::min(begin, file.GetLevel(i).offset);
+			end = std::max(end, file.GetLevel(i).offset + file.GetLevel(i).size);
+		}
+
+		std::vector<VkDeviceSize> offsets;
+
+		for (uint32_t i = level; i < (uint32_t)mMipLevels; i++) {
+			offsets.push_back(file.GetLevel(i).offset - begin);
+		}
 
-		// create staging buffer for image
-		VkBuffer stagingBuffer;
-		VmaAllocation stagingMemory;
+		uint32_t width = (uint32_t)std::max(mWidth >> level, 1);
+		uint32_t height = (uint32_t)std::max(mHeight >> level, 1);
+		CreateImage((int32_t)width, (int32_t)height, mMipLevels - (int32_t)level, gui);
+
+		mUploadTicket = renderer->GetDevice()->GetUploaderRef()->UploadImageLevels(mImage, file.GetData() + begin, end - begin, width, height, (uint32_t)offsets.size(), offsets.data());
+
+		return true;
+	}
+
+	void Texture2D::CreateImageFromPixels(const uint8_t* pixels, int32_t width, int32_t height, int32_t mipLevels, bool gui)
+	{
+		VkDeviceSize imgSize = (VkDeviceSize)(width * height * 4); // enforce 4 channels
 		Context* renderer = (Vulkan::Context*)Context::GetRef();
 
-		renderer->GetDevice()->CreateBuffer
-		(
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			imgSize,
-			&stagingBuffer,
-			&stagingMemory
-		);
+		CreateImage(width, height, mipLevels, gui);
 
-		// Copy texture data into staging buffer
-		void* gpuData = nullptr;
-		vmaMapMemory(renderer->GetDevice()->GetAllocator(), stagingMemory, &gpuData);
-		memcpy(gpuData, info.data, (size_t)imgSize);
-		vmaUnmapMemory(renderer->GetDevice()->GetAllocator(), stagingMemory);
+		// copy and mip generation go out with the next upload batch, wich is submitted before any frame could sample the image
+		mUploadTicket = renderer->GetDevice()->GetUploaderRef()->UploadImage(mImage, pixels, imgSize, (uint32_t)width, (uint32_t)height, (uint32_t)mipLevels);
+	}
 
+	void Texture2D::CreateImage(int32_t width, int32_t height, int32_t mipLevels, bool gui)
+	{
+		Context* renderer = (Vulkan::Context*)Context::GetRef();
 		auto& renderpass = renderer->GetMainRenderpassRef();
 
 		// create image resource
 		renderer->GetDevice()->CreateImage
 		(
-			mWidth,
-			mHeight,
-			mMipLevels,
+			width,
+			height,
+			mipLevels,
 			1,
-			gui ? VK_SAMPLE_COUNT_1_BIT : renderpass->GetMSAA(),
-			VK_FORMAT_R8G8B8A8_SRGB,
+			(gui || mFormat != VK_FORMAT_R8G8B8A8_SRGB) ? VK_SAMPLE_COUNT_1_BIT : renderpass->GetMSAA(), // block-compressed formats are never multisampled
+			mFormat,
 			VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			mImage,
 			mMemory
 		);
-
-		// transition layout to transfer data
-		renderer->GetDevice()->TransitionImageLayout
-		(
-			renderpass->GetCommandPoolRef(),
-			mImage,
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			mMipLevels
-		);
-
-		// copy buffer to image
-		{
-			VkCommandBuffer cmdBuffer = renderer->GetDevice()->BeginSingleTimeCommand(renderpass->GetCommandPoolRef());
-
-			VkBufferImageCopy region = {};
-			region.bufferOffset = 0;
-			region.bufferRowLength = 0;
-			region.bufferImageHeight = 0;
-			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			region.imageSubresource.mipLevel = 0;
-			region.imageSubresource.baseArrayLayer = 0;
-			region.imageSubresource.layerCount = 1;
-			region.imageOffset.x = 0;
-			region.imageOffset.y = 0;
-			region.imageOffset.z = 0;
-			region.imageExtent.width = mWidth;
-			region.imageExtent.height = mHeight;
-			region.imageExtent.depth = 1;
-			vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer, mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-			renderer->GetDevice()->EndSingleTimeCommand(renderpass->GetCommandPoolRef(), cmdBuffer);
-		}
-
-		// free staging buffer
-		vkDestroyBuffer(renderer->GetDevice()->GetLogicalDevice(), stagingBuffer, nullptr);
-		vmaFreeMemory(renderer->GetDevice()->GetAllocator(), stagingMemory);
-
-		CreateMipmaps();
 	}
 
-	void Texture2D::CreateMipmaps()
+	void Texture2D::LoadTextureFromBuffer(const BufferInfo& info, bool gui)
 	{
-		Context* renderer = (Vulkan::Context*)Context::GetRef();
-		auto& renderpass = renderer->GetMainRenderpassRef();
-
-		VkCommandBuffer commandBuffer = renderer->GetDevice()->BeginSingleTimeCommand(renderpass->GetCommandPoolRef());
-
-		VkImageMemoryBarrier barrier = {};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.image = mImage;
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
-		barrier.subresourceRange.levelCount = 1;
-
-		int32_t mipWidth = mWidth;
-		int32_t mipHeight = mHeight;
-
-		for (int32_t i = 1; i < mMipLevels; i++)
-		{
-			barrier.subresourceRange.baseMipLevel = i - 1;
-			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-			VkImageBlit blit = {};
-			blit.srcOffsets[0] = { 0, 0, 0 };
-			blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
-			blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			blit.srcSubresource.mipLevel = i - 1;
-			blit.srcSubresource.baseArrayLayer = 0;
-			blit.srcSubresource.layerCount = 1;
-			blit.dstOffsets[0] = { 0, 0, 0 };
-			blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
-			blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			blit.dstSubresource.mipLevel = i;
-			blit.dstSubresource.baseArrayLayer = 0;
-			blit.dstSubresource.layerCount = 1;
-			vkCmdBlitImage(commandBuffer, mImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
-
-			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-			if (mipWidth > 1) mipWidth /= 2;
-			if (mipHeight > 1) mipHeight /= 2;
-		}
-
-		barrier.subresourceRange.baseMipLevel = mMipLevels - 1;
-		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		mWidth = info.width;
+		mHeight = info.height;
 
-		renderer->GetDevice()->EndSingleTimeCommand(renderpass->GetCommandPoolRef(), commandBuffer);
+		mMipLevels = gui ? 1 : (uint32_t)(std::floor(std::log2(std::max(mWidth, mHeight)))) + 1;
+		CreateImageFromPixels(info.data, mWidth, mHeight, mMipLevels, gui);
 	}
 
 	TextureCubemap::TextureCubemap(std::vector<std::string> paths)
@@ -390,12 +523,12 @@ namespace Cosmos::Renderer::Vulkan
 	TextureCubemap::~TextureCubemap()
 	{
 		auto* renderer = (Vulkan::Context*)Context::GetRef();
-		vkDeviceWaitIdle(renderer->GetDevice()->GetLogicalDevice());
+		renderer->GetDevice()->GetUploaderRef()->Wait(mUploadTicket);
 
-		vkDestroyImageView(renderer->GetDevice()->GetLogicalDevice(), mView, nullptr);
-		vkDestroyImage(renderer->GetDevice()->GetLogicalDevice(), mImage, nullptr);
-		vmaFreeMemory(renderer->GetDevice()->GetAllocator(), mMemory);
-		vkDestroySampler(renderer->GetDevice()->GetLogicalDevice(), mSampler, nullptr);
+		auto& deletionQueue = renderer->GetDeletionQueueRef();
+		deletionQueue->ReleaseImageView(mView);
+		deletionQueue->ReleaseImage(mImage, mMemory);
+		deletionQueue->ReleaseSampler(mSampler);
 	}
 
 	void* TextureCubemap::GetView()
@@ -418,16 +551,11 @@ namespace Cosmos::Renderer::Vulkan
 		auto* renderer = (Vulkan::Context*)Context::GetRef();
 		COSMOS_ASSERT(mPaths.size() == 6, "A cubemap must have 6 textures");
 
-		VkBuffer stagingBuffer = VK_NULL_HANDLE;
-		VmaAllocation stagingBufferMemory = VK_NULL_HANDLE;
-
-		VkDeviceSize layerSize;
-		VkDeviceSize imageSize;
+		// layers are packed one after the other, as the copy expects them
+		std::vector<uint8_t> layers;
+		VkDeviceSize layerSize = 0;
 		int32_t channels;
 
-		void* gpuData;
-		uint64_t memAddress;
-
 		for (uint8_t i = 0; i < mPaths.size(); i++)
 		{
 			stbi_uc* pixels = stbi_load(mPaths[i].c_str(), &mWidth, &mHeight, &channels, STBI_rgb_alpha);
@@ -442,29 +570,11 @@ namespace Cosmos::Renderer::Vulkan
 			{
 				// this 4 should be mChannels, however RGBA is widely supported on GPU as RGB-only is not
 				layerSize = mWidth * mHeight * 4;
-				imageSize = layerSize * mPaths.size();
-
-				renderer->GetDevice()->CreateBuffer
-				(
-					VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-					imageSize,
-					&stagingBuffer,
-					&stagingBufferMemory
-				);
-
-				vmaMapMemory(renderer->GetDevice()->GetAllocator(), stagingBufferMemory, &gpuData);
-				memAddress = reinterpret_cast<uint64_t>(gpuData);
+				layers.resize((size_t)(layerSize * mPaths.size()));
 			}
 
-			memcpy(reinterpret_cast<uint8_t*>(memAddress), static_cast<void*>(pixels), static_cast<size_t>(layerSize));
+			memcpy(layers.data() + layerSize * i, static_cast<void*>(pixels), static_cast<size_t>(layerSize));
 			stbi_image_free(pixels);
-			memAddress += layerSize;
-
-			if (i == 5)
-			{
-				vmaUnmapMemory(renderer->GetDevice()->GetAllocator(), stagingBufferMemory);
-			}
 		}
 
 		auto& renderpass = renderer->GetMainRenderpassRef();
@@ -479,61 +589,14 @@ namespace Cosmos::Renderer::Vulkan
 			renderpass->GetMSAA(),
 			VK_FORMAT_R8G8B8A8_SRGB,
 			VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			mImage,
 			mMemory,
 			VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
 		);
 
-		// transition layout to transfer data
-		renderer->GetDevice()->TransitionImageLayout
-		(
-			renderpass->GetCommandPoolRef(),
-			mImage,
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			mMipLevels,
-			(uint32_t)mPaths.size()
-		);
-
-		// copy buffer to image
-		{
-			VkCommandBuffer cmdBuffer = renderer->GetDevice()->BeginSingleTimeCommand(renderpass->GetCommandPoolRef());
-
-			VkBufferImageCopy region = {};
-			region.bufferOffset = 0;
-			region.bufferRowLength = 0;
-			region.bufferImageHeight = 0;
-			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			region.imageSubresource.mipLevel = 0;
-			region.imageSubresource.baseArrayLayer = 0;
-			region.imageSubresource.layerCount = 6;
-			region.imageOffset.x = 0;
-			region.imageOffset.y = 0;
-			region.imageOffset.z = 0;
-			region.imageExtent.width = mWidth;
-			region.imageExtent.height = mHeight;
-			region.imageExtent.depth = 1;
-			vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer, mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-			renderer->GetDevice()->EndSingleTimeCommand(renderpass->GetCommandPoolRef(), cmdBuffer);
-		}
-
-		// transition layout to shader read only
-		renderer->GetDevice()->TransitionImageLayout
-		(
-			renderpass->GetCommandPoolRef(),
-			mImage,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			mMipLevels,
-			(uint32_t)mPaths.size()
-		);
-
-		// free staging buffer
-		vkDestroyBuffer(renderer->GetDevice()->GetLogicalDevice(), stagingBuffer, nullptr);
-		vmaFreeMemory(renderer->GetDevice()->GetAllocator(), stagingBufferMemory);
+		mUploadTicket = renderer->GetDevice()->GetUploaderRef()->UploadImage(mImage, layers.data(), (VkDeviceSize)layers.size(), (uint32_t)mWidth, (uint32_t)mHeight, (uint32_t)mMipLevels, (uint32_t)mPaths.size());
 	}
 }
 #endif
\ No newline at end of file
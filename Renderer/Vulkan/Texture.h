@@ -3,15 +3,35 @@
 #include "Wrapper/vulkan.h"
 
 #include "Core/ITexture.h"
+#include "Core/ResidencyPolicy.h"
+#include <algorithm>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer { class KTXFile; }
 
 namespace Cosmos::Renderer::Vulkan
 {
-	class Texture2D : public ITexture2D
+	class Texture2D : public ITexture2D, public IStreamable
 	{
 	public:
 
-		// constructor
-		Texture2D(std::string path, bool gui = false);
+		// what's read from disk before any gpu resource exists, it may be read on any thread
+		struct Decoded
+		{
+			std::string cookedPath = {};						// empty when the source image was decoded
+			Shared<KTXFile> cooked = {};
+			std::vector<uint8_t> pixels = {};					// rgba pixels of the source image, at the mip level below
+			int32_t width = 0;									// full resolution, even when the pixels are of a smaller level
+			int32_t height = 0;
+			uint32_t level = 0;
+			double time = 0.0;									// spent reading and decoding, in milliseconds
+		};
+
+	public:
+
+		// constructor, an async texture is decoded on the worker threads and shows a placeholder until it's uploaded
+		Texture2D(std::string path, bool gui = false, bool async = false);
 
 		// constructor
 		Texture2D(const BufferInfo& info, bool gui = false);
@@ -30,6 +50,52 @@ namespace Cosmos::Renderer::Vulkan
 		// returns an user-interface descriptor set of the image, used to display the texture on the ui
 		virtual void* GetUIDescriptor() override;
 
+	public:
+
+		// returns if the texture is still being decoded, the placeholder is shown meanwhile
+		inline bool IsPending() const { return mPending; }
+
+		// returns if the texture mip levels may be streamed in and out by the residency manager
+		inline bool IsStreamable() const { return mStreamable; }
+
+		// returns the largest dimension of the full resolution texture
+		virtual uint32_t GetMaxDimension() const override { return (uint32_t)std::max(mWidth, mHeight); }
+
+		// returns the most detailed mip level currently on the gpu, 0 is the full resolution
+		virtual uint32_t GetResidentLevel() const override { return mResidentLevel; }
+
+		// returns the least detailed mip level the texture may drop to, it's always kept resident
+		virtual uint32_t GetFallbackLevel() const override { return mFallbackLevel; }
+
+		// returns if a mip level was requested and isn't swapped in yet, the current one keeps being sampled meanwhile
+		virtual bool IsStreaming() const override { return mStreaming; }
+
+		// returns a number that changes every time the image view is recreated, descriptors using the view must be rewritten
+		inline uint64_t GetViewVersion() const { return mViewVersion; }
+
+		// returns the texture index on the global descriptor set, user-interface textures are not on it
+		inline uint32_t GetBindlessIndex() const { return mBindlessIndex; }
+
+		// returns how many bytes the gpu image uses when the given level is the most detailed one resident
+		virtual VkDeviceSize GetResidentBytes(uint32_t level) const override;
+
+		// queues the recreation of the gpu image starting at the given mip level, the image is read again from disk on the worker threads
+		virtual bool StreamToLevel(uint32_t level) override;
+
+		// creates the gpu resources of a texture decoded on the worker threads, replacing the placeholder
+		void FinishLoading(Decoded& decoded);
+
+		// creates the image of the level being streamed out of what the worker threads decoded, null if they couldn't
+		// it's swapped in once it's upload retires, returns false if there's nothing to wait for
+		bool FinishStreaming(Decoded* decoded);
+
+		// swaps in the image of the level being streamed, returns false while it's upload hasn't retired
+		bool SwapStreamed();
+
+		// reads a texture from disk, the cooked one when it's up to date unless cooked is false, returns false if nothing could be read
+		// source images are downsampled on the spot to the given mip level, cooked ones have every level already
+		static bool Decode(std::string path, Decoded& decoded, bool cooked = true, uint32_t level = 0);
+
 	private:
 
 		// loads the texture based on constructor's path
@@ -38,19 +104,48 @@ namespace Cosmos::Renderer::Vulkan
 		// loads the texture by a buffer data
 		void LoadTextureFromBuffer(const BufferInfo& info, bool gui);
 
-		// creates mipmaps for the current bound texture
-		void CreateMipmaps();
+		// creates the gpu image out of a decoded texture, returns false if nothing could be loaded
+		bool CreateFromDecoded(Decoded& decoded, bool gui);
+
+		// creates the view and sampler and hands them to the ui, the global descriptor set and the residency manager
+		void CreateResources(bool gui);
+
+		// loads a cooked texture starting at the given mip level, returns false if it's not one the engine can load
+		bool LoadCookedTexture(const KTXFile& file, std::string path, uint32_t level, bool gui);
+
+		// creates the gpu image out of rgba pixels, it's upload and mipmaps are recorded into the next upload batch
+		void CreateImageFromPixels(const uint8_t* pixels, int32_t width, int32_t height, int32_t mipLevels, bool gui);
+
+		// creates the gpu image, it's content is undefined until uploaded
+		void CreateImage(int32_t width, int32_t height, int32_t mipLevels, bool gui);
 
 	private:
 
 		int32_t mWidth = 0;
 		int32_t mHeight = 0;
 		int32_t mMipLevels = 1;
+		VkFormat mFormat = VK_FORMAT_R8G8B8A8_SRGB;
 		VkImage mImage = VK_NULL_HANDLE;
 		VmaAllocation mMemory = VK_NULL_HANDLE;
+		uint64_t mUploadTicket = 0;
 		VkImageView mView = VK_NULL_HANDLE;
 		VkSampler mSampler = VK_NULL_HANDLE;
 		VkDescriptorSet mDescriptorSet = VK_NULL_HANDLE;
+		std::string mCookedPath = {};
+		bool mGUI = false;
+		bool mPending = false;
+
+		bool mStreamable = false;
+		uint32_t mResidentLevel = 0;
+		uint32_t mFallbackLevel = 0;
+		uint64_t mViewVersion = 0;
+		uint32_t mBindlessIndex = UINT32_MAX;
+
+		bool mStreaming = false;
+		uint32_t mStreamLevel = 0;
+		VkImage mStreamImage = VK_NULL_HANDLE;
+		VmaAllocation mStreamMemory = VK_NULL_HANDLE;
+		uint64_t mStreamTicket = 0;
 	};
 
 	class TextureCubemap : public ITextureCubemap
@@ -86,6 +181,7 @@ namespace Cosmos::Renderer::Vulkan
 		int32_t mMipLevels = 1;
 		VkImage mImage = VK_NULL_HANDLE;
 		VmaAllocation mMemory = VK_NULL_HANDLE;
+		uint64_t mUploadTicket = 0;
 		VkImageView mView = VK_NULL_HANDLE;
 		VkSampler mSampler = VK_NULL_HANDLE;
 
@@ -0,0 +1,140 @@
+#if defined RENDERER_VULKAN
+#include "TextureLoader.h"
+
+#include <Common/Debug/Logger.h>
+#include <Common/Util/ThreadPool.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	TextureLoader::TextureLoader(uint32_t maxDecoding)
+	{
+		// the pool keeps workers free for the frame across every background user, this only bounds what's handed over so cancels stay cheap
+		mMaxDecoding = maxDecoding > 0 ? maxDecoding : ThreadPool::GetRef().GetBackgroundLimit();
+	}
+
+	Texture2D* TextureLoader::GetPlaceholder()
+	{
+		if (!mPlaceholder)
+		{
+			uint8_t pixel[4] = { 128, 128, 128, 255 };
+
+			ITexture2D::BufferInfo info = {};
+			info.data = pixel;
+			info.width = 1;
+			info.height = 1;
+			info.length = sizeof(pixel);
+
+			mPlaceholder = CreateShared<Texture2D>(info, true);
+		}
+
+		return mPlaceholder.get();
+	}
+
+	void TextureLoader::Load(Texture2D* texture)
+	{
+		Request request = {};
+		request.texture = texture;
+		request.path = texture->GetPathRef();
+
+		mQueued.push_back(std::move(request));
+		Dispatch();
+	}
+
+	void TextureLoader::Stream(Texture2D* texture, uint32_t level, bool cooked)
+	{
+		Request request = {};
+		request.texture = texture;
+		request.path = texture->GetPathRef();
+		request.level = level;
+		request.cooked = cooked;
+		request.streaming = true;
+
+		mQueued.push_back(std::move(request));
+		Dispatch();
+	}
+
+	void TextureLoader::Cancel(Texture2D* texture)
+	{
+		auto matches = [texture](const Request& request) { return request.texture == texture; };
+
+		mQueued.erase(std::remove_if(mQueued.begin(), mQueued.end(), matches), mQueued.end());
+		mDecoding.erase(std::remove_if(mDecoding.begin(), mDecoding.end(), matches), mDecoding.end());
+		mSwapping.erase(std::remove(mSwapping.begin(), mSwapping.end(), texture), mSwapping.end());
+
+		mStatistics.queued = (uint32_t)mQueued.size();
+		mStatistics.decoding = (uint32_t)mDecoding.size();
+		mStatistics.swapping = (uint32_t)mSwapping.size();
+	}
+
+	void TextureLoader::OnUpdate()
+	{
+		mSwapping.erase(std::remove_if(mSwapping.begin(), mSwapping.end(), [](Texture2D* texture) { return texture->SwapStreamed(); }), mSwapping.end());
+
+		for (size_t i = 0; i < mDecoding.size(); )
+		{
+			if (mDecoding[i].decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				i++;
+				continue;
+			}
+
+			Request request = std::move(mDecoding[i]);
+			mDecoding.erase(mDecoding.begin() + i);
+
+			Shared<Texture2D::Decoded> decoded = request.decoded.get();
+
+			// the texture keeps it's resident level until the new one is uploaded, or for good if it couldn't be read
+			if (request.streaming)
+			{
+				if (request.texture->FinishStreaming(decoded.get())) {
+					mSwapping.push_back(request.texture);
+				}
+
+				mStatistics.decodeTime += decoded ? decoded->time : 0.0;
+				continue;
+			}
+
+			// the texture keeps showing the placeholder
+			if (!decoded) {
+				COSMOS_LOG(Logger::Error, "Failed to load %s texture", request.path.c_str());
+				mStatistics.failed++;
+				continue;
+			}
+
+			request.texture->FinishLoading(*decoded);
+			mStatistics.decodeTime += decoded->time;
+			mStatistics.loaded++;
+		}
+
+		Dispatch();
+		mStatistics.swapping = (uint32_t)mSwapping.size();
+	}
+
+	void TextureLoader::Dispatch()
+	{
+		while (!mQueued.empty() && mDecoding.size() < mMaxDecoding)
+		{
+			Request request = std::move(mQueued.front());
+			mQueued.pop_front();
+
+			// the task owns what it decodes, a texture destroyed meanwhile doesn't invalidate it
+			std::string path = request.path;
+			uint32_t level = request.level;
+			bool cooked = request.cooked;
+			request.decoded = ThreadPool::GetRef().EnqueueBackground([path, level, cooked]() -> Shared<Texture2D::Decoded>
+				{
+					Shared<Texture2D::Decoded> decoded = CreateShared<Texture2D::Decoded>();
+					return Texture2D::Decode(path, *decoded, cooked, level) ? decoded : nullptr;
+				});
+
+			mDecoding.push_back(std::move(request));
+		}
+
+		mStatistics.queued = (uint32_t)mQueued.size();
+		mStatistics.decoding = (uint32_t)mDecoding.size();
+	}
+}
+
+#endif
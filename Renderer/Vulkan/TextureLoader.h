@@ -0,0 +1,89 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Texture.h"
+#include <Common/Util/Memory.h>
+#include <deque>
+#include <future>
+#include <vector>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// decodes textures on the worker threads, their gpu resources are created on the main thread once decoded
+	// streamed mip levels go the same way, their images are swapped in once the upload retires instead of waiting for it
+	class TextureLoader
+	{
+	public:
+
+		struct Statistics
+		{
+			uint32_t queued = 0;								// waiting for a worker
+			uint32_t decoding = 0;								// being decoded by the workers
+			uint32_t loaded = 0;								// finished since startup
+			uint32_t failed = 0;								// couldn't be read since startup
+			uint32_t swapping = 0;								// streamed levels waiting for their upload
+			double decodeTime = 0.0;							// spent by the workers since startup, in milliseconds
+		};
+
+	public:
+
+		// constructor, zero decodes at once means the pool background limit, wich every background user shares
+		TextureLoader(uint32_t maxDecoding = 0);
+
+		// destructor
+		~TextureLoader() = default;
+
+		// delete copy constructor
+		TextureLoader(const TextureLoader&) = delete;
+
+		// delete assignment constructor
+		TextureLoader& operator=(const TextureLoader&) = delete;
+
+		// returns a reference to the statistics
+		inline Statistics& GetStatisticsRef() { return mStatistics; }
+
+	public:
+
+		// returns the texture shown while others are pending, it's created the first time it's requested
+		Texture2D* GetPlaceholder();
+
+		// queues a pending texture to be decoded from it's path
+		void Load(Texture2D* texture);
+
+		// queues the decode of a mip level of a loaded texture, cooked tells if it's read from the cooked file or the source image
+		void Stream(Texture2D* texture, uint32_t level, bool cooked);
+
+		// forgets a pending or streaming texture, a decode already running is discarded when done
+		void Cancel(Texture2D* texture);
+
+		// finishes the textures whose decode is done, swaps in streamed levels whose upload retired and hands queued ones to the workers
+		// must be called once per frame before recording
+		void OnUpdate();
+
+	private:
+
+		struct Request
+		{
+			Texture2D* texture = nullptr;
+			std::string path = {};
+			uint32_t level = 0;
+			bool cooked = true;
+			bool streaming = false;
+			std::future<Shared<Texture2D::Decoded>> decoded = {};
+		};
+
+		// hands queued requests to the workers up to the limit
+		void Dispatch();
+
+	private:
+
+		uint32_t mMaxDecoding = 1;
+		std::deque<Request> mQueued = {};
+		std::vector<Request> mDecoding = {};
+		std::vector<Texture2D*> mSwapping = {};
+		Shared<Texture2D> mPlaceholder = {};
+		Statistics mStatistics = {};
+	};
+}
+
+#endif
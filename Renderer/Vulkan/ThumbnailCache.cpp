@@ -0,0 +1,324 @@
+#if defined RENDERER_VULKAN
+#include "ThumbnailCache.h"
+
+#include "Context.h"
+#include "Core/ThumbnailGenerator.h"
+#include "DeletionQueue.h"
+#include "Device.h"
+#include "GUI.h"
+#include "Uploader.h"
+
+#include <Common/Debug/Logger.h>
+#include <Common/Util/ThreadPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// disk cache file layout: header, key and size * size rgba pixels
+	struct ThumbnailHeader
+	{
+		char magic[4] = { 'C', 'T', 'H', 'B' };
+		uint32_t size = 0;
+		uint32_t keyLength = 0;
+	};
+
+	ThumbnailCache::ThumbnailCache(Shared<Device> device, std::string directory, uint32_t size, uint32_t atlasSize)
+		: mDevice(device), mDirectory(directory), mSize(size), mAtlasSize(atlasSize)
+	{
+		mTilesPerRow = mAtlasSize / mSize;
+		mTiles.resize((size_t)mTilesPerRow * mTilesPerRow, UINT32_MAX);
+
+		for (uint32_t i = (uint32_t)mTiles.size(); i-- > 0; ) {
+			mFreeTiles.push_back(i);
+		}
+
+		// the pool budget is shared with texture decodes, this only bounds what's handed over at once
+		mMaxLoading = ThreadPool::GetRef().GetBackgroundLimit();
+
+		std::error_code error;
+		std::filesystem::create_directories(mDirectory, error);
+
+		if (error) {
+			COSMOS_LOG(Logger::Warn, "Failed to create the thumbnail cache %s, thumbnails will be generated every time: %s", mDirectory.c_str(), error.message().c_str());
+		}
+
+		mDevice->CreateImage
+		(
+			mAtlasSize,
+			mAtlasSize,
+			1,
+			1,
+			VK_SAMPLE_COUNT_1_BIT,
+			VK_FORMAT_R8G8B8A8_SRGB,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			mImage,
+			mMemory
+		);
+
+		// the atlas starts transparent, tiles are written as thumbnails arrive
+		std::vector<uint8_t> clear((size_t)mAtlasSize * mAtlasSize * 4, 0);
+		VkDeviceSize offset = 0;
+		mUploadTicket = mDevice->GetUploaderRef()->UploadImageLevels(mImage, clear.data(), (VkDeviceSize)clear.size(), mAtlasSize, mAtlasSize, 1, &offset);
+
+		mView = mDevice->CreateImageView(mImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+		mSampler = mDevice->CreateSampler(VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+		mDescriptorSet = (VkDescriptorSet)GUI::GetRef()->AddTexture(mSampler, mView);
+	}
+
+	ThumbnailCache::~ThumbnailCache()
+	{
+		auto* renderer = (Vulkan::Context*)Context::GetRef();
+
+		// loads still running own what they write, their results are just dropped
+		mDevice->GetUploaderRef()->Wait(mUploadTicket);
+		((GUI*)GUI::GetRef())->RemoveTexture(mDescriptorSet);
+
+		auto& deletionQueue = renderer->GetDeletionQueueRef();
+		deletionQueue->ReleaseImageView(mView);
+		deletionQueue->ReleaseImage(mImage, mMemory);
+		deletionQueue->ReleaseSampler(mSampler);
+	}
+
+	uint32_t ThumbnailCache::Request(std::string path)
+	{
+		if (!ThumbnailGenerator::IsSupported(path)) {
+			return UINT32_MAX;
+		}
+
+		std::error_code error;
+		auto time = std::filesystem::last_write_time(path, error);
+		uintmax_t bytes = error ? 0 : std::filesystem::file_size(path, error);
+
+		if (error) {
+			return UINT32_MAX;
+		}
+
+		// a file that changed gets a new entry, the old thumbnail is evicted once it's no longer drawn
+		std::string key = path + "|" + std::to_string((long long)time.time_since_epoch().count()) + "|" + std::to_string((unsigned long long)bytes);
+		auto it = mHandles.find(key);
+
+		if (it != mHandles.end()) {
+			return it->second;
+		}
+
+		uint32_t handle = (uint32_t)mEntries.size();
+
+		Entry entry = {};
+		entry.path = path;
+		entry.key = key;
+		entry.lastUsed = mFrame;
+		mEntries.push_back(entry);
+		mHandles[key] = handle;
+
+		Enqueue(handle);
+		return handle;
+	}
+
+	bool ThumbnailCache::GetRegion(uint32_t handle, Region& region)
+	{
+		if (handle >= (uint32_t)mEntries.size()) {
+			return false;
+		}
+
+		Entry& entry = mEntries[handle];
+		entry.lastUsed = mFrame;
+
+		// evicted thumbnails are read back from the disk cache
+		if (entry.tile == UINT32_MAX) {
+			if (!entry.requested) {
+				Enqueue(handle);
+			}
+
+			return false;
+		}
+
+		// half a texel in, linear filtering doesn't reach the neighbour tiles
+		float texel = 1.0f / (float)mAtlasSize;
+		float x = (float)(entry.tile % mTilesPerRow * mSize);
+		float y = (float)(entry.tile / mTilesPerRow * mSize);
+
+		region.u0 = (x + 0.5f) * texel;
+		region.v0 = (y + 0.5f) * texel;
+		region.u1 = (x + (float)mSize - 0.5f) * texel;
+		region.v1 = (y + (float)mSize - 0.5f) * texel;
+		return true;
+	}
+
+	void ThumbnailCache::OnUpdate()
+	{
+		mFrame++;
+
+		for (size_t i = 0; i < mLoading.size(); )
+		{
+			if (mLoading[i].result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				i++;
+				continue;
+			}
+
+			uint32_t handle = mLoading[i].handle;
+			Shared<Result> result = mLoading[i].result.get();
+			mLoading.erase(mLoading.begin() + i);
+
+			// it stays requested, so it's not tried again every frame
+			if (!result) {
+				COSMOS_LOG(Logger::Warn, "Failed to create the thumbnail of %s", mEntries[handle].path.c_str());
+				continue;
+			}
+
+			mDone.push_back({ handle, result });
+		}
+
+		// every thumbnail done this frame goes into it's tile with a single upload
+		std::vector<uint8_t> data;
+		std::vector<VkBufferImageCopy> regions;
+		uint32_t fromDisk = 0;
+		size_t placed = 0;
+
+		for (; placed < mDone.size(); placed++)
+		{
+			uint32_t tile = AllocateTile();
+
+			if (tile == UINT32_MAX) {
+				break;
+			}
+
+			uint32_t handle = mDone[placed].first;
+			Result& result = *mDone[placed].second;
+
+			mEntries[handle].tile = tile;
+			mEntries[handle].requested = false;
+			mTiles[tile] = handle;
+
+			VkBufferImageCopy region = {};
+			region.bufferOffset = (VkDeviceSize)data.size();
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = 0;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = { (int32_t)(tile % mTilesPerRow * mSize), (int32_t)(tile / mTilesPerRow * mSize), 0 };
+			region.imageExtent = { mSize, mSize, 1 };
+			regions.push_back(region);
+
+			data.insert(data.end(), result.pixels.begin(), result.pixels.end());
+			fromDisk += result.fromDisk ? 1 : 0;
+		}
+
+		mDone.erase(mDone.begin(), mDone.begin() + placed);
+
+		if (!regions.empty()) {
+			mUploadTicket = mDevice->GetUploaderRef()->UploadImageRegions(mImage, data.data(), (VkDeviceSize)data.size(), regions.data(), (uint32_t)regions.size());
+			COSMOS_LOG(Logger::Trace, "Uploaded %zu thumbnail(s), %u read from the disk cache", regions.size(), fromDisk);
+		}
+
+		Dispatch();
+	}
+
+	void ThumbnailCache::Enqueue(uint32_t handle)
+	{
+		mEntries[handle].requested = true;
+		mQueued.push_back(handle);
+		Dispatch();
+	}
+
+	void ThumbnailCache::Dispatch()
+	{
+		while (!mQueued.empty() && mLoading.size() < mMaxLoading)
+		{
+			uint32_t handle = mQueued.front();
+			mQueued.pop_front();
+
+			// the file is named after the key hash, the key itself is stored in it to tell collisions apart
+			char name[32];
+			snprintf(name, sizeof(name), "%016llx.thumb", (unsigned long long)std::hash<std::string>{}(mEntries[handle].key));
+
+			std::string path = mEntries[handle].path;
+			std::string key = mEntries[handle].key;
+			std::string file = mDirectory + "/" + name;
+			uint32_t size = mSize;
+
+			Loading loading = {};
+			loading.handle = handle;
+			loading.result = ThreadPool::GetRef().EnqueueBackground([path, key, file, size]() { return Load(path, key, file, size); });
+			mLoading.push_back(std::move(loading));
+		}
+	}
+
+	uint32_t ThumbnailCache::AllocateTile()
+	{
+		if (!mFreeTiles.empty()) {
+			uint32_t tile = mFreeTiles.back();
+			mFreeTiles.pop_back();
+			return tile;
+		}
+
+		// thumbnails drawn on this or the last frame are kept, a frame may still be recording them
+		uint32_t victim = UINT32_MAX;
+
+		for (uint32_t tile = 0; tile < (uint32_t)mTiles.size(); tile++)
+		{
+			const Entry& entry = mEntries[mTiles[tile]];
+
+			if (entry.lastUsed + 1 < mFrame && (victim == UINT32_MAX || entry.lastUsed < mEntries[mTiles[victim]].lastUsed)) {
+				victim = tile;
+			}
+		}
+
+		if (victim != UINT32_MAX) {
+			mEntries[mTiles[victim]].tile = UINT32_MAX;
+			mTiles[victim] = UINT32_MAX;
+		}
+
+		return victim;
+	}
+
+	Shared<ThumbnailCache::Result> ThumbnailCache::Load(std::string path, std::string key, std::string file, uint32_t size)
+	{
+		Shared<Result> result = CreateShared<Result>();
+		size_t bytes = (size_t)size * size * 4;
+
+		std::ifstream in(file, std::ios::binary);
+
+		if (in.is_open())
+		{
+			ThumbnailHeader header = {};
+			in.read((char*)&header, sizeof(header));
+
+			if (in.good() && memcmp(header.magic, ThumbnailHeader().magic, sizeof(header.magic)) == 0 && header.size == size && header.keyLength == (uint32_t)key.size())
+			{
+				std::string stored(header.keyLength, '\0');
+				in.read(stored.data(), (std::streamsize)stored.size());
+				result->pixels.resize(bytes);
+				in.read((char*)result->pixels.data(), (std::streamsize)bytes);
+
+				if (in.good() && stored == key) {
+					result->fromDisk = true;
+					return result;
+				}
+			}
+		}
+
+		if (!ThumbnailGenerator::Generate(path, size, result->pixels)) {
+			return nullptr;
+		}
+
+		ThumbnailHeader header = {};
+		header.size = size;
+		header.keyLength = (uint32_t)key.size();
+
+		std::ofstream out(file, std::ios::binary | std::ios::trunc);
+		out.write((const char*)&header, sizeof(header));
+		out.write(key.data(), (std::streamsize)key.size());
+		out.write((const char*)result->pixels.data(), (std::streamsize)bytes);
+
+		return result;
+	}
+}
+
+#endif
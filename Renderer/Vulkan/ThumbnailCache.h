@@ -0,0 +1,121 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Wrapper/vulkan.h"
+#include <Common/Util/Memory.h>
+#include <deque>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer::Vulkan { class Device; }
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// small previews of image and mesh files packed into a single atlas, generated on the worker threads
+	// thumbnails are also kept on disk keyed by the file path, modification time and size, so they're only generated again when the file changes
+	class ThumbnailCache
+	{
+	public:
+
+		struct Region
+		{
+			float u0 = 0.0f;
+			float v0 = 0.0f;
+			float u1 = 0.0f;
+			float v1 = 0.0f;
+		};
+
+	public:
+
+		// constructor, the atlas is atlasSize x atlasSize texels split into size x size tiles
+		ThumbnailCache(Shared<Device> device, std::string directory, uint32_t size = 64, uint32_t atlasSize = 2048);
+
+		// destructor
+		~ThumbnailCache();
+
+		// delete copy constructor
+		ThumbnailCache(const ThumbnailCache&) = delete;
+
+		// delete assignment constructor
+		ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+		// returns the user-interface descriptor set of the atlas
+		inline VkDescriptorSet GetUIDescriptor() const { return mDescriptorSet; }
+
+	public:
+
+		// returns the handle of a file's thumbnail, generating it on the workers or reading it from disk if it's not on the atlas, UINT32_MAX if the file has none
+		uint32_t Request(std::string path);
+
+		// returns if the thumbnail is on the atlas, writing where, it's kept there as long as it's asked for every frame
+		bool GetRegion(uint32_t handle, Region& region);
+
+		// uploads the thumbnails done by the workers and hands queued ones to them, must be called once per frame before the ui is drawn
+		void OnUpdate();
+
+	private:
+
+		struct Entry
+		{
+			std::string path = {};
+			std::string key = {};								// path, modification time and size
+			uint32_t tile = UINT32_MAX;
+			uint64_t lastUsed = 0;
+			bool requested = false;
+		};
+
+		struct Result
+		{
+			std::vector<uint8_t> pixels = {};
+			bool fromDisk = false;
+		};
+
+		struct Loading
+		{
+			uint32_t handle = UINT32_MAX;
+			std::future<Shared<Result>> result = {};
+		};
+
+		// queues an entry to be read or generated
+		void Enqueue(uint32_t handle);
+
+		// hands queued entries to the workers up to the limit
+		void Dispatch();
+
+		// returns a free tile, evicting the least recently used thumbnail not drawn on the last frames, UINT32_MAX if there's none
+		uint32_t AllocateTile();
+
+		// reads or generates a thumbnail, it runs on the workers
+		static Shared<Result> Load(std::string path, std::string key, std::string file, uint32_t size);
+
+	private:
+
+		Shared<Device> mDevice;
+		std::string mDirectory = {};
+		uint32_t mSize = 64;
+		uint32_t mAtlasSize = 2048;
+		uint32_t mTilesPerRow = 32;
+		uint32_t mMaxLoading = 1;
+		uint64_t mFrame = 0;
+
+		VkImage mImage = VK_NULL_HANDLE;
+		VmaAllocation mMemory = VK_NULL_HANDLE;
+		VkImageView mView = VK_NULL_HANDLE;
+		VkSampler mSampler = VK_NULL_HANDLE;
+		VkDescriptorSet mDescriptorSet = VK_NULL_HANDLE;
+		uint64_t mUploadTicket = 0;
+
+		std::vector<Entry> mEntries = {};
+		std::unordered_map<std::string, uint32_t> mHandles = {};	// by key
+		std::vector<uint32_t> mTiles = {};						// the entry on each tile, UINT32_MAX when free
+		std::vector<uint32_t> mFreeTiles = {};
+		std::deque<uint32_t> mQueued = {};
+		std::vector<Loading> mLoading = {};
+		std::vector<std::pair<uint32_t, Shared<Result>>> mDone = {};	// waiting for a free tile
+	};
+}
+
+#endif
@@ -0,0 +1,626 @@
+#if defined RENDERER_VULKAN
+#include "Uploader.h"
+
+#include "Device.h"
+#include <Common/Debug/Logger.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// creates a host visible buffer the cpu writes sequentially and the gpu copies from
+	static void CreateStagingBuffer(VmaAllocator allocator, VkDeviceSize size, VkBuffer& buffer, VmaAllocation& memory, void** mapped)
+	{
+		VmaAllocationCreateInfo allocCI = {};
+		allocCI.usage = VMA_MEMORY_USAGE_AUTO;
+		allocCI.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		VkBufferCreateInfo bufferCI = {};
+		bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCI.size = size;
+		bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocationInfo allocInfo = {};
+		COSMOS_ASSERT(vmaCreateBuffer(allocator, &bufferCI, &allocCI, &buffer, &memory, &allocInfo) == VK_SUCCESS, "Failed to create staging buffer");
+		*mapped = allocInfo.pMappedData;
+	}
+
+	// blits every mip level from the previous one, all levels end in shader read only layout
+	static void RecordMipmaps(VkCommandBuffer cmdBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount)
+	{
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.image = image;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = layerCount;
+		barrier.subresourceRange.levelCount = 1;
+
+		int32_t mipWidth = (int32_t)width;
+		int32_t mipHeight = (int32_t)height;
+
+		for (uint32_t i = 1; i < mipLevels; i++)
+		{
+			barrier.subresourceRange.baseMipLevel = i - 1;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			VkImageBlit blit = {};
+			blit.srcOffsets[0] = { 0, 0, 0 };
+			blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+			blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.srcSubresource.mipLevel = i - 1;
+			blit.srcSubresource.baseArrayLayer = 0;
+			blit.srcSubresource.layerCount = layerCount;
+			blit.dstOffsets[0] = { 0, 0, 0 };
+			blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
+			blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.dstSubresource.mipLevel = i;
+			blit.dstSubresource.baseArrayLayer = 0;
+			blit.dstSubresource.layerCount = layerCount;
+			vkCmdBlitImage(cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			if (mipWidth > 1) mipWidth /= 2;
+			if (mipHeight > 1) mipHeight /= 2;
+		}
+
+		barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	Uploader::Uploader(Device* device, VkDeviceSize capacity)
+		: mDevice(device), mCapacity(capacity)
+	{
+		Device::QueueFamilyIndices indices = mDevice->FindQueueFamilies(mDevice->GetPhysicalDevice(), mDevice->GetSurface());
+
+		// a transfer-only family is usually a dma engine, copies there run alongside rendering
+		mGraphicsFamily = indices.graphics.value();
+		mGraphicsQueue = mDevice->GetGraphicsQueue();
+		mDedicated = indices.transfer.has_value() && mDevice->GetTransferQueue() != VK_NULL_HANDLE;
+		mTransferFamily = mDedicated ? indices.transfer.value() : mGraphicsFamily;
+		mTransferQueue = mDedicated ? mDevice->GetTransferQueue() : mGraphicsQueue;
+
+		VkCommandPoolCreateInfo cmdPoolInfo = {};
+		cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		cmdPoolInfo.queueFamilyIndex = mTransferFamily;
+		COSMOS_ASSERT(vkCreateCommandPool(mDevice->GetLogicalDevice(), &cmdPoolInfo, nullptr, &mTransferPool) == VK_SUCCESS, "Failed to create command pool");
+
+		if (mDedicated) {
+			cmdPoolInfo.queueFamilyIndex = mGraphicsFamily;
+			COSMOS_ASSERT(vkCreateCommandPool(mDevice->GetLogicalDevice(), &cmdPoolInfo, nullptr, &mGraphicsPool) == VK_SUCCESS, "Failed to create command pool");
+		}
+
+		// the graphics side of every batch is timed, it's where mip generation runs
+		mTimestamps = mDevice->GetPropertiesRef().limits.timestampComputeAndGraphics == VK_TRUE;
+
+		// image copies need offsets aligned to the texel size, the device may prefer a larger one
+		mRingSpace = StagingRing(mCapacity, std::max<VkDeviceSize>(16, mDevice->GetPropertiesRef().limits.optimalBufferCopyOffsetAlignment));
+
+		void* mapped = nullptr;
+		CreateStagingBuffer(mDevice->GetAllocator(), mCapacity, mRing, mRingMemory, &mapped);
+		mRingData = (uint8_t*)mapped;
+
+		COSMOS_LOG(Logger::Trace, "Upload ring of %.1fMB, copies run on the %s queue", (double)mCapacity / (1024.0 * 1024.0), mDedicated ? "transfer" : "graphics");
+	}
+
+	Uploader::~Uploader()
+	{
+		Submit();
+
+		while (!mInFlight.empty()) {
+			RetireOldest();
+		}
+
+		if (mRecording.recording) {
+			vkEndCommandBuffer(mRecording.copyCmdBuffer);
+
+			if (mDedicated) {
+				vkEndCommandBuffer(mRecording.finishCmdBuffer);
+			}
+
+			mFree.push_back(std::move(mRecording));
+		}
+
+		// command buffers are freed with their pools
+		for (Batch& batch : mFree) {
+			vkDestroyFence(mDevice->GetLogicalDevice(), batch.fence, nullptr);
+
+			if (batch.copied != VK_NULL_HANDLE) {
+				vkDestroySemaphore(mDevice->GetLogicalDevice(), batch.copied, nullptr);
+			}
+
+			if (batch.timestamps != VK_NULL_HANDLE) {
+				vkDestroyQueryPool(mDevice->GetLogicalDevice(), batch.timestamps, nullptr);
+			}
+		}
+
+		vkDestroyCommandPool(mDevice->GetLogicalDevice(), mTransferPool, nullptr);
+
+		if (mGraphicsPool != VK_NULL_HANDLE) {
+			vkDestroyCommandPool(mDevice->GetLogicalDevice(), mGraphicsPool, nullptr);
+		}
+
+		vmaDestroyBuffer(mDevice->GetAllocator(), mRing, mRingMemory);
+	}
+
+	uint64_t Uploader::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+	{
+		if (size == 0) {
+			return mCompletedTicket;
+		}
+
+		VkBuffer source = VK_NULL_HANDLE;
+		VkDeviceSize sourceOffset = 0;
+		Stage(data, size, source, sourceOffset);
+
+		Batch& batch = GetRecordingBatch();
+
+		VkBufferCopy region = {};
+		region.srcOffset = sourceOffset;
+		region.dstOffset = offset;
+		region.size = size;
+		vkCmdCopyBuffer(batch.copyCmdBuffer, source, buffer, 1, &region);
+
+		// the buffer changes owner from the transfer to the graphics family, both sides must record the same barrier
+		if (mDedicated) {
+			VkBufferMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			barrier.srcQueueFamilyIndex = mTransferFamily;
+			barrier.dstQueueFamilyIndex = mGraphicsFamily;
+			barrier.buffer = buffer;
+			barrier.offset = offset;
+			barrier.size = size;
+			vkCmdPipelineBarrier(batch.copyCmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+			vkCmdPipelineBarrier(batch.finishCmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
+
+		batch.empty = false;
+		mStatistics.bytes += size;
+		mStatistics.uploads++;
+		return batch.ticket;
+	}
+
+	uint64_t Uploader::UploadImage(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount)
+	{
+		VkBuffer source = VK_NULL_HANDLE;
+		VkDeviceSize sourceOffset = 0;
+		Stage(data, size, source, sourceOffset);
+
+		Batch& batch = GetRecordingBatch();
+
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = mipLevels;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = layerCount;
+		vkCmdPipelineBarrier(batch.copyCmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		VkBufferImageCopy region = {};
+		region.bufferOffset = sourceOffset;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = layerCount;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { width, height, 1 };
+		vkCmdCopyBufferToImage(batch.copyCmdBuffer, source, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		// blits need the graphics queue, the image is handed over to it keeping it's layout
+		if (mDedicated) {
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			barrier.srcQueueFamilyIndex = mTransferFamily;
+			barrier.dstQueueFamilyIndex = mGraphicsFamily;
+			vkCmdPipelineBarrier(batch.copyCmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(batch.finishCmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		RecordMipmaps(GetFinishCmdBuffer(batch), image, width, height, mipLevels, layerCount);
+
+		batch.empty = false;
+		mStatistics.bytes += size;
+		mStatistics.uploads++;
+		mStatistics.generatedLevels += (mipLevels - 1) * layerCount;
+		return batch.ticket;
+	}
+
+	uint64_t Uploader::UploadImageLevels(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mipLevels, const VkDeviceSize* offsets)
+	{
+		VkBuffer source = VK_NULL_HANDLE;
+		VkDeviceSize sourceOffset = 0;
+		Stage(data, size, source, sourceOffset);
+
+		Batch& batch = GetRecordingBatch();
+
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = mipLevels;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		vkCmdPipelineBarrier(batch.copyCmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		std::vector<VkBufferImageCopy> regions(mipLevels);
+
+		for (uint32_t i = 0; i < mipLevels; i++) {
+			regions[i].bufferOffset = sourceOffset + offsets[i];
+			regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			regions[i].imageSubresource.mipLevel = i;
+			regions[i].imageSubresource.baseArrayLayer = 0;
+			regions[i].imageSubresource.layerCount = 1;
+			regions[i].imageOffset = { 0, 0, 0 };
+			regions[i].imageExtent = { std::max(width >> i, 1u), std::max(height >> i, 1u), 1 };
+		}
+
+		vkCmdCopyBufferToImage(batch.copyCmdBuffer, source, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, regions.data());
+
+		// nothing is left to generate, the image goes straight to it's final layout, along with the ownership change on a dedicated queue
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		if (mDedicated) {
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			barrier.srcQueueFamilyIndex = mTransferFamily;
+			barrier.dstQueueFamilyIndex = mGraphicsFamily;
+			vkCmdPipelineBarrier(batch.copyCmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(batch.finishCmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		else {
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(batch.copyCmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		batch.empty = false;
+		mStatistics.bytes += size;
+		mStatistics.uploads++;
+		mStatistics.precomputedLevels += mipLevels;
+		return batch.ticket;
+	}
+
+	uint64_t Uploader::UploadImageRegions(VkImage image, const void* data, VkDeviceSize size, const VkBufferImageCopy* regions, uint32_t regionCount)
+	{
+		VkBuffer source = VK_NULL_HANDLE;
+		VkDeviceSize sourceOffset = 0;
+		Stage(data, size, source, sourceOffset);
+
+		Batch& batch = GetRecordingBatch();
+		VkCommandBuffer cmdBuffer = GetFinishCmdBuffer(batch);
+
+		// the staged bytes were written by the host, no queue family owned them before
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		std::vector<VkBufferImageCopy> copies(regions, regions + regionCount);
+
+		for (VkBufferImageCopy& copy : copies) {
+			copy.bufferOffset += sourceOffset;
+		}
+
+		vkCmdCopyBufferToImage(cmdBuffer, source, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, copies.data());
+
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		batch.empty = false;
+		mStatistics.bytes += size;
+		mStatistics.uploads++;
+		return batch.ticket;
+	}
+
+	bool Uploader::IsComplete(uint64_t ticket)
+	{
+		if (ticket <= mCompletedTicket) {
+			return true;
+		}
+
+		Retire();
+		return ticket <= mCompletedTicket;
+	}
+
+	void Uploader::Wait(uint64_t ticket)
+	{
+		if (mRecording.recording && ticket >= mRecording.ticket) {
+			Submit();
+		}
+
+		while (ticket > mCompletedTicket && !mInFlight.empty()) {
+			RetireOldest();
+		}
+	}
+
+	void Uploader::Submit()
+	{
+		Retire();
+
+		if (!mRecording.recording || mRecording.empty) {
+			return;
+		}
+
+		Batch& batch = mRecording;
+
+		// whatever the graphics queue runs after this batch sees all it wrote, frames are submitted after it
+		VkMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		vkCmdPipelineBarrier(GetFinishCmdBuffer(batch), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		if (batch.timestamps != VK_NULL_HANDLE) {
+			vkCmdWriteTimestamp(GetFinishCmdBuffer(batch), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, batch.timestamps, 1);
+		}
+
+		COSMOS_ASSERT(vkEndCommandBuffer(batch.copyCmdBuffer) == VK_SUCCESS, "Failed to end command buffer recording");
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.copyCmdBuffer;
+
+		if (mDedicated) {
+			COSMOS_ASSERT(vkEndCommandBuffer(batch.finishCmdBuffer) == VK_SUCCESS, "Failed to end command buffer recording");
+
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &batch.copied;
+			COSMOS_ASSERT(vkQueueSubmit(mTransferQueue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS, "Failed to submit upload copies");
+
+			VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			VkSubmitInfo finishInfo = {};
+			finishInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			finishInfo.waitSemaphoreCount = 1;
+			finishInfo.pWaitSemaphores = &batch.copied;
+			finishInfo.pWaitDstStageMask = &waitStage;
+			finishInfo.commandBufferCount = 1;
+			finishInfo.pCommandBuffers = &batch.finishCmdBuffer;
+			COSMOS_ASSERT(vkQueueSubmit(mGraphicsQueue, 1, &finishInfo, batch.fence) == VK_SUCCESS, "Failed to submit upload finish");
+		}
+
+		else {
+			COSMOS_ASSERT(vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, batch.fence) == VK_SUCCESS, "Failed to submit upload copies");
+		}
+
+		batch.ringEnd = mRingSpace.GetHead();
+		batch.recording = false;
+		mInFlight.push_back(std::move(batch));
+		mRecording = {};
+
+		mStatistics.batches++;
+		mStatistics.inFlight = (uint32_t)mInFlight.size();
+	}
+
+	Uploader::Batch& Uploader::GetRecordingBatch()
+	{
+		if (mRecording.recording) {
+			return mRecording;
+		}
+
+		if (mFree.empty()) {
+			mFree.push_back(CreateBatch());
+		}
+
+		mRecording = std::move(mFree.back());
+		mFree.pop_back();
+
+		mRecording.ticket = mNextTicket++;
+		mRecording.recording = true;
+		mRecording.empty = true;
+
+		VkCommandBufferBeginInfo cmdBeginInfo = {};
+		cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cmdBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		COSMOS_ASSERT(vkBeginCommandBuffer(mRecording.copyCmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to begin command buffer recording");
+
+		if (mDedicated) {
+			COSMOS_ASSERT(vkBeginCommandBuffer(mRecording.finishCmdBuffer, &cmdBeginInfo) == VK_SUCCESS, "Failed to begin command buffer recording");
+		}
+
+		if (mRecording.timestamps != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(GetFinishCmdBuffer(mRecording), mRecording.timestamps, 0, 2);
+			vkCmdWriteTimestamp(GetFinishCmdBuffer(mRecording), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mRecording.timestamps, 0);
+		}
+
+		return mRecording;
+	}
+
+	VkCommandBuffer Uploader::GetFinishCmdBuffer(Batch& batch)
+	{
+		return mDedicated ? batch.finishCmdBuffer : batch.copyCmdBuffer;
+	}
+
+	void Uploader::Stage(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset)
+	{
+		// a single upload may not take most of the ring, it would keep everything else waiting, it gets it's own staging instead
+		if (size > mCapacity / 4) {
+			VmaAllocation memory = VK_NULL_HANDLE;
+			void* mapped = nullptr;
+			CreateStagingBuffer(mDevice->GetAllocator(), size, buffer, memory, &mapped);
+			memcpy(mapped, data, (size_t)size);
+			vmaFlushAllocation(mDevice->GetAllocator(), memory, 0, size);
+			offset = 0;
+
+			Batch& batch = GetRecordingBatch();
+			batch.stagingBuffers.push_back(buffer);
+			batch.stagingMemories.push_back(memory);
+			return;
+		}
+
+		// the position is placed again after every retire, the last one rewinds the ring to the beginning
+		if (!mRingSpace.Allocate(size, offset))
+		{
+			mStatistics.stalls++;
+
+			do {
+				// the space may be held by the batch being recorded, it can only be waited once submitted
+				if (mInFlight.empty()) {
+					Submit();
+				}
+
+				COSMOS_ASSERT(!mInFlight.empty(), "Upload ring is full with no batch in flight");
+				RetireOldest();
+			} while (!mRingSpace.Allocate(size, offset));
+		}
+
+		buffer = mRing;
+
+		memcpy(mRingData + offset, data, (size_t)size);
+		vmaFlushAllocation(mDevice->GetAllocator(), mRingMemory, offset, size);
+	}
+
+	void Uploader::Retire()
+	{
+		while (!mInFlight.empty() && vkGetFenceStatus(mDevice->GetLogicalDevice(), mInFlight.front().fence) == VK_SUCCESS) {
+			Release(mInFlight.front());
+			mInFlight.pop_front();
+		}
+
+		mStatistics.inFlight = (uint32_t)mInFlight.size();
+	}
+
+	void Uploader::RetireOldest()
+	{
+		vkWaitForFences(mDevice->GetLogicalDevice(), 1, &mInFlight.front().fence, VK_TRUE, UINT64_MAX);
+		Release(mInFlight.front());
+		mInFlight.pop_front();
+
+		mStatistics.inFlight = (uint32_t)mInFlight.size();
+	}
+
+	void Uploader::Release(Batch& batch)
+	{
+		mCompletedTicket = batch.ticket;
+
+		// the batch is still at the front, it's the last in flight when it's alone there
+		mRingSpace.Release(batch.ringEnd, mInFlight.size() == 1);
+
+		// the fence has signaled, the timestamps are written
+		if (batch.timestamps != VK_NULL_HANDLE) {
+			uint64_t ticks[2] = {};
+
+			if (vkGetQueryPoolResults(mDevice->GetLogicalDevice(), batch.timestamps, 0, 2, sizeof(ticks), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+				mStatistics.gpuTime += (double)(ticks[1] - ticks[0]) * (double)mDevice->GetPropertiesRef().limits.timestampPeriod / 1000000.0;
+			}
+		}
+
+		for (size_t i = 0; i < batch.stagingBuffers.size(); i++) {
+			vmaDestroyBuffer(mDevice->GetAllocator(), batch.stagingBuffers[i], batch.stagingMemories[i]);
+		}
+
+		batch.stagingBuffers.clear();
+		batch.stagingMemories.clear();
+
+		vkResetFences(mDevice->GetLogicalDevice(), 1, &batch.fence);
+		vkResetCommandBuffer(batch.copyCmdBuffer, 0);
+
+		if (mDedicated) {
+			vkResetCommandBuffer(batch.finishCmdBuffer, 0);
+		}
+
+		mFree.push_back(std::move(batch));
+	}
+
+	Uploader::Batch Uploader::CreateBatch()
+	{
+		Batch batch = {};
+
+		VkCommandBufferAllocateInfo cmdBufferAllocInfo = {};
+		cmdBufferAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		cmdBufferAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cmdBufferAllocInfo.commandPool = mTransferPool;
+		cmdBufferAllocInfo.commandBufferCount = 1;
+		COSMOS_ASSERT(vkAllocateCommandBuffers(mDevice->GetLogicalDevice(), &cmdBufferAllocInfo, &batch.copyCmdBuffer) == VK_SUCCESS, "Failed to allocate command buffers");
+
+		if (mDedicated) {
+			cmdBufferAllocInfo.commandPool = mGraphicsPool;
+			COSMOS_ASSERT(vkAllocateCommandBuffers(mDevice->GetLogicalDevice(), &cmdBufferAllocInfo, &batch.finishCmdBuffer) == VK_SUCCESS, "Failed to allocate command buffers");
+
+			VkSemaphoreCreateInfo semaphoreCI = {};
+			semaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			COSMOS_ASSERT(vkCreateSemaphore(mDevice->GetLogicalDevice(), &semaphoreCI, nullptr, &batch.copied) == VK_SUCCESS, "Failed to create semaphore");
+		}
+
+		VkFenceCreateInfo fenceCI = {};
+		fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceCI.flags = 0;
+		COSMOS_ASSERT(vkCreateFence(mDevice->GetLogicalDevice(), &fenceCI, nullptr, &batch.fence) == VK_SUCCESS, "Failed to create fence");
+
+		if (mTimestamps) {
+			VkQueryPoolCreateInfo queryPoolCI = {};
+			queryPoolCI.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolCI.queryCount = 2;
+			COSMOS_ASSERT(vkCreateQueryPool(mDevice->GetLogicalDevice(), &queryPoolCI, nullptr, &batch.timestamps) == VK_SUCCESS, "Failed to create query pool");
+		}
+
+		return batch;
+	}
+}
+
+#endif
@@ -0,0 +1,146 @@
+#pragma once
+#if defined RENDERER_VULKAN
+
+#include "Core/StagingRing.h"
+#include "Wrapper/vulkan.h"
+#include <deque>
+#include <vector>
+
+// forward declarations
+namespace Cosmos::Renderer::Vulkan { class Device; }
+
+namespace Cosmos::Renderer::Vulkan
+{
+	// copies data into device local buffers and images through a persistently mapped staging ring
+	// uploads are batched into a single submission per frame, on a transfer-only queue when the device has one, and retired by fences
+	// uploads are recorded on the main thread
+	class Uploader
+	{
+	public:
+
+		struct Statistics
+		{
+			uint64_t bytes = 0;									// bytes copied through the ring since startup
+			uint32_t uploads = 0;								// uploads recorded since startup
+			uint32_t batches = 0;								// submissions since startup
+			uint32_t stalls = 0;								// times an upload had to wait for the ring to free space
+			uint32_t inFlight = 0;								// batches submitted and not yet retired
+			uint32_t generatedLevels = 0;						// mip levels blitted on the gpu since startup
+			uint32_t precomputedLevels = 0;						// mip levels copied as they were given since startup
+			double gpuTime = 0.0;								// milliseconds the retired batches took on the graphics queue, 0 if timestamps are unsupported
+		};
+
+	public:
+
+		// constructor
+		Uploader(Device* device, VkDeviceSize capacity);
+
+		// destructor
+		~Uploader();
+
+		// delete copy constructor
+		Uploader(const Uploader&) = delete;
+
+		// delete assignment constructor
+		Uploader& operator=(const Uploader&) = delete;
+
+	public:
+
+		// returns if copies run on a transfer-only queue
+		inline bool HasDedicatedQueue() const { return mDedicated; }
+
+		// returns a reference to the statistics
+		inline Statistics& GetStatisticsRef() { return mStatistics; }
+
+	public:
+
+		// copies data into a buffer created with VK_BUFFER_USAGE_TRANSFER_DST_BIT, returns the ticket of the batch the copy went into
+		uint64_t UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+		// copies tightly packed rgba pixels into the first mip level of all layers of an image in undefined layout
+		// the remaining levels are blitted from it on the graphics queue and the image ends in shader read only layout
+		uint64_t UploadImage(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount = 1);
+
+		// copies every mip level of an image in undefined layout from data, level i is read at offsets[i], nothing is generated on the gpu
+		// the image ends in shader read only layout, offsets must be multiples of the texel size
+		uint64_t UploadImageLevels(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mipLevels, const VkDeviceSize* offsets);
+
+		// copies tightly packed rgba pixels into rectangles of the first mip level of an image already in shader read only layout, it stays in it
+		// region buffer offsets are from the start of data, the copy is recorded on the graphics queue so frames sampling the image are ordered with it
+		uint64_t UploadImageRegions(VkImage image, const void* data, VkDeviceSize size, const VkBufferImageCopy* regions, uint32_t regionCount);
+
+		// returns if the batch of a ticket has finished on the gpu, never blocks
+		bool IsComplete(uint64_t ticket);
+
+		// blocks until the batch of a ticket has finished on the gpu, submitting it if it's still being recorded
+		void Wait(uint64_t ticket);
+
+		// submits the batch being recorded, must be called before the frame commands are submitted so they see every upload of the frame
+		void Submit();
+
+	private:
+
+		struct Batch
+		{
+			uint64_t ticket = 0;
+			VkCommandBuffer copyCmdBuffer = VK_NULL_HANDLE;		// transfer family, copies and ownership releases
+			VkCommandBuffer finishCmdBuffer = VK_NULL_HANDLE;	// graphics family, ownership acquires, mip generation and final layouts
+			VkSemaphore copied = VK_NULL_HANDLE;				// signaled by the copies, waited by the finish
+			VkFence fence = VK_NULL_HANDLE;
+			VkQueryPool timestamps = VK_NULL_HANDLE;			// begin and end of the graphics work
+			uint64_t ringEnd = 0;								// the ring is free up to here once the batch retires
+			std::vector<VkBuffer> stagingBuffers = {};			// dedicated staging of uploads too big for the ring
+			std::vector<VmaAllocation> stagingMemories = {};
+			bool recording = false;
+			bool empty = true;
+		};
+
+		// returns the batch being recorded, beginning it if needed
+		Batch& GetRecordingBatch();
+
+		// returns the command buffer the graphics work of the batch is recorded into
+		VkCommandBuffer GetFinishCmdBuffer(Batch& batch);
+
+		// copies data into staging memory, returning the buffer and offset to copy from, may submit and wait older batches when the ring is full
+		void Stage(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset);
+
+		// releases the batches finished on the gpu, oldest first
+		void Retire();
+
+		// waits for the oldest batch in flight and releases it
+		void RetireOldest();
+
+		// releases a finished batch, it's objects are kept for the next ones, it must still be the front of the batches in flight
+		void Release(Batch& batch);
+
+		// creates a batch with it's command buffers, semaphore and fence
+		Batch CreateBatch();
+
+	private:
+
+		Device* mDevice = nullptr;
+		bool mDedicated = false;
+		bool mTimestamps = false;
+		uint32_t mTransferFamily = 0;
+		uint32_t mGraphicsFamily = 0;
+		VkQueue mTransferQueue = VK_NULL_HANDLE;
+		VkQueue mGraphicsQueue = VK_NULL_HANDLE;
+		VkCommandPool mTransferPool = VK_NULL_HANDLE;
+		VkCommandPool mGraphicsPool = VK_NULL_HANDLE;
+
+		VkBuffer mRing = VK_NULL_HANDLE;
+		VmaAllocation mRingMemory = VK_NULL_HANDLE;
+		uint8_t* mRingData = nullptr;
+		VkDeviceSize mCapacity = 0;
+		StagingRing mRingSpace = {};							// head and tail of the uploads on the ring
+
+		uint64_t mNextTicket = 1;
+		uint64_t mCompletedTicket = 0;
+		Batch mRecording = {};
+		std::deque<Batch> mInFlight = {};
+		std::vector<Batch> mFree = {};
+		Statistics mStatistics = {};
+	};
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "Test.h"
+
+#include <Common/Util/Timer.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdarg>
+#include <cstdio>
+#include <filesystem>
+
+namespace Cosmos::Tests
+{
+	static uint32_t sFailures = 0;
+
+	std::vector<Case>& GetCases()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	Registrar::Registrar(const char* name, void (*func)(), bool benchmark)
+	{
+		Case entry = {};
+		entry.name = name;
+		entry.func = func;
+		entry.benchmark = benchmark;
+		GetCases().push_back(entry);
+	}
+
+	void Fail(const char* file, int line, const char* expression)
+	{
+		// a broken invariant usually fails thousands of times in a loop, the first few are enough to find it
+		if (sFailures < 16) {
+			printf("    FAILED %s:%d: %s\n", file, line, expression);
+		}
+
+		sFailures++;
+	}
+
+	uint32_t GetFailureCount()
+	{
+		return sFailures;
+	}
+
+	double Measure(uint32_t repeat, const std::function<void()>& func)
+	{
+		double best = DBL_MAX;
+
+		for (uint32_t i = 0; i < std::max(repeat, 1u); i++) {
+			Timer timer;
+			timer.Start();
+			func();
+			best = std::min(best, timer.Stop());
+		}
+
+		return best;
+	}
+
+	void Report(const char* name, const char* format, ...)
+	{
+		char text[512];
+
+		va_list args;
+		va_start(args, format);
+		vsnprintf(text, sizeof(text), format, args);
+		va_end(args);
+
+		printf("    %-40s %s\n", name, text);
+	}
+
+	std::string GetScratchPath(const std::string& name)
+	{
+		static std::filesystem::path directory = []()
+			{
+				std::filesystem::path path = std::filesystem::temp_directory_path() / "cosmos_tests";
+				std::filesystem::create_directories(path);
+				return path;
+			}();
+
+		return (directory / name).string();
+	}
+}
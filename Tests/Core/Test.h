@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// a minimal runner for the parts of the engine that run on the cpu alone, cases register themselves when their file is linked
+namespace Cosmos::Tests
+{
+	struct Case
+	{
+		const char* name = nullptr;
+		void (*func)() = nullptr;
+		bool benchmark = false;								// only ran when asked for, they report timings instead of checking
+	};
+
+	// returns every registered case, in link order
+	std::vector<Case>& GetCases();
+
+	// registers a case when constructed, it's what the macros declare
+	struct Registrar
+	{
+		Registrar(const char* name, void (*func)(), bool benchmark);
+	};
+
+	// reports a failed check, the case keeps running
+	void Fail(const char* file, int line, const char* expression);
+
+	// returns how many checks failed so far
+	uint32_t GetFailureCount();
+
+	// returns the best time in milliseconds of running func repeat times, the best run is the one least disturbed
+	double Measure(uint32_t repeat, const std::function<void()>& func);
+
+	// prints a benchmark result line
+	void Report(const char* name, const char* format, ...);
+
+	// returns a path for a file named name on a scratch directory, created on the first call
+	std::string GetScratchPath(const std::string& name);
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static ::Cosmos::Tests::Registrar name##Registrar(#name, &name, false); \
+	static void name()
+
+#define BENCHMARK_CASE(name) \
+	static void name(); \
+	static ::Cosmos::Tests::Registrar name##Registrar(#name, &name, true); \
+	static void name()
+
+#define TEST_CHECK(expression) \
+	do { if (!(expression)) { ::Cosmos::Tests::Fail(__FILE__, __LINE__, #expression); } } while (0)
@@ -0,0 +1,204 @@
+#include "Core/Test.h"
+
+#include <Common/File/AssetIndex.h>
+#include <Common/Util/Timer.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace Cosmos::Tests
+{
+	// the index is kept current on it's own thread, checks wait for it with a generous timeout
+	template<typename T>
+	static bool WaitFor(T&& condition, double seconds = 20.0)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		while (!condition()) {
+			if (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > seconds) {
+				return false;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+
+		return true;
+	}
+
+	static std::string CreateTree(const std::string& name)
+	{
+		std::string root = GetScratchPath(name);
+		std::filesystem::remove_all(root);
+		std::filesystem::create_directories(root + "/textures/old");
+		std::filesystem::create_directories(root + "/meshes");
+		std::ofstream(root + "/textures/Brick_Albedo.png") << "x";
+		std::ofstream(root + "/textures/old/brick_normal.png") << "x";
+		std::ofstream(root + "/meshes/brick_wall.gltf") << "x";
+		return root;
+	}
+
+	static size_t ListCount(AssetIndex& index, const std::string& directory)
+	{
+		std::vector<AssetIndex::Entry> entries = {};
+		index.List(directory, entries);
+		return entries.size();
+	}
+
+	static std::vector<AssetIndex::Entry> SearchAll(AssetIndex& index, const std::string& text, const std::string& directory, bool recursive)
+	{
+		std::vector<AssetIndex::Entry> entries = {};
+		AssetIndex::Search search = {};
+
+		if (index.BeginSearch(text, directory, recursive, search)) {
+			while (!index.StepSearch(search, entries, 1.0));
+		}
+
+		return entries;
+	}
+
+	TEST_CASE(AssetIndex_ListAndSearch)
+	{
+		std::string root = CreateTree("index_search");
+		AssetIndex index(root);
+		TEST_CHECK(WaitFor([&]() { return index.IsReady(); }));
+
+		TEST_CHECK(ListCount(index, root) == 2);
+		TEST_CHECK(ListCount(index, root + "/textures") == 2);
+		TEST_CHECK(SearchAll(index, "BRICK", root, true).size() == 3);
+		TEST_CHECK(SearchAll(index, "brick", root + "/textures", false).size() == 1);
+		TEST_CHECK(SearchAll(index, "bricknormal", root, true).empty());
+
+		// changes arrive through the watcher
+		std::ofstream(root + "/meshes/brick_floor.gltf") << "x";
+		std::filesystem::remove_all(root + "/textures/old");
+		TEST_CHECK(WaitFor([&]() { return ListCount(index, root + "/meshes") == 2 && ListCount(index, root + "/textures") == 1; }));
+		TEST_CHECK(SearchAll(index, "brick", root, true).size() == 3);
+
+		std::filesystem::remove_all(root);
+	}
+
+	TEST_CASE(AssetIndex_Compact)
+	{
+		std::string root = GetScratchPath("index_compact");
+		std::filesystem::remove_all(root);
+		std::filesystem::create_directories(root + "/many");
+
+		for (uint32_t i = 0; i < 500; i++) {
+			std::ofstream(root + "/many/file" + std::to_string(i) + ".txt") << "x";
+		}
+
+		AssetIndex index(root);
+		TEST_CHECK(WaitFor([&]() { return index.IsReady(); }));
+		TEST_CHECK(index.GetNodeCount() == 502);
+
+		// begun before the compaction, it's ids won't mean the same after
+		AssetIndex::Search stale = {};
+		TEST_CHECK(index.BeginSearch("file", root, true, stale));
+
+		std::filesystem::remove_all(root + "/many");
+		TEST_CHECK(WaitFor([&]() { return index.GetNodeCount() == 1; }));
+
+		std::ofstream(root + "/file_again.txt") << "x";
+		TEST_CHECK(WaitFor([&]() { return ListCount(index, root) == 1; }));
+
+		std::vector<AssetIndex::Entry> entries = {};
+		TEST_CHECK(index.StepSearch(stale, entries, 1.0));
+		TEST_CHECK(entries.empty());
+
+		entries = SearchAll(index, "file", root, true);
+		TEST_CHECK(entries.size() == 1 && entries[0].path == root + "/file_again.txt");
+
+		std::filesystem::remove_all(root);
+	}
+
+	TEST_CASE(AssetIndex_Burst)
+	{
+		// far more events than the watcher queue holds (16384 by default on linux), what was dropped is recovered by a rescan
+		std::string root = GetScratchPath("index_burst");
+		std::filesystem::remove_all(root);
+		std::filesystem::create_directories(root);
+
+		AssetIndex index(root);
+		TEST_CHECK(WaitFor([&]() { return index.IsReady(); }));
+
+		constexpr uint32_t count = 60000;
+
+		for (uint32_t i = 0; i < count; i++) {
+			std::string directory = root + "/dir" + std::to_string(i / 1000);
+
+			if (i % 1000 == 0) {
+				std::filesystem::create_directories(directory);
+			}
+
+			std::ofstream(directory + "/asset" + std::to_string(i) + ".bin");
+		}
+
+		TEST_CHECK(WaitFor([&]() { return SearchAll(index, "asset", root, true).size() == count; }));
+		TEST_CHECK(ListCount(index, root) == count / 1000);
+
+		// removing it all is another burst
+		std::filesystem::remove_all(root);
+		std::filesystem::create_directories(root);
+		TEST_CHECK(WaitFor([&]() { return ListCount(index, root) == 0 && index.GetNodeCount() == 1; }));
+
+		std::filesystem::remove_all(root);
+	}
+
+	BENCHMARK_CASE(AssetIndex_Benchmark)
+	{
+		// 200k files under 2000 directories, named like assets so queries of every length have something to narrow down
+		std::string root = GetScratchPath("index_benchmark");
+		std::filesystem::remove_all(root);
+
+		const char* materials[] = { "rock", "brick", "wood", "metal", "grass", "sand", "tile", "fabric" };
+		const char* maps[] = { "albedo", "normal", "roughness", "height", "mesh" };
+		constexpr uint32_t count = 200000;
+
+		for (uint32_t i = 0; i < count; i++) {
+			std::string directory = root + "/set" + std::to_string(i / 10000) + "/group" + std::to_string(i / 100 % 100);
+
+			if (i % 100 == 0) {
+				std::filesystem::create_directories(directory);
+			}
+
+			std::ofstream(directory + "/" + materials[i % 8] + "_" + maps[i / 8 % 5] + "_" + std::to_string(i) + ".png");
+		}
+
+		Timer crawlTimer;
+		crawlTimer.Start();
+		AssetIndex index(root);
+		TEST_CHECK(WaitFor([&]() { return index.IsReady(); }, 300.0));
+		Report("crawl", "%9.3fms, %zu nodes", crawlTimer.Stop(), index.GetNodeCount());
+
+		std::vector<AssetIndex::Entry> entries = {};
+		double listRoot = Measure(20, [&]() { entries.clear(); index.List(root, entries); });
+		Report("list root", "%9.3fms, %zu entries", listRoot, entries.size());
+
+		double listGroup = Measure(20, [&]() { entries.clear(); index.List(root + "/set7/group42", entries); });
+		Report("list directory", "%9.3fms, %zu entries", listGroup, entries.size());
+
+		// the browser steps a search with a small budget every frame, the first step is what typing waits on
+		for (const char* text : { "r", "k", "ro", "_1", "roc", "rock", "normal_1999", "missing" })
+		{
+			double firstStep = Measure(5, [&]()
+				{
+					AssetIndex::Search search = {};
+					entries.clear();
+					index.BeginSearch(text, root, true, search);
+					index.StepSearch(search, entries, 2.0);
+				});
+
+			double complete = Measure(5, [&]() { entries = SearchAll(index, text, root, true); });
+
+			char label[64];
+			snprintf(label, sizeof(label), "search \"%s\" (%zu char%s)", text, strlen(text), strlen(text) == 1 ? "" : "s");
+			Report(label, "first step %8.3fms, complete %9.3fms, %zu matches", firstStep, complete, entries.size());
+		}
+
+		TEST_CHECK(SearchAll(index, "rock_albedo", root, true).size() == count / 40);
+		std::filesystem::remove_all(root);
+	}
+}
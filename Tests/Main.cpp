@@ -0,0 +1,60 @@
+#include "Core/Test.h"
+
+#include <Common/Debug/Logger.h>
+#include <Common/Util/Timer.h>
+
+#include <cstdio>
+#include <cstring>
+
+// runs every test case, or every benchmark with --benchmark, a filter argument only runs the cases with it on their name
+// the engine log is silenced, cases feed broken files on purpose, --verbose shows it
+int main(int argc, char* argv[])
+{
+	bool benchmarks = false;
+	bool verbose = false;
+	const char* filter = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--benchmark") == 0) {
+			benchmarks = true;
+		}
+
+		else if (strcmp(argv[i], "--verbose") == 0) {
+			verbose = true;
+		}
+
+		else {
+			filter = argv[i];
+		}
+	}
+
+	Cosmos::Logger::GetInstance();
+	Cosmos::Logger::GetBackendLogger()->set_level(verbose ? spdlog::level::trace : spdlog::level::off);
+
+	uint32_t ran = 0;
+	uint32_t failed = 0;
+
+	for (const Cosmos::Tests::Case& entry : Cosmos::Tests::GetCases())
+	{
+		if (entry.benchmark != benchmarks || (filter != nullptr && strstr(entry.name, filter) == nullptr)) {
+			continue;
+		}
+
+		printf("[ RUN  ] %s\n", entry.name);
+
+		uint32_t failures = Cosmos::Tests::GetFailureCount();
+		Cosmos::Timer timer;
+		timer.Start();
+
+		entry.func();
+
+		bool passed = Cosmos::Tests::GetFailureCount() == failures;
+		printf("[ %s ] %s (%.2fms)\n", passed ? " OK " : "FAIL", entry.name, timer.Stop());
+
+		ran++;
+		failed += passed ? 0 : 1;
+	}
+
+	printf("%u case(s) ran, %u failed\n", ran, failed);
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,413 @@
+#include "Core/Test.h"
+
+#include <Common/Math/BoundingBox.h>
+#include <Common/Math/DynamicBVH.h>
+#include <Common/Math/Frustum.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+
+namespace Cosmos::Tests
+{
+	struct Box
+	{
+		glm::vec3 min = glm::vec3(0.0f);
+		glm::vec3 max = glm::vec3(0.0f);
+	};
+
+	// slab test in double precision, written apart from the bvh one, returns the entry distance or -1 on a miss
+	static double RayBox(const glm::vec3& origin, const glm::vec3& direction, const Box& box, double maxDistance)
+	{
+		double enter = 0.0;
+		double exit = maxDistance;
+
+		for (int32_t axis = 0; axis < 3; axis++)
+		{
+			if (direction[axis] == 0.0f) {
+				if (origin[axis] < box.min[axis] || origin[axis] > box.max[axis]) {
+					return -1.0;
+				}
+
+				continue;
+			}
+
+			double t0 = ((double)box.min[axis] - origin[axis]) / direction[axis];
+			double t1 = ((double)box.max[axis] - origin[axis]) / direction[axis];
+			enter = std::max(enter, std::min(t0, t1));
+			exit = std::min(exit, std::max(t0, t1));
+		}
+
+		return enter <= exit ? enter : -1.0;
+	}
+
+	static Box RandomBox(std::mt19937& random, float extent, float size)
+	{
+		std::uniform_real_distribution<float> position(-extent, extent);
+		std::uniform_real_distribution<float> half(0.0f, size);
+
+		Box box = {};
+		glm::vec3 center = glm::vec3(position(random), position(random), position(random));
+		glm::vec3 halfSize = glm::vec3(half(random), half(random), half(random));
+		box.min = center - halfSize;
+		box.max = center + halfSize;
+		return box;
+	}
+
+	// user data is the key of the map, so visits can be checked against the linear scan
+	struct Proxy
+	{
+		int32_t handle = DynamicBVH::Null;
+		Box box = {};
+	};
+
+	// every proxy keeps it's true bounds inside the enlarged ones the tree holds
+	static void CheckBounds(const DynamicBVH& bvh, const std::unordered_map<uint64_t, Proxy>& proxies)
+	{
+		TEST_CHECK(bvh.GetProxyCount() == proxies.size());
+
+		for (auto& [id, proxy] : proxies) {
+			const DynamicBVH::Node& node = bvh.GetNodeRef(proxy.handle);
+			TEST_CHECK(glm::all(glm::lessThanEqual(node.min, proxy.box.min)) && glm::all(glm::greaterThanEqual(node.max, proxy.box.max)));
+			TEST_CHECK(bvh.GetUserData(proxy.handle) == id);
+		}
+	}
+
+	// the query must visit every proxy a linear scan finds, each once, and nothing whose enlarged bounds are outside
+	static void CheckQuery(const DynamicBVH& bvh, const std::unordered_map<uint64_t, Proxy>& proxies, const Frustum& frustum)
+	{
+		std::unordered_map<uint64_t, uint32_t> visited = {};
+		bvh.Query(frustum, [&](uint64_t userData) { visited[userData]++; });
+
+		for (auto& [id, count] : visited) {
+			TEST_CHECK(count == 1);
+			auto it = proxies.find(id);
+			TEST_CHECK(it != proxies.end());
+
+			if (it != proxies.end()) {
+				const DynamicBVH::Node& node = bvh.GetNodeRef(it->second.handle);
+				TEST_CHECK(frustum.ClassifyAABB(node.min, node.max) != Frustum::Intersection::Outside);
+			}
+		}
+
+		for (auto& [id, proxy] : proxies) {
+			if (frustum.ClassifyAABB(proxy.box.min, proxy.box.max) != Frustum::Intersection::Outside) {
+				TEST_CHECK(visited.find(id) != visited.end());
+			}
+		}
+	}
+
+	// collecting every proxy crossed must find all the linear scan does, and the closest hit must be the linear closest
+	static void CheckRayCast(const DynamicBVH& bvh, const std::unordered_map<uint64_t, Proxy>& proxies, const glm::vec3& origin, const glm::vec3& direction, float maxDistance)
+	{
+		std::unordered_map<uint64_t, uint32_t> crossed = {};
+		bvh.RayCast(origin, direction, maxDistance, [&](uint64_t userData, float distance) { crossed[userData]++; return distance; });
+
+		double expected = DBL_MAX;
+
+		for (auto& [id, proxy] : proxies)
+		{
+			double entry = RayBox(origin, direction, proxy.box, maxDistance);
+
+			if (entry < 0.0) {
+				continue;
+			}
+
+			expected = std::min(expected, entry);
+			TEST_CHECK(crossed.find(id) != crossed.end());
+		}
+
+		for (auto& [id, count] : crossed) {
+			TEST_CHECK(count == 1);
+		}
+
+		float closest = maxDistance;
+		bvh.RayCast(origin, direction, maxDistance, [&](uint64_t userData, float distance) -> float
+			{
+				double entry = RayBox(origin, direction, proxies.at(userData).box, distance);
+
+				if (entry >= 0.0 && entry < distance) {
+					closest = (float)entry;
+				}
+
+				return closest;
+			});
+
+		if (expected == DBL_MAX) {
+			TEST_CHECK(closest == maxDistance);
+		}
+
+		else {
+			TEST_CHECK(std::abs(closest - expected) <= 1e-4 * std::max(1.0, expected));
+		}
+	}
+
+	static void CheckAll(std::mt19937& random, const DynamicBVH& bvh, const std::unordered_map<uint64_t, Proxy>& proxies)
+	{
+		std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+		CheckBounds(bvh, proxies);
+
+		for (uint32_t i = 0; i < 20; i++)
+		{
+			glm::vec3 eye = glm::vec3(position(random), position(random), position(random));
+			glm::vec3 target = glm::vec3(position(random), position(random), position(random)) * 0.25f;
+			float fov = glm::radians(30.0f + 30.0f * (unit(random) + 1.0f));
+			float farthest = 20.0f + 50.0f * (unit(random) + 1.0f);
+			CheckQuery(bvh, proxies, Frustum(glm::perspective(fov, 16.0f / 9.0f, 0.1f, farthest) * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f))));
+		}
+
+		for (uint32_t i = 0; i < 200; i++)
+		{
+			glm::vec3 origin = glm::vec3(position(random), position(random), position(random));
+			glm::vec3 direction = glm::vec3(unit(random), unit(random), unit(random));
+
+			// axis aligned rays, their inverse direction is infinite on the other axes
+			if (i % 5 == 0) {
+				direction = glm::vec3(0.0f);
+				direction[i % 3] = unit(random) < 0.0f ? -1.0f : 1.0f;
+			}
+
+			CheckRayCast(bvh, proxies, origin, direction, i % 2 == 0 ? FLT_MAX : 40.0f);
+		}
+	}
+
+	TEST_CASE(DynamicBVH_Empty)
+	{
+		DynamicBVH bvh;
+		Frustum frustum(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 100.0f));
+		uint32_t visits = 0;
+
+		bvh.Query(frustum, [&](uint64_t) { visits++; });
+		bvh.RayCast(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), FLT_MAX, [&](uint64_t, float distance) { visits++; return distance; });
+
+		TEST_CHECK(visits == 0);
+		TEST_CHECK(bvh.GetProxyCount() == 0);
+		TEST_CHECK(bvh.GetHeight() == 0);
+	}
+
+	TEST_CASE(DynamicBVH_InsertMoveRemove)
+	{
+		std::mt19937 random(29);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		DynamicBVH bvh;
+		std::unordered_map<uint64_t, Proxy> proxies = {};
+		uint64_t nextID = 0;
+
+		for (uint32_t i = 0; i < 1500; i++) {
+			Proxy proxy = {};
+			proxy.box = RandomBox(random, 50.0f, 3.0f);
+			proxy.handle = bvh.Insert(proxy.box.min, proxy.box.max, nextID);
+			proxies[nextID++] = proxy;
+		}
+
+		CheckAll(random, bvh, proxies);
+
+		for (uint32_t round = 0; round < 4; round++)
+		{
+			std::vector<uint64_t> ids = {};
+
+			for (auto& [id, proxy] : proxies) {
+				ids.push_back(id);
+			}
+
+			std::sort(ids.begin(), ids.end());
+			std::shuffle(ids.begin(), ids.end(), random);
+
+			// a third moves a little, mostly staying inside it's enlarged bounds, a third jumps elsewhere and a sixth is removed
+			for (size_t i = 0; i < ids.size(); i++)
+			{
+				Proxy& proxy = proxies[ids[i]];
+
+				if (i % 6 < 2) {
+					glm::vec3 offset = glm::vec3(unit(random), unit(random), unit(random)) * 0.2f;
+					proxy.box.min += offset;
+					proxy.box.max += offset;
+					bvh.Move(proxy.handle, proxy.box.min, proxy.box.max);
+				}
+
+				else if (i % 6 < 4) {
+					proxy.box = RandomBox(random, 50.0f, 3.0f);
+					bvh.Move(proxy.handle, proxy.box.min, proxy.box.max);
+				}
+
+				else if (i % 6 == 4) {
+					bvh.Remove(proxy.handle);
+					proxies.erase(ids[i]);
+				}
+			}
+
+			// the removed ones are replaced, reusing their nodes
+			for (uint32_t i = 0; i < 200; i++) {
+				Proxy proxy = {};
+				proxy.box = RandomBox(random, 50.0f, 3.0f);
+				proxy.handle = bvh.Insert(proxy.box.min, proxy.box.max, nextID);
+				proxies[nextID++] = proxy;
+			}
+
+			CheckAll(random, bvh, proxies);
+		}
+
+		// an avl-like balanced tree stays logarithmic
+		TEST_CHECK(bvh.GetHeight() < 40);
+
+		for (auto& [id, proxy] : proxies) {
+			bvh.Remove(proxy.handle);
+		}
+
+		proxies.clear();
+		CheckAll(random, bvh, proxies);
+		TEST_CHECK(bvh.GetHeight() == 0);
+	}
+
+	TEST_CASE(DynamicBVH_Clustered)
+	{
+		// many equal and touching boxes, sharing their planes with the axis aligned rays
+		std::mt19937 random(31);
+		DynamicBVH bvh(0.0f);
+		std::unordered_map<uint64_t, Proxy> proxies = {};
+		uint64_t nextID = 0;
+
+		for (int32_t x = -10; x < 10; x++) {
+			for (int32_t z = -10; z < 10; z++) {
+				Proxy proxy = {};
+				proxy.box.min = glm::vec3((float)x, 0.0f, (float)z);
+				proxy.box.max = glm::vec3((float)x + 1.0f, (x + z) % 3 == 0 ? 0.0f : 1.0f, (float)z + 1.0f);
+				proxy.handle = bvh.Insert(proxy.box.min, proxy.box.max, nextID);
+				proxies[nextID++] = proxy;
+			}
+		}
+
+		CheckAll(random, bvh, proxies);
+
+		for (int32_t i = -10; i <= 10; i++) {
+			CheckRayCast(bvh, proxies, glm::vec3((float)i, 0.0f, -20.0f), glm::vec3(0.0f, 0.0f, 1.0f), FLT_MAX);
+			CheckRayCast(bvh, proxies, glm::vec3(-20.0f, 1.0f, (float)i), glm::vec3(1.0f, 0.0f, 0.0f), FLT_MAX);
+			CheckRayCast(bvh, proxies, glm::vec3((float)i + 0.5f, 5.0f, 0.5f), glm::vec3(0.0f, -1.0f, 0.0f), FLT_MAX);
+		}
+	}
+
+	TEST_CASE(DynamicBVH_ScanLeaves)
+	{
+		// a view accepting most proxies makes the next query scan the leaves, it must find what the walk did and go back once fewer are accepted
+		std::mt19937 random(34);
+		DynamicBVH bvh;
+		std::unordered_map<uint64_t, Proxy> proxies = {};
+
+		for (uint64_t id = 0; id < 2000; id++) {
+			Proxy proxy = {};
+			proxy.box = RandomBox(random, 50.0f, 3.0f);
+			proxy.handle = bvh.Insert(proxy.box.min, proxy.box.max, id);
+			proxies[id] = proxy;
+		}
+
+		auto view = [](float farthest) { return Frustum(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, farthest) * glm::lookAt(glm::vec3(0.0f, 0.0f, 200.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f))); };
+		Frustum wide = view(400.0f);
+		Frustum narrow = view(155.0f);
+
+		DynamicBVH::QueryStatistics walked = bvh.Query(wide, [](uint64_t) {});
+		TEST_CHECK(!walked.scanned && walked.leavesAccepted == 2000);
+
+		CheckQuery(bvh, proxies, wide);
+		DynamicBVH::QueryStatistics scanned = bvh.Query(narrow, [](uint64_t) {});
+		TEST_CHECK(scanned.scanned && scanned.leavesAccepted * 100 < 2000 * DynamicBVH::ScanLeavesPercent);
+
+		DynamicBVH::QueryStatistics back = bvh.Query(narrow, [](uint64_t) {});
+		TEST_CHECK(!back.scanned && back.leavesAccepted == scanned.leavesAccepted);
+		CheckQuery(bvh, proxies, narrow);
+	}
+
+	// what Scene::ObjectPicking does for each candidate, the ray goes into the entity space and is tested against it's mesh bounds there
+	static float PickEntity(const glm::mat4& model, const BoundingBox& bounds, const glm::vec3& origin, const glm::vec3& direction, float maxDistance)
+	{
+		glm::mat4 inverse = glm::inverse(model);
+		glm::vec3 localOrigin = glm::vec3(inverse * glm::vec4(origin, 1.0f));
+		glm::vec3 localDirection = glm::vec3(inverse * glm::vec4(direction, 0.0f));
+		float t = 0.0f;
+
+		if (!RayAABBCollide(localOrigin, localDirection, bounds.GetMin(), bounds.GetMax(), t) || t >= maxDistance) {
+			return maxDistance;
+		}
+
+		return t;
+	}
+
+	BENCHMARK_CASE(DynamicBVH_PickingBenchmark)
+	{
+		// rotated and scaled entities sharing one mesh, picked by rays from a camera outside of them
+		BoundingBox bounds(glm::vec3(-0.5f), glm::vec3(0.5f));
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+		for (uint32_t count : { 10000u, 100000u })
+		{
+			std::mt19937 random(49);
+			float extent = 2.0f * std::cbrt((float)count);
+			std::vector<glm::mat4> models(count);
+			DynamicBVH bvh;
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				glm::vec3 position = glm::vec3(unit(random), unit(random), unit(random)) * extent;
+				glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+				glm::vec3 scale = glm::vec3(1.0f) + glm::abs(glm::vec3(unit(random), unit(random), unit(random)));
+				models[i] = glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), position), unit(random) * 3.14f, axis), scale);
+
+				BoundingBox world = bounds.GetAABB(models[i]);
+				bvh.Insert(world.GetMin(), world.GetMax(), i);
+			}
+
+			std::vector<std::pair<glm::vec3, glm::vec3>> rays(1000);
+
+			for (auto& [origin, direction] : rays) {
+				origin = glm::vec3(unit(random), unit(random), 0.0f) * extent + glm::vec3(0.0f, 0.0f, extent * 3.0f);
+				direction = glm::normalize(glm::vec3(unit(random), unit(random), 0.0f) * 0.3f - glm::vec3(0.0f, 0.0f, 1.0f));
+			}
+
+			std::vector<float> treeHits(rays.size(), FLT_MAX);
+			std::vector<float> linearHits(rays.size(), FLT_MAX);
+			uint32_t visited = 0;
+
+			double tree = Measure(3, [&]()
+				{
+					visited = 0;
+
+					for (size_t r = 0; r < rays.size(); r++) {
+						auto& [origin, direction] = rays[r];
+						float closest = FLT_MAX;
+						visited += bvh.RayCast(origin, direction, FLT_MAX, [&](uint64_t userData, float maxDistance) { return closest = PickEntity(models[userData], bounds, origin, direction, maxDistance); }).leavesAccepted;
+						treeHits[r] = closest;
+					}
+				});
+
+			// seconds at 100k, once is enough
+			double linear = Measure(1, [&]()
+				{
+					for (size_t r = 0; r < rays.size(); r++) {
+						auto& [origin, direction] = rays[r];
+						float closest = FLT_MAX;
+
+						for (uint32_t i = 0; i < count; i++) {
+							closest = PickEntity(models[i], bounds, origin, direction, closest);
+						}
+
+						linearHits[r] = closest;
+					}
+				});
+
+			// both keep the nearest hit of the same per-entity test, so the distances must be the same
+			uint32_t hits = 0;
+
+			for (size_t r = 0; r < rays.size(); r++) {
+				TEST_CHECK(treeHits[r] == linearHits[r]);
+				hits += treeHits[r] != FLT_MAX;
+			}
+
+			char label[64];
+			snprintf(label, sizeof(label), "%u entities, 1000 picks", count);
+			Report(label, "bvh %.3fms (%.1f candidates per pick), linear %.3fms, %u hit", tree, (double)visited / rays.size(), linear, hits);
+		}
+	}
+}
@@ -0,0 +1,159 @@
+#include "Core/Test.h"
+
+#include <Common/Math/DynamicBVH.h>
+#include <Common/Math/Frustum.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	// the plane by plane classification, what ClassifyAABB does without sse
+	static Frustum::Intersection ClassifyScalar(Frustum& frustum, const glm::vec3& min, const glm::vec3& max, float* margin = nullptr)
+	{
+		glm::vec3 center = (min + max) * 0.5f;
+		glm::vec3 extent = (max - min) * 0.5f;
+		Frustum::Intersection result = Frustum::Intersection::Inside;
+		float closest = FLT_MAX;
+
+		for (uint32_t i = 0; i < Frustum::Side::Count; i++)
+		{
+			glm::vec4 plane = frustum.GetPlanes()[i];
+			float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+			float radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+			closest = std::min({ closest, std::abs(distance + radius), std::abs(distance - radius) });
+
+			if (distance + radius < 0.0f) {
+				result = Frustum::Intersection::Outside;
+			}
+
+			else if (distance - radius < 0.0f && result != Frustum::Intersection::Outside) {
+				result = Frustum::Intersection::Intersecting;
+			}
+		}
+
+		if (margin != nullptr) {
+			*margin = closest;
+		}
+
+		return result;
+	}
+
+	static Frustum CreateFrustum(const glm::vec3& eye, const glm::vec3& target, float farthest)
+	{
+		return Frustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, farthest) * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+	}
+
+	TEST_CASE(Frustum_ClassifyAABB)
+	{
+		std::mt19937 random(34);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		uint32_t counts[3] = {};
+
+		for (uint32_t view = 0; view < 20; view++)
+		{
+			Frustum frustum = CreateFrustum(glm::vec3(unit(random), unit(random), unit(random)) * 40.0f, glm::vec3(unit(random), unit(random), unit(random)) * 5.0f, 30.0f + 40.0f * (unit(random) + 1.0f));
+
+			for (uint32_t i = 0; i < 5000; i++)
+			{
+				glm::vec3 center = glm::vec3(unit(random), unit(random), unit(random)) * 60.0f;
+				glm::vec3 extent = glm::abs(glm::vec3(unit(random), unit(random), unit(random))) * (i % 10 == 0 ? 40.0f : 3.0f);
+				float margin = 0.0f;
+				Frustum::Intersection expected = ClassifyScalar(frustum, center - extent, center + extent, &margin);
+
+				// on a plane the order of the sums decides
+				if (margin < 1e-3f) {
+					continue;
+				}
+
+				TEST_CHECK(frustum.ClassifyAABB(center - extent, center + extent) == expected);
+				TEST_CHECK(frustum.ContainsAABB(center - extent, center + extent) == (expected != Frustum::Intersection::Outside));
+				counts[expected]++;
+			}
+		}
+
+		// every outcome was seen
+		TEST_CHECK(counts[0] > 0 && counts[1] > 0 && counts[2] > 0);
+	}
+
+	// a city block layout, buildings of random height on a grid with streets between them
+	static std::vector<std::pair<glm::vec3, glm::vec3>> CreateCity(std::mt19937& random, uint32_t side)
+	{
+		std::uniform_real_distribution<float> height(4.0f, 60.0f);
+		std::uniform_real_distribution<float> footprint(3.0f, 8.0f);
+		std::vector<std::pair<glm::vec3, glm::vec3>> boxes = {};
+
+		for (uint32_t x = 0; x < side; x++) {
+			for (uint32_t z = 0; z < side; z++) {
+				glm::vec3 corner = glm::vec3((float)x * 12.0f, 0.0f, (float)z * 12.0f);
+				boxes.push_back({ corner, corner + glm::vec3(footprint(random), height(random), footprint(random)) });
+			}
+		}
+
+		return boxes;
+	}
+
+	BENCHMARK_CASE(Frustum_Benchmark)
+	{
+		// 100k buildings, seen from the street and from above
+		std::mt19937 random(34);
+		std::vector<std::pair<glm::vec3, glm::vec3>> city = CreateCity(random, 317);
+		float size = 317.0f * 12.0f;
+
+		Frustum street = CreateFrustum(glm::vec3(size * 0.5f, 2.0f, size * 0.5f), glm::vec3(size, 2.0f, size * 0.6f), 1000.0f);
+		Frustum above = CreateFrustum(glm::vec3(size * 0.5f, 800.0f, -200.0f), glm::vec3(size * 0.5f, 0.0f, size * 0.5f), 5000.0f);
+
+		uint32_t visible = 0;
+		Report("sse2 ClassifyAABB, 100k boxes", "%8.3fms", Measure(10, [&]() { visible = 0; for (auto& [min, max] : city) visible += street.ClassifyAABB(min, max) != Frustum::Intersection::Outside; }));
+		Report("scalar classification, 100k boxes", "%8.3fms", Measure(10, [&]() { visible = 0; for (auto& [min, max] : city) visible += ClassifyScalar(street, min, max) != Frustum::Intersection::Outside; }));
+
+		DynamicBVH bvh;
+		std::vector<int32_t> proxies = {};
+
+		double build = Measure(1, [&]()
+			{
+				for (size_t i = 0; i < city.size(); i++) {
+					proxies.push_back(bvh.Insert(city[i].first, city[i].second, i));
+				}
+			});
+
+		Report("bvh build, 100k inserts", "%8.3fms, height %d", build, bvh.GetHeight());
+
+		for (auto& [name, frustum] : { std::pair<const char*, Frustum*>{ "street", &street }, std::pair<const char*, Frustum*>{ "above", &above } })
+		{
+			uint32_t linearVisible = 0;
+			uint32_t treeVisible = 0;
+			DynamicBVH::QueryStatistics statistics = {};
+
+			double linear = Measure(10, [&]() { linearVisible = 0; for (auto& [min, max] : city) linearVisible += frustum->ClassifyAABB(min, max) != Frustum::Intersection::Outside; });
+			double tree = Measure(10, [&]() { treeVisible = 0; statistics = bvh.Query(*frustum, [&](uint64_t) { treeVisible++; }); });
+
+			char label[64];
+			snprintf(label, sizeof(label), "%s view", name);
+			Report(label, "bvh %.3fms (%s, %u nodes tested, %u accepted), linear %.3fms (%u visible)", tree, statistics.scanned ? "leaves scanned" : "tree walked", statistics.nodesTested, treeVisible, linear, linearVisible);
+
+			// the same view twice gives the same proxies, whichever way the second query goes
+			TEST_CHECK(treeVisible == bvh.Query(*frustum, [](uint64_t) {}).leavesAccepted);
+		}
+
+		// traffic, a thousand entities move every frame, most stay inside their enlarged bounds
+		std::uniform_real_distribution<float> step(-0.2f, 0.2f);
+		uint32_t frame = 0;
+
+		double moves = Measure(10, [&]()
+			{
+				for (uint32_t i = 0; i < 1000; i++) {
+					size_t index = (frame * 1000 + i) * 97 % city.size();
+					glm::vec3 offset = glm::vec3(step(random), 0.0f, step(random));
+					city[index].first += offset;
+					city[index].second += offset;
+					bvh.Move(proxies[index], city[index].first, city[index].second);
+				}
+
+				frame++;
+			});
+
+		Report("1000 moves per frame", "%8.3fms", moves);
+	}
+}
@@ -0,0 +1,380 @@
+#include "Core/Test.h"
+
+#include <Common/Math/TriangleBVH.h>
+
+#include <cfloat>
+#include <cmath>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	struct Soup
+	{
+		std::vector<glm::vec3> positions = {};
+		std::vector<uint32_t> indices = {};
+	};
+
+	struct Ray
+	{
+		glm::vec3 origin = glm::vec3(0.0f);
+		glm::vec3 direction = glm::vec3(0.0f);
+	};
+
+	// moller-trumbore written apart from the bvh one, the reference every traversal is compared against
+	static float BruteForce(const Soup& soup, const Ray& ray, uint32_t& triangle)
+	{
+		float closest = FLT_MAX;
+		triangle = UINT32_MAX;
+
+		for (size_t i = 0; i + 2 < soup.indices.size(); i += 3)
+		{
+			glm::vec3 a = soup.positions[soup.indices[i]];
+			glm::vec3 b = soup.positions[soup.indices[i + 1]];
+			glm::vec3 c = soup.positions[soup.indices[i + 2]];
+
+			glm::vec3 edge1 = b - a;
+			glm::vec3 edge2 = c - a;
+			glm::vec3 p = glm::cross(ray.direction, edge2);
+			float determinant = glm::dot(edge1, p);
+
+			if (std::fabs(determinant) < 1e-12f) {
+				continue;
+			}
+
+			glm::vec3 s = ray.origin - a;
+			float u = glm::dot(s, p) / determinant;
+			glm::vec3 q = glm::cross(s, edge1);
+			float v = glm::dot(ray.direction, q) / determinant;
+			float t = glm::dot(edge2, q) / determinant;
+
+			if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < closest) {
+				closest = t;
+				triangle = (uint32_t)(i / 3);
+			}
+		}
+
+		return closest;
+	}
+
+	// casts every ray on the bvh and on the brute force, the distances must match and so must the triangle unless another one is as close
+	static void Compare(const Soup& soup, const std::vector<Ray>& rays)
+	{
+		TriangleBVH bvh;
+		bvh.Build(soup.positions.data(), soup.indices.data(), soup.indices.size());
+		TEST_CHECK(bvh.GetTriangleCount() == soup.indices.size() / 3);
+
+		for (const Ray& ray : rays)
+		{
+			uint32_t expectedTriangle = UINT32_MAX;
+			float expected = BruteForce(soup, ray, expectedTriangle);
+
+			TriangleBVH::Hit hit = {};
+			bool found = bvh.RayCast(ray.origin, ray.direction, FLT_MAX, hit);
+
+			TEST_CHECK(found == (expectedTriangle != UINT32_MAX));
+
+			if (!found || expectedTriangle == UINT32_MAX) {
+				continue;
+			}
+
+			float tolerance = 1e-4f * std::max(1.0f, expected);
+			TEST_CHECK(std::fabs(hit.distance - expected) <= tolerance);
+			TEST_CHECK(hit.triangle < soup.indices.size() / 3);
+
+			// a different triangle is only fine when it's hit at the same distance, shared edges and overlaps
+			if (hit.triangle != expectedTriangle) {
+				uint32_t ignored = 0;
+				Soup single = {};
+				single.positions = soup.positions;
+				single.indices = { soup.indices[hit.triangle * 3], soup.indices[hit.triangle * 3 + 1], soup.indices[hit.triangle * 3 + 2] };
+				TEST_CHECK(std::fabs(BruteForce(single, ray, ignored) - expected) <= tolerance);
+			}
+
+			// the normal faces the ray origin
+			TEST_CHECK(glm::dot(hit.normal, ray.direction) <= 0.0f);
+		}
+	}
+
+	static Soup RandomSoup(std::mt19937& random, uint32_t count, float extent, float size)
+	{
+		std::uniform_real_distribution<float> position(-extent, extent);
+		std::uniform_real_distribution<float> offset(-size, size);
+		Soup soup = {};
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			glm::vec3 center = glm::vec3(position(random), position(random), position(random));
+
+			for (uint32_t j = 0; j < 3; j++) {
+				soup.indices.push_back((uint32_t)soup.positions.size());
+				soup.positions.push_back(center + glm::vec3(offset(random), offset(random), offset(random)));
+			}
+		}
+
+		return soup;
+	}
+
+	static std::vector<Ray> RandomRays(std::mt19937& random, uint32_t count, float extent)
+	{
+		std::uniform_real_distribution<float> position(-extent, extent);
+		std::vector<Ray> rays(count);
+
+		for (Ray& ray : rays) {
+			ray.origin = glm::vec3(position(random), position(random), position(random)) * 2.0f;
+			glm::vec3 target = glm::vec3(position(random), position(random), position(random)) * 0.5f;
+			ray.direction = target - ray.origin;
+
+			// not every ray is normalized, distances are in units of the direction
+			if (random() % 2 == 0) {
+				ray.direction = glm::normalize(ray.direction);
+			}
+		}
+
+		return rays;
+	}
+
+	TEST_CASE(TriangleBVH_Empty)
+	{
+		TriangleBVH bvh;
+		bvh.Build(nullptr, nullptr, 0);
+
+		TriangleBVH::Hit hit = {};
+		TEST_CHECK(bvh.IsEmpty());
+		TEST_CHECK(!bvh.RayCast(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), FLT_MAX, hit));
+	}
+
+	TEST_CASE(TriangleBVH_SingleTriangle)
+	{
+		Soup soup = {};
+		soup.positions = { glm::vec3(-1.0f, -1.0f, 2.0f), glm::vec3(1.0f, -1.0f, 2.0f), glm::vec3(0.0f, 1.0f, 2.0f) };
+		soup.indices = { 0, 1, 2 };
+
+		TriangleBVH bvh;
+		bvh.Build(soup.positions.data(), soup.indices.data(), soup.indices.size());
+
+		TriangleBVH::Hit hit = {};
+		TEST_CHECK(bvh.RayCast(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), FLT_MAX, hit));
+		TEST_CHECK(std::fabs(hit.distance - 2.0f) < 1e-6f);
+		TEST_CHECK(hit.triangle == 0);
+		TEST_CHECK(hit.normal.z < 0.0f);
+
+		// both faces are hit, and the distance limit is honored
+		TEST_CHECK(bvh.RayCast(glm::vec3(0.0f, 0.0f, 4.0f), glm::vec3(0.0f, 0.0f, -1.0f), FLT_MAX, hit));
+		TEST_CHECK(hit.normal.z > 0.0f);
+		TEST_CHECK(!bvh.RayCast(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), 1.5f, hit));
+		TEST_CHECK(!bvh.RayCast(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), FLT_MAX, hit));
+	}
+
+	TEST_CASE(TriangleBVH_RandomSoups)
+	{
+		std::mt19937 random(7);
+		uint32_t counts[] = { 1, 2, 3, 17, 256, 5000 };
+
+		for (uint32_t count : counts) {
+			Soup soup = RandomSoup(random, count, 10.0f, 1.5f);
+			Compare(soup, RandomRays(random, 500, 10.0f));
+		}
+	}
+
+	TEST_CASE(TriangleBVH_Degenerate)
+	{
+		std::mt19937 random(11);
+		Soup soup = RandomSoup(random, 1000, 5.0f, 1.0f);
+		std::uniform_real_distribution<float> position(-5.0f, 5.0f);
+
+		// zero area triangles mixed in, points, repeated vertices and collinear ones, they're never hit and must not break the build
+		for (uint32_t i = 0; i < 1000; i++)
+		{
+			glm::vec3 a = glm::vec3(position(random), position(random), position(random));
+			glm::vec3 b = glm::vec3(position(random), position(random), position(random));
+			uint32_t first = (uint32_t)soup.positions.size();
+
+			switch (i % 3)
+			{
+				case 0: soup.positions.insert(soup.positions.end(), { a, a, a }); break;
+				case 1: soup.positions.insert(soup.positions.end(), { a, b, a }); break;
+				default: soup.positions.insert(soup.positions.end(), { a, b, (a + b) * 0.5f }); break;
+			}
+
+			soup.indices.insert(soup.indices.end(), { first, first + 1, first + 2 });
+		}
+
+		// a mesh made only of them
+		Soup points = {};
+		points.positions = { glm::vec3(1.0f) };
+		points.indices = std::vector<uint32_t>(300, 0);
+
+		Compare(soup, RandomRays(random, 1000, 5.0f));
+		Compare(points, RandomRays(random, 100, 2.0f));
+	}
+
+	TEST_CASE(TriangleBVH_AxisAligned)
+	{
+		// a grid of unit quads on each axis plane, nodes are flat boxes and rays run along the axes, their inverse direction is infinite
+		Soup soup = {};
+
+		for (int32_t axis = 0; axis < 3; axis++) {
+			for (int32_t layer = -2; layer <= 2; layer++) {
+				for (int32_t u = -4; u < 4; u++) {
+					for (int32_t v = -4; v < 4; v++)
+					{
+						glm::vec3 corners[4] = {};
+						glm::vec2 offsets[4] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+
+						for (uint32_t c = 0; c < 4; c++) {
+							corners[c][axis] = (float)layer * 3.0f;
+							corners[c][(axis + 1) % 3] = (float)u + offsets[c].x;
+							corners[c][(axis + 2) % 3] = (float)v + offsets[c].y;
+						}
+
+						uint32_t first = (uint32_t)soup.positions.size();
+						soup.positions.insert(soup.positions.end(), corners, corners + 4);
+						soup.indices.insert(soup.indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+					}
+				}
+			}
+		}
+
+		std::mt19937 random(13);
+		std::uniform_real_distribution<float> position(-6.0f, 6.0f);
+		std::vector<Ray> rays = {};
+
+		for (uint32_t i = 0; i < 2000; i++)
+		{
+			Ray ray = {};
+			ray.origin = glm::vec3(position(random), position(random), position(random));
+
+			// some origins sit exactly on the planes and edges of the boxes
+			if (i % 4 == 0) {
+				ray.origin = glm::floor(ray.origin);
+			}
+
+			ray.direction[i % 3] = (i / 3) % 2 == 0 ? 1.0f : -1.0f;
+			rays.push_back(ray);
+		}
+
+		Compare(soup, rays);
+		Compare(soup, RandomRays(random, 1000, 6.0f));
+	}
+
+	TEST_CASE(TriangleBVH_Coplanar)
+	{
+		// every triangle on the same plane, overlapping each other, the centroids have no extent on one axis
+		std::mt19937 random(17);
+		std::uniform_real_distribution<float> position(-4.0f, 4.0f);
+		Soup soup = {};
+
+		for (uint32_t i = 0; i < 2000; i++)
+		{
+			glm::vec3 a = glm::vec3(position(random), 1.0f, position(random));
+			glm::vec3 b = a + glm::vec3(position(random), 0.0f, position(random)) * 0.25f;
+			glm::vec3 c = a + glm::vec3(position(random), 0.0f, position(random)) * 0.25f;
+
+			uint32_t first = (uint32_t)soup.positions.size();
+			soup.positions.insert(soup.positions.end(), { a, b, c });
+			soup.indices.insert(soup.indices.end(), { first, first + 1, first + 2 });
+		}
+
+		// the same triangle many times over, no split can separate them
+		Soup stacked = {};
+		stacked.positions = { glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+
+		for (uint32_t i = 0; i < 500; i++) {
+			stacked.indices.insert(stacked.indices.end(), { 0, 1, 2 });
+		}
+
+		Compare(soup, RandomRays(random, 2000, 4.0f));
+		Compare(stacked, RandomRays(random, 500, 1.0f));
+	}
+
+	TEST_CASE(TriangleBVH_Transform)
+	{
+		std::mt19937 random(19);
+		Soup soup = RandomSoup(random, 200, 3.0f, 0.5f);
+		glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, 0.0f)) * glm::scale(glm::mat4(1.0f), glm::vec3(2.0f));
+
+		// the transformed soup is the reference for the transformed build
+		Soup transformed = soup;
+
+		for (glm::vec3& position : transformed.positions) {
+			position = glm::vec3(matrix * glm::vec4(position, 1.0f));
+		}
+
+		TriangleBVH bvh;
+		bvh.Build(soup.positions.data(), soup.indices.data(), soup.indices.size(), matrix);
+
+		for (const Ray& ray : RandomRays(random, 500, 8.0f))
+		{
+			uint32_t triangle = UINT32_MAX;
+			float expected = BruteForce(transformed, ray, triangle);
+
+			TriangleBVH::Hit hit = {};
+			TEST_CHECK(bvh.RayCast(ray.origin, ray.direction, FLT_MAX, hit) == (triangle != UINT32_MAX));
+			TEST_CHECK(triangle == UINT32_MAX || std::fabs(hit.distance - expected) <= 1e-4f * std::max(1.0f, expected));
+		}
+	}
+
+	BENCHMARK_CASE(TriangleBVH_Benchmark)
+	{
+		// a displaced sphere, close to what a scanned or sculpted mesh looks like
+		std::mt19937 random(23);
+		std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+		uint32_t resolutions[] = { 32, 128, 400 };
+
+		for (uint32_t resolution : resolutions)
+		{
+			Soup soup = {};
+
+			for (uint32_t i = 0; i <= resolution; i++) {
+				for (uint32_t j = 0; j <= resolution; j++) {
+					float theta = 3.14159265f * i / resolution;
+					float phi = 6.28318531f * j / resolution;
+					glm::vec3 normal = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+					soup.positions.push_back(normal * (1.0f + 0.05f * noise(random)));
+				}
+			}
+
+			for (uint32_t i = 0; i < resolution; i++) {
+				for (uint32_t j = 0; j < resolution; j++) {
+					uint32_t a = i * (resolution + 1) + j;
+					uint32_t c = a + resolution + 1;
+					soup.indices.insert(soup.indices.end(), { a, c, a + 1, a + 1, c, c + 1 });
+				}
+			}
+
+			std::vector<Ray> rays = RandomRays(random, 20000, 1.5f);
+			TriangleBVH bvh;
+
+			double build = Measure(3, [&]() { bvh.Build(soup.positions.data(), soup.indices.data(), soup.indices.size()); });
+
+			uint32_t hits = 0;
+			double cast = Measure(3, [&]()
+				{
+					hits = 0;
+
+					for (const Ray& ray : rays) {
+						TriangleBVH::Hit hit = {};
+						hits += bvh.RayCast(ray.origin, ray.direction, FLT_MAX, hit) ? 1 : 0;
+					}
+				});
+
+			// the brute force only gets a few rays, it's linear on the triangles
+			uint32_t bruteRays = std::max(1u, 20000000u / (uint32_t)(soup.indices.size() / 3));
+			uint32_t bruteHits = 0;
+			double brute = Measure(1, [&]()
+				{
+					for (uint32_t i = 0; i < bruteRays; i++) {
+						uint32_t triangle = 0;
+						BruteForce(soup, rays[i % rays.size()], triangle);
+						bruteHits += triangle != UINT32_MAX ? 1 : 0;
+					}
+				});
+
+			double bvhRate = rays.size() / (cast / 1000.0);
+			double bruteRate = bruteRays / (brute / 1000.0);
+
+			Report("TriangleBVH", "%7zu triangles, %6zu nodes, %8.2fms build, %10.0f rays/s (%.2fus), brute force %8.0f rays/s, %6.0fx, %u/%u hits",
+				bvh.GetTriangleCount(), bvh.GetNodeCount(), build, bvhRate, 1000000.0 / bvhRate, bruteRate, bvhRate / bruteRate, hits, bruteHits);
+		}
+	}
+}
@@ -0,0 +1,210 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/Vertex.h>
+#include <Renderer/GLTF/Accessor.h>
+#include <Renderer/Wrapper/tinygltf.h>
+#include <Common/Util/ThreadPool.h>
+
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	// interleaved accessor data, count elements of stride components each
+	static std::vector<float> RandomFloats(size_t count, size_t stride, std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> values(-100.0f, 100.0f);
+		std::vector<float> floats(count * stride);
+
+		for (float& value : floats) {
+			value = values(random);
+		}
+
+		return floats;
+	}
+
+	// compares the bytes, so a kernel differing from the reference by a rounding fails
+	static bool BitEqual(const std::vector<Vertex>& a, const std::vector<Vertex>& b)
+	{
+		return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(Vertex)) == 0;
+	}
+
+	// a primitive the way the loader sees it, positions and normals interleaved and the skin on their own accessors
+	struct SyntheticPrimitive
+	{
+		std::vector<float> interleaved = {};
+		std::vector<float> uvs = {};
+		std::vector<uint16_t> joints = {};
+		std::vector<float> weights = {};
+		size_t count = 0;
+	};
+
+	// decodes like Node::LoadPrimitive does once the accessors are found
+	static void DecodePrimitive(const SyntheticPrimitive& primitive, Vertex* vertices, float scale)
+	{
+		const size_t stride = sizeof(Vertex);
+		GLTF::GatherFloats(primitive.interleaved.data(), 6, 3, primitive.count, scale, &vertices->position, stride);
+		GLTF::GatherFloats(primitive.interleaved.data() + 3, 6, 3, primitive.count, 1.0f, &vertices->normal, stride);
+		GLTF::NormalizeVec3(&vertices->normal, stride, primitive.count);
+		GLTF::GatherFloats(primitive.uvs.data(), 2, 2, primitive.count, 1.0f, &vertices->uv, stride);
+		GLTF::WidenJoints(primitive.joints.data(), TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, 4, primitive.count, &vertices->joint, stride);
+		GLTF::GatherFloats(primitive.weights.data(), 4, 4, primitive.count, 1.0f, &vertices->weight, stride);
+		GLTF::FixZeroWeights(&vertices->weight, stride, primitive.count);
+	}
+
+	TEST_CASE(Accessor_GatherFloats)
+	{
+		// odd counts and strides wider than the element, like positions interleaved with other attributes
+		std::mt19937 random(7);
+		const size_t count = 1003;
+
+		for (uint32_t components : { 2u, 3u, 4u })
+		{
+			for (size_t srcStride : { (size_t)components, (size_t)7 })
+			{
+				std::vector<float> source = RandomFloats(count, srcStride, random);
+				std::vector<Vertex> kernel(count), reference(count);
+
+				for (Vertex* out : { kernel.data(), reference.data() }) {
+					memset(out, 0xCD, count * sizeof(Vertex));
+				}
+
+				GLTF::GatherFloats(source.data(), srcStride, components, count, 0.01f, &kernel[0].weight, sizeof(Vertex));
+
+				for (size_t i = 0; i < count; i++) {
+					for (uint32_t c = 0; c < components; c++) {
+						reference[i].weight[c] = source[i * srcStride + c] * 0.01f;
+					}
+				}
+
+				// the floats after the element and the other attributes are left as they were
+				TEST_CHECK(BitEqual(kernel, reference));
+			}
+		}
+	}
+
+	TEST_CASE(Accessor_NormalizeVec3)
+	{
+		// small and large lengths, counts that leave every remainder of the four-wide loop
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> exponent(-8.0f, 8.0f);
+
+		for (size_t count : { 1, 2, 3, 4, 5, 1003 })
+		{
+			std::vector<Vertex> kernel(count), reference(count);
+
+			for (size_t i = 0; i < count; i++) {
+				std::vector<float> v = RandomFloats(1, 3, random);
+				kernel[i].normal = glm::vec3(v[0], v[1], v[2]) * std::exp2(exponent(random));
+				reference[i].normal = glm::normalize(kernel[i].normal);
+			}
+
+			GLTF::NormalizeVec3(&kernel[0].normal, sizeof(Vertex), count);
+			TEST_CHECK(BitEqual(kernel, reference));
+		}
+	}
+
+	TEST_CASE(Accessor_WidenJoints)
+	{
+		std::mt19937 random(13);
+		std::uniform_int_distribution<uint32_t> joints(0, 65535);
+		const size_t count = 1003;
+
+		for (int32_t componentType : { TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT })
+		{
+			// the source has a stride of six components, the two after each joint must not leak into it
+			std::vector<uint8_t> bytes(count * 6);
+			std::vector<uint16_t> shorts(count * 6);
+
+			for (size_t i = 0; i < count * 6; i++) {
+				shorts[i] = (uint16_t)joints(random);
+				bytes[i] = (uint8_t)shorts[i];
+			}
+
+			const void* source = componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE ? (const void*)bytes.data() : (const void*)shorts.data();
+			std::vector<Vertex> kernel(count), reference(count);
+			GLTF::WidenJoints(source, componentType, 6, count, &kernel[0].joint, sizeof(Vertex));
+
+			for (size_t i = 0; i < count; i++) {
+				for (uint32_t c = 0; c < 4; c++) {
+					reference[i].joint[c] = componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE ? bytes[i * 6 + c] : shorts[i * 6 + c];
+				}
+			}
+
+			TEST_CHECK(BitEqual(kernel, reference));
+		}
+	}
+
+	TEST_CASE(Accessor_FixZeroWeights)
+	{
+		std::mt19937 random(17);
+		const size_t count = 1003;
+		std::vector<Vertex> kernel(count), reference(count);
+
+		// a third of the vertices are unskinned, some others only have tiny weights that are not zero
+		for (size_t i = 0; i < count; i++) {
+			std::vector<float> w = RandomFloats(1, 4, random);
+			glm::vec4 weight = i % 3 == 0 ? glm::vec4(0.0f) : glm::vec4(w[0], w[1], w[2], w[3]) * (i % 3 == 1 ? 1e-20f : 1.0f);
+			kernel[i].weight = weight;
+			reference[i].weight = glm::length(weight) == 0.0f ? glm::vec4(1.0f, 0.0f, 0.0f, 0.0f) : weight;
+		}
+
+		GLTF::FixZeroWeights(&kernel[0].weight, sizeof(Vertex), count);
+		TEST_CHECK(BitEqual(kernel, reference));
+	}
+
+	BENCHMARK_CASE(Accessor_Benchmark)
+	{
+		// 64 primitives of 20k vertices, decoded one after the other and then by the pool like Node::LoadPrimitives
+		std::mt19937 random(19);
+		std::uniform_int_distribution<uint32_t> joints(0, 127);
+		std::vector<SyntheticPrimitive> primitives(64);
+		size_t vertexCount = 0;
+
+		for (SyntheticPrimitive& primitive : primitives) {
+			primitive.count = 20000;
+			primitive.interleaved = RandomFloats(primitive.count, 6, random);
+			primitive.uvs = RandomFloats(primitive.count, 2, random);
+			primitive.weights = RandomFloats(primitive.count, 4, random);
+			primitive.joints.resize(primitive.count * 4);
+
+			for (uint16_t& joint : primitive.joints) {
+				joint = (uint16_t)joints(random);
+			}
+
+			vertexCount += primitive.count;
+		}
+
+		std::vector<Vertex> serial(vertexCount), parallel(vertexCount);
+
+		double serialTime = Measure(5, [&]()
+			{
+				for (size_t i = 0; i < primitives.size(); i++) {
+					DecodePrimitive(primitives[i], &serial[i * 20000], 0.5f);
+				}
+			});
+
+		char label[64];
+		snprintf(label, sizeof(label), "%zu vertices, single thread", vertexCount);
+		Report(label, "%8.3fms", serialTime);
+
+		for (uint32_t threadCount : { 2u, 4u, 8u })
+		{
+			ThreadPool pool(threadCount - 1);
+			double time = Measure(5, [&]()
+				{
+					pool.ParallelFor(primitives.size(), [&](size_t i) { DecodePrimitive(primitives[i], &parallel[i * 20000], 0.5f); });
+				});
+
+			snprintf(label, sizeof(label), "%zu vertices, %u threads", vertexCount, threadCount);
+			Report(label, "%8.3fms, %.2fx (%u hardware threads)", time, serialTime / time, std::thread::hardware_concurrency());
+		}
+
+		// the split doesn't change a bit of the output
+		TEST_CHECK(BitEqual(serial, parallel));
+	}
+}
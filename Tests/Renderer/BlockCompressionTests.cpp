@@ -0,0 +1,225 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/BlockCompression.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	enum class Pattern { Solid, Gradient, Noise };
+
+	static const char* GetPatternName(Pattern pattern)
+	{
+		switch (pattern)
+		{
+			case Pattern::Solid: return "solid";
+			case Pattern::Gradient: return "gradient";
+			case Pattern::Noise: return "noise";
+		}
+
+		return "";
+	}
+
+	// fills a 4x4 block, gradients run on a random direction between two random colors
+	static void FillBlock(Pattern pattern, std::mt19937& random, bool opaque, uint8_t* texels)
+	{
+		std::uniform_int_distribution<int32_t> byte(0, 255);
+		int32_t a[4] = { byte(random), byte(random), byte(random), opaque ? 255 : byte(random) };
+		int32_t b[4] = { byte(random), byte(random), byte(random), opaque ? 255 : byte(random) };
+		float dx = std::uniform_real_distribution<float>(-1.0f, 1.0f)(random);
+		float dy = std::uniform_real_distribution<float>(-1.0f, 1.0f)(random);
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			float t = std::clamp(0.5f + ((float)(i % 4) - 1.5f) * dx / 3.0f + ((float)(i / 4) - 1.5f) * dy / 3.0f, 0.0f, 1.0f);
+
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				switch (pattern)
+				{
+					case Pattern::Solid: { texels[i * 4 + c] = (uint8_t)a[c]; break; }
+					case Pattern::Gradient: { texels[i * 4 + c] = (uint8_t)std::lround(a[c] + (b[c] - a[c]) * t); break; }
+					case Pattern::Noise: { texels[i * 4 + c] = (uint8_t)(c == 3 && opaque ? 255 : byte(random)); break; }
+				}
+			}
+		}
+	}
+
+	// peak signal to noise ratio over the given channels of many blocks, 99 stands for lossless
+	static double GetPSNR(double squaredError, size_t samples)
+	{
+		double mse = squaredError / (double)samples;
+		return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+	}
+
+	struct Codec
+	{
+		const char* name;
+		uint32_t channels;										// the first channels compared, bc5 only keeps red and green
+		bool opaque;
+		void (*encode)(const uint8_t*, uint8_t*);
+		bool (*decode)(const uint8_t*, uint8_t*);
+		double floors[3];										// minimum psnr for solid, gradient and noise blocks, about a decibel under what the encoders reach
+	};
+
+	static const Codec s_Codecs[] =
+	{
+		{ "BC1", 3, true, EncodeBC1, [](const uint8_t* block, uint8_t* texels) { DecodeBC1(block, texels); return true; }, { 40.0, 30.0, 12.5 } },
+		{ "BC3", 4, false, EncodeBC3, [](const uint8_t* block, uint8_t* texels) { DecodeBC3(block, texels); return true; }, { 41.5, 31.0, 13.5 } },
+		{ "BC5", 2, true, EncodeBC5, [](const uint8_t* block, uint8_t* texels) { DecodeBC5(block, texels); return true; }, { 60.0, 36.5, 28.0 } },
+		{ "BC7", 4, false, EncodeBC7, DecodeBC7, { 52.0, 43.0, 12.5 } }
+	};
+
+	TEST_CASE(BlockCompression_PSNR)
+	{
+		for (const Codec& codec : s_Codecs)
+		{
+			for (Pattern pattern : { Pattern::Solid, Pattern::Gradient, Pattern::Noise })
+			{
+				std::mt19937 random(7);
+				double squaredError = 0.0;
+				double worst = 0.0;
+				const uint32_t blocks = 2000;
+
+				for (uint32_t b = 0; b < blocks; b++)
+				{
+					uint8_t texels[64] = {};
+					uint8_t decoded[64] = {};
+					uint8_t block[16] = {};
+					FillBlock(pattern, random, codec.opaque, texels);
+
+					codec.encode(texels, block);
+					TEST_CHECK(codec.decode(block, decoded));
+
+					double blockError = 0.0;
+
+					for (uint32_t i = 0; i < 16; i++) {
+						for (uint32_t c = 0; c < codec.channels; c++) {
+							double difference = (double)texels[i * 4 + c] - (double)decoded[i * 4 + c];
+							blockError += difference * difference;
+						}
+					}
+
+					squaredError += blockError;
+					worst = std::max(worst, blockError);
+				}
+
+				double psnr = GetPSNR(squaredError, (size_t)blocks * 16 * codec.channels);
+				double worstPSNR = GetPSNR(worst, 16 * codec.channels);
+				Report(codec.name, "%-8s %6.2fdB (worst block %6.2fdB)", GetPatternName(pattern), psnr, worstPSNR);
+				TEST_CHECK(psnr >= codec.floors[(int32_t)pattern]);
+			}
+		}
+	}
+
+	// writes bits least significant first, the order bc7 blocks are read in
+	struct BitWriter
+	{
+		uint8_t* block = nullptr;
+		uint32_t position = 0;
+
+		void Write(uint32_t value, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; i++, position++) {
+				block[position / 8] |= (uint8_t)(((value >> i) & 1) << (position % 8));
+			}
+		}
+	};
+
+	// decodes a mode 6 block straight from the specification tables, apart from the engine one
+	static void ReferenceDecodeBC7Mode6(const uint8_t* block, uint8_t* texels)
+	{
+		static const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		auto bit = [block](uint32_t position) { return (uint32_t)(block[position / 8] >> (position % 8)) & 1; };
+		auto bits = [&bit](uint32_t position, uint32_t count)
+			{
+				uint32_t value = 0;
+
+				for (uint32_t i = 0; i < count; i++) {
+					value |= bit(position + i) << i;
+				}
+
+				return value;
+			};
+
+		// 7 mode bits, rgba endpoint pairs of 7 bits each from bit 7, p-bits at 63 and 64, indices from 65 with a 3 bit anchor
+		uint32_t endpoints[2][4] = {};
+
+		for (uint32_t c = 0; c < 4; c++) {
+			endpoints[0][c] = (bits(7 + c * 14, 7) << 1) | bit(63);
+			endpoints[1][c] = (bits(7 + c * 14 + 7, 7) << 1) | bit(64);
+		}
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			uint32_t index = i == 0 ? bits(65, 3) : bits(68 + (i - 1) * 4, 4);
+
+			for (uint32_t c = 0; c < 4; c++) {
+				texels[i * 4 + c] = (uint8_t)(((64 - weights[index]) * endpoints[0][c] + weights[index] * endpoints[1][c] + 32) >> 6);
+			}
+		}
+	}
+
+	TEST_CASE(BlockCompression_BC7Mode6)
+	{
+		// hand written: red endpoints 127 and 0, every other 0, p-bits 1 and 0, texel 15 fully on the second endpoint
+		uint8_t block[16] = {};
+		BitWriter writer = { block, 0 };
+		writer.Write(1 << 6, 7);
+		writer.Write(127, 7);
+		writer.Write(0, 7 * 7);
+		writer.Write(1, 1);
+		writer.Write(0, 1);
+		writer.Write(0, 3 + 14 * 4);
+		writer.Write(15, 4);
+		TEST_CHECK(writer.position == 128);
+
+		uint8_t texels[64] = {};
+		TEST_CHECK(DecodeBC7(block, texels));
+
+		const uint8_t first[4] = { 255, 1, 1, 1 };
+		const uint8_t last[4] = { 0, 0, 0, 0 };
+		TEST_CHECK(memcmp(texels, first, 4) == 0);
+		TEST_CHECK(memcmp(texels + 60, last, 4) == 0);
+
+		// any other mode is refused
+		uint8_t other[16] = {};
+		other[0] = 1 << 5;
+		TEST_CHECK(!DecodeBC7(other, texels));
+
+		// random mode 6 blocks must decode bit-exactly as the specification says
+		std::mt19937 random(11);
+
+		for (uint32_t b = 0; b < 5000; b++)
+		{
+			for (uint8_t& byte : block) {
+				byte = (uint8_t)random();
+			}
+
+			block[0] = (uint8_t)((block[0] & 0x80) | 0x40);
+
+			uint8_t expected[64] = {};
+			ReferenceDecodeBC7Mode6(block, expected);
+			TEST_CHECK(DecodeBC7(block, texels) && memcmp(texels, expected, sizeof(texels)) == 0);
+		}
+
+		// and what the encoder writes round-trips through the reference
+		for (uint32_t b = 0; b < 500; b++)
+		{
+			uint8_t source[64] = {};
+			FillBlock(Pattern::Gradient, random, false, source);
+			memset(block, 0, sizeof(block));
+			EncodeBC7(source, block);
+
+			uint8_t expected[64] = {};
+			ReferenceDecodeBC7Mode6(block, expected);
+			TEST_CHECK(DecodeBC7(block, texels) && memcmp(texels, expected, sizeof(texels)) == 0);
+		}
+	}
+}
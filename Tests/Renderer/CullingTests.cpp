@@ -0,0 +1,119 @@
+#include "Core/Test.h"
+
+#include <Common/Math/Frustum.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	// IsVisible of Data/Shader/culling.comp written with glm, planes are left unnormalized and the radius is scaled by their length instead
+	static bool ShaderIsVisible(const glm::mat4& viewProjection, const glm::vec3& center, float radius)
+	{
+		glm::mat4 rows = glm::transpose(viewProjection);
+		glm::vec4 planes[6] = { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2] };
+
+		for (uint32_t i = 0; i < 6; i++) {
+			if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius * glm::length(glm::vec3(planes[i]))) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// the world space sphere of an instance as the shader computes it, the radius follows the largest scale axis
+	static glm::vec4 TransformSphere(const glm::mat4& model, const glm::vec4& sphere)
+	{
+		glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(sphere), 1.0f));
+		float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+		return glm::vec4(center, sphere.w * scale);
+	}
+
+	static glm::mat4 RandomModel(std::mt19937& random, float extent)
+	{
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+		glm::vec3 scale = glm::vec3(1.25f) + 0.75f * glm::vec3(unit(random), unit(random), unit(random));
+
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(unit(random), unit(random), unit(random)) * extent);
+		model = glm::rotate(model, 3.14159265f * unit(random), axis);
+		return glm::scale(model, scale);
+	}
+
+	TEST_CASE(Culling_ShaderSphereTest)
+	{
+		// the gpu must keep what the cpu frustum keeps, they only may differ on spheres touching a plane
+		std::mt19937 random(33);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		uint32_t visible = 0;
+		uint32_t culled = 0;
+
+		for (uint32_t view = 0; view < 20; view++)
+		{
+			glm::vec3 eye = glm::vec3(unit(random), unit(random), unit(random)) * 30.0f;
+			glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f + 30.0f * unit(random)), 16.0f / 9.0f, 0.1f, 80.0f) * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			Frustum frustum(viewProjection);
+
+			for (uint32_t i = 0; i < 2000; i++)
+			{
+				glm::vec4 sphere = TransformSphere(RandomModel(random, 60.0f), glm::vec4(unit(random), unit(random), unit(random), 0.5f + 2.0f * (unit(random) + 1.0f)));
+				glm::vec3 center = glm::vec3(sphere);
+
+				// how far the sphere is from crossing the nearest plane it's outside of, normalized
+				float margin = FLT_MAX;
+
+				for (uint32_t plane = 0; plane < Frustum::Side::Count; plane++) {
+					glm::vec4 normalized = frustum.GetPlanes()[plane];
+					margin = std::min(margin, std::abs(glm::dot(glm::vec3(normalized), center) + normalized.w + sphere.w));
+				}
+
+				if (margin < 1e-3f) {
+					continue;
+				}
+
+				bool expected = frustum.ContainsSphere(center, sphere.w);
+				TEST_CHECK(ShaderIsVisible(viewProjection, center, sphere.w) == expected);
+				(expected ? visible : culled)++;
+			}
+		}
+
+		TEST_CHECK(visible > 0 && culled > 0);
+	}
+
+	BENCHMARK_CASE(Culling_Benchmark)
+	{
+		// the per instance test the cpu ran before, gpu culling replaces it with a single indirect draw per primitive batch
+		std::mt19937 random(34);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f) * glm::lookAt(glm::vec3(0.0f, 20.0f, 0.0f), glm::vec3(100.0f, 0.0f, 100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		Frustum frustum(viewProjection);
+		glm::vec4 sphere = glm::vec4(0.0f, 0.5f, 0.0f, 1.0f);
+
+		for (uint32_t count : { 10000u, 100000u })
+		{
+			std::vector<glm::mat4> models = {};
+
+			for (uint32_t i = 0; i < count; i++) {
+				models.push_back(RandomModel(random, 300.0f));
+			}
+
+			uint32_t visible = 0;
+
+			double time = Measure(10, [&]()
+				{
+					visible = 0;
+
+					for (const glm::mat4& model : models) {
+						glm::vec4 world = TransformSphere(model, sphere);
+						visible += frustum.ContainsSphere(glm::vec3(world), world.w) ? 1 : 0;
+					}
+				});
+
+			char name[64];
+			snprintf(name, sizeof(name), "%u instances", count);
+			Report(name, "cpu sphere culling %.3fms, %u visible", time, visible);
+		}
+	}
+}
@@ -0,0 +1,121 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/DrawReservation.h>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	struct ReservedRange
+	{
+		uint32_t draw = 0;
+		uint32_t command = 0;
+		uint32_t count = 0;
+	};
+
+	// every thread reserves until it's refused, returns everything that was handed out
+	static std::vector<ReservedRange> ReserveFromThreads(DrawReservation& reservation, uint32_t threadCount, uint32_t maxCount)
+	{
+		std::vector<std::vector<ReservedRange>> perThread(threadCount);
+		std::vector<std::thread> threads = {};
+
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			threads.emplace_back([&reservation, &perThread, i, maxCount]()
+				{
+					std::mt19937 random(40 + i);
+					std::uniform_int_distribution<uint32_t> counts(1, maxCount);
+					ReservedRange range = {};
+					range.count = counts(random);
+
+					while (reservation.Reserve(range.count, range.draw, range.command)) {
+						perThread[i].push_back(range);
+						range.count = counts(random);
+					}
+				});
+		}
+
+		std::vector<ReservedRange> ranges = {};
+
+		for (uint32_t i = 0; i < threadCount; i++) {
+			threads[i].join();
+			ranges.insert(ranges.end(), perThread[i].begin(), perThread[i].end());
+		}
+
+		return ranges;
+	}
+
+	// returns if the draws are 0..n-1 and the commands are back to back from 0, each reserved once
+	static bool IsPacked(std::vector<ReservedRange> ranges, const DrawReservation& reservation)
+	{
+		if (ranges.size() != reservation.GetDrawCount()) {
+			return false;
+		}
+
+		std::sort(ranges.begin(), ranges.end(), [](const ReservedRange& a, const ReservedRange& b) { return a.draw < b.draw; });
+
+		for (size_t i = 0; i < ranges.size(); i++) {
+			if (ranges[i].draw != (uint32_t)i) {
+				return false;
+			}
+		}
+
+		std::sort(ranges.begin(), ranges.end(), [](const ReservedRange& a, const ReservedRange& b) { return a.command < b.command; });
+		uint32_t next = 0;
+
+		for (const ReservedRange& range : ranges)
+		{
+			if (range.command != next) {
+				return false;
+			}
+
+			next += range.count;
+		}
+
+		return next == reservation.GetCommandCount();
+	}
+
+	TEST_CASE(DrawReservation_Threads)
+	{
+		// out of draws first
+		DrawReservation draws(4096, 262144);
+		std::vector<ReservedRange> ranges = ReserveFromThreads(draws, 8, 32);
+		TEST_CHECK(IsPacked(ranges, draws));
+		TEST_CHECK(draws.GetDrawCount() == 4096);
+
+		// out of commands first, a thread refused may leave room for a smaller one but never goes past the limit
+		DrawReservation commands(4096, 20000);
+		ranges = ReserveFromThreads(commands, 8, 64);
+		TEST_CHECK(IsPacked(ranges, commands));
+		TEST_CHECK(commands.GetDrawCount() < 4096);
+		TEST_CHECK(commands.GetCommandCount() <= 20000 && commands.GetCommandCount() > 20000 - 64);
+
+		// a refused reservation takes nothing
+		uint32_t drawIndex = 0;
+		uint32_t commandIndex = 0;
+		uint32_t before = commands.GetCommandCount();
+		TEST_CHECK(!commands.Reserve(UINT32_MAX, drawIndex, commandIndex));
+		TEST_CHECK(commands.GetCommandCount() == before);
+
+		commands.Reset();
+		TEST_CHECK(commands.Reserve(1, drawIndex, commandIndex) && drawIndex == 0 && commandIndex == 0);
+	}
+
+	BENCHMARK_CASE(DrawReservation_Benchmark)
+	{
+		for (uint32_t threadCount : { 1u, 4u, 8u })
+		{
+			DrawReservation reservation(1u << 20, 1u << 30);
+			double time = Measure(5, [&]() { reservation.Reset(); ReserveFromThreads(reservation, threadCount, 64); });
+
+			char label[64];
+			snprintf(label, sizeof(label), "1M reservations, %u thread(s)", threadCount);
+			Report(label, "%8.3fms (%u hardware threads)", time, std::thread::hardware_concurrency());
+		}
+	}
+}
@@ -0,0 +1,190 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/KTXFile.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	// offsets of the header fields the corruption cases touch, the level index follows the 80 byte header
+	static constexpr size_t s_FormatOffset = 12;
+	static constexpr size_t s_WidthOffset = 20;
+	static constexpr size_t s_LayerCountOffset = 32;
+	static constexpr size_t s_FaceCountOffset = 36;
+	static constexpr size_t s_LevelCountOffset = 40;
+	static constexpr size_t s_SupercompressionOffset = 44;
+	static constexpr size_t s_LevelIndexOffset = 80;
+
+	struct Texture
+	{
+		KTXFile::Format format = KTXFile::Format::R8G8B8A8_SRGB;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<uint8_t> data = {};
+		std::vector<KTXFile::Level> levels = {};
+	};
+
+	// every level of a full mip chain filled with random bytes, levels are packed one after the other
+	static Texture CreateTexture(KTXFile::Format format, uint32_t width, uint32_t height, std::mt19937& random)
+	{
+		Texture texture = {};
+		texture.format = format;
+		texture.width = width;
+		texture.height = height;
+
+		for (uint32_t level = 0; ; level++)
+		{
+			uint64_t size = KTXFile::GetLevelSize(format, std::max(width >> level, 1u), std::max(height >> level, 1u));
+			texture.levels.push_back({ (uint64_t)texture.data.size(), size });
+
+			for (uint64_t i = 0; i < size; i++) {
+				texture.data.push_back((uint8_t)random());
+			}
+
+			if ((width >> level) <= 1 && (height >> level) <= 1) {
+				break;
+			}
+		}
+
+		return texture;
+	}
+
+	static std::vector<uint8_t> ReadFile(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	}
+
+	static void WriteFile(const std::string& path, const std::vector<uint8_t>& bytes)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+	}
+
+	template<typename T>
+	static void Patch(std::vector<uint8_t>& bytes, size_t offset, T value)
+	{
+		memcpy(bytes.data() + offset, &value, sizeof(T));
+	}
+
+	// opening a corrupted copy must fail cleanly
+	static bool Opens(const std::string& name, const std::vector<uint8_t>& bytes)
+	{
+		std::string path = GetScratchPath(name);
+		WriteFile(path, bytes);
+
+		KTXFile file;
+		return file.Open(path);
+	}
+
+	TEST_CASE(KTXFile_RoundTrip)
+	{
+		std::mt19937 random(5);
+
+		const KTXFile::Format formats[] =
+		{
+			KTXFile::Format::R8G8B8A8_UNORM, KTXFile::Format::R8G8B8A8_SRGB, KTXFile::Format::BC1_RGB_UNORM, KTXFile::Format::BC1_RGB_SRGB,
+			KTXFile::Format::BC3_UNORM, KTXFile::Format::BC3_SRGB, KTXFile::Format::BC5_UNORM, KTXFile::Format::BC7_UNORM, KTXFile::Format::BC7_SRGB
+		};
+
+		for (KTXFile::Format format : formats)
+		{
+			// square, wide, tall and sizes that aren't multiples of the block
+			for (auto [width, height] : { std::pair<uint32_t, uint32_t>{ 64, 64 }, { 37, 5 }, { 1, 19 }, { 1, 1 } })
+			{
+				Texture texture = CreateTexture(format, width, height, random);
+				std::string path = GetScratchPath("roundtrip.ktx2");
+				TEST_CHECK(KTXFile::Write(path, format, width, height, texture.data.data(), texture.levels));
+
+				KTXFile file;
+				TEST_CHECK(file.Open(path));
+				TEST_CHECK(file.GetFormat() == format && file.GetWidth() == width && file.GetHeight() == height);
+				TEST_CHECK(file.GetLevelCount() == (uint32_t)texture.levels.size());
+
+				for (uint32_t level = 0; level < file.GetLevelCount() && level < texture.levels.size(); level++) {
+					const KTXFile::Level& read = file.GetLevel(level);
+					TEST_CHECK(read.size == texture.levels[level].size);
+					TEST_CHECK(memcmp(file.GetData() + read.offset, texture.data.data() + texture.levels[level].offset, (size_t)read.size) == 0);
+				}
+			}
+		}
+	}
+
+	TEST_CASE(KTXFile_Truncated)
+	{
+		std::mt19937 random(6);
+		Texture texture = CreateTexture(KTXFile::Format::BC7_SRGB, 32, 32, random);
+		std::string path = GetScratchPath("truncated.ktx2");
+		TEST_CHECK(KTXFile::Write(path, texture.format, texture.width, texture.height, texture.data.data(), texture.levels));
+
+		std::vector<uint8_t> bytes = ReadFile(path);
+		TEST_CHECK(Opens("truncated_copy.ktx2", bytes));
+
+		// every cut before the end loses part of the header, the index or a level
+		for (size_t size = 0; size < bytes.size(); size += (size < s_LevelIndexOffset + 200 ? 1 : 97)) {
+			TEST_CHECK(!Opens("truncated_copy.ktx2", std::vector<uint8_t>(bytes.begin(), bytes.begin() + size)));
+		}
+	}
+
+	TEST_CASE(KTXFile_Corrupted)
+	{
+		std::mt19937 random(8);
+		Texture texture = CreateTexture(KTXFile::Format::BC1_RGB_UNORM, 16, 8, random);
+		std::string path = GetScratchPath("corrupted.ktx2");
+		TEST_CHECK(KTXFile::Write(path, texture.format, texture.width, texture.height, texture.data.data(), texture.levels));
+
+		const std::vector<uint8_t> bytes = ReadFile(path);
+		std::vector<uint8_t> copy;
+
+		copy = bytes; copy[1] = 'X';
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint32_t>(copy, s_FormatOffset, 999);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint32_t>(copy, s_WidthOffset, 0);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		// a larger size than stored makes every level too short
+		copy = bytes; Patch<uint32_t>(copy, s_WidthOffset, 4096);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint32_t>(copy, s_LayerCountOffset, 2);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint32_t>(copy, s_FaceCountOffset, 6);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint32_t>(copy, s_SupercompressionOffset, 1);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint32_t>(copy, s_LevelCountOffset, 0);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		// more levels than the size has, their sizes would come from shifts past the width
+		copy = bytes; Patch<uint32_t>(copy, s_LevelCountOffset, 40);
+		copy.resize(copy.size() + 40 * 24, 0);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint32_t>(copy, s_LevelCountOffset, UINT32_MAX);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		// level index entries: offset past the end, offset plus length wrapping around, length under the level size
+		copy = bytes; Patch<uint64_t>(copy, s_LevelIndexOffset, (uint64_t)bytes.size());
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint64_t>(copy, s_LevelIndexOffset, UINT64_MAX - 8);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint64_t>(copy, s_LevelIndexOffset + 8, 8);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+
+		copy = bytes; Patch<uint64_t>(copy, s_LevelIndexOffset + 8, UINT64_MAX);
+		TEST_CHECK(!Opens("corrupted_copy.ktx2", copy));
+	}
+}
@@ -0,0 +1,182 @@
+#include "Core/Test.h"
+
+#include <Renderer/GLTF/Meshlet.h>
+#include <Common/Core/Defines.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	struct MeshletSource
+	{
+		std::vector<Vertex> vertices = {};
+		std::vector<uint32_t> indices = {};
+	};
+
+	// a displaced uv sphere, wound counter-clockwise seen from outside
+	static MeshletSource CreateSphere(uint32_t resolution, std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+		MeshletSource source = {};
+
+		for (uint32_t i = 0; i <= resolution; i++) {
+			for (uint32_t j = 0; j <= resolution; j++) {
+				float theta = 3.14159265f * i / resolution;
+				float phi = 6.28318531f * j / resolution;
+				glm::vec3 normal = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+
+				Vertex vertex = {};
+				vertex.position = normal * (1.0f + 0.02f * noise(random));
+				vertex.normal = normal;
+				source.vertices.push_back(vertex);
+			}
+		}
+
+		for (uint32_t i = 0; i < resolution; i++) {
+			for (uint32_t j = 0; j < resolution; j++) {
+				uint32_t a = i * (resolution + 1) + j;
+				uint32_t c = a + resolution + 1;
+				source.indices.insert(source.indices.end(), { a, a + 1, c, a + 1, c + 1, c });
+			}
+		}
+
+		return source;
+	}
+
+	// every meshlet is a contiguous index range within the limits, together they cover the whole range in order
+	static void CheckBuild(const MeshletSource& source, const std::vector<GLTF::Meshlet>& meshlets, uint32_t firstIndex, uint32_t indexCount)
+	{
+		uint32_t next = firstIndex;
+
+		for (const GLTF::Meshlet& meshlet : meshlets)
+		{
+			TEST_CHECK(meshlet.GetFirstIndex() == next);
+			TEST_CHECK(meshlet.GetIndexCount() > 0 && meshlet.GetIndexCount() % 3 == 0);
+			TEST_CHECK(meshlet.GetIndexCount() / 3 <= COSMOS_MESHLET_MAX_TRIANGLES);
+			next = meshlet.GetFirstIndex() + meshlet.GetIndexCount();
+
+			std::vector<uint32_t> unique(source.indices.begin() + meshlet.GetFirstIndex(), source.indices.begin() + next);
+			std::sort(unique.begin(), unique.end());
+			unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+			TEST_CHECK(unique.size() == meshlet.GetVertexCount());
+			TEST_CHECK(meshlet.GetVertexCount() <= COSMOS_MESHLET_MAX_VERTICES);
+
+			for (uint32_t index : unique) {
+				TEST_CHECK(glm::distance(source.vertices[index].position, meshlet.GetCenter()) <= meshlet.GetRadius() * 1.0001f + 1e-6f);
+			}
+		}
+
+		TEST_CHECK(next == firstIndex + indexCount);
+	}
+
+	TEST_CASE(Meshlet_Build)
+	{
+		std::mt19937 random(26);
+		MeshletSource source = CreateSphere(40, random);
+
+		// degenerate triangles repeat a vertex, they must count it once
+		source.indices.insert(source.indices.end(), { 5, 5, 6, 7, 7, 7, 8, 9, 8 });
+		uint32_t indexCount = (uint32_t)source.indices.size();
+
+		std::vector<GLTF::Meshlet> meshlets = GLTF::Meshlet::Build(source.vertices.data(), source.indices.data(), 0, indexCount);
+		TEST_CHECK(meshlets.size() > 1);
+		CheckBuild(source, meshlets, 0, indexCount);
+
+		// a range in the middle, as primitives sharing the mesh index buffer are built
+		meshlets = GLTF::Meshlet::Build(source.vertices.data(), source.indices.data(), 300, 999);
+		CheckBuild(source, meshlets, 300, 999);
+
+		TEST_CHECK(GLTF::Meshlet::Build(source.vertices.data(), source.indices.data(), 0, 0).empty());
+	}
+
+	TEST_CASE(Meshlet_Culling)
+	{
+		// culling must be conservative, a meshlet is only dropped if every triangle is facing away or it has no vertex inside the view
+		std::mt19937 random(27);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		MeshletSource source = CreateSphere(64, random);
+		std::vector<GLTF::Meshlet> meshlets = GLTF::Meshlet::Build(source.vertices.data(), source.indices.data(), 0, (uint32_t)source.indices.size());
+		uint32_t backfacing = 0;
+		uint32_t outside = 0;
+
+		for (uint32_t view = 0; view < 50; view++)
+		{
+			glm::vec3 eye = glm::normalize(glm::vec3(unit(random), unit(random), unit(random))) * (1.5f + 3.0f * (unit(random) + 1.0f));
+			glm::vec3 target = glm::vec3(unit(random), unit(random), unit(random)) * 0.8f;
+			Frustum frustum(glm::perspective(glm::radians(30.0f), 1.0f, 0.1f, 100.0f) * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+			for (const GLTF::Meshlet& meshlet : meshlets)
+			{
+				if (meshlet.IsBackfacing(eye)) {
+					backfacing++;
+
+					for (uint32_t i = meshlet.GetFirstIndex(); i < meshlet.GetFirstIndex() + meshlet.GetIndexCount(); i += 3) {
+						glm::vec3 a = source.vertices[source.indices[i]].position;
+						glm::vec3 b = source.vertices[source.indices[i + 1]].position;
+						glm::vec3 c = source.vertices[source.indices[i + 2]].position;
+						TEST_CHECK(glm::dot(glm::cross(b - a, c - a), eye - a) <= 1e-6f);
+					}
+				}
+
+				if (!frustum.ContainsSphere(meshlet.GetCenter(), meshlet.GetRadius())) {
+					outside++;
+
+					for (uint32_t i = meshlet.GetFirstIndex(); i < meshlet.GetFirstIndex() + meshlet.GetIndexCount(); i++) {
+						TEST_CHECK(!frustum.ContainsSphere(source.vertices[source.indices[i]].position, 0.0f));
+					}
+				}
+			}
+		}
+
+		// otherwise the checks above never ran
+		TEST_CHECK(backfacing > 0 && outside > 0);
+	}
+
+	BENCHMARK_CASE(Meshlet_Benchmark)
+	{
+		std::mt19937 random(28);
+		uint32_t resolutions[] = { 128, 512, 1024 };
+
+		for (uint32_t resolution : resolutions)
+		{
+			MeshletSource source = CreateSphere(resolution, random);
+			uint32_t indexCount = (uint32_t)source.indices.size();
+			std::vector<GLTF::Meshlet> meshlets = {};
+
+			double build = Measure(3, [&]() { meshlets = GLTF::Meshlet::Build(source.vertices.data(), source.indices.data(), 0, indexCount); });
+
+			uint64_t vertices = 0;
+			for (const GLTF::Meshlet& meshlet : meshlets) {
+				vertices += meshlet.GetVertexCount();
+			}
+
+			// a camera close to the surface, like walking on a terrain, sees little of it and half of what's left faces away
+			glm::vec3 eye = glm::vec3(0.0f, 1.3f, 0.3f);
+			Frustum frustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) * glm::lookAt(eye, glm::vec3(0.0f, 0.8f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+			uint32_t visible = 0;
+			uint64_t visibleTriangles = 0;
+
+			double cull = Measure(20, [&]()
+				{
+					visible = 0;
+					visibleTriangles = 0;
+
+					for (const GLTF::Meshlet& meshlet : meshlets) {
+						if (meshlet.IsVisible(frustum, eye)) {
+							visible++;
+							visibleTriangles += meshlet.GetIndexCount() / 3;
+						}
+					}
+				});
+
+			char name[64];
+			snprintf(name, sizeof(name), "%u triangles", indexCount / 3);
+			Report(name, "build %7.2fms, %zu meshlets (%.1f vertices, %.1f triangles avg), cull %.3fms, %u visible (%.1f%% of triangles)",
+				build, meshlets.size(), (double)vertices / meshlets.size(), (double)indexCount / 3.0 / meshlets.size(), cull, visible, 100.0 * visibleTriangles / (indexCount / 3));
+		}
+	}
+}
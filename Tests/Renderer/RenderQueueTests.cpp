@@ -0,0 +1,150 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/IContext.h>
+#include <Renderer/Core/IMesh.h>
+
+#include <random>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	// records the ranges one after the other on the calling thread, there's no command buffer
+	class QueueContext : public IContext
+	{
+	public:
+
+		QueueContext() = default;
+
+		virtual void OnUpdate() override {}
+		virtual void OnEvent(Shared<Platform::EventBase> event) override {}
+
+		virtual void RecordParallel(size_t count, const std::function<void(size_t first, size_t last, void* commandBuffer)>& func) override
+		{
+			size_t ranges = std::max<size_t>(1, count / COSMOS_RECORD_MIN_BATCHES);
+
+			for (size_t i = 0; i < ranges; i++) {
+				func(count * i / ranges, count * (i + 1) / ranges, nullptr);
+			}
+		}
+	};
+
+	// a loaded mesh without gpu data, a batch is one draw of all it's instances
+	class QueueMesh : public IMesh
+	{
+	public:
+
+		QueueMesh(bool loaded = true) { mLoaded = loaded; }
+
+		virtual void OnUpdate(float timestep) override {}
+		virtual bool OnPrepare(RenderQueue::Batch& batch, IContext::Stage stage) override { instances += batch.count; return true; }
+		virtual void OnRender(const RenderQueue::Batch& batch, RenderQueue::BindState& state, IContext::Stage stage) override { state.draws++; }
+		virtual bool IsTransfering() override { return false; }
+		virtual void LoadFromFile(std::string path, float scale = 1.0f) override {}
+		virtual void Refresh() override {}
+		virtual void SetResidency(Residency residency) override {}
+		virtual const TriangleBVH* GetTriangleBVH() override { return nullptr; }
+
+	public:
+
+		uint32_t instances = 0;
+	};
+
+	// submits count instances spread in front of the camera, each taking the mesh at it's index modulo the meshes
+	static void SubmitInstances(RenderQueue& queue, std::vector<QueueMesh>& meshes, uint32_t count, uint32_t pipeline = 0)
+	{
+		std::mt19937 random(32);
+		std::uniform_real_distribution<float> depth(0.1f, 500.0f);
+
+		for (uint32_t i = 0; i < count; i++) {
+			float z = depth(random);
+			queue.Submit(&meshes[i % meshes.size()], glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -z)), i + 1, z, pipeline);
+		}
+	}
+
+	TEST_CASE(RenderQueue_Batching)
+	{
+		QueueContext context;
+		RenderQueue& queue = context.GetRenderQueueRef();
+
+		// the same mesh on every entity, the way the mesh cache hands it out, is a single instanced draw
+		std::vector<QueueMesh> shared(1);
+		SubmitInstances(queue, shared, 10000);
+		queue.Flush(IContext::Stage::Default);
+		queue.BeginFrame();
+		TEST_CHECK(queue.GetStatisticsRef().packets == 10000);
+		TEST_CHECK(queue.GetStatisticsRef().batches == 1);
+		TEST_CHECK(queue.GetStatisticsRef().draws == 1);
+		TEST_CHECK(shared[0].instances == 10000);
+
+		// interleaved meshes are sorted back together, one batch each
+		std::vector<QueueMesh> meshes(3);
+		SubmitInstances(queue, meshes, 900);
+		queue.Flush(IContext::Stage::Default);
+		queue.BeginFrame();
+		TEST_CHECK(queue.GetStatisticsRef().batches == 3);
+
+		for (QueueMesh& mesh : meshes) {
+			TEST_CHECK(mesh.instances == 300);
+		}
+
+		// a mesh drawn by two pipelines is two batches, a mesh not loaded is dropped
+		std::vector<QueueMesh> unloaded;
+		unloaded.emplace_back(false);
+		SubmitInstances(queue, shared, 100, 0);
+		SubmitInstances(queue, shared, 100, 1);
+		SubmitInstances(queue, unloaded, 100);
+		queue.Flush(IContext::Stage::Default);
+		queue.BeginFrame();
+		TEST_CHECK(queue.GetStatisticsRef().packets == 300);
+		TEST_CHECK(queue.GetStatisticsRef().batches == 2);
+		TEST_CHECK(unloaded[0].instances == 0);
+
+		// a mesh object per entity never batches, wich is why entities loading the same file must share it
+		std::vector<QueueMesh> separate(500);
+		SubmitInstances(queue, separate, 500);
+		queue.Flush(IContext::Stage::Default);
+		queue.BeginFrame();
+		TEST_CHECK(queue.GetStatisticsRef().batches == 500);
+	}
+
+	BENCHMARK_CASE(RenderQueue_Benchmark)
+	{
+		// a single mesh shared by every entity, a few hundred meshes like a city and a mesh per draw, the worst case for batching
+		for (uint32_t count : { 10000u, 100000u })
+		{
+			std::mt19937 random(33);
+			std::uniform_real_distribution<float> depth(0.1f, 500.0f);
+			std::vector<glm::mat4> transforms(count);
+			std::vector<float> depths(count);
+
+			for (uint32_t i = 0; i < count; i++) {
+				depths[i] = depth(random);
+				transforms[i] = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -depths[i]));
+			}
+
+			for (uint32_t meshCount : { 1u, 256u, count })
+			{
+				QueueContext context;
+				RenderQueue& queue = context.GetRenderQueueRef();
+				std::vector<QueueMesh> meshes(meshCount);
+
+				auto submit = [&]()
+					{
+						for (uint32_t i = 0; i < count; i++) {
+							queue.Submit(&meshes[i % meshCount], transforms[i], i + 1, depths[i]);
+						}
+					};
+
+				double submitTime = Measure(5, [&]() { submit(); queue.Clear(); });
+				double frameTime = Measure(5, [&]() { submit(); queue.Flush(IContext::Stage::Default); queue.BeginFrame(); });
+				RenderQueue::Statistics& statistics = queue.GetStatisticsRef();
+
+				char label[64];
+				snprintf(label, sizeof(label), "%u draws, %u mesh(es)", count, meshCount);
+				Report(label, "submit %7.3fms, sort %7.3fms, batches %7.3fms, frame %7.3fms, %u batches", submitTime, statistics.sortTime, statistics.submitTime, frameTime, statistics.batches);
+				TEST_CHECK(statistics.packets == count && statistics.batches == meshCount);
+			}
+		}
+	}
+}
@@ -0,0 +1,258 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/ResidencyPolicy.h>
+#include <Common/Core/Defines.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	// an rgba8 texture with a full mip chain, only it's resident level is tracked
+	class FakeStreamable : public IStreamable
+	{
+	public:
+
+		FakeStreamable(uint32_t size, uint32_t fallbackSize = 64)
+			: mSize(size)
+		{
+			while ((mSize >> mFallbackLevel) > fallbackSize) {
+				mFallbackLevel++;
+			}
+		}
+
+		virtual uint32_t GetMaxDimension() const override { return mSize; }
+		virtual uint32_t GetResidentLevel() const override { return mResidentLevel; }
+		virtual uint32_t GetFallbackLevel() const override { return mFallbackLevel; }
+		virtual bool IsStreaming() const override { return mStreaming; }
+
+		virtual uint64_t GetResidentBytes(uint32_t level) const override
+		{
+			uint64_t bytes = 0;
+
+			for (uint32_t size = std::max(mSize >> level, 1u); ; size /= 2) {
+				bytes += (uint64_t)size * size * 4;
+
+				if (size == 1) {
+					return bytes;
+				}
+			}
+		}
+
+		virtual bool StreamToLevel(uint32_t level) override
+		{
+			mResidentLevel = level;
+			mStreams++;
+			return true;
+		}
+
+	public:
+
+		uint32_t mSize = 0;
+		uint32_t mResidentLevel = 0;
+		uint32_t mFallbackLevel = 0;
+		uint32_t mStreams = 0;
+		bool mStreaming = false;
+	};
+
+	static uint64_t GetUsage(const std::vector<std::unique_ptr<FakeStreamable>>& textures)
+	{
+		uint64_t usage = 0;
+
+		for (auto& texture : textures) {
+			usage += texture->GetResidentBytes(texture->GetResidentLevel());
+		}
+
+		return usage;
+	}
+
+	TEST_CASE(ResidencyPolicy_OverBudget)
+	{
+		// four full resolution textures and room for about one, the one drawn largest keeps the most detail
+		ResidencyPolicy policy;
+		std::vector<std::unique_ptr<FakeStreamable>> textures = {};
+
+		for (uint32_t i = 0; i < 4; i++) {
+			textures.push_back(std::make_unique<FakeStreamable>(2048));
+			policy.Register(textures.back().get());
+		}
+
+		uint64_t budget = textures[0]->GetResidentBytes(0) + textures[0]->GetResidentBytes(2);
+		float sizes[4] = { 1500.0f, 300.0f, 40.0f, 0.0f };
+
+		for (uint32_t frame = 0; frame < 64; frame++)
+		{
+			for (uint32_t i = 0; i < 3; i++) {
+				policy.Touch(textures[i].get(), sizes[i]);
+			}
+
+			uint32_t streams = 0;
+			for (auto& texture : textures) streams += texture->mStreams;
+
+			policy.Update(GetUsage(textures), budget);
+
+			uint32_t after = 0;
+			for (auto& texture : textures) after += texture->mStreams;
+
+			// the work is spread over frames
+			TEST_CHECK(after - streams <= COSMOS_RESIDENCY_UPLOADS_PER_FRAME);
+
+			for (auto& texture : textures) {
+				TEST_CHECK(texture->GetResidentLevel() <= texture->GetFallbackLevel());
+			}
+		}
+
+		TEST_CHECK(GetUsage(textures) <= budget);
+		TEST_CHECK(textures[0]->GetResidentLevel() <= 1);
+		TEST_CHECK(textures[0]->GetResidentLevel() <= textures[1]->GetResidentLevel());
+		TEST_CHECK(textures[1]->GetResidentLevel() <= textures[2]->GetResidentLevel());
+
+		// never drawn, it's at it's fallback
+		TEST_CHECK(textures[3]->GetResidentLevel() == textures[3]->GetFallbackLevel());
+		TEST_CHECK(policy.GetStatisticsRef().textures == 4 && policy.GetStatisticsRef().usage <= budget);
+	}
+
+	TEST_CASE(ResidencyPolicy_StreamIn)
+	{
+		// textures at their fallback get the detail their coverage asks for, as long as it fits
+		ResidencyPolicy policy;
+		std::vector<std::unique_ptr<FakeStreamable>> textures = {};
+
+		for (uint32_t i = 0; i < 3; i++) {
+			textures.push_back(std::make_unique<FakeStreamable>(1024));
+			textures.back()->mResidentLevel = textures.back()->GetFallbackLevel();
+			policy.Register(textures.back().get());
+		}
+
+		// 1024 texels on 512 pixels need level 1, on 2000 pixels level 0, the last one isn't drawn
+		float sizes[3] = { 512.0f, 2000.0f, 0.0f };
+		uint64_t budget = 64ull * 1024 * 1024;
+
+		for (uint32_t frame = 0; frame < 16; frame++)
+		{
+			for (uint32_t i = 0; i < 2; i++) {
+				policy.Touch(textures[i].get(), sizes[i]);
+			}
+
+			policy.Update(GetUsage(textures), budget);
+		}
+
+		TEST_CHECK(textures[0]->GetResidentLevel() == 1);
+		TEST_CHECK(textures[1]->GetResidentLevel() == 0);
+		TEST_CHECK(textures[2]->GetResidentLevel() == textures[2]->GetFallbackLevel());
+
+		// a budget too small for the full chain stops at the level that still fits under the watermark
+		FakeStreamable large(4096);
+		large.mResidentLevel = large.GetFallbackLevel();
+		policy.Register(&large);
+		budget = (GetUsage(textures) + large.GetResidentBytes(2)) / COSMOS_RESIDENCY_LOW_WATERMARK * 100 + 100;
+
+		for (uint32_t frame = 0; frame < 16; frame++) {
+			policy.Touch(textures[0].get(), sizes[0]);
+			policy.Touch(textures[1].get(), sizes[1]);
+			policy.Touch(&large, 4096.0f);
+			policy.Update(GetUsage(textures) + large.GetResidentBytes(large.GetResidentLevel()), budget);
+		}
+
+		TEST_CHECK(large.GetResidentLevel() == 2);
+		policy.Unregister(&large);
+	}
+
+	TEST_CASE(ResidencyPolicy_Idle)
+	{
+		// once idle for long, a texture is the first to lose detail, even against one drawn tiny
+		ResidencyPolicy policy;
+		FakeStreamable idle(1024);
+		FakeStreamable drawn(1024);
+		policy.Register(&idle);
+		policy.Register(&drawn);
+
+		for (uint32_t frame = 0; frame < COSMOS_RESIDENCY_IDLE_FRAMES + 2; frame++) {
+			policy.Touch(&drawn, 2.0f);
+			policy.Update(0, UINT64_MAX);
+		}
+
+		uint64_t budget = idle.GetResidentBytes(0) + drawn.GetResidentBytes(0) - 1;
+		policy.Touch(&drawn, 2.0f);
+		policy.Update(idle.GetResidentBytes(0) + drawn.GetResidentBytes(0), budget);
+
+		TEST_CHECK(idle.GetResidentLevel() == idle.GetFallbackLevel());
+		TEST_CHECK(drawn.GetResidentLevel() == 0);
+	}
+
+	TEST_CASE(ResidencyPolicy_Hysteresis)
+	{
+		// other allocations make usage swing a little around the budget, the texture loses a level once and doesn't get it back
+		ResidencyPolicy policy;
+		FakeStreamable texture(2048);
+		policy.Register(&texture);
+
+		uint64_t others = 8ull * 1024 * 1024;
+		uint64_t budget = texture.GetResidentBytes(0) + others;
+		uint64_t swing = budget / 50;
+
+		for (uint32_t frame = 0; frame < 100; frame++) {
+			policy.Touch(&texture, 2048.0f);
+			policy.Update(texture.GetResidentBytes(texture.GetResidentLevel()) + (frame % 2 == 0 ? others + swing : others - swing), budget);
+		}
+
+		TEST_CHECK(texture.mStreams == 1);
+		TEST_CHECK(texture.GetResidentLevel() == 1);
+
+		// a texture still streaming is left alone, even over budget
+		texture.mStreaming = true;
+		policy.Touch(&texture, 2048.0f);
+		policy.Update(budget * 2, budget);
+		TEST_CHECK(texture.mStreams == 1);
+
+		// once done it's picked again, a single level isn't enough and it keeps losing detail on the next frame, under the budget but over the watermark
+		texture.mStreaming = false;
+		uint64_t over = budget / 20;
+
+		for (uint32_t frame = 0; frame < 8; frame++) {
+			policy.Touch(&texture, 2048.0f);
+			policy.Update(texture.GetResidentBytes(texture.GetResidentLevel()) + budget - texture.GetResidentBytes(1) + over, budget);
+		}
+
+		TEST_CHECK(texture.mStreams == 3);
+		TEST_CHECK(texture.GetResidentLevel() == 3);
+	}
+
+	BENCHMARK_CASE(ResidencyPolicy_Benchmark)
+	{
+		// the per frame cost is a scan of every texture for each stream operation, measured over budget so every frame streams
+		std::mt19937 random(30);
+		std::uniform_real_distribution<float> coverage(0.0f, 2048.0f);
+
+		for (uint32_t count : { 1000u, 10000u })
+		{
+			ResidencyPolicy policy;
+			std::vector<std::unique_ptr<FakeStreamable>> textures = {};
+			std::vector<float> sizes = {};
+
+			for (uint32_t i = 0; i < count; i++) {
+				textures.push_back(std::make_unique<FakeStreamable>(1024));
+				sizes.push_back(coverage(random));
+				policy.Register(textures.back().get());
+			}
+
+			uint64_t budget = GetUsage(textures) / 2;
+
+			double time = Measure(20, [&]()
+				{
+					for (uint32_t i = 0; i < count; i++) {
+						policy.Touch(textures[i].get(), sizes[i]);
+					}
+
+					policy.Update(GetUsage(textures), budget);
+				});
+
+			char name[64];
+			snprintf(name, sizeof(name), "%u textures", count);
+			Report(name, "%8.3fms per frame (touch every texture and update)", time);
+		}
+	}
+}
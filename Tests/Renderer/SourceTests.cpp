@@ -0,0 +1,167 @@
+#include "Core/Test.h"
+
+#include <Renderer/GLTF/Source.h>
+
+#include <cstring>
+#include <fstream>
+
+#if !defined _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Cosmos::Tests
+{
+	// writes a gltf with a single buffer described by the given json, the buffer file holds three positions
+	static std::string WriteSource(const std::string& name, const std::string& buffer)
+	{
+		float positions[9] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+		std::ofstream(GetScratchPath("source buffer.bin"), std::ios::binary).write((const char*)positions, sizeof(positions));
+
+		std::string path = GetScratchPath(name + ".gltf");
+		std::ofstream(path)
+			<< R"({ "asset": { "version": "2.0" }, )"
+			<< R"("accessors": [{ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" }], )"
+			<< R"("bufferViews": [{ "buffer": 0, "byteOffset": 0, "byteLength": 36 }], )"
+			<< R"("buffers": [)" << buffer << "] }";
+
+		return path;
+	}
+
+	static bool LoadSource(const std::string& path, Renderer::GLTF::Source& source, tinygltf::Model& model, std::string& error)
+	{
+		std::string warning;
+		return source.Load(path, model, error, warning);
+	}
+
+	TEST_CASE(Source_EscapedURI)
+	{
+		Renderer::GLTF::Source source;
+		tinygltf::Model model;
+		std::string error;
+
+		TEST_CHECK(LoadSource(WriteSource("source_escaped", R"({ "uri": "source%20buffer%2ebin", "byteLength": 36 })"), source, model, error));
+		TEST_CHECK(source.GetMappedBytes() == 36);
+		TEST_CHECK(model.accessors.size() == 1 && source.IsAccessorValid(model, model.accessors[0]));
+
+		if (model.accessors.size() == 1 && source.IsAccessorValid(model, model.accessors[0])) {
+			float y = 0.0f;
+			memcpy(&y, source.GetAccessorData(model, model.accessors[0]) + 7 * sizeof(float), sizeof(float));
+			TEST_CHECK(y == 1.0f);
+		}
+	}
+
+	TEST_CASE(Source_InvalidEscape)
+	{
+		// none may throw, they fail the load with an error
+		for (const char* uri : { "source%zzbuffer.bin", "source%2", "source buffer.bin%" })
+		{
+			Renderer::GLTF::Source source;
+			tinygltf::Model model;
+			std::string error;
+
+			TEST_CHECK(!LoadSource(WriteSource("source_invalid", std::string(R"({ "uri": ")") + uri + R"(", "byteLength": 36 })"), source, model, error));
+			TEST_CHECK(!error.empty());
+		}
+	}
+
+	TEST_CASE(Source_MissingByteLength)
+	{
+		// tinygltf requires the member, the placeholder adds it, but nothing of the buffer can be read
+		Renderer::GLTF::Source source;
+		tinygltf::Model model;
+		std::string error;
+
+		TEST_CHECK(LoadSource(WriteSource("source_length", R"({ "uri": "source buffer.bin" })"), source, model, error));
+		TEST_CHECK(model.buffers.size() == 1);
+		TEST_CHECK(model.accessors.size() == 1 && !source.IsAccessorValid(model, model.accessors[0]));
+
+		// malformed ones too
+		TEST_CHECK(!LoadSource(WriteSource("source_length", R"([1])"), source, model, error));
+		TEST_CHECK(LoadSource(WriteSource("source_length", R"({ "uri": "source buffer.bin", "byteLength": "36" })"), source, model, error));
+	}
+
+	#if !defined _WIN32
+	// returns the peak resident kilobytes of a child process running func, the parent's pages it touches are counted too
+	static long MeasurePeak(const std::function<void()>& func)
+	{
+		pid_t pid = fork();
+
+		if (pid == 0) {
+			func();
+			_exit(0);
+		}
+
+		int status = 0;
+		rusage usage = {};
+		wait4(pid, &status, 0, &usage);
+		return usage.ru_maxrss;
+	}
+	#endif
+
+	BENCHMARK_CASE(Source_Benchmark)
+	{
+		// a single 64mb position buffer, read whole by both, tinygltf copies it into the model while the source maps it
+		constexpr uint32_t count = 64 * 1024 * 1024 / 12;
+		std::vector<float> positions((size_t)count * 3);
+
+		for (size_t i = 0; i < positions.size(); i++) {
+			positions[i] = (float)(i % 1024);
+		}
+
+		std::ofstream(GetScratchPath("source_large.bin"), std::ios::binary).write((const char*)positions.data(), (std::streamsize)(positions.size() * sizeof(float)));
+		std::vector<float>().swap(positions);
+
+		std::string path = GetScratchPath("source_large.gltf");
+		std::ofstream(path)
+			<< R"({ "asset": { "version": "2.0" }, )"
+			<< R"("accessors": [{ "bufferView": 0, "componentType": 5126, "count": )" << count << R"(, "type": "VEC3" }], )"
+			<< R"("bufferViews": [{ "buffer": 0, "byteOffset": 0, "byteLength": )" << count * 12ull << R"( }], )"
+			<< R"("buffers": [{ "uri": "source_large.bin", "byteLength": )" << count * 12ull << " }] }";
+
+		auto sum = [](const uint8_t* data, size_t bytes)
+			{
+				volatile float total = 0.0f;
+				float value = 0.0f;
+
+				for (size_t offset = 0; offset + sizeof(float) <= bytes; offset += 4096) {
+					memcpy(&value, data + offset, sizeof(float));
+					total = total + value;
+				}
+			};
+
+		auto copied = [&]()
+			{
+				tinygltf::TinyGLTF context;
+				tinygltf::Model model;
+				std::string error, warning;
+				context.LoadASCIIFromFile(&model, &error, &warning, path);
+
+				if (!model.buffers.empty()) {
+					sum(model.buffers[0].data.data(), model.buffers[0].data.size());
+				}
+			};
+
+		auto mapped = [&]()
+			{
+				Renderer::GLTF::Source source;
+				tinygltf::Model model;
+				std::string error;
+
+				if (LoadSource(path, source, model, error) && source.IsAccessorValid(model, model.accessors[0])) {
+					sum(source.GetAccessorData(model, model.accessors[0]), (size_t)count * 12);
+				}
+			};
+
+		Report("tinygltf load", "%8.2fms", Measure(3, copied));
+		Report("source load (mapped)", "%8.2fms", Measure(3, mapped));
+
+		#if !defined _WIN32
+		// mapped pages are file backed and count as resident once touched, but they can be dropped instead of swapped
+		long baseline = MeasurePeak([]() {});
+		Report("tinygltf peak rss", "%8.1fmb over the process", (double)(MeasurePeak(copied) - baseline) / 1024.0);
+		Report("source peak rss (mapped)", "%8.1fmb over the process", (double)(MeasurePeak(mapped) - baseline) / 1024.0);
+		#endif
+	}
+}
@@ -0,0 +1,163 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/StagingRing.h>
+
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	struct StagedUpload
+	{
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint64_t batch = 0;
+	};
+
+	// the uploader without a device, batches are submitted once per frame and the gpu finishes them a few frames later
+	struct RingSimulation
+	{
+		StagingRing ring;
+		std::deque<uint64_t> inFlight = {};							// ring end of every submitted batch
+		std::vector<StagedUpload> live = {};
+		uint64_t retired = 0;
+		uint32_t stalls = 0;
+		bool overlapped = false;
+	};
+
+	// releases the oldest batch and forgets the uploads it held
+	static void RetireOldest(RingSimulation& sim)
+	{
+		sim.ring.Release(sim.inFlight.front(), sim.inFlight.size() == 1);
+		sim.inFlight.pop_front();
+		sim.retired++;
+
+		std::vector<StagedUpload> kept = {};
+
+		for (const StagedUpload& upload : sim.live) {
+			if (upload.batch >= sim.retired) kept.push_back(upload);
+		}
+
+		sim.live = kept;
+	}
+
+	// stages like the uploader does, waiting the oldest batches while the ring is full, flags an upload placed over one still in flight
+	static void Stage(RingSimulation& sim, uint64_t size)
+	{
+		uint64_t offset = 0;
+
+		if (!sim.ring.Allocate(size, offset))
+		{
+			sim.stalls++;
+
+			do {
+				if (sim.inFlight.empty()) {
+					sim.inFlight.push_back(sim.ring.GetHead());
+				}
+
+				RetireOldest(sim);
+			} while (!sim.ring.Allocate(size, offset));
+		}
+
+		for (const StagedUpload& upload : sim.live) {
+			sim.overlapped |= offset < upload.offset + upload.size && upload.offset < offset + size;
+		}
+
+		sim.overlapped |= offset + size > sim.ring.GetCapacity();
+		sim.live.push_back({ offset, size, sim.retired + sim.inFlight.size() });
+	}
+
+	// submits the frame batch, the ones older than latency frames have finished on the gpu
+	static void EndFrame(RingSimulation& sim, uint32_t latency)
+	{
+		sim.inFlight.push_back(sim.ring.GetHead());
+
+		while (sim.inFlight.size() > latency) {
+			RetireOldest(sim);
+		}
+	}
+
+	TEST_CASE(StagingRing_Arithmetic)
+	{
+		// aligned and back to back
+		StagingRing ring(1024, 16);
+		uint64_t offset = 0;
+		TEST_CHECK(ring.Allocate(10, offset) && offset == 0);
+		TEST_CHECK(ring.Allocate(100, offset) && offset == 16);
+		TEST_CHECK(ring.GetHead() == 116);
+
+		// an upload past the end starts over from the beginning, it only fits once the tail moved past it
+		TEST_CHECK(ring.Allocate(800, offset) && offset == 128);
+		TEST_CHECK(!ring.Allocate(200, offset));
+		TEST_CHECK(ring.GetHead() == 928);
+		ring.Release(116, false);
+		TEST_CHECK(ring.Allocate(100, offset) && offset == 0);
+		TEST_CHECK(ring.GetHead() == 1124);
+
+		// the last batch in flight rewinds the ring once nothing is left on it
+		ring.Release(928, false);
+		ring.Release(1124, true);
+		TEST_CHECK(ring.GetHead() == 0 && ring.GetTail() == 0);
+		TEST_CHECK(ring.Allocate(1024, offset) && offset == 0);
+
+		// a release that still leaves uploads on the ring doesn't rewind
+		StagingRing partial(1024, 16);
+		partial.Allocate(100, offset);
+		partial.Allocate(100, offset);
+		partial.Release(100, true);
+		TEST_CHECK(partial.GetTail() == 100 && partial.GetHead() == 212);
+	}
+
+	TEST_CASE(StagingRing_Stalls)
+	{
+		// draining every batch rewinds the ring, uploads after it must not keep stalling on a position from before the rewind
+		StagingRing ring(4096, 16);
+		uint64_t offset = 0;
+		TEST_CHECK(ring.Allocate(2000, offset));
+		uint64_t first = ring.GetHead();
+		TEST_CHECK(ring.Allocate(2000, offset));
+		uint64_t second = ring.GetHead();
+
+		TEST_CHECK(!ring.Allocate(2500, offset));
+		ring.Release(first, false);
+		TEST_CHECK(!ring.Allocate(2500, offset));
+		ring.Release(second, true);
+		TEST_CHECK(ring.Allocate(2500, offset) && offset == 0);
+		TEST_CHECK(ring.Allocate(1000, offset) && offset == 2512);
+
+		// a burst larger than the ring drains it, the frames after it fit and must never wait
+		for (uint32_t seed = 0; seed < 8; seed++)
+		{
+			RingSimulation sim = { StagingRing(1 << 16, 256) };
+			std::mt19937 random(seed);
+			std::uniform_int_distribution<uint64_t> sizes(1, (1 << 16) / 4);
+
+			for (uint32_t i = 0; i < 16; i++) {
+				Stage(sim, sizes(random));
+			}
+
+			// the gpu catches up with the burst
+			EndFrame(sim, 0);
+			TEST_CHECK(sim.stalls > 0 && sim.ring.GetHead() == 0);
+			sim.stalls = 0;
+
+			// three frames in flight at most, each one under a third of the ring
+			std::uniform_int_distribution<uint64_t> small(1, (1 << 16) / 16);
+
+			for (uint32_t frame = 0; frame < 2000; frame++)
+			{
+				for (uint32_t i = 0; i < 4; i++) {
+					Stage(sim, small(random));
+				}
+
+				EndFrame(sim, 2);
+			}
+
+			TEST_CHECK(!sim.overlapped);
+			TEST_CHECK(sim.stalls == 0);
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/KTXFile.h>
+#include <Renderer/Core/TextureCooker.h>
+
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	using namespace Renderer;
+
+	TEST_CASE(TextureCooker_MipChain)
+	{
+		// odd sizes repeat their last row/column, a solid image must stay solid on every level with both filters
+		constexpr uint32_t width = 37;
+		constexpr uint32_t height = 20;
+		std::vector<uint8_t> pixels((size_t)width * height * 4);
+
+		for (size_t i = 0; i < pixels.size(); i += 4) {
+			pixels[i + 0] = 200;
+			pixels[i + 1] = 90;
+			pixels[i + 2] = 17;
+			pixels[i + 3] = 255;
+		}
+
+		for (TextureCooker::Filter filter : { TextureCooker::Filter::Box, TextureCooker::Filter::Kaiser })
+		{
+			TextureCooker::MipChain chain = TextureCooker::GenerateMipChain(pixels.data(), width, height, filter);
+			TEST_CHECK(chain.width == width && chain.height == height);
+			TEST_CHECK(chain.levels.size() == 6);
+
+			for (size_t level = 0; level < chain.levels.size(); level++)
+			{
+				uint32_t levelWidth = std::max(width >> level, 1u);
+				uint32_t levelHeight = std::max(height >> level, 1u);
+				TEST_CHECK(chain.levels[level].size == (uint64_t)levelWidth * levelHeight * 4);
+				TEST_CHECK(chain.levels[level].offset + chain.levels[level].size <= chain.pixels.size());
+
+				const uint8_t* data = chain.pixels.data() + chain.levels[level].offset;
+				bool solid = true;
+
+				for (uint64_t i = 0; i < chain.levels[level].size; i += 4) {
+					for (uint32_t channel = 0; channel < 4; channel++) {
+						solid &= std::abs((int32_t)data[i + channel] - (int32_t)pixels[channel]) <= 1;
+					}
+				}
+
+				TEST_CHECK(solid);
+			}
+		}
+	}
+
+	BENCHMARK_CASE(TextureCooker_Benchmark)
+	{
+		// a 2048x2048 albedo, smooth gradients with some noise so the png compresses like a photo would
+		constexpr int32_t size = 2048;
+		std::mt19937 random(43);
+		std::uniform_int_distribution<int32_t> noise(-12, 12);
+		std::vector<uint8_t> pixels((size_t)size * size * 4);
+
+		for (int32_t y = 0; y < size; y++) {
+			for (int32_t x = 0; x < size; x++) {
+				uint8_t* pixel = &pixels[((size_t)y * size + x) * 4];
+				pixel[0] = (uint8_t)std::clamp(x / 8 + noise(random), 0, 255);
+				pixel[1] = (uint8_t)std::clamp(y / 8 + noise(random), 0, 255);
+				pixel[2] = (uint8_t)std::clamp((x + y) / 16 + noise(random), 0, 255);
+				pixel[3] = 255;
+			}
+		}
+
+		std::string source = GetScratchPath("cooker_albedo.png");
+		stbi_write_png(source.c_str(), size, size, 4, pixels.data(), size * 4);
+
+		// offline, the whole chain on the cpu
+		Report("mip chain box", "%8.2fms", Measure(3, [&]() { TextureCooker::GenerateMipChain(pixels.data(), size, size, TextureCooker::Filter::Box); }));
+		Report("mip chain kaiser", "%8.2fms", Measure(3, [&]() { TextureCooker::GenerateMipChain(pixels.data(), size, size, TextureCooker::Filter::Kaiser); }));
+		Report("cook albedo (kaiser + bc7)", "%8.2fms", Measure(1, [&]() { TextureCooker::Cook(source, TextureCooker::Usage::Albedo); }));
+
+		// the cpu side of a load up to the staging copy, the runtime path then blits it's mips on the gpu while the cooked one uploads them as they are
+		std::vector<uint8_t> staging = {};
+		uint64_t runtimeBytes = 0;
+		uint64_t cookedBytes = 0;
+
+		double runtime = Measure(5, [&]()
+			{
+				int32_t width = 0, height = 0, channels = 0;
+				stbi_uc* decoded = stbi_load(source.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+				if (decoded != nullptr) {
+					runtimeBytes = (uint64_t)width * height * 4;
+					staging.resize(runtimeBytes);
+					memcpy(staging.data(), decoded, runtimeBytes);
+					stbi_image_free(decoded);
+				}
+			});
+
+		std::string cooked = TextureCooker::FindCooked(source);
+		TEST_CHECK(!cooked.empty());
+
+		double precomputed = Measure(5, [&]()
+			{
+				KTXFile file;
+
+				if (file.Open(cooked)) {
+					const KTXFile::Level& first = file.GetLevel(0);
+					const KTXFile::Level& last = file.GetLevel(file.GetLevelCount() - 1);
+					cookedBytes = std::max(first.offset + first.size, last.offset + last.size) - std::min(first.offset, last.offset);
+					staging.resize(cookedBytes);
+					memcpy(staging.data(), file.GetData() + std::min(first.offset, last.offset), cookedBytes);
+				}
+			});
+
+		Report("load png (runtime blit mips)", "%8.2fms, %.1fmb staged, 1 level", runtime, (double)runtimeBytes / (1024.0 * 1024.0));
+		Report("load ktx2 (precomputed mips)", "%8.2fms, %.1fmb staged, all levels", precomputed, (double)cookedBytes / (1024.0 * 1024.0));
+
+		std::filesystem::remove(cooked);
+	}
+}
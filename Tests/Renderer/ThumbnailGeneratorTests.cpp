@@ -0,0 +1,154 @@
+#include "Core/Test.h"
+
+#include <Renderer/Core/ThumbnailGenerator.h>
+
+#include <cstring>
+#include <fstream>
+
+namespace Cosmos::Tests
+{
+	// a single triangle, three positions followed by three 16-bit indices, 44 bytes with padding
+	static const char* s_Buffer = "mesh.bin";
+
+	static void WriteBuffer()
+	{
+		float positions[9] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+		uint16_t indices[4] = { 0, 1, 2, 0 };
+
+		std::ofstream file(GetScratchPath(s_Buffer), std::ios::binary);
+		file.write((const char*)positions, sizeof(positions));
+		file.write((const char*)indices, sizeof(indices));
+	}
+
+	// writes a gltf whose parts may be replaced, the defaults describe the valid triangle
+	struct Document
+	{
+		std::string scenes = R"([{ "nodes": [0] }])";
+		std::string nodes = R"([{ "mesh": 0 }])";
+		std::string meshes = R"([{ "primitives": [{ "attributes": { "POSITION": 0 }, "indices": 1 }] }])";
+		std::string accessors = R"([{ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" }, { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" }])";
+		std::string bufferViews = R"([{ "buffer": 0, "byteOffset": 0, "byteLength": 36 }, { "buffer": 0, "byteOffset": 36, "byteLength": 6 }])";
+		std::string extra = "";
+
+		bool Generate(const std::string& name, std::vector<uint8_t>& pixels) const
+		{
+			std::string path = GetScratchPath(name + ".gltf");
+
+			{
+				std::ofstream file(path);
+				file << R"({ "asset": { "version": "2.0" }, )" << extra
+					<< R"("scenes": )" << scenes << ", "
+					<< R"("nodes": )" << nodes << ", "
+					<< R"("meshes": )" << meshes << ", "
+					<< R"("accessors": )" << accessors << ", "
+					<< R"("bufferViews": )" << bufferViews << ", "
+					<< R"("buffers": [{ "uri": ")" << s_Buffer << R"(", "byteLength": 44 }] })";
+			}
+
+			return Renderer::ThumbnailGenerator::Generate(path, 32, pixels);
+		}
+	};
+
+	static bool HasCoverage(const std::vector<uint8_t>& pixels)
+	{
+		for (size_t i = 3; i < pixels.size(); i += 4) {
+			if (pixels[i] != 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	TEST_CASE(ThumbnailGenerator_Mesh)
+	{
+		WriteBuffer();
+		std::vector<uint8_t> pixels;
+
+		TEST_CHECK(Document().Generate("valid", pixels));
+		TEST_CHECK(pixels.size() == 32 * 32 * 4 && HasCoverage(pixels));
+
+		// without indices the positions are the triangle
+		Document unindexed;
+		unindexed.meshes = R"([{ "primitives": [{ "attributes": { "POSITION": 0 } }] }])";
+		TEST_CHECK(unindexed.Generate("unindexed", pixels) && HasCoverage(pixels));
+	}
+
+	TEST_CASE(ThumbnailGenerator_MalformedAccessors)
+	{
+		WriteBuffer();
+		std::vector<uint8_t> pixels;
+
+		// each file is rejected or skips the broken primitive, none may read out of bounds
+		Document missing;
+		missing.meshes = R"([{ "primitives": [{ "attributes": { "POSITION": 7 }, "indices": 9 }] }])";
+		TEST_CHECK(!missing.Generate("missing", pixels));
+
+		Document sparse;
+		sparse.accessors = R"([{ "componentType": 5126, "count": 3, "type": "VEC3", "sparse": { "count": 1, "indices": { "bufferView": 1, "componentType": 5123 }, "values": { "bufferView": 0 } } }, { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" }])";
+		TEST_CHECK(!sparse.Generate("sparse", pixels));
+
+		Document overrun;
+		overrun.accessors = R"([{ "bufferView": 0, "componentType": 5126, "count": 1000000, "type": "VEC3" }, { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" }])";
+		TEST_CHECK(!overrun.Generate("overrun", pixels));
+
+		Document overflow;
+		overflow.accessors = R"([{ "bufferView": 0, "componentType": 5126, "count": 4611686018427387904, "type": "VEC3" }, { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" }])";
+		TEST_CHECK(!overflow.Generate("overflow", pixels));
+
+		Document stride;
+		stride.bufferViews = R"([{ "buffer": 0, "byteOffset": 0, "byteLength": 36, "byteStride": 24 }, { "buffer": 0, "byteOffset": 36, "byteLength": 6 }])";
+		TEST_CHECK(!stride.Generate("stride", pixels));
+
+		Document view;
+		view.bufferViews = R"([{ "buffer": 0, "byteOffset": 40, "byteLength": 36 }, { "buffer": 0, "byteOffset": 36, "byteLength": 6 }])";
+		TEST_CHECK(!view.Generate("view", pixels));
+
+		Document indices;
+		indices.accessors = R"([{ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" }, { "bufferView": 1, "componentType": 5123, "count": 300, "type": "SCALAR" }])";
+		TEST_CHECK(!indices.Generate("indices", pixels));
+
+		Document floatIndices;
+		floatIndices.accessors = R"([{ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" }, { "bufferView": 0, "componentType": 5126, "count": 3, "type": "SCALAR" }])";
+		TEST_CHECK(!floatIndices.Generate("float_indices", pixels));
+	}
+
+	TEST_CASE(ThumbnailGenerator_MalformedNodes)
+	{
+		WriteBuffer();
+		std::vector<uint8_t> pixels;
+
+		Document mesh;
+		mesh.nodes = R"([{ "mesh": 5 }])";
+		TEST_CHECK(!mesh.Generate("node_mesh", pixels));
+
+		Document scene;
+		scene.scenes = R"([{ "nodes": [3] }])";
+		TEST_CHECK(!scene.Generate("scene_nodes", pixels));
+
+		Document child;
+		child.nodes = R"([{ "children": [-2, 8] }])";
+		TEST_CHECK(!child.Generate("children", pixels));
+
+		Document defaultScene;
+		defaultScene.extra = R"("scene": 4, )";
+		defaultScene.Generate("default_scene", pixels);
+
+		// cycles must end, the mesh is still drawn once
+		Document cycle;
+		cycle.nodes = R"([{ "children": [1] }, { "mesh": 0, "children": [0, 1] }])";
+		TEST_CHECK(cycle.Generate("cycle", pixels) && HasCoverage(pixels));
+
+		// a node shared by many parents at every level would otherwise be gathered exponentially many times
+		std::string nodes = "[";
+
+		for (uint32_t i = 0; i < 64; i++) {
+			nodes += "{ \"mesh\": 0, \"children\": [" + std::to_string(i + 1) + ", " + std::to_string(i + 1) + "] }, ";
+		}
+
+		nodes += "{ \"mesh\": 0 }]";
+		Document shared;
+		shared.nodes = nodes;
+		TEST_CHECK(shared.Generate("shared", pixels) && HasCoverage(pixels));
+	}
+}
@@ -0,0 +1,115 @@
+#include "Core/Test.h"
+
+#include <Common/Util/Algorithm.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace Cosmos::Tests
+{
+	// the size of a render queue packet, a key and what it sorts
+	struct SortItem
+	{
+		uint64_t key = 0;
+		void* payload = nullptr;
+		uint32_t order = 0;
+	};
+
+	static void CheckRadixSort(std::vector<SortItem> items)
+	{
+		for (uint32_t i = 0; i < (uint32_t)items.size(); i++) {
+			items[i].order = i;
+		}
+
+		std::vector<SortItem> expected = items;
+		std::stable_sort(expected.begin(), expected.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+
+		std::vector<SortItem> scratch = {};
+		RadixSort(items, scratch, [](const SortItem& item) { return item.key; });
+
+		// stable, equal keys keep their submission order
+		bool equal = items.size() == expected.size();
+
+		for (size_t i = 0; equal && i < items.size(); i++) {
+			equal = items[i].key == expected[i].key && items[i].order == expected[i].order;
+		}
+
+		TEST_CHECK(equal);
+	}
+
+	// keys laid out like the render queue ones, a few pipelines, some materials and meshes and a depth
+	static uint64_t MakeQueueKey(std::mt19937& random, uint32_t materials, uint32_t meshes)
+	{
+		float depth = std::uniform_real_distribution<float>(0.5f, 500.0f)(random);
+		uint32_t depthBits = 0;
+		memcpy(&depthBits, &depth, sizeof(float));
+
+		uint64_t pipeline = random() % 3;
+		uint64_t material = random() % materials;
+		uint64_t mesh = random() % meshes;
+		return (pipeline << 56) | (material << 36) | (mesh << 16) | (depthBits >> 16);
+	}
+
+	TEST_CASE(Algorithm_RadixSort)
+	{
+		std::mt19937_64 random(31);
+
+		CheckRadixSort({});
+		CheckRadixSort({ { 7 } });
+
+		for (size_t count : { 2, 3, 100, 4097 })
+		{
+			std::vector<SortItem> items(count);
+
+			// full range keys
+			for (SortItem& item : items) item.key = random();
+			CheckRadixSort(items);
+
+			// many duplicates, stability matters
+			for (SortItem& item : items) item.key = random() % 5;
+			CheckRadixSort(items);
+
+			// only the top byte differs, every other pass is skipped
+			for (SortItem& item : items) item.key = (random() % 256) << 56;
+			CheckRadixSort(items);
+
+			// all the same
+			for (SortItem& item : items) item.key = 0xDEADBEEF;
+			CheckRadixSort(items);
+
+			// already sorted and reversed
+			for (size_t i = 0; i < count; i++) items[i].key = i * 0x10001;
+			CheckRadixSort(items);
+			std::reverse(items.begin(), items.end());
+			CheckRadixSort(items);
+		}
+	}
+
+	BENCHMARK_CASE(Algorithm_RadixSortBenchmark)
+	{
+		std::mt19937 random(31);
+
+		for (uint32_t count : { 10000u, 100000u })
+		{
+			std::vector<SortItem> source(count);
+
+			for (SortItem& item : source) {
+				item.key = MakeQueueKey(random, 50, 50);
+			}
+
+			std::vector<SortItem> items = {};
+			std::vector<SortItem> scratch = {};
+
+			// the copy is timed apart and taken out, only the sort itself is compared
+			double copy = Measure(20, [&]() { items = source; });
+			double radix = Measure(20, [&]() { items = source; RadixSort(items, scratch, [](const SortItem& item) { return item.key; }); }) - copy;
+			double introsort = Measure(20, [&]() { items = source; std::sort(items.begin(), items.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; }); }) - copy;
+			double stable = Measure(20, [&]() { items = source; std::stable_sort(items.begin(), items.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; }); }) - copy;
+
+			char name[64];
+			snprintf(name, sizeof(name), "%u packets", count);
+			Report(name, "radix %.3fms, std::sort %.3fms, std::stable_sort %.3fms", radix, introsort, stable);
+		}
+	}
+}
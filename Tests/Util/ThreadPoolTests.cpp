@@ -0,0 +1,109 @@
+#include "Core/Test.h"
+
+#include <Common/Util/ThreadPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+
+namespace Cosmos::Tests
+{
+	TEST_CASE(ThreadPool_ParallelFor)
+	{
+		ThreadPool pool(3);
+
+		for (size_t count : { 0, 1, 2, 7, 1000 }) {
+			std::vector<std::atomic<uint32_t>> visits(count);
+			pool.ParallelFor(count, [&](size_t i) { visits[i]++; });
+
+			for (size_t i = 0; i < count; i++) {
+				TEST_CHECK(visits[i] == 1);
+			}
+		}
+	}
+
+	TEST_CASE(ThreadPool_NestedParallelFor)
+	{
+		// every worker is inside the outer loop, the inner helpers queue behind them and must not be waited on
+		ThreadPool pool(2);
+		std::atomic<uint64_t> sum = 0;
+
+		pool.ParallelFor(16, [&](size_t i)
+			{
+				pool.ParallelFor(100, [&](size_t j) { sum += i * 100 + j; });
+			});
+
+		TEST_CHECK(sum == 1600 * 1599 / 2);
+	}
+
+	TEST_CASE(ThreadPool_BusyWorkers)
+	{
+		// the only worker is blocked until the loop returns, so the caller must do all of it alone
+		ThreadPool pool(1);
+		std::promise<void> release;
+		std::shared_future<void> released = release.get_future().share();
+		std::future<void> blocker = pool.Enqueue([released]() { released.wait(); });
+
+		std::vector<uint32_t> values(64, 0);
+		pool.ParallelFor(values.size(), [&](size_t i) { values[i] = (uint32_t)i; });
+		release.set_value();
+		blocker.wait();
+
+		std::vector<uint32_t> expected(64);
+		std::iota(expected.begin(), expected.end(), 0);
+		TEST_CHECK(values == expected);
+	}
+
+	TEST_CASE(ThreadPool_BackgroundLimit)
+	{
+		ThreadPool pool(4);
+		TEST_CHECK(pool.GetBackgroundLimit() == 2);
+
+		std::atomic<uint32_t> running = 0;
+		std::atomic<uint32_t> peak = 0;
+		std::vector<std::future<void>> futures = {};
+
+		for (uint32_t i = 0; i < 16; i++) {
+			futures.push_back(pool.EnqueueBackground([&]()
+				{
+					uint32_t now = ++running;
+					uint32_t previous = peak;
+
+					while (now > previous && !peak.compare_exchange_weak(previous, now)) {}
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(2));
+					running--;
+				}));
+		}
+
+		// regular work still gets the free workers while the background queue is full
+		std::vector<std::atomic<uint32_t>> visits(256);
+		pool.ParallelFor(visits.size(), [&](size_t i) { visits[i]++; });
+
+		for (auto& future : futures) {
+			future.wait();
+		}
+
+		for (auto& visit : visits) {
+			TEST_CHECK(visit == 1);
+		}
+
+		TEST_CHECK(peak >= 1 && peak <= pool.GetBackgroundLimit());
+	}
+
+	TEST_CASE(ThreadPool_DrainOnDestruction)
+	{
+		// background tasks queued over the limit still run before the pool is gone
+		std::atomic<uint32_t> done = 0;
+
+		{
+			ThreadPool pool(2);
+
+			for (uint32_t i = 0; i < 8; i++) {
+				pool.EnqueueBackground([&done]() { done++; });
+			}
+		}
+
+		TEST_CHECK(done == 8);
+	}
+}
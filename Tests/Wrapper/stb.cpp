@@ -0,0 +1,17 @@
+#include <Platform/Core/PlatformDetection.h>
+
+// the renderer defines these next to the vulkan ones, wich the tests don't link
+#if defined(PLATFORM_WINDOWS)
+#pragma warning(push)
+#pragma warning(disable : 6272 6262 26827 26819 4996)
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#if defined(PLATFORM_WINDOWS)
+#pragma warning(pop)
+#endif